@@ -3,6 +3,10 @@
 #ifndef APPS_H_
 #define APPS_H_
 
+#define FILTER_SPECIFIER_HELP_STR \
+"Resampling filter specifier: filter[:param_a[:param_b]]\n" \
+"filter: point, bilinear, bicubic, spline16, spline36, lanczos\n"
+
 #define PIXFMT_SPECIFIER_HELP_STR \
 "Pixel format specifier: type[:fullrange[chroma][:depth]]\n" \
 "fullrange: f=fullrange, l=limited\n" \
@@ -18,6 +22,10 @@ int arg_decode_cpu(const struct ArgparseOption *opt, void *out, const char *para
 
 int arg_decode_pixfmt(const struct ArgparseOption *opt, void *out, const char *param, int negated);
 
+int arg_decode_filter(const struct ArgparseOption *opt, void *out, const char *param, int negated);
+
+int bench_main(int argc, char **argv);
+
 int colorspace_main(int argc, char **argv);
 
 int depth_main(int argc, char **argv);
@@ -26,6 +34,8 @@ int graph_main(int argc, char **argv);
 
 int resize_main(int argc, char **argv);
 
+int tiers_main(int argc, char **argv);
+
 int unresize_main(int argc, char **argv);
 
 #ifdef __cplusplus
@@ -0,0 +1,468 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <regex>
+#include <string>
+#include <vector>
+#include "common/except.h"
+#include "common/pixel.h"
+#include "graph/image_buffer.h"
+#include "graph/image_filter.h"
+#include "colorspace/colorspace.h"
+#include "depth/depth.h"
+#include "resize/filter.h"
+#include "resize/resize_impl.h"
+#include "unresize/unresize_impl.h"
+
+#ifdef ZIMG_X86
+  #if defined(_MSC_VER)
+    #include <intrin.h>
+  #else
+    #include <x86intrin.h>
+  #endif
+#endif
+
+#include "apps.h"
+#include "argparse.h"
+#include "frame.h"
+#include "json.h"
+#include "perf.h"
+#include "table.h"
+#include "timer.h"
+#include "utils.h"
+
+namespace {
+
+typedef std::function<std::unique_ptr<zimg::graph::ImageFilter>(zimg::CPUClass)> filter_factory;
+
+struct Benchmark {
+	std::string name;
+	zimg::PixelType src_type;
+	zimg::PixelType dst_type;
+	unsigned src_width;
+	unsigned src_height;
+	unsigned dst_width;
+	unsigned dst_height;
+	unsigned planes;
+	unsigned depth;
+	filter_factory create;
+};
+
+struct Result {
+	std::string name;
+	const char *cpu;
+	double seconds;
+	double pixels_per_second;
+	double bytes_per_second;
+	double cycles_per_pixel;
+	std::string counters;
+};
+
+const char *pixel_name(zimg::PixelType type)
+{
+	for (const auto &entry : g_pixel_table) {
+		if (entry.second == type)
+			return entry.first;
+	}
+	return "";
+}
+
+// Timestamp counter, in reference cycles. Returns zero if unavailable.
+uint64_t read_cycle_counter()
+{
+#ifdef ZIMG_X86
+	return __rdtsc();
+#else
+	return 0;
+#endif
+}
+
+void add_resize(std::vector<Benchmark> &list, unsigned w, unsigned h)
+{
+	// Resample at the same size with a sub-pixel shift, so that each filter
+	// is evaluated with exactly twice its support in taps.
+	static const char *filters[] = { "bilinear", "bicubic", "spline36", "lanczos" };
+	static const zimg::PixelType types[] = { zimg::PixelType::WORD, zimg::PixelType::HALF, zimg::PixelType::FLOAT };
+
+	for (const char *filter_name : filters) {
+		std::shared_ptr<zimg::resize::Filter> filter{ g_resize_table[filter_name](NAN, NAN) };
+
+		for (zimg::PixelType type : types) {
+			for (bool horizontal : { true, false }) {
+				std::string name = std::string{ horizontal ? "resize_h/" : "resize_v/" } + filter_name + '/' + pixel_name(type);
+				auto create = [=](zimg::CPUClass cpu)
+				{
+					return zimg::resize::ResizeImplBuilder{ w, h, type }
+						.set_horizontal(horizontal)
+						.set_dst_dim(horizontal ? w : h)
+						.set_depth(zimg::pixel_depth(type))
+						.set_filter(filter.get())
+						.set_shift(0.25)
+						.set_subwidth(horizontal ? w : h)
+						.set_cpu(cpu)
+						.create();
+				};
+				list.push_back({ name, type, type, w, h, w, h, 1, zimg::pixel_depth(type), create });
+			}
+		}
+	}
+}
+
+void add_depth(std::vector<Benchmark> &list, unsigned w, unsigned h)
+{
+	static const std::pair<zimg::PixelFormat, zimg::PixelFormat> conversions[] = {
+		{ { zimg::PixelType::BYTE, 8 },   { zimg::PixelType::WORD, 16 } },
+		{ { zimg::PixelType::WORD, 10 },  { zimg::PixelType::WORD, 16 } },
+		{ { zimg::PixelType::BYTE, 8 },   zimg::PixelType::FLOAT },
+		{ { zimg::PixelType::WORD, 10 },  zimg::PixelType::FLOAT },
+		{ zimg::PixelType::HALF,          zimg::PixelType::FLOAT },
+		{ zimg::PixelType::FLOAT,         zimg::PixelType::HALF },
+		{ zimg::PixelType::FLOAT,         { zimg::PixelType::WORD, 16 } },
+		{ zimg::PixelType::FLOAT,         { zimg::PixelType::BYTE, 8 } },
+		{ { zimg::PixelType::WORD, 10 },  { zimg::PixelType::BYTE, 8 } },
+	};
+
+	for (const auto &conv : conversions) {
+		std::string name = std::string{ "depth/" } +
+			pixel_name(conv.first.type) + std::to_string(conv.first.depth) + '-' +
+			pixel_name(conv.second.type) + std::to_string(conv.second.depth);
+		zimg::PixelFormat format_in = conv.first;
+		zimg::PixelFormat format_out = conv.second;
+		auto create = [=](zimg::CPUClass cpu)
+		{
+			return zimg::depth::DepthConversion{ w, h }
+				.set_pixel_in(format_in)
+				.set_pixel_out(format_out)
+				.set_dither_type(zimg::depth::DitherType::NONE)
+				.set_cpu(cpu)
+				.create();
+		};
+		list.push_back({ name, format_in.type, format_out.type, w, h, w, h, 1, format_in.depth, create });
+	}
+
+	for (const auto &entry : g_dither_table) {
+		if (entry.second == zimg::depth::DitherType::NONE)
+			continue;
+
+		zimg::depth::DitherType dither = entry.second;
+		auto create = [=](zimg::CPUClass cpu)
+		{
+			return zimg::depth::DepthConversion{ w, h }
+				.set_pixel_in(zimg::PixelFormat{ zimg::PixelType::WORD, 10 })
+				.set_pixel_out(zimg::PixelFormat{ zimg::PixelType::BYTE, 8 })
+				.set_dither_type(dither)
+				.set_cpu(cpu)
+				.create();
+		};
+		list.push_back({ std::string{ "dither/" } + entry.first + "/word10-byte8", zimg::PixelType::WORD, zimg::PixelType::BYTE, w, h, w, h, 1, 10, create });
+	}
+}
+
+void add_colorspace(std::vector<Benchmark> &list, unsigned w, unsigned h)
+{
+	using zimg::colorspace::ColorspaceDefinition;
+	using zimg::colorspace::ColorPrimaries;
+	using zimg::colorspace::MatrixCoefficients;
+	using zimg::colorspace::TransferCharacteristics;
+
+	static const ColorspaceDefinition yuv_709{ MatrixCoefficients::REC_709, TransferCharacteristics::REC_709, ColorPrimaries::REC_709 };
+	static const ColorspaceDefinition rgb_709 = yuv_709.to_rgb();
+	static const ColorspaceDefinition rgb_linear_709 = rgb_709.to_linear();
+	static const ColorspaceDefinition rgb_linear_2020 = rgb_linear_709.to(ColorPrimaries::REC_2020);
+
+	static const struct {
+		const char *name;
+		ColorspaceDefinition csp_in;
+		ColorspaceDefinition csp_out;
+	} conversions[] = {
+		{ "matrix/yuv-rgb",         yuv_709,         rgb_709 },
+		{ "matrix/rgb-yuv",         rgb_709,         yuv_709 },
+		{ "gamma/to_linear",        rgb_709,         rgb_linear_709 },
+		{ "gamma/from_linear",      rgb_linear_709,  rgb_709 },
+		{ "gamut/2020-709",         rgb_linear_2020, rgb_linear_709 },
+	};
+
+	for (const auto &conv : conversions) {
+		ColorspaceDefinition csp_in = conv.csp_in;
+		ColorspaceDefinition csp_out = conv.csp_out;
+		auto create = [=](zimg::CPUClass cpu)
+		{
+			return zimg::colorspace::ColorspaceConversion{ w, h }
+				.set_csp_in(csp_in)
+				.set_csp_out(csp_out)
+				.set_cpu(cpu)
+				.create();
+		};
+		list.push_back({ conv.name, zimg::PixelType::FLOAT, zimg::PixelType::FLOAT, w, h, w, h, 3, 32, create });
+	}
+}
+
+void add_unresize(std::vector<Benchmark> &list, unsigned w, unsigned h)
+{
+	static const zimg::PixelType types[] = { zimg::PixelType::WORD, zimg::PixelType::FLOAT };
+
+	for (zimg::PixelType type : types) {
+		for (bool horizontal : { true, false }) {
+			std::string name = std::string{ horizontal ? "unresize_h/" : "unresize_v/" } + pixel_name(type);
+			unsigned orig_dim = (horizontal ? w : h) * 2 / 3;
+			auto create = [=](zimg::CPUClass cpu)
+			{
+				return zimg::unresize::UnresizeImplBuilder{ w, h, type }
+					.set_horizontal(horizontal)
+					.set_orig_dim(orig_dim)
+					.set_cpu(cpu)
+					.create();
+			};
+			list.push_back({ name, type, type, w, h, horizontal ? orig_dim : w, horizontal ? h : orig_dim, 1, zimg::pixel_depth(type), create });
+		}
+	}
+}
+
+std::vector<Benchmark> make_benchmarks(unsigned w, unsigned h)
+{
+	std::vector<Benchmark> list;
+	add_resize(list, w, h);
+	add_depth(list, w, h);
+	add_colorspace(list, w, h);
+	add_unresize(list, w, h);
+	return list;
+}
+
+
+Result run_benchmark(const Benchmark &bench, const zimg::graph::ImageFilter *filter, const char *cpu_name, unsigned times, PerfCounters *perf)
+{
+	ImageFrame src_frame{ bench.src_width, bench.src_height, bench.src_type, bench.planes, bench.planes == 3 };
+	ImageFrame dst_frame{ bench.dst_width, bench.dst_height, bench.dst_type, bench.planes, bench.planes == 3 };
+	fill_random(src_frame, bench.depth);
+
+	FilterExecutor executor{ filter, nullptr, &src_frame, &dst_frame };
+	uint64_t min_cycles = UINT64_MAX;
+
+	// Warm up caches and lazily initialized tables.
+	executor();
+
+	if (perf)
+		perf->reset();
+
+	auto results = measure_benchmark(times, [&]()
+	{
+		if (perf)
+			perf->start();
+
+		uint64_t start = read_cycle_counter();
+		executor();
+		min_cycles = std::min(min_cycles, read_cycle_counter() - start);
+
+		if (perf)
+			perf->stop();
+	});
+
+	double pixels = static_cast<double>(bench.dst_width) * bench.dst_height;
+	double bytes = (static_cast<double>(bench.src_width) * bench.src_height * zimg::pixel_size(bench.src_type) +
+	                static_cast<double>(bench.dst_width) * bench.dst_height * zimg::pixel_size(bench.dst_type)) * bench.planes;
+
+	Result result{};
+	result.name = bench.name;
+	result.cpu = cpu_name;
+	result.seconds = results.second;
+	result.pixels_per_second = pixels / results.second;
+	result.bytes_per_second = bytes / results.second;
+	result.cycles_per_pixel = min_cycles ? min_cycles / pixels : NAN;
+	if (perf)
+		result.counters = perf->to_json(pixels * times);
+	return result;
+}
+
+void write_json(std::ostream &os, const std::vector<Result> &results, unsigned w, unsigned h)
+{
+	os << std::setprecision(6);
+	os << "{\n";
+	os << "\"width\":" << w << ",\"height\":" << h << ",\n";
+	os << "\"results\":[";
+
+	for (size_t i = 0; i < results.size(); ++i) {
+		const Result &r = results[i];
+
+		os << (i ? ",\n" : "\n");
+		os << "{\"name\":\"" << r.name << "\",\"cpu\":\"" << r.cpu << '"';
+		os << ",\"seconds\":" << r.seconds;
+		os << ",\"pixels_per_second\":" << r.pixels_per_second;
+		os << ",\"gigabytes_per_second\":" << r.bytes_per_second / 1e9;
+		os << ",\"cycles_per_pixel\":";
+		if (std::isnan(r.cycles_per_pixel))
+			os << "null";
+		else
+			os << r.cycles_per_pixel;
+		if (!r.counters.empty())
+			os << ",\"counters\":" << r.counters;
+		os << '}';
+	}
+
+	os << "\n]\n}\n";
+}
+
+// Report results slower than the baseline by more than [threshold] percent.
+unsigned compare_baseline(const std::vector<Result> &results, const char *path, double threshold)
+{
+	std::ifstream f;
+
+	f.exceptions(std::ios_base::badbit | std::ios_base::failbit);
+	f.open(path);
+
+	std::string baseline_json{ std::istreambuf_iterator<char>{ f }, std::istreambuf_iterator<char>{} };
+	json::Object baseline = std::move(json::parse_document(baseline_json).object());
+
+	std::map<std::string, double> baseline_map;
+	for (const json::Value &entry : baseline["results"].array()) {
+		const json::Object &obj = entry.object();
+		baseline_map[obj["name"].string() + '@' + obj["cpu"].string()] = obj["pixels_per_second"].number();
+	}
+
+	unsigned regressions = 0;
+
+	for (const Result &r : results) {
+		auto it = baseline_map.find(r.name + '@' + r.cpu);
+		if (it == baseline_map.end())
+			continue;
+
+		double change = (r.pixels_per_second / it->second - 1.0) * 100.0;
+		if (change < -threshold) {
+			std::cerr << "regression: " << r.name << " (" << r.cpu << "): " << std::fixed << std::setprecision(1) << change << "%\n";
+			std::cerr.unsetf(std::ios_base::floatfield);
+			++regressions;
+		}
+	}
+
+	return regressions;
+}
+
+
+struct Arguments {
+	unsigned width;
+	unsigned height;
+	unsigned times;
+	const char *cpu;
+	const char *filter;
+	const char *output;
+	const char *baseline;
+	double threshold;
+	char perf;
+};
+
+const ArgparseOption program_switches[] = {
+	{ OPTION_UINT,   "w",     "width",     offsetof(Arguments, width),     nullptr, "image width" },
+	{ OPTION_UINT,   "h",     "height",    offsetof(Arguments, height),    nullptr, "image height" },
+	{ OPTION_UINT,   nullptr, "times",     offsetof(Arguments, times),     nullptr, "number of benchmark cycles" },
+	{ OPTION_STRING, nullptr, "cpu",       offsetof(Arguments, cpu),       nullptr, "run only the given CPU tier" },
+	{ OPTION_STRING, nullptr, "filter",    offsetof(Arguments, filter),    nullptr, "run only benchmarks matching regex" },
+	{ OPTION_STRING, nullptr, "output",    offsetof(Arguments, output),    nullptr, "write JSON results to file" },
+	{ OPTION_STRING, nullptr, "baseline",  offsetof(Arguments, baseline),  nullptr, "compare against JSON results from a previous run" },
+	{ OPTION_FLOAT,  nullptr, "threshold", offsetof(Arguments, threshold), nullptr, "regression threshold in percent" },
+	{ OPTION_FLAG,   nullptr, "perf",      offsetof(Arguments, perf),      nullptr, "read hardware performance counters" },
+	{ OPTION_NULL }
+};
+
+const ArgparseOption program_positional[] = {
+	{ OPTION_NULL }
+};
+
+const char help_str[] =
+"Runs each kernel on every CPU tier supported by the host. Throughput is\n"
+"reported per output pixel, and bandwidth counts each input and output\n"
+"byte once. Cycles are measured with the timestamp counter, if available.\n"
+"Performance counters, if requested, are summed over all measured runs.\n"
+"\n"
+"Exits with status 1 if any result is slower than the baseline.\n";
+
+const ArgparseCommandLine program_def = { program_switches, program_positional, "bench", "run kernel micro-benchmarks", help_str };
+
+} // namespace
+
+
+int bench_main(int argc, char **argv)
+{
+	Arguments args{};
+	int ret;
+
+	args.width = 1920;
+	args.height = 1080;
+	args.times = 20;
+	args.threshold = 5.0;
+
+	if ((ret = argparse_parse(&program_def, &args, argc, argv)) < 0)
+		return ret == ARGPARSE_HELP_MESSAGE ? 0 : ret;
+
+	try {
+		if (!args.width || !args.height || !args.times)
+			throw std::runtime_error{ "bad benchmark parameters" };
+
+		std::regex filter_regex{ args.filter ? args.filter : "" };
+		std::vector<std::pair<const char *, zimg::CPUClass>> tiers;
+		if (args.cpu)
+			tiers.push_back({ args.cpu, g_cpu_table[args.cpu] });
+		else
+			tiers = host_cpu_tiers();
+		std::vector<Result> results;
+
+		std::unique_ptr<PerfCounters> perf;
+		if (args.perf) {
+			perf.reset(new PerfCounters{});
+			if (!perf->available()) {
+				std::cerr << "warning: perf counters unavailable: " << perf->error() << '\n';
+				perf.reset();
+			}
+		}
+
+		for (const Benchmark &bench : make_benchmarks(args.width, args.height)) {
+			if (args.filter && !std::regex_search(bench.name, filter_regex))
+				continue;
+
+			for (const auto &tier : tiers) {
+				// Some pixel types are only implemented by certain instruction sets.
+				std::unique_ptr<zimg::graph::ImageFilter> filter;
+				try {
+					filter = bench.create(tier.second);
+				} catch (const zimg::error::InternalError &) {
+					continue;
+				}
+
+				results.push_back(run_benchmark(bench, filter.get(), tier.first, args.times, perf.get()));
+
+				const Result &r = results.back();
+				std::cerr << std::left << std::setw(32) << r.name << std::setw(8) << r.cpu << std::right << std::fixed
+				          << std::setprecision(1) << std::setw(10) << r.pixels_per_second / 1e6 << " Mpix/s"
+				          << std::setprecision(2) << std::setw(8) << r.bytes_per_second / 1e9 << " GB/s";
+				if (!std::isnan(r.cycles_per_pixel))
+					std::cerr << std::setprecision(3) << std::setw(8) << r.cycles_per_pixel << " cpp";
+				std::cerr << '\n';
+				std::cerr.unsetf(std::ios_base::floatfield | std::ios_base::adjustfield);
+			}
+		}
+
+		if (args.output) {
+			std::ofstream out{ args.output, std::ios_base::out | std::ios_base::trunc };
+			write_json(out, results, args.width, args.height);
+			if (!out)
+				throw std::runtime_error{ "error writing results" };
+		} else {
+			write_json(std::cout, results, args.width, args.height);
+		}
+
+		if (args.baseline && compare_baseline(results, args.baseline, args.threshold))
+			return 1;
+	} catch (const zimg::error::Exception &e) {
+		std::cerr << e.what() << '\n';
+		return 2;
+	} catch (const std::exception &e) {
+		std::cerr << e.what() << '\n';
+		return 2;
+	}
+
+	return 0;
+}
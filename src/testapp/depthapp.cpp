@@ -77,6 +77,7 @@ struct Arguments {
 	const char *visualise_path;
 	unsigned times;
 	zimg::CPUClass cpu;
+	unsigned threads;
 };
 
 const ArgparseOption program_switches[] = {
@@ -88,6 +89,7 @@ const ArgparseOption program_switches[] = {
 	{ OPTION_STRING, nullptr, "visualise",  offsetof(Arguments, visualise_path),     nullptr, "path to BMP file for visualisation"},
 	{ OPTION_UINT,   nullptr, "times",      offsetof(Arguments, times),              nullptr, "number of benchmark cycles"},
 	{ OPTION_USER1,  nullptr, "cpu",        offsetof(Arguments, cpu),                arg_decode_cpu, "select CPU type"},
+	{ OPTION_UINT,   nullptr, "threads",    offsetof(Arguments, threads),            nullptr, "number of error diffusion threads"},
 	{ OPTION_NULL }
 };
 
@@ -152,7 +154,8 @@ int depth_main(int argc, char **argv)
 			.set_pixel_in(args.format_in)
 			.set_pixel_out(args.format_out)
 			.set_dither_type(args.dither)
-			.set_cpu(args.cpu);
+			.set_cpu(args.cpu)
+			.set_threads(args.threads ? args.threads : 1);
 
 		filter = conv.create();
 
@@ -1,14 +1,22 @@
+#include <algorithm>
 #include <atomic>
+#include <climits>
+#include <cmath>
 #include <cstdio>
+#include <cstring>
 #include <fstream>
 #include <exception>
+#include <iomanip>
 #include <iostream>
 #include <mutex>
 #include <streambuf>
 #include <string>
 #include <thread>
+#include <vector>
 #include "common/alloc.h"
+#include "common/cpuinfo.h"
 #include "common/except.h"
+#include "common/pixel.h"
 #include "common/static_map.h"
 #include "graph/filtergraph.h"
 #include "graph/graphbuilder.h"
@@ -18,263 +26,278 @@
 #include "apps.h"
 #include "argparse.h"
 #include "frame.h"
+#include "graphspec.h"
 #include "json.h"
+#include "perf.h"
+#include "roofline.h"
 #include "table.h"
 #include "timer.h"
 
+#if defined(__linux__)
+  #include <pthread.h>
+  #include <sched.h>
+#elif defined(_WIN32)
+  #include <Windows.h>
+#endif
+
 namespace {
 
-class TracingFilterFactory : public zimg::graph::DefaultFilterFactory {
-public:
-	filter_list create_colorspace(const zimg::colorspace::ColorspaceConversion &conv) override
-	{
-		printf("colorspace: [%d, %d, %d] => [%d, %d, %d] (%f)\n",
-		       static_cast<int>(conv.csp_in.matrix),
-		       static_cast<int>(conv.csp_in.transfer),
-		       static_cast<int>(conv.csp_in.primaries),
-		       static_cast<int>(conv.csp_out.matrix),
-		       static_cast<int>(conv.csp_out.transfer),
-		       static_cast<int>(conv.csp_out.primaries),
-		       conv.peak_luminance);
-
-		return zimg::graph::DefaultFilterFactory::create_colorspace(conv);
-	}
+size_t frame_size(const zimg::graph::GraphBuilder::state &state)
+{
+	size_t luma = static_cast<size_t>(state.width) * state.height * zimg::pixel_size(state.type);
 
-	filter_list create_depth(const zimg::depth::DepthConversion &conv) override
-	{
-		printf("depth: [%d/%u %c:%c] => [%d/%u %c:%c]\n",
-		       static_cast<int>(conv.pixel_in.type),
-		       conv.pixel_in.depth,
-		       conv.pixel_in.fullrange ? 'f' : 'l',
-			   conv.pixel_in.chroma ? 'c' : 'l',
-		       static_cast<int>(conv.pixel_out.type),
-		       conv.pixel_out.depth,
-		       conv.pixel_out.fullrange ? 'f' : 'l',
-		       conv.pixel_out.chroma ? 'c' : 'l');
-
-		return zimg::graph::DefaultFilterFactory::create_depth(conv);
-	}
+	if (state.color == zimg::graph::GraphBuilder::ColorFamily::GREY)
+		return luma;
+	else
+		return luma + 2 * ((luma >> state.subsample_w) >> state.subsample_h);
+}
 
-	filter_list create_resize(const zimg::resize::ResizeConversion &conv) override
-	{
-		printf("resize: [%d, %d] => [%d, %d] (%f, %f, %f, %f)\n",
-		       conv.src_width,
-		       conv.src_height,
-		       conv.dst_width,
-		       conv.dst_height,
-		       conv.shift_w,
-		       conv.shift_h,
-		       conv.subwidth,
-		       conv.subheight);
-
-		return zimg::graph::DefaultFilterFactory::create_resize(conv);
-	}
+// Bind a thread to a single logical processor.
+bool pin_thread(std::thread &th, unsigned cpu)
+{
+#if defined(__linux__)
+	cpu_set_t set;
+	CPU_ZERO(&set);
+	CPU_SET(cpu, &set);
+	return !pthread_setaffinity_np(th.native_handle(), sizeof(set), &set);
+#elif defined(_WIN32)
+	return cpu < sizeof(DWORD_PTR) * CHAR_BIT && !!SetThreadAffinityMask(th.native_handle(), static_cast<DWORD_PTR>(1) << cpu);
+#else
+	(void)th;
+	(void)cpu;
+	return false;
+#endif
+}
+
+void thread_target(const zimg::graph::FilterGraph *graph,
+                   const zimg::graph::GraphBuilder::state *src_state,
+                   const zimg::graph::GraphBuilder::state *dst_state,
+                   std::atomic_int *counter,
+                   std::vector<double> *latency,
+                   std::exception_ptr *eptr,
+                   std::mutex *mutex)
+{
+	try {
+		ImageFrame src_frame = allocate_frame(*src_state);
+		ImageFrame dst_frame = allocate_frame(*dst_state);
+		zimg::AlignedVector<char> tmp(graph->get_tmp_size());
+		Timer timer;
+
+		while (true) {
+			if ((*counter)-- <= 0)
+				break;
+
+			timer.start();
+			graph->process(src_frame.as_read_buffer(), dst_frame.as_write_buffer(), tmp.data(), nullptr, nullptr);
+			timer.stop();
 
-	filter_list create_unresize(const zimg::unresize::UnresizeConversion &conv) override
-	{
-		printf("unresize: [%d, %d] => [%d, %d] (%f, %f)\n",
-		       conv.up_width,
-		       conv.up_height,
-		       conv.orig_width,
-		       conv.orig_height,
-		       conv.shift_w,
-		       conv.shift_h);
-
-		return zimg::graph::DefaultFilterFactory::create_unresize(conv);
+			latency->push_back(timer.elapsed());
+		}
+	} catch (...) {
+		std::lock_guard<std::mutex> lock{ *mutex };
+		*eptr = std::current_exception();
 	}
+}
+
+struct Arguments {
+	const char *specpath;
+	unsigned times;
+	unsigned threads;
+	unsigned tile_width;
+	char stats;
+	const char *plan;
+	const char *trace;
+	char pin;
+	const char *json;
+	char perf;
+	char roofline;
 };
 
+struct ThreadResult {
+	unsigned threads;
+	unsigned frames;
+	double seconds;
+	double p50;
+	double p95;
+	double p99;
+	double max;
+	std::string counters;
+};
 
-json::Object read_graph_spec(const char *path)
+// Nearest-rank percentile of sorted samples.
+double percentile(const std::vector<double> &sorted, double p)
 {
-	std::ifstream f;
-
-	f.exceptions(std::ios_base::badbit | std::ios_base::failbit);
-	f.open(path);
-
-	std::string spec_json{ std::istreambuf_iterator<char>{ f }, std::istreambuf_iterator<char>{} };
-	return std::move(json::parse_document(spec_json).object());
+	size_t rank = static_cast<size_t>(std::ceil(p / 100.0 * sorted.size()));
+	return sorted[std::max(rank, static_cast<size_t>(1)) - 1];
 }
 
-void read_graph_state(zimg::graph::GraphBuilder::state *state, const json::Object &obj)
+void write_json(const char *path, const zimg::graph::FilterGraph &graph, size_t bytes_per_frame, const std::vector<ThreadResult> &results)
 {
-	static const zimg::static_string_map<zimg::graph::GraphBuilder::ColorFamily, 3> color_map{
-		{ "grey", zimg::graph::GraphBuilder::ColorFamily::GREY },
-		{ "rgb",  zimg::graph::GraphBuilder::ColorFamily::RGB },
-		{ "yuv",  zimg::graph::GraphBuilder::ColorFamily::YUV },
-	};
-	static const zimg::static_string_map<zimg::graph::GraphBuilder::FieldParity, 3> parity_map{
-		{ "progressive", zimg::graph::GraphBuilder::FieldParity::PROGRESSIVE },
-		{ "top",         zimg::graph::GraphBuilder::FieldParity::TOP },
-		{ "bottom",      zimg::graph::GraphBuilder::FieldParity::BOTTOM },
-	};
-	static const zimg::static_string_map<zimg::graph::GraphBuilder::ChromaLocationW, 2> chromaloc_w_map{
-		{ "left",   zimg::graph::GraphBuilder::ChromaLocationW::LEFT },
-		{ "center", zimg::graph::GraphBuilder::ChromaLocationW::CENTER },
-	};
-	static const zimg::static_string_map<zimg::graph::GraphBuilder::ChromaLocationH, 3> chromaloc_h_map{
-		{ "center", zimg::graph::GraphBuilder::ChromaLocationH::CENTER },
-		{ "top",    zimg::graph::GraphBuilder::ChromaLocationH::TOP },
-		{ "bottom", zimg::graph::GraphBuilder::ChromaLocationH::BOTTOM },
-	};
-
-	if (const auto &val = obj["width"])
-		state->width = static_cast<unsigned>(val.integer());
-	if (const auto &val = obj["height"])
-		state->height = static_cast<unsigned>(val.integer());
-	if (const auto &val = obj["type"])
-		state->type = g_pixel_table[val.string().c_str()];
-
-	if (const auto &val = obj["subsample_w"])
-		state->subsample_w = static_cast<unsigned>(val.integer());
-	if (const auto &val = obj["subsample_h"])
-		state->subsample_h = static_cast<unsigned>(val.integer());
-
-	if (const auto &val = obj["color"])
-		state->color = color_map[val.string().c_str()];
-	if (const auto &val = obj["colorspace"]) {
-		const json::Object &colorspace_obj = val.object();
-
-		state->colorspace.matrix = g_matrix_table[colorspace_obj["matrix"].string().c_str()];
-		state->colorspace.transfer = g_transfer_table[colorspace_obj["transfer"].string().c_str()];
-		state->colorspace.primaries = g_primaries_table[colorspace_obj["primaries"].string().c_str()];
+	std::ofstream out{ path, std::ios_base::out | std::ios_base::trunc };
+
+	out << "{\n";
+	out << "\"heap_size\":" << graph.get_tmp_size() << ",\"cache_size\":" << zimg::cpu_cache_size()
+	    << ",\"tile_width\":" << graph.tile_width() << ",\"bytes_per_frame\":" << bytes_per_frame << ",\n";
+	out << "\"runs\":[";
+
+	for (size_t i = 0; i < results.size(); ++i) {
+		const ThreadResult &r = results[i];
+		double fps = r.frames / r.seconds;
+
+		out << (i ? ",\n" : "\n");
+		out << "{\"threads\":" << r.threads << ",\"frames\":" << r.frames << ",\"seconds\":" << r.seconds
+		    << ",\"fps\":" << fps << ",\"gigabytes_per_second\":" << fps * bytes_per_frame / 1e9
+		    << ",\"speedup\":" << fps / (results[0].frames / results[0].seconds)
+		    << ",\"latency_ms\":{\"p50\":" << r.p50 * 1e3 << ",\"p95\":" << r.p95 * 1e3
+		    << ",\"p99\":" << r.p99 * 1e3 << ",\"max\":" << r.max * 1e3 << '}';
+		if (!r.counters.empty())
+			out << ",\"counters\":" << r.counters;
+		out << '}';
 	}
+	out << "\n]\n}\n";
 
-	if (const auto &val = obj["depth"])
-		state->depth = static_cast<unsigned>(val.integer());
-	if (const auto &val = obj["fullrange"])
-		state->fullrange = val.boolean();
-
-	if (const auto &val = obj["parity"])
-		state->parity = parity_map[val.string().c_str()];
-	if (const auto &val = obj["chroma_location_w"])
-		state->chroma_location_w = chromaloc_w_map[val.string().c_str()];
-	if (const auto &val = obj["chroma_location_h"])
-		state->chroma_location_h = chromaloc_h_map[val.string().c_str()];
-
-	if (const auto &val = obj["active_region"]) {
-		state->active_left = val.object()["left"].number();
-		state->active_top = val.object()["top"].number();
-		state->active_width = val.object()["width"].number();
-		state->active_height = val.object()["height"].number();
-	} else {
-		state->active_left = 0.0;
-		state->active_top = 0.0;
-		state->active_width = state->width;
-		state->active_height = state->height;
-	}
+	if (!out)
+		throw std::runtime_error{ "error writing results" };
 }
 
-void read_graph_params(zimg::graph::GraphBuilder::params *params, const json::Object &obj)
+void print_stats(const zimg::graph::FilterGraph &graph)
 {
-	if (const auto &val = obj["filter"]) {
-		const json::Object &filter_obj = val.object();
-		auto factory_func = g_resize_table[filter_obj["name"].string().c_str()];
-		params->filter = factory_func(filter_obj["param_a"].number(), filter_obj["param_b"].number());
-		params->unresize = filter_obj["name"].string() == "unresize";
-	} else {
-		params->filter.reset(new zimg::resize::BicubicFilter{ 1.0 / 3.0, 1.0 / 3.0 });
+	for (const auto &node : graph.get_stats()) {
+		double seconds = node.nanoseconds / 1e9;
+
+		std::cout << node.name << ": "
+		          << node.calls << " calls, "
+		          << node.nanoseconds / 1e6 << " ms, "
+		          << node.pixels / seconds / 1e6 << " MP/s, "
+		          << (node.bytes_read + node.bytes_written) / seconds / 1e9 << " GB/s\n";
 	}
-
-	if (const auto &val = obj["filter_uv"]) {
-		const json::Object &filter_obj = val.object();
-		auto factory_func = g_resize_table[filter_obj["name"].string().c_str()];
-		params->filter_uv = factory_func(filter_obj["param_a"].number(), filter_obj["param_b"].number());
-	} else {
-		params->filter_uv.reset(new zimg::resize::BilinearFilter{});
-	}
-
-	if (const auto &val = obj["dither_type"])
-		params->dither_type = g_dither_table[val.string().c_str()];
-	if (const auto &val = obj["peak_luminance"])
-		params->peak_luminance = val.number();
-	if (const auto &val = obj["approximate_gamma"])
-		params->approximate_gamma = val.boolean();
-	if (const auto &val = obj["scene_referred"])
-		params->scene_referred = val.boolean();
-	if (const auto &val = obj["cpu"])
-		params->cpu = g_cpu_table[val.string().c_str()];
 }
 
-std::unique_ptr<zimg::graph::FilterGraph> create_graph(const json::Object &spec,
-                                                       zimg::graph::GraphBuilder::state *src_state_out,
-                                                       zimg::graph::GraphBuilder::state *dst_state_out)
+// Approximate arithmetic cost per output sample, by filter family. Resizing
+// costs a multiply and add per tap, and the tap count grows when downscaling.
+double estimate_flops(const std::string &name, const json::Object &spec,
+                      const zimg::graph::GraphBuilder::state &src_state,
+                      const zimg::graph::GraphBuilder::state &dst_state)
 {
-	zimg::graph::GraphBuilder::state src_state{};
-	zimg::graph::GraphBuilder::state dst_state{};
-	zimg::graph::GraphBuilder::params params{};
-	TracingFilterFactory factory;
-	bool has_params = false;
-
-	try {
-		read_graph_state(&src_state, spec["source"].object());
-
-		dst_state = src_state;
-		read_graph_state(&dst_state, spec["target"].object());
-
-		if (const auto &val = spec["params"]) {
-			read_graph_params(&params, val.object());
-			has_params = true;
+	if (!name.compare(0, 6, "Resize")) {
+		unsigned support = 2;
+
+		if (const auto &params = spec["params"]) {
+			if (const auto &val = params.object()["filter"]) {
+				const json::Object &filter_obj = val.object();
+				double param_a = filter_obj["param_a"] ? filter_obj["param_a"].number() : NAN;
+				double param_b = filter_obj["param_b"] ? filter_obj["param_b"].number() : NAN;
+
+				if (auto filter = g_resize_table[filter_obj["name"].string().c_str()](param_a, param_b))
+					support = filter->support();
+			}
 		}
-	} catch (const std::invalid_argument &e) {
-		throw std::runtime_error{ e.what() };
-	} catch (const std::out_of_range &e) {
-		throw std::runtime_error{ e.what() };
-	}
 
-	*src_state_out = src_state;
-	*dst_state_out = dst_state;
+		bool horizontal = !name.compare(0, 11, "ResizeImplH");
+		double ratio = horizontal ? static_cast<double>(src_state.width) / dst_state.width
+		                          : static_cast<double>(src_state.height) / dst_state.height;
+		return 2.0 * 2 * support * std::max(ratio, 1.0);
+	}
 
-	return zimg::graph::GraphBuilder{}.set_source(src_state)
-	                                  .connect_graph(dst_state, has_params ? &params : nullptr, &factory)
-	                                  .complete_graph();
+	if (!name.compare(0, 8, "Unresize"))
+		return 8.0;
+	if (name.find("ErrorDiffusion") != std::string::npos)
+		return 12.0;
+	if (name.find("Dither") != std::string::npos)
+		return 4.0;
+	if (name.find("Colorspace") != std::string::npos)
+		return 20.0;
+
+	// Depth conversion and copies.
+	return 2.0;
 }
 
-ImageFrame allocate_frame(const zimg::graph::GraphBuilder::state &state)
+void print_roofline(const json::Object &spec, zimg::graph::FilterGraph &graph,
+                    const zimg::graph::GraphBuilder::state &src_state,
+                    const zimg::graph::GraphBuilder::state &dst_state,
+                    unsigned times)
 {
-	return{
-		state.width,
-		state.height,
-		state.type,
-		state.color != zimg::graph::GraphBuilder::ColorFamily::GREY ? 3U : 1U,
-		state.color != zimg::graph::GraphBuilder::ColorFamily::RGB,
-		state.subsample_w,
-		state.subsample_h
-	};
-}
+	MachineRoofline machine = measure_roofline(graph.get_cpu());
 
-void thread_target(const zimg::graph::FilterGraph *graph,
-                   const zimg::graph::GraphBuilder::state *src_state,
-                   const zimg::graph::GraphBuilder::state *dst_state,
-                   std::atomic_int *counter,
-                   std::exception_ptr *eptr,
-                   std::mutex *mutex)
-{
-	try {
-		ImageFrame src_frame = allocate_frame(*src_state);
-		ImageFrame dst_frame = allocate_frame(*dst_state);
-		zimg::AlignedVector<char> tmp(graph->get_tmp_size());
+	graph.set_stats_enabled(true);
+	graph.reset_stats();
 
-		while (true) {
-			if ((*counter)-- <= 0)
-				break;
+	std::atomic_int counter{ static_cast<int>(times) };
+	std::vector<double> latency;
+	std::exception_ptr eptr{};
+	std::mutex mutex;
+	Timer timer;
 
-			graph->process(src_frame.as_read_buffer(), dst_frame.as_write_buffer(), tmp.data(), nullptr, nullptr);
-		}
-	} catch (...) {
-		std::lock_guard<std::mutex> lock{ *mutex };
-		*eptr = std::current_exception();
+	timer.start();
+	thread_target(&graph, &src_state, &dst_state, &counter, &latency, &eptr, &mutex);
+	timer.stop();
+
+	if (eptr)
+		std::rethrow_exception(eptr);
+
+	size_t bytes_per_frame = frame_size(src_state) + frame_size(dst_state);
+
+	std::cout << '\n';
+	std::cout << "roofline (single thread)\n";
+	std::cout << "DRAM copy:       " << machine.dram_bandwidth / 1e9 << " GB/s\n";
+	std::cout << "cache copy:      " << machine.cache_bandwidth / 1e9 << " GB/s\n";
+	std::cout << "peak:            " << machine.peak_flops / 1e9 << " GFLOP/s\n";
+	std::cout << "fps:             " << times / timer.elapsed() << " (DRAM bound: " << machine.dram_bandwidth / bytes_per_frame << ")\n";
+	std::cout << '\n';
+	std::cout << std::left << std::setw(40) << "node" << std::right
+	          << std::setw(10) << "MS/s" << std::setw(10) << "GB/s" << std::setw(10) << "flop/B"
+	          << std::setw(12) << "bound MS/s" << std::setw(8) << "eff" << "  limit\n";
+
+	for (const auto &node : graph.get_stats()) {
+		if (!node.nanoseconds || !node.pixels)
+			continue;
+
+		double seconds = node.nanoseconds / 1e9;
+		double bytes_per_sample = static_cast<double>(node.bytes_read + node.bytes_written) / node.pixels;
+		double flops_per_sample = estimate_flops(node.name, spec, src_state, dst_state);
+
+		double memory_bound = machine.cache_bandwidth / bytes_per_sample;
+		double compute_bound = machine.peak_flops / flops_per_sample;
+		double attainable = std::min(memory_bound, compute_bound);
+		double achieved = node.pixels / seconds;
+		double efficiency = achieved / attainable;
+
+		std::cout << std::left << std::setw(40) << node.name << std::right << std::fixed
+		          << std::setprecision(1) << std::setw(10) << achieved / 1e6
+		          << std::setprecision(2) << std::setw(10) << achieved * bytes_per_sample / 1e9
+		          << std::setprecision(2) << std::setw(10) << flops_per_sample / bytes_per_sample
+		          << std::setprecision(1) << std::setw(12) << attainable / 1e6
+		          << std::setprecision(0) << std::setw(7) << efficiency * 100 << '%'
+		          << "  " << (memory_bound < compute_bound ? "memory" : "compute")
+		          << (efficiency < 0.5 ? " <--" : "") << '\n';
+		std::cout.unsetf(std::ios_base::floatfield | std::ios_base::adjustfield);
+		std::cout << std::setprecision(6);
 	}
+
+	graph.reset_stats();
 }
 
-void execute(const json::Object &spec, unsigned times, unsigned threads, unsigned tile_width)
+void execute(const json::Object &spec, const Arguments &args)
 {
 	zimg::graph::GraphBuilder::state src_state;
 	zimg::graph::GraphBuilder::state dst_state;
 	std::unique_ptr<zimg::graph::FilterGraph> graph = create_graph(spec, &src_state, &dst_state);
 
-	if (tile_width)
-		graph->set_tile_width(tile_width);
+	if (args.tile_width)
+		graph->set_tile_width(args.tile_width);
+	if (args.stats)
+		graph->set_stats_enabled(true);
+	if (args.trace)
+		graph->set_trace_capacity(1UL << 20);
+
+	if (args.plan) {
+		if (!strcmp(args.plan, "json"))
+			std::cout << graph->dump_plan(zimg::graph::FilterGraph::plan_format::JSON);
+		else if (!strcmp(args.plan, "dot"))
+			std::cout << graph->dump_plan(zimg::graph::FilterGraph::plan_format::DOT);
+		else
+			throw std::runtime_error{ "bad plan format" };
+	}
 
 	std::cout << '\n';
 	std::cout << "input buffering:  " << graph->get_input_buffering() << '\n';
@@ -282,24 +305,54 @@ void execute(const json::Object &spec, unsigned times, unsigned threads, unsigne
 	std::cout << "heap size:        " << graph->get_tmp_size() << '\n';
 	std::cout << "tile width:       " << graph->tile_width() << '\n';
 
-	if (!threads && !std::thread::hardware_concurrency())
+	for (const auto &entry : g_cpu_table) {
+		if (entry.second == graph->get_cpu()) {
+			std::cout << "cpu:              " << entry.first << '\n';
+			break;
+		}
+	}
+
+	size_t bytes_per_frame = frame_size(src_state) + frame_size(dst_state);
+	unsigned long cache_size = zimg::cpu_cache_size();
+
+	std::cout << "frame bytes:      " << bytes_per_frame << '\n';
+	if (cache_size)
+		std::cout << "heap/LLC share:   " << 100.0 * graph->get_tmp_size() / cache_size << "% of " << cache_size << '\n';
+
+	if (!std::thread::hardware_concurrency() && (!args.threads || args.pin))
 		throw std::runtime_error{ "could not auto-detect CPU count" };
 
-	unsigned thread_min = threads ? threads : 1;
-	unsigned thread_max = threads ? threads : std::thread::hardware_concurrency();
+	unsigned thread_min = args.threads ? args.threads : 1;
+	unsigned thread_max = args.threads ? args.threads : std::thread::hardware_concurrency();
+	std::vector<ThreadResult> results;
 
 	for (unsigned n = thread_min; n <= thread_max; ++n) {
 		std::vector<std::thread> thread_pool;
-		std::atomic_int counter{ static_cast<int>(times * n) };
+		std::vector<std::vector<double>> thread_latency(n);
+		std::atomic_int counter{ static_cast<int>(args.times * n) };
 		std::exception_ptr eptr{};
 		std::mutex mutex;
 		Timer timer;
 
+		// Counters are inherited by the worker threads and totalled when they exit.
+		std::unique_ptr<PerfCounters> perf;
+		if (args.perf)
+			perf.reset(new PerfCounters{ true });
+
 		thread_pool.reserve(n);
+		for (auto &latency : thread_latency) {
+			latency.reserve(args.times * n);
+		}
+
+		if (perf)
+			perf->start();
 
 		timer.start();
 		for (unsigned nn = 0; nn < n; ++nn) {
-			thread_pool.emplace_back(thread_target, graph.get(), &src_state, &dst_state, &counter, &eptr, &mutex);
+			thread_pool.emplace_back(thread_target, graph.get(), &src_state, &dst_state, &counter, &thread_latency[nn], &eptr, &mutex);
+
+			if (args.pin && !pin_thread(thread_pool.back(), nn % std::thread::hardware_concurrency()))
+				std::cerr << "warning: could not pin thread " << nn << '\n';
 		}
 
 		for (auto &th : thread_pool) {
@@ -307,28 +360,68 @@ void execute(const json::Object &spec, unsigned times, unsigned threads, unsigne
 		}
 		timer.stop();
 
+		if (perf)
+			perf->stop();
+
 		if (eptr)
 			std::rethrow_exception(eptr);
 
+		std::vector<double> latency;
+		for (const auto &v : thread_latency) {
+			latency.insert(latency.end(), v.begin(), v.end());
+		}
+		std::sort(latency.begin(), latency.end());
+
+		ThreadResult r{ n, args.times * n, timer.elapsed(), percentile(latency, 50), percentile(latency, 95), percentile(latency, 99), latency.back(), {} };
+		if (perf && perf->available())
+			r.counters = perf->to_json(static_cast<double>(dst_state.width) * dst_state.height * r.frames);
+		results.push_back(r);
+
+		double fps = r.frames / r.seconds;
+		double speedup = fps / (results[0].frames / results[0].seconds);
+
 		std::cout << '\n';
 		std::cout << "threads:    " << n << '\n';
-		std::cout << "iterations: " << times * n << '\n';
-		std::cout << "fps:        " << (times * n) / timer.elapsed() << '\n';
+		std::cout << "iterations: " << r.frames << '\n';
+		std::cout << "fps:        " << fps << '\n';
+		std::cout << "bandwidth:  " << fps * bytes_per_frame / 1e9 << " GB/s\n";
+		std::cout << "speedup:    " << speedup << " (" << 100.0 * speedup * thread_min / n << "% efficiency)\n";
+		std::cout << "latency:    p50 " << r.p50 * 1e3 << " ms, p95 " << r.p95 * 1e3 << " ms, p99 " << r.p99 * 1e3 << " ms, max " << r.max * 1e3 << " ms\n";
+
+		if (perf)
+			perf->print(static_cast<double>(dst_state.width) * dst_state.height * r.frames);
+
+		if (args.stats) {
+			print_stats(*graph);
+			graph->reset_stats();
+		}
 	}
-}
 
+	if (args.json)
+		write_json(args.json, *graph, bytes_per_frame, results);
 
-struct Arguments {
-	const char *specpath;
-	unsigned times;
-	unsigned threads;
-	unsigned tile_width;
-};
+	if (args.roofline)
+		print_roofline(spec, *graph, src_state, dst_state, args.times);
+
+	if (args.trace) {
+		std::ofstream out{ args.trace, std::ios_base::out | std::ios_base::trunc };
+		out << graph->dump_trace();
+		if (!out)
+			throw std::runtime_error{ "error writing trace" };
+	}
+}
 
 const ArgparseOption program_switches[] = {
-	{ OPTION_UINT, nullptr, "times",      offsetof(Arguments, times),      nullptr, "number of benchmark cycles per thread" },
-	{ OPTION_UINT, nullptr, "threads",    offsetof(Arguments, threads),    nullptr, "number of threads" },
-	{ OPTION_UINT, nullptr, "tile-width", offsetof(Arguments, tile_width), nullptr, "graph tile width" },
+	{ OPTION_UINT,   nullptr, "times",      offsetof(Arguments, times),      nullptr, "number of benchmark cycles per thread" },
+	{ OPTION_UINT,   nullptr, "threads",    offsetof(Arguments, threads),    nullptr, "number of threads (default: sweep 1 to CPU count)" },
+	{ OPTION_UINT,   nullptr, "tile-width", offsetof(Arguments, tile_width), nullptr, "graph tile width" },
+	{ OPTION_FLAG,   nullptr, "stats",      offsetof(Arguments, stats),      nullptr, "print per-filter statistics" },
+	{ OPTION_STRING, nullptr, "plan",       offsetof(Arguments, plan),       nullptr, "print execution plan (json, dot)" },
+	{ OPTION_STRING, nullptr, "trace",      offsetof(Arguments, trace),      nullptr, "write Chrome trace of the most recent events to file" },
+	{ OPTION_FLAG,   nullptr, "pin",        offsetof(Arguments, pin),        nullptr, "pin each thread to a logical processor" },
+	{ OPTION_STRING, nullptr, "json",       offsetof(Arguments, json),       nullptr, "write thread-scaling results to file" },
+	{ OPTION_FLAG,   nullptr, "perf",       offsetof(Arguments, perf),       nullptr, "read hardware performance counters" },
+	{ OPTION_FLAG,   nullptr, "roofline",   offsetof(Arguments, roofline),   nullptr, "compare each filter against machine bandwidth and peak flops" },
 	{ OPTION_NULL }
 };
 
@@ -337,7 +430,12 @@ const ArgparseOption program_positional[] = {
 	{ OPTION_NULL }
 };
 
-const ArgparseCommandLine program_def = { program_switches, program_positional, "graph", "benchmark filter graph", };
+const char help_str[] =
+"The roofline mode measures single-threaded copy bandwidth and peak flops,\n"
+"then bounds each filter by cache bandwidth and an estimate of its\n"
+"arithmetic cost. Filters below half of their bound are marked.\n";
+
+const ArgparseCommandLine program_def = { program_switches, program_positional, "graph", "benchmark filter graph", help_str };
 
 } // namespace
 
@@ -354,7 +452,7 @@ int graph_main(int argc, char **argv)
 
 	try {
 		json::Object spec = read_graph_spec(args.specpath);
-		execute(spec, args.times, args.threads, args.tile_width);
+		execute(spec, args);
 	} catch (const zimg::error::Exception &e) {
 		std::cerr << e.what() << '\n';
 		return 2;
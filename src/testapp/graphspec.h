@@ -0,0 +1,38 @@
+#pragma once
+
+#ifndef GRAPHSPEC_H_
+#define GRAPHSPEC_H_
+
+#include <memory>
+#include "graph/graphbuilder.h"
+
+#include "json.h"
+
+namespace zimg {
+
+enum class CPUClass;
+
+namespace graph {
+
+class FilterGraph;
+
+} // namespace graph
+} // namespace zimg
+
+
+class ImageFrame;
+
+json::Object read_graph_spec(const char *path);
+
+// Build the graph described by [spec]. If [cpu] is not null, it overrides the
+// CPU type in the specification. If [verbose] is set, filters are printed as
+// they are created.
+std::unique_ptr<zimg::graph::FilterGraph> create_graph(const json::Object &spec,
+                                                       zimg::graph::GraphBuilder::state *src_state_out,
+                                                       zimg::graph::GraphBuilder::state *dst_state_out,
+                                                       const zimg::CPUClass *cpu = nullptr,
+                                                       bool verbose = true);
+
+ImageFrame allocate_frame(const zimg::graph::GraphBuilder::state &state);
+
+#endif // GRAPHSPEC_H_
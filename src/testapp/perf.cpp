@@ -0,0 +1,188 @@
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+
+#ifdef __linux__
+  #include <cerrno>
+
+  #include <linux/perf_event.h>
+  #include <sys/ioctl.h>
+  #include <sys/syscall.h>
+  #include <unistd.h>
+#endif // __linux__
+
+#include "perf.h"
+
+namespace {
+
+#ifdef __linux__
+struct event_desc {
+	uint32_t type;
+	uint64_t config;
+};
+
+const event_desc event_table[PerfCounters::NUM_COUNTERS] = {
+	{ PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+	{ PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
+	{ PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES },
+	{ PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16) },
+	{ PERF_TYPE_HARDWARE, PERF_COUNT_HW_STALLED_CYCLES_FRONTEND },
+	{ PERF_TYPE_HARDWARE, PERF_COUNT_HW_STALLED_CYCLES_BACKEND },
+};
+
+int open_event(const event_desc &desc, bool inherit)
+{
+	perf_event_attr attr;
+	std::memset(&attr, 0, sizeof(attr));
+
+	attr.size = sizeof(attr);
+	attr.type = desc.type;
+	attr.config = desc.config;
+	attr.disabled = 1;
+	attr.inherit = inherit;
+	attr.exclude_kernel = 1;
+	attr.exclude_hv = 1;
+	attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+	return static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+}
+#endif // __linux__
+
+} // namespace
+
+
+PerfCounters::PerfCounters(bool inherit)
+{
+	for (int &fd : m_fd) {
+		fd = -1;
+	}
+
+#ifdef __linux__
+	for (int i = 0; i < NUM_COUNTERS; ++i) {
+		m_fd[i] = open_event(event_table[i], inherit);
+		if (m_fd[i] < 0 && m_error.empty())
+			m_error = std::strerror(errno);
+	}
+#else
+	(void)inherit;
+	m_error = "not supported on this platform";
+#endif
+}
+
+PerfCounters::~PerfCounters()
+{
+#ifdef __linux__
+	for (int fd : m_fd) {
+		if (fd >= 0)
+			close(fd);
+	}
+#endif
+}
+
+const char *PerfCounters::name(counter c)
+{
+	static const char *names[NUM_COUNTERS] = {
+		"cycles",
+		"instructions",
+		"llc_misses",
+		"l1d_misses",
+		"stalled_cycles_frontend",
+		"stalled_cycles_backend",
+	};
+	return names[c];
+}
+
+bool PerfCounters::available() const
+{
+	for (int fd : m_fd) {
+		if (fd >= 0)
+			return true;
+	}
+	return false;
+}
+
+void PerfCounters::reset()
+{
+#ifdef __linux__
+	for (int fd : m_fd) {
+		if (fd >= 0)
+			ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+	}
+#endif
+}
+
+void PerfCounters::start()
+{
+#ifdef __linux__
+	for (int fd : m_fd) {
+		if (fd >= 0)
+			ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+	}
+#endif
+}
+
+void PerfCounters::stop()
+{
+#ifdef __linux__
+	for (int fd : m_fd) {
+		if (fd >= 0)
+			ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+	}
+#endif
+}
+
+double PerfCounters::value(counter c) const
+{
+#ifdef __linux__
+	uint64_t data[3]; // value, time enabled, time running
+
+	if (m_fd[c] < 0 || read(m_fd[c], data, sizeof(data)) != sizeof(data) || !data[2])
+		return 0.0;
+
+	return static_cast<double>(data[0]) * (static_cast<double>(data[1]) / data[2]);
+#else
+	(void)c;
+	return 0.0;
+#endif
+}
+
+void PerfCounters::print(double pixels) const
+{
+	if (!available()) {
+		std::cout << "perf counters unavailable: " << m_error << '\n';
+		return;
+	}
+
+	if (has(CYCLES) && has(INSTRUCTIONS) && value(CYCLES))
+		std::cout << "ipc:        " << value(INSTRUCTIONS) / value(CYCLES) << '\n';
+
+	for (int i = 0; i < NUM_COUNTERS; ++i) {
+		counter c = static_cast<counter>(i);
+		if (has(c))
+			std::cout << name(c) << "/pixel: " << value(c) / pixels << '\n';
+	}
+}
+
+std::string PerfCounters::to_json(double pixels) const
+{
+	std::ostringstream ss;
+	bool first = true;
+
+	ss << '{';
+	if (has(CYCLES) && has(INSTRUCTIONS) && value(CYCLES)) {
+		ss << "\"ipc\":" << value(INSTRUCTIONS) / value(CYCLES);
+		first = false;
+	}
+	for (int i = 0; i < NUM_COUNTERS; ++i) {
+		counter c = static_cast<counter>(i);
+		if (!has(c))
+			continue;
+
+		ss << (first ? "" : ",") << '"' << name(c) << "_per_pixel\":" << value(c) / pixels;
+		first = false;
+	}
+	ss << '}';
+
+	return ss.str();
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#ifndef PERF_H_
+#define PERF_H_
+
+#include <string>
+
+// Hardware performance counters for the calling thread.
+//
+// Counters are read through perf_event_open on Linux. Individual counters may
+// be unavailable, e.g. in containers or virtual machines, in which case they
+// read as zero and are omitted from reports.
+class PerfCounters {
+public:
+	enum counter {
+		CYCLES,
+		INSTRUCTIONS,
+		LLC_MISSES,
+		L1D_MISSES,
+		STALLED_CYCLES_FRONTEND,
+		STALLED_CYCLES_BACKEND,
+		NUM_COUNTERS,
+	};
+private:
+	int m_fd[NUM_COUNTERS];
+	std::string m_error;
+public:
+	// If [inherit] is set, threads created after construction are counted.
+	explicit PerfCounters(bool inherit = false);
+
+	PerfCounters(const PerfCounters &) = delete;
+
+	~PerfCounters();
+
+	PerfCounters &operator=(const PerfCounters &) = delete;
+
+	static const char *name(counter c);
+
+	bool available() const;
+
+	bool has(counter c) const { return m_fd[c] >= 0; }
+
+	// Reason why no counters could be opened.
+	const std::string &error() const { return m_error; }
+
+	void reset();
+
+	void start();
+
+	void stop();
+
+	// Counter value, scaled up if the counter was multiplexed.
+	double value(counter c) const;
+
+	// Print IPC and per-pixel counts.
+	void print(double pixels) const;
+
+	// Serialize IPC and per-pixel counts as a JSON object.
+	std::string to_json(double pixels) const;
+};
+
+#endif // PERF_H_
@@ -1,7 +1,6 @@
 #include <cmath>
 #include <iostream>
 #include <memory>
-#include <regex>
 #include <stdexcept>
 #include <string>
 #include "common/cpuinfo.h"
@@ -26,35 +25,6 @@ constexpr bool is_set_pixel_format(const zimg::PixelFormat &format) noexcept
 	return format != zimg::PixelFormat{};
 }
 
-int decode_filter(const struct ArgparseOption *, void *out, const char *param, int)
-{
-	try {
-		std::unique_ptr<zimg::resize::Filter> *filter = static_cast<std::unique_ptr<zimg::resize::Filter> *>(out);
-		std::regex filter_regex{ R"(^(point|bilinear|bicubic|spline16|spline36|lanczos)(?::([\w.+-]+)(?::([\w.+-]+))?)?$)" };
-		std::cmatch match;
-		std::string filter_str;
-		double param_a = NAN;
-		double param_b = NAN;
-
-		if (!std::regex_match(param, match, filter_regex))
-			throw std::runtime_error{ "bad filter string" };
-
-		filter_str = match[1];
-
-		if (match.size() >= 2 && match[2].length())
-			param_a = std::stod(match[2]);
-		if (match.size() >= 3 && match[3].length())
-			param_b = std::stod(match[3]);
-
-		*filter = g_resize_table[filter_str.c_str()](param_a, param_b);
-	} catch (const std::exception &e) {
-		std::cerr << e.what() << '\n';
-		return -1;
-	}
-
-	return 0;
-}
-
 
 struct Arguments {
 	const char *inpath;
@@ -79,7 +49,7 @@ struct Arguments {
 const ArgparseOption program_switches[] = {
 	{ OPTION_UINT,   "w",     "width-in",     offsetof(Arguments, width_in),       nullptr, "image width" },
 	{ OPTION_UINT,   "h",     "height-in",    offsetof(Arguments, height_in),      nullptr, "image height"},
-	{ OPTION_USER1,  nullptr, "filter",       offsetof(Arguments, filter),         decode_filter, "select resampling filter" },
+	{ OPTION_USER1,  nullptr, "filter",       offsetof(Arguments, filter),         arg_decode_filter, "select resampling filter" },
 	{ OPTION_FLOAT,  nullptr, "shift-w",      offsetof(Arguments, shift_w),        nullptr, "subpixel shift" },
 	{ OPTION_FLOAT,  nullptr, "shift-h",      offsetof(Arguments, shift_h),        nullptr, "subpixel shift" },
 	{ OPTION_FLOAT,  nullptr, "sub-width",    offsetof(Arguments, subwidth),       nullptr, "active image width" },
@@ -100,8 +70,7 @@ const ArgparseOption program_positional[] = {
 };
 
 const char help_str[] =
-"Resampling filter specifier: filter[:param_a[:param_b]]\n"
-"filter: point, bilinear, bicubic, spline16, spline36, lanczos\n"
+FILTER_SPECIFIER_HELP_STR
 "\n"
 PIXFMT_SPECIFIER_HELP_STR
 "\n"
@@ -0,0 +1,122 @@
+#include <algorithm>
+#include <cstring>
+#include "common/alloc.h"
+#include "common/cpuinfo.h"
+
+#ifdef ZIMG_X86
+  #include <xmmintrin.h>
+#endif
+
+#include "roofline.h"
+#include "timer.h"
+
+namespace {
+
+double copy_bandwidth(size_t size, unsigned times)
+{
+	zimg::AlignedVector<char> src(size, 1);
+	zimg::AlignedVector<char> dst(size);
+
+	auto results = measure_benchmark(times, [&]()
+	{
+		std::memcpy(dst.data(), src.data(), size);
+	});
+	return 2.0 * size / results.second;
+}
+
+// Independent multiply and add chains, enough to cover the latency of both.
+double flops_128(unsigned long long iterations)
+{
+#ifdef ZIMG_X86
+	__m128 m0 = _mm_set_ps1(1.0f), m1 = m0, m2 = m0, m3 = m0, m4 = m0, m5 = m0, m6 = m0, m7 = m0;
+	__m128 a0 = _mm_setzero_ps(), a1 = a0, a2 = a0, a3 = a0, a4 = a0, a5 = a0, a6 = a0, a7 = a0;
+	const __m128 mul = _mm_set_ps1(0.999999f);
+	const __m128 add = _mm_set_ps1(1e-6f);
+	Timer timer;
+
+	timer.start();
+	for (unsigned long long i = 0; i < iterations; ++i) {
+		m0 = _mm_mul_ps(m0, mul); a0 = _mm_add_ps(a0, add);
+		m1 = _mm_mul_ps(m1, mul); a1 = _mm_add_ps(a1, add);
+		m2 = _mm_mul_ps(m2, mul); a2 = _mm_add_ps(a2, add);
+		m3 = _mm_mul_ps(m3, mul); a3 = _mm_add_ps(a3, add);
+		m4 = _mm_mul_ps(m4, mul); a4 = _mm_add_ps(a4, add);
+		m5 = _mm_mul_ps(m5, mul); a5 = _mm_add_ps(a5, add);
+		m6 = _mm_mul_ps(m6, mul); a6 = _mm_add_ps(a6, add);
+		m7 = _mm_mul_ps(m7, mul); a7 = _mm_add_ps(a7, add);
+	}
+	timer.stop();
+
+	// Keep the results live.
+	volatile float sink = _mm_cvtss_f32(_mm_add_ps(
+		_mm_add_ps(_mm_add_ps(m0, m1), _mm_add_ps(m2, m3)), _mm_add_ps(_mm_add_ps(m4, m5), _mm_add_ps(m6, m7))));
+	sink = _mm_cvtss_f32(_mm_add_ps(
+		_mm_add_ps(_mm_add_ps(a0, a1), _mm_add_ps(a2, a3)), _mm_add_ps(_mm_add_ps(a4, a5), _mm_add_ps(a6, a7))));
+	(void)sink;
+
+	return iterations * 16.0 * 4 / timer.elapsed();
+#else
+	float m[8] = { 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f };
+	float a[8] = {};
+	Timer timer;
+
+	timer.start();
+	for (unsigned long long i = 0; i < iterations; ++i) {
+		for (unsigned k = 0; k < 8; ++k) {
+			m[k] *= 0.999999f;
+			a[k] += 1e-6f;
+		}
+	}
+	timer.stop();
+
+	volatile float sink = m[0] + a[0];
+	(void)sink;
+
+	return iterations * 16.0 / timer.elapsed();
+#endif
+}
+
+#ifdef ZIMG_X86
+// Ratio of the vector width used by [cpu] to 128 bits.
+double vector_scale(zimg::CPUClass cpu)
+{
+	switch (zimg::cpu_dispatch_class(cpu)) {
+	case zimg::CPUClass::NONE:
+		return 0.25;
+	case zimg::CPUClass::X86_AVX:
+	case zimg::CPUClass::X86_F16C:
+	case zimg::CPUClass::X86_AVX2:
+		return 2.0;
+	case zimg::CPUClass::X86_AVX512:
+		return 4.0;
+	default:
+		return 1.0;
+	}
+}
+#endif // ZIMG_X86
+
+} // namespace
+
+
+MachineRoofline measure_roofline(zimg::CPUClass cpu)
+{
+	const size_t dram_size = 256UL << 20;
+	size_t cache_size = std::max(zimg::cpu_cache_size(), 64UL << 10);
+
+	MachineRoofline roofline{};
+	roofline.dram_bandwidth = copy_bandwidth(dram_size, 5);
+	roofline.cache_bandwidth = copy_bandwidth(cache_size / 4, 1000);
+
+	double peak = 0.0;
+	for (unsigned n = 0; n < 5; ++n) {
+		peak = std::max(peak, flops_128(1UL << 24));
+	}
+
+#ifdef ZIMG_X86
+	roofline.peak_flops = peak * vector_scale(cpu);
+#else
+	(void)cpu;
+	roofline.peak_flops = peak;
+#endif
+	return roofline;
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+#ifndef ROOFLINE_H_
+#define ROOFLINE_H_
+
+namespace zimg {
+
+enum class CPUClass;
+
+} // namespace zimg
+
+
+// Single-core throughput limits of the host, in bytes and flops per second.
+struct MachineRoofline {
+	double dram_bandwidth;
+	double cache_bandwidth;
+	double peak_flops;
+};
+
+// Measure copy bandwidth for buffers in DRAM and in the last-level cache,
+// counting bytes read and written. Peak flops are measured with 128-bit
+// multiply and add, then scaled to the vector width of [cpu].
+MachineRoofline measure_roofline(zimg::CPUClass cpu);
+
+#endif // ROOFLINE_H_
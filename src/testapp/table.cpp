@@ -107,11 +107,13 @@ const zimg::static_string_map<ColorPrimaries, 12> g_primaries_table{
 	{ "jedec_p22", ColorPrimaries::JEDEC_P22 },
 };
 
-const zimg::static_string_map<DitherType, 4> g_dither_table{
+const zimg::static_string_map<DitherType, 6> g_dither_table{
 	{ "none",            DitherType::NONE },
 	{ "ordered",         DitherType::ORDERED },
 	{ "random",          DitherType::RANDOM },
 	{ "error_diffusion", DitherType::ERROR_DIFFUSION },
+	{ "sierra_lite",     DitherType::SIERRA_LITE },
+	{ "blue_noise",      DitherType::BLUE_NOISE },
 };
 
 const zimg::static_string_map<std::unique_ptr<zimg::resize::Filter>(*)(double, double), 7> g_resize_table{
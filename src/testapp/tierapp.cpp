@@ -0,0 +1,193 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+#include "common/alloc.h"
+#include "common/cpuinfo.h"
+#include "common/except.h"
+#include "common/pixel.h"
+#include "graph/filtergraph.h"
+#include "graph/graphbuilder.h"
+#include "graph/image_buffer.h"
+#include "depth/quantize.h"
+
+#include "apps.h"
+#include "argparse.h"
+#include "frame.h"
+#include "graphspec.h"
+#include "json.h"
+#include "table.h"
+#include "timer.h"
+#include "utils.h"
+
+namespace {
+
+const char *cpu_name(zimg::CPUClass cpu)
+{
+	for (const auto &entry : g_cpu_table) {
+		if (entry.second == cpu)
+			return entry.first;
+	}
+	return "";
+}
+
+double sample_value(const zimg::graph::ImageBuffer<const void> &buf, zimg::PixelType type, unsigned i, unsigned j)
+{
+	switch (type) {
+	case zimg::PixelType::BYTE:
+		return zimg::graph::static_buffer_cast<const uint8_t>(buf)[i][j];
+	case zimg::PixelType::WORD:
+		return zimg::graph::static_buffer_cast<const uint16_t>(buf)[i][j];
+	case zimg::PixelType::HALF:
+		return zimg::depth::half_to_float(zimg::graph::static_buffer_cast<const uint16_t>(buf)[i][j]);
+	case zimg::PixelType::FLOAT:
+		return zimg::graph::static_buffer_cast<const float>(buf)[i][j];
+	default:
+		return 0.0;
+	}
+}
+
+// Largest absolute difference between corresponding samples, in code values
+// for integer formats. Returns infinity if only one of the samples is NaN.
+double max_difference(const ImageFrame &a, const ImageFrame &b)
+{
+	double max_diff = 0.0;
+
+	for (unsigned p = 0; p < a.planes(); ++p) {
+		auto buf_a = a.as_read_buffer(p);
+		auto buf_b = b.as_read_buffer(p);
+
+		for (unsigned i = 0; i < a.height(p); ++i) {
+			for (unsigned j = 0; j < a.width(p); ++j) {
+				double x = sample_value(buf_a, a.pixel_type(), i, j);
+				double y = sample_value(buf_b, b.pixel_type(), i, j);
+
+				if (std::isnan(x) || std::isnan(y)) {
+					if (std::isnan(x) != std::isnan(y))
+						return INFINITY;
+					continue;
+				}
+				max_diff = std::max(max_diff, std::fabs(x - y));
+			}
+		}
+	}
+
+	return max_diff;
+}
+
+
+struct Arguments {
+	const char *specpath;
+	unsigned times;
+	double tolerance_int;
+	double tolerance_float;
+};
+
+const ArgparseOption program_switches[] = {
+	{ OPTION_UINT,  nullptr, "times",           offsetof(Arguments, times),           nullptr, "number of benchmark cycles" },
+	{ OPTION_FLOAT, nullptr, "tolerance-int",   offsetof(Arguments, tolerance_int),   nullptr, "maximum difference for integer output, in code values" },
+	{ OPTION_FLOAT, nullptr, "tolerance-float", offsetof(Arguments, tolerance_float), nullptr, "maximum difference for floating point output" },
+	{ OPTION_NULL }
+};
+
+const ArgparseOption program_positional[] = {
+	{ OPTION_STRING, nullptr, "specpath", offsetof(Arguments, specpath), nullptr, "graph specification file" },
+	{ OPTION_NULL }
+};
+
+const char help_str[] =
+"Builds the graph once for each instruction set supported by the host and\n"
+"for both autodetection modes, checks the output against the portable C\n"
+"implementation, and reports single-threaded speedup. A specification that\n"
+"performs a single conversion exercises a single filter.\n"
+"\n"
+"Exits with status 1 if any output differs by more than the tolerance.\n";
+
+const ArgparseCommandLine program_def = { program_switches, program_positional, "tiers", "compare CPU dispatch tiers", help_str };
+
+} // namespace
+
+
+int tiers_main(int argc, char **argv)
+{
+	Arguments args{};
+	int ret;
+
+	args.times = 20;
+	args.tolerance_int = 1.0;
+	args.tolerance_float = 1e-3;
+
+	if ((ret = argparse_parse(&program_def, &args, argc, argv)) < 0)
+		return ret == ARGPARSE_HELP_MESSAGE ? 0 : ret;
+
+	try {
+		json::Object spec = read_graph_spec(args.specpath);
+
+		std::vector<std::pair<const char *, zimg::CPUClass>> tiers = host_cpu_tiers();
+		tiers.push_back({ "auto", zimg::CPUClass::AUTO });
+		tiers.push_back({ "auto_64b", zimg::CPUClass::AUTO_64B });
+
+		zimg::graph::GraphBuilder::state src_state;
+		zimg::graph::GraphBuilder::state dst_state;
+		std::unique_ptr<ImageFrame> src_frame;
+		std::unique_ptr<ImageFrame> ref_frame;
+		double ref_fps = 0.0;
+		bool mismatch = false;
+
+		std::cout << std::left << std::setw(10) << "tier" << std::setw(10) << "dispatch" << std::right
+		          << std::setw(10) << "fps" << std::setw(10) << "speedup" << std::setw(12) << "max diff" << "  status\n";
+
+		for (const auto &tier : tiers) {
+			auto graph = create_graph(spec, &src_state, &dst_state, &tier.second, false);
+
+			if (!src_frame) {
+				src_frame.reset(new ImageFrame{ allocate_frame(src_state) });
+				fill_random(*src_frame, src_state.depth);
+			}
+
+			ImageFrame dst_frame = allocate_frame(dst_state);
+			zimg::AlignedVector<char> tmp(graph->get_tmp_size());
+
+			auto results = measure_benchmark(args.times, [&]()
+			{
+				graph->process(src_frame->as_read_buffer(), dst_frame.as_write_buffer(), tmp.data(), nullptr, nullptr);
+			});
+			double fps = 1.0 / results.second;
+
+			// The first tier is the C implementation, which serves as the reference.
+			double diff = 0.0;
+			if (ref_frame)
+				diff = max_difference(*ref_frame, dst_frame);
+			else
+				ref_frame.reset(new ImageFrame{ std::move(dst_frame) });
+			if (!ref_fps)
+				ref_fps = fps;
+
+			double tolerance = zimg::pixel_is_integer(dst_state.type) ? args.tolerance_int : args.tolerance_float;
+			bool ok = diff <= tolerance;
+			mismatch = mismatch || !ok;
+
+			std::cout << std::left << std::setw(10) << tier.first << std::setw(10) << cpu_name(graph->get_cpu()) << std::right
+			          << std::fixed << std::setprecision(1) << std::setw(10) << fps
+			          << std::setprecision(2) << std::setw(10) << fps / ref_fps;
+			std::cout.unsetf(std::ios_base::floatfield);
+			std::cout << std::setprecision(4) << std::setw(12) << diff << "  " << (ok ? "ok" : "MISMATCH") << '\n';
+		}
+
+		if (mismatch)
+			return 1;
+	} catch (const zimg::error::Exception &e) {
+		std::cerr << e.what() << '\n';
+		return 2;
+	} catch (const std::exception &e) {
+		std::cerr << e.what() << '\n';
+		return 2;
+	}
+
+	return 0;
+}
@@ -3,6 +3,7 @@
 #include "common/except.h"
 #include "common/make_unique.h"
 #include "common/pixel.h"
+#include "resize/filter.h"
 #include "unresize/unresize.h"
 
 #include "apps.h"
@@ -29,10 +30,12 @@ struct Arguments {
 	unsigned height_out;
 	double shift_w;
 	double shift_h;
+	std::unique_ptr<zimg::resize::Filter> filter;
 	zimg::PixelFormat working_format;
 	const char *visualise_path;
 	unsigned times;
 	zimg::CPUClass cpu;
+	unsigned threads;
 };
 
 const ArgparseOption program_switches[] = {
@@ -40,10 +43,12 @@ const ArgparseOption program_switches[] = {
 	{ OPTION_UINT,   "h",     "height-in",    offsetof(Arguments, height_in),      nullptr, "image height"},
 	{ OPTION_FLOAT,  nullptr, "shift-w",      offsetof(Arguments, shift_w),        nullptr, "subpixel shift" },
 	{ OPTION_FLOAT,  nullptr, "shift-h",      offsetof(Arguments, shift_h),        nullptr, "subpixel shift" },
+	{ OPTION_USER1,  nullptr, "filter",       offsetof(Arguments, filter),         arg_decode_filter, "filter to invert (default: bilinear)" },
 	{ OPTION_USER1,  nullptr, "format",       offsetof(Arguments, working_format), arg_decode_pixfmt, "working pixel format" },
 	{ OPTION_STRING, nullptr, "visualise",    offsetof(Arguments, visualise_path), nullptr, "path to BMP file for visualisation" },
 	{ OPTION_UINT,   nullptr, "times",        offsetof(Arguments, times),          nullptr, "number of benchmark cycles" },
 	{ OPTION_USER1,  nullptr, "cpu",          offsetof(Arguments, cpu),            arg_decode_cpu, "select CPU type" },
+	{ OPTION_UINT,   nullptr, "threads",      offsetof(Arguments, threads),        nullptr, "number of vertical unresize threads" },
 	{ OPTION_NULL }
 };
 
@@ -60,7 +65,7 @@ const ArgparseCommandLine program_def = {
 	program_positional,
 	"unresize",
 	"unresize images",
-	PIXFMT_SPECIFIER_HELP_STR "\n" PATH_SPECIFIER_HELP_STR
+	FILTER_SPECIFIER_HELP_STR "\n" PIXFMT_SPECIFIER_HELP_STR "\n" PATH_SPECIFIER_HELP_STR
 };
 
 double ns_per_sample(const ImageFrame &frame, double seconds)
@@ -105,11 +110,14 @@ int unresize_main(int argc, char **argv)
 		ImageFrame dst_frame{ args.width_out, args.height_out, src_frame.pixel_type(), src_frame.planes(), src_frame.is_yuv() };
 
 		auto filter_pair = zimg::unresize::UnresizeConversion{ src_frame.width(), src_frame.height(), src_frame.pixel_type() }
+			.set_depth(zimg::pixel_depth(src_frame.pixel_type()))
 			.set_orig_width(dst_frame.width())
 			.set_orig_height(dst_frame.height())
 			.set_shift_w(args.shift_w)
 			.set_shift_h(args.shift_h)
+			.set_filter(args.filter.get())
 			.set_cpu(args.cpu)
+			.set_threads(args.threads ? args.threads : 1)
 			.create();
 
 		if (filter_pair.second)
@@ -1,9 +1,15 @@
 #include <algorithm>
 #include <memory>
+#include <random>
 #include "common/alloc.h"
+#include "common/cpuinfo.h"
+#include "common/pixel.h"
+#include "graph/image_buffer.h"
 #include "graph/image_filter.h"
+#include "depth/quantize.h"
 
 #include "frame.h"
+#include "table.h"
 #include "utils.h"
 
 struct FilterExecutor::data {
@@ -19,7 +25,7 @@ void FilterExecutor::exec_grey(const zimg::graph::ImageFilter *filter, unsigned
 	auto attr = filter->get_image_attributes();
 	unsigned step = filter->get_simultaneous_lines();
 
-	filter->init_context(m_data->ctx.data());
+	filter->init_context(m_data->ctx.data(), 0);
 
 	for (unsigned i = 0; i < attr.height; i += step) {
 		filter->process(m_data->ctx.data(), &src_buffer, &dst_buffer, m_data->tmp.data(), i, 0, attr.width);
@@ -31,7 +37,7 @@ void FilterExecutor::exec_color()
 	auto attr = m_filter->get_image_attributes();
 	unsigned step = m_filter->get_simultaneous_lines();
 
-	m_filter->init_context(m_data->ctx.data());
+	m_filter->init_context(m_data->ctx.data(), 0);
 
 	for (unsigned i = 0; i < attr.height; i += step) {
 		m_filter->process(m_data->ctx.data(), m_src_frame->as_read_buffer(), m_dst_frame->as_write_buffer(), m_data->tmp.data(), i, 0, attr.width);
@@ -67,3 +73,51 @@ void FilterExecutor::operator()()
 		exec_color();
 	}
 }
+
+
+std::vector<std::pair<const char *, zimg::CPUClass>> host_cpu_tiers()
+{
+	zimg::CPUClass host_cpu = zimg::cpu_dispatch_class(zimg::CPUClass::AUTO_64B);
+	std::vector<std::pair<const char *, zimg::CPUClass>> tiers;
+
+	for (const auto &entry : g_cpu_table) {
+		if (!zimg::cpu_is_autodetect(entry.second) && entry.second <= host_cpu)
+			tiers.push_back(entry);
+	}
+
+	std::sort(tiers.begin(), tiers.end(), [](const std::pair<const char *, zimg::CPUClass> &a, const std::pair<const char *, zimg::CPUClass> &b)
+	{
+		return a.second < b.second;
+	});
+	return tiers;
+}
+
+void fill_random(ImageFrame &frame, unsigned depth)
+{
+	std::mt19937 mt;
+	std::uniform_int_distribution<unsigned> int_dist{ 0, (1U << std::min(depth, 16U)) - 1 };
+	std::uniform_real_distribution<float> float_dist{ 0.0f, 1.0f };
+
+	for (unsigned p = 0; p < frame.planes(); ++p) {
+		auto buf = frame.as_write_buffer(p);
+
+		for (unsigned i = 0; i < frame.height(p); ++i) {
+			for (unsigned j = 0; j < frame.width(p); ++j) {
+				switch (frame.pixel_type()) {
+				case zimg::PixelType::BYTE:
+					zimg::graph::static_buffer_cast<uint8_t>(buf)[i][j] = static_cast<uint8_t>(int_dist(mt));
+					break;
+				case zimg::PixelType::WORD:
+					zimg::graph::static_buffer_cast<uint16_t>(buf)[i][j] = static_cast<uint16_t>(int_dist(mt));
+					break;
+				case zimg::PixelType::HALF:
+					zimg::graph::static_buffer_cast<uint16_t>(buf)[i][j] = zimg::depth::float_to_half(float_dist(mt));
+					break;
+				case zimg::PixelType::FLOAT:
+					zimg::graph::static_buffer_cast<float>(buf)[i][j] = float_dist(mt);
+					break;
+				}
+			}
+		}
+	}
+}
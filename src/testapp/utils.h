@@ -4,8 +4,13 @@
 #define UTILS_H_
 
 #include <memory>
+#include <utility>
+#include <vector>
 
 namespace zimg {
+
+enum class CPUClass;
+
 namespace graph {
 
 class ImageFilter;
@@ -33,4 +38,11 @@ public:
 	void operator()();
 };
 
+
+// Instruction sets usable on the host, from least to most capable.
+std::vector<std::pair<const char *, zimg::CPUClass>> host_cpu_tiers();
+
+// Fill [frame] with reproducible random samples of the given bit depth.
+void fill_random(ImageFrame &frame, unsigned depth);
+
 #endif // UTILS_H_
@@ -211,7 +211,7 @@ std::pair<Token, TracingIterator<ForwardIt>> match_number_literal(TracingIterato
 		if (pos == last)
 			throw JsonError{ "expected digits following exponent indicator", line, col };
 
-		pos = skip_while(first, last, is_json_digit);
+		pos = skip_while(pos, last, is_json_digit);
 	}
 
 	return{ { Token::NUMBER_LITERAL, line, col, { first, pos } }, pos };
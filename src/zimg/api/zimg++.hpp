@@ -202,6 +202,13 @@ public:
 		return ret;
 	}
 
+	unsigned get_stream_input_buffering() const
+	{
+		unsigned ret;
+		check(zimg_filter_graph_get_stream_input_buffering(m_graph, &ret));
+		return ret;
+	}
+
 	void process(const zimg_image_buffer_const &src, const zimg_image_buffer &dst, void *tmp,
 	             zimg_filter_graph_callback unpack_cb = 0, void *unpack_user = 0,
 	             zimg_filter_graph_callback pack_cb = 0, void *pack_user = 0) const
@@ -209,6 +216,83 @@ public:
 		check(zimg_filter_graph_process(m_graph, &src, &dst, tmp, unpack_cb, unpack_user, pack_cb, pack_user));
 	}
 
+	void process_seed(const zimg_image_buffer_const &src, const zimg_image_buffer &dst, void *tmp, unsigned seed,
+	                  zimg_filter_graph_callback unpack_cb = 0, void *unpack_user = 0,
+	                  zimg_filter_graph_callback pack_cb = 0, void *pack_user = 0) const
+	{
+		check(zimg_filter_graph_process_seed(m_graph, &src, &dst, tmp, unpack_cb, unpack_user, pack_cb, pack_user, seed));
+	}
+
+	void process_batch(const zimg_image_buffer_const &src, const zimg_image_buffer &dst, void *tmp, unsigned seed,
+	                   zimg_filter_graph_batch_callback unpack_cb = 0, void *unpack_user = 0,
+	                   zimg_filter_graph_batch_callback pack_cb = 0, void *pack_user = 0) const
+	{
+		check(zimg_filter_graph_process_batch(m_graph, &src, &dst, tmp, unpack_cb, unpack_user, pack_cb, pack_user, seed));
+	}
+
+	void set_stats_enabled(bool enabled)
+	{
+		check(zimg_filter_graph_set_stats_enabled(m_graph, enabled));
+	}
+
+	unsigned get_stats(zimg_filter_graph_node_stats *stats, unsigned num_nodes, zimg_cpu_type_e *cpu_type = 0) const
+	{
+		check(zimg_filter_graph_get_stats(m_graph, stats, &num_nodes, cpu_type));
+		return num_nodes;
+	}
+
+	void reset_stats() const
+	{
+		check(zimg_filter_graph_reset_stats(m_graph));
+	}
+
+	size_t dump_plan(zimg_graph_plan_format_e format, char *buf, size_t size) const
+	{
+		check(zimg_filter_graph_dump_plan(m_graph, format, buf, &size));
+		return size;
+	}
+
+	void set_trace_capacity(size_t capacity)
+	{
+		check(zimg_filter_graph_set_trace_capacity(m_graph, capacity));
+	}
+
+	size_t dump_trace(char *buf, size_t size) const
+	{
+		check(zimg_filter_graph_dump_trace(m_graph, buf, &size));
+		return size;
+	}
+
+	void clear_trace() const
+	{
+		check(zimg_filter_graph_clear_trace(m_graph));
+	}
+
+	void set_async_io(unsigned unpack_ahead, unsigned pack_behind)
+	{
+		check(zimg_filter_graph_set_async_io(m_graph, unpack_ahead, pack_behind));
+	}
+
+	void set_callback_batch(unsigned rows, bool full_width)
+	{
+		check(zimg_filter_graph_set_callback_batch(m_graph, rows, full_width));
+	}
+
+	static void trim_scratch_pool()
+	{
+		if (zimg_scratch_pool_trim())
+			throw zerror();
+	}
+
+	static size_t get_scratch_pool_high_water(bool reset = false)
+	{
+		size_t high_water;
+
+		if (zimg_scratch_pool_get_usage(0, &high_water, reset))
+			throw zerror();
+		return high_water;
+	}
+
 	static zimg_filter_graph *build(const zimg_image_format &src_format, const zimg_image_format &dst_format, const zimg_graph_builder_params *params = 0)
 	{
 		zimg_filter_graph *graph;
@@ -218,6 +302,64 @@ public:
 
 		return graph;
 	}
+
+	friend class FilterGraphStream;
+};
+
+class FilterGraphStream {
+private:
+	zimg_filter_graph_stream *m_stream;
+
+	FilterGraphStream(const FilterGraphStream &);
+
+	FilterGraphStream &operator=(const FilterGraphStream &);
+
+	void check(zimg_error_code_e err) const
+	{
+		if (err)
+			throw zerror();
+	}
+public:
+	FilterGraphStream(const FilterGraph &graph, const zimg_image_buffer_const &src, const zimg_image_buffer &dst, unsigned seed = 0)
+	{
+		if (!(m_stream = zimg_filter_graph_stream_begin(graph.m_graph, &src, &dst, seed)))
+			throw zerror();
+	}
+
+	~FilterGraphStream()
+	{
+		zimg_filter_graph_stream_end(m_stream);
+	}
+
+#if __cplusplus >= 201103L || (defined(_MSC_VER) && _MSC_VER >= 1600)
+	FilterGraphStream(FilterGraphStream &&other) : m_stream(other.m_stream)
+	{
+		other.m_stream = 0;
+	}
+
+	FilterGraphStream &operator=(FilterGraphStream &&other)
+	{
+		if (this != &other) {
+			zimg_filter_graph_stream_end(m_stream);
+			m_stream = other.m_stream;
+			other.m_stream = 0;
+		}
+
+		return *this;
+	}
+#endif
+
+	void push_rows(unsigned count)
+	{
+		check(zimg_filter_graph_stream_push_rows(m_stream, count));
+	}
+
+	unsigned pull_rows(unsigned *first)
+	{
+		unsigned count;
+		check(zimg_filter_graph_stream_pull_rows(m_stream, first, &count));
+		return count;
+	}
 };
 
 } // namespace zimgxx
@@ -1,9 +1,13 @@
+#include <algorithm>
 #include <cmath>
+#include <cstring>
 #include <memory>
 #include <string>
 #include <tuple>
 #include <type_traits>
 #include <utility>
+#include <vector>
+#include "common/alloc.h"
 #include "common/cpuinfo.h"
 #include "common/except.h"
 #include "common/make_unique.h"
@@ -13,6 +17,7 @@
 #include "graph/filtergraph.h"
 #include "graph/graphbuilder.h"
 #include "graph/image_buffer.h"
+#include "graph/scratch_pool.h"
 #include "colorspace/colorspace.h"
 #include "depth/depth.h"
 #include "resize/filter.h"
@@ -25,6 +30,7 @@ namespace {
 constexpr unsigned API_VERSION_2_0 = ZIMG_MAKE_API_VERSION(2, 0);
 constexpr unsigned API_VERSION_2_1 = ZIMG_MAKE_API_VERSION(2, 1);
 constexpr unsigned API_VERSION_2_2 = ZIMG_MAKE_API_VERSION(2, 2);
+constexpr unsigned API_VERSION_2_4 = ZIMG_MAKE_API_VERSION(2, 4);
 
 #define API_VERSION_ASSERT(x) zassert_d((x) >= API_VERSION_2_0, "API version invalid")
 #define POINTER_ALIGNMENT_ASSERT(x) zassert_d(!(x) || reinterpret_cast<uintptr_t>(x) % zimg::ALIGNMENT_RELAXED == 0, "pointer not aligned")
@@ -151,6 +157,48 @@ zimg::CPUClass translate_cpu(zimg_cpu_type_e cpu)
 	return search_enum_map(map, cpu, "unrecognized cpu type");
 }
 
+// Copy a string to a caller-provided buffer, truncating if needed.
+void export_string(const std::string &str, char *buf, size_t *size)
+{
+	if (buf && *size) {
+		size_t n = std::min(str.size(), *size - 1);
+		std::memcpy(buf, str.c_str(), n);
+		buf[n] = '\0';
+	}
+
+	*size = str.size() + 1;
+}
+
+zimg_cpu_type_e export_cpu(zimg::CPUClass cpu)
+{
+	using zimg::CPUClass;
+
+	static SM_CONSTEXPR_14 const zimg::static_map<CPUClass, zimg_cpu_type_e, 7> map{
+		{ CPUClass::NONE,       ZIMG_CPU_NONE },
+#ifdef ZIMG_X86
+		{ CPUClass::X86_SSE,    ZIMG_CPU_X86_SSE },
+		{ CPUClass::X86_SSE2,   ZIMG_CPU_X86_SSE2 },
+		{ CPUClass::X86_AVX,    ZIMG_CPU_X86_AVX },
+		{ CPUClass::X86_F16C,   ZIMG_CPU_X86_F16C },
+		{ CPUClass::X86_AVX2,   ZIMG_CPU_X86_AVX2 },
+		{ CPUClass::X86_AVX512, ZIMG_CPU_X86_AVX512_SKL },
+#endif
+	};
+	auto it = map.find(cpu);
+	return it == map.end() ? ZIMG_CPU_NONE : it->second;
+}
+
+zimg::graph::FilterGraph::plan_format translate_plan_format(zimg_graph_plan_format_e format)
+{
+	using plan_format = zimg::graph::FilterGraph::plan_format;
+
+	static SM_CONSTEXPR_14 const zimg::static_map<zimg_graph_plan_format_e, plan_format, 2> map{
+		{ ZIMG_GRAPH_PLAN_JSON, plan_format::JSON },
+		{ ZIMG_GRAPH_PLAN_DOT,  plan_format::DOT },
+	};
+	return search_enum_map(map, format, "unrecognized plan format");
+}
+
 zimg::PixelType translate_pixel_type(zimg_pixel_type_e pixel_type)
 {
 	using zimg::PixelType;
@@ -297,11 +345,13 @@ zimg::depth::DitherType translate_dither(zimg_dither_type_e dither)
 {
 	using zimg::depth::DitherType;
 
-	static SM_CONSTEXPR_14 const zimg::static_map<zimg_dither_type_e, DitherType, 4> map{
+	static SM_CONSTEXPR_14 const zimg::static_map<zimg_dither_type_e, DitherType, 6> map{
 		{ ZIMG_DITHER_NONE,            DitherType::NONE },
 		{ ZIMG_DITHER_ORDERED,         DitherType::ORDERED },
 		{ ZIMG_DITHER_RANDOM,          DitherType::RANDOM },
 		{ ZIMG_DITHER_ERROR_DIFFUSION, DitherType::ERROR_DIFFUSION },
+		{ ZIMG_DITHER_SIERRA_LITE,     DitherType::SIERRA_LITE },
+		{ ZIMG_DITHER_BLUE_NOISE,      DitherType::BLUE_NOISE },
 	};
 	return search_enum_map(map, dither, "unrecognized dither type");
 }
@@ -447,10 +497,69 @@ zimg::graph::GraphBuilder::params import_graph_params(const zimg_graph_builder_p
 		params.peak_luminance = src.nominal_peak_luminance;
 		params.approximate_gamma = !!src.allow_approximate_gamma;
 	}
+	if (src.version >= API_VERSION_2_4) {
+		params.dither_threads = src.dither_threads ? src.dither_threads : 1;
+	}
 
 	return params;
 }
 
+zimg::allocator_hooks import_allocator(const zimg_allocator &src)
+{
+	if (!src.alloc != !src.free)
+		zimg::error::throw_<zimg::error::IllegalArgument>("allocator must provide both alloc and free");
+
+	return{ src.alloc, src.free, src.user };
+}
+
+void process_graph(const zimg_filter_graph *ptr, const zimg_image_buffer_const *src, const zimg_image_buffer *dst, void *tmp,
+                   zimg::graph::FilterGraph::callback unpack_cb, zimg::graph::FilterGraph::callback pack_cb, unsigned seed)
+{
+	const zimg::graph::FilterGraph *graph = assert_dynamic_type<const zimg::graph::FilterGraph>(ptr);
+
+	if (graph->requires_64b_alignment()) {
+		POINTER_ALIGNMENT64_ASSERT(src->plane[0].data);
+		POINTER_ALIGNMENT64_ASSERT(src->plane[1].data);
+		POINTER_ALIGNMENT64_ASSERT(src->plane[2].data);
+
+		STRIDE_ALIGNMENT64_ASSERT(src->plane[0].stride);
+		STRIDE_ALIGNMENT64_ASSERT(src->plane[1].stride);
+		STRIDE_ALIGNMENT64_ASSERT(src->plane[2].stride);
+
+		POINTER_ALIGNMENT64_ASSERT(dst->plane[0].data);
+		POINTER_ALIGNMENT64_ASSERT(dst->plane[1].data);
+		POINTER_ALIGNMENT64_ASSERT(dst->plane[2].data);
+
+		STRIDE_ALIGNMENT64_ASSERT(dst->plane[0].stride);
+		STRIDE_ALIGNMENT64_ASSERT(dst->plane[1].stride);
+		STRIDE_ALIGNMENT64_ASSERT(dst->plane[2].stride);
+
+		POINTER_ALIGNMENT64_ASSERT(tmp);
+	} else {
+		POINTER_ALIGNMENT_ASSERT(src->plane[0].data);
+		POINTER_ALIGNMENT_ASSERT(src->plane[1].data);
+		POINTER_ALIGNMENT_ASSERT(src->plane[2].data);
+
+		STRIDE_ALIGNMENT_ASSERT(src->plane[0].stride);
+		STRIDE_ALIGNMENT_ASSERT(src->plane[1].stride);
+		STRIDE_ALIGNMENT_ASSERT(src->plane[2].stride);
+
+		POINTER_ALIGNMENT_ASSERT(dst->plane[0].data);
+		POINTER_ALIGNMENT_ASSERT(dst->plane[1].data);
+		POINTER_ALIGNMENT_ASSERT(dst->plane[2].data);
+
+		STRIDE_ALIGNMENT_ASSERT(dst->plane[0].stride);
+		STRIDE_ALIGNMENT_ASSERT(dst->plane[1].stride);
+		STRIDE_ALIGNMENT_ASSERT(dst->plane[2].stride);
+
+		POINTER_ALIGNMENT_ASSERT(tmp);
+	}
+
+	auto src_buf = import_image_buffer(*src);
+	auto dst_buf = import_image_buffer(*dst);
+	graph->process(src_buf, dst_buf, tmp, unpack_cb, pack_cb, seed);
+}
+
 } // namespace
 
 
@@ -505,6 +614,13 @@ unsigned zimg_select_buffer_mask(unsigned count)
   } \
   return ret;
 
+zimg_error_code_e zimg_set_allocator(const zimg_allocator *allocator)
+{
+	EX_BEGIN
+	zimg::set_global_allocator(allocator ? import_allocator(*allocator) : zimg::allocator_hooks{});
+	EX_END
+}
+
 void zimg_filter_graph_free(zimg_filter_graph *ptr)
 {
 	delete ptr;
@@ -540,61 +656,227 @@ zimg_error_code_e zimg_filter_graph_get_output_buffering(const zimg_filter_graph
 	EX_END
 }
 
+zimg_error_code_e zimg_filter_graph_get_stream_input_buffering(const zimg_filter_graph *ptr, unsigned *out)
+{
+	zassert_d(ptr, "null pointer");
+	zassert_d(out, "null pointer");
+
+	EX_BEGIN
+	*out = assert_dynamic_type<const zimg::graph::FilterGraph>(ptr)->get_stream_input_buffering();
+	EX_END
+}
+
 zimg_error_code_e zimg_filter_graph_process(const zimg_filter_graph *ptr, const zimg_image_buffer_const *src, const zimg_image_buffer *dst, void *tmp,
                                              zimg_filter_graph_callback unpack_cb, void *unpack_user,
                                              zimg_filter_graph_callback pack_cb, void *pack_user)
+{
+	return zimg_filter_graph_process_seed(ptr, src, dst, tmp, unpack_cb, unpack_user, pack_cb, pack_user, 0);
+}
+
+zimg_error_code_e zimg_filter_graph_process_seed(const zimg_filter_graph *ptr, const zimg_image_buffer_const *src, const zimg_image_buffer *dst, void *tmp,
+                                                  zimg_filter_graph_callback unpack_cb, void *unpack_user,
+                                                  zimg_filter_graph_callback pack_cb, void *pack_user, unsigned seed)
+{
+	zassert_d(ptr, "null pointer");
+	zassert_d(src, "null pointer");
+	zassert_d(dst, "null pointer");
+
+	EX_BEGIN
+	process_graph(ptr, src, dst, tmp, { unpack_cb, unpack_user }, { pack_cb, pack_user }, seed);
+	EX_END
+}
+
+zimg_error_code_e zimg_filter_graph_process_batch(const zimg_filter_graph *ptr, const zimg_image_buffer_const *src, const zimg_image_buffer *dst, void *tmp,
+                                                   zimg_filter_graph_batch_callback unpack_cb, void *unpack_user,
+                                                   zimg_filter_graph_batch_callback pack_cb, void *pack_user, unsigned seed)
 {
 	zassert_d(ptr, "null pointer");
 	zassert_d(src, "null pointer");
 	zassert_d(dst, "null pointer");
 
+	EX_BEGIN
+	process_graph(ptr, src, dst, tmp, { unpack_cb, unpack_user }, { pack_cb, pack_user }, seed);
+	EX_END
+}
+
+zimg_error_code_e zimg_scratch_pool_trim(void)
+{
+	EX_BEGIN
+	zimg::graph::ScratchPool::local().trim();
+	EX_END
+}
+
+zimg_error_code_e zimg_scratch_pool_get_usage(size_t *allocated, size_t *high_water, int reset)
+{
+	EX_BEGIN
+	if (allocated)
+		*allocated = zimg::graph::ScratchPool::allocated_size();
+	if (high_water)
+		*high_water = zimg::graph::ScratchPool::high_water_mark();
+	if (reset)
+		zimg::graph::ScratchPool::reset_high_water_mark();
+	EX_END
+}
+
+zimg_error_code_e zimg_filter_graph_set_stats_enabled(zimg_filter_graph *ptr, int enabled)
+{
+	zassert_d(ptr, "null pointer");
+
+	EX_BEGIN
+	assert_dynamic_type<zimg::graph::FilterGraph>(ptr)->set_stats_enabled(!!enabled);
+	EX_END
+}
+
+zimg_error_code_e zimg_filter_graph_get_stats(const zimg_filter_graph *ptr, zimg_filter_graph_node_stats *stats, unsigned *num_nodes, zimg_cpu_type_e *cpu_type)
+{
+	zassert_d(ptr, "null pointer");
+	zassert_d(num_nodes, "null pointer");
+
 	EX_BEGIN
 	const zimg::graph::FilterGraph *graph = assert_dynamic_type<const zimg::graph::FilterGraph>(ptr);
+	std::vector<zimg::graph::FilterGraph::node_stats> node_stats = graph->get_stats();
+
+	if (stats) {
+		for (size_t i = 0; i < std::min(node_stats.size(), static_cast<size_t>(*num_nodes)); ++i) {
+			stats[i].name = node_stats[i].name;
+			stats[i].calls = node_stats[i].calls;
+			stats[i].pixels = node_stats[i].pixels;
+			stats[i].nanoseconds = node_stats[i].nanoseconds;
+			stats[i].bytes_read = node_stats[i].bytes_read;
+			stats[i].bytes_written = node_stats[i].bytes_written;
+		}
+	}
 
-	if (graph->requires_64b_alignment()) {
-		POINTER_ALIGNMENT64_ASSERT(src->plane[0].data);
-		POINTER_ALIGNMENT64_ASSERT(src->plane[1].data);
-		POINTER_ALIGNMENT64_ASSERT(src->plane[2].data);
+	*num_nodes = static_cast<unsigned>(node_stats.size());
+	if (cpu_type)
+		*cpu_type = export_cpu(graph->get_cpu());
+	EX_END
+}
 
-		STRIDE_ALIGNMENT64_ASSERT(src->plane[0].stride);
-		STRIDE_ALIGNMENT64_ASSERT(src->plane[1].stride);
-		STRIDE_ALIGNMENT64_ASSERT(src->plane[2].stride);
+zimg_error_code_e zimg_filter_graph_reset_stats(const zimg_filter_graph *ptr)
+{
+	zassert_d(ptr, "null pointer");
 
-		POINTER_ALIGNMENT64_ASSERT(dst->plane[0].data);
-		POINTER_ALIGNMENT64_ASSERT(dst->plane[1].data);
-		POINTER_ALIGNMENT64_ASSERT(dst->plane[2].data);
+	EX_BEGIN
+	assert_dynamic_type<const zimg::graph::FilterGraph>(ptr)->reset_stats();
+	EX_END
+}
 
-		STRIDE_ALIGNMENT64_ASSERT(dst->plane[0].stride);
-		STRIDE_ALIGNMENT64_ASSERT(dst->plane[1].stride);
-		STRIDE_ALIGNMENT64_ASSERT(dst->plane[2].stride);
+zimg_error_code_e zimg_filter_graph_dump_plan(const zimg_filter_graph *ptr, zimg_graph_plan_format_e format, char *buf, size_t *size)
+{
+	zassert_d(ptr, "null pointer");
+	zassert_d(size, "null pointer");
 
-		POINTER_ALIGNMENT64_ASSERT(tmp);
-	} else {
-		POINTER_ALIGNMENT_ASSERT(src->plane[0].data);
-		POINTER_ALIGNMENT_ASSERT(src->plane[1].data);
-		POINTER_ALIGNMENT_ASSERT(src->plane[2].data);
+	EX_BEGIN
+	export_string(assert_dynamic_type<const zimg::graph::FilterGraph>(ptr)->dump_plan(translate_plan_format(format)), buf, size);
+	EX_END
+}
 
-		STRIDE_ALIGNMENT_ASSERT(src->plane[0].stride);
-		STRIDE_ALIGNMENT_ASSERT(src->plane[1].stride);
-		STRIDE_ALIGNMENT_ASSERT(src->plane[2].stride);
+zimg_error_code_e zimg_filter_graph_set_trace_capacity(zimg_filter_graph *ptr, size_t capacity)
+{
+	zassert_d(ptr, "null pointer");
 
-		POINTER_ALIGNMENT_ASSERT(dst->plane[0].data);
-		POINTER_ALIGNMENT_ASSERT(dst->plane[1].data);
-		POINTER_ALIGNMENT_ASSERT(dst->plane[2].data);
+	EX_BEGIN
+	assert_dynamic_type<zimg::graph::FilterGraph>(ptr)->set_trace_capacity(capacity);
+	EX_END
+}
 
-		STRIDE_ALIGNMENT_ASSERT(dst->plane[0].stride);
-		STRIDE_ALIGNMENT_ASSERT(dst->plane[1].stride);
-		STRIDE_ALIGNMENT_ASSERT(dst->plane[2].stride);
+zimg_error_code_e zimg_filter_graph_dump_trace(const zimg_filter_graph *ptr, char *buf, size_t *size)
+{
+	zassert_d(ptr, "null pointer");
+	zassert_d(size, "null pointer");
 
-		POINTER_ALIGNMENT_ASSERT(tmp);
+	EX_BEGIN
+	export_string(assert_dynamic_type<const zimg::graph::FilterGraph>(ptr)->dump_trace(), buf, size);
+	EX_END
+}
+
+zimg_error_code_e zimg_filter_graph_clear_trace(const zimg_filter_graph *ptr)
+{
+	zassert_d(ptr, "null pointer");
+
+	EX_BEGIN
+	assert_dynamic_type<const zimg::graph::FilterGraph>(ptr)->clear_trace();
+	EX_END
+}
+
+zimg_error_code_e zimg_filter_graph_set_async_io(zimg_filter_graph *ptr, unsigned unpack_ahead, unsigned pack_behind)
+{
+	zassert_d(ptr, "null pointer");
+
+	EX_BEGIN
+	assert_dynamic_type<zimg::graph::FilterGraph>(ptr)->set_async_io(unpack_ahead, pack_behind);
+	EX_END
+}
+
+zimg_error_code_e zimg_filter_graph_set_callback_batch(zimg_filter_graph *ptr, unsigned rows, int full_width)
+{
+	zassert_d(ptr, "null pointer");
+
+	EX_BEGIN
+	assert_dynamic_type<zimg::graph::FilterGraph>(ptr)->set_callback_batch(rows, !!full_width);
+	EX_END
+}
+
+zimg_filter_graph_stream *zimg_filter_graph_stream_begin(const zimg_filter_graph *ptr, const zimg_image_buffer_const *src, const zimg_image_buffer *dst, unsigned seed)
+{
+	zassert_d(ptr, "null pointer");
+	zassert_d(src, "null pointer");
+	zassert_d(dst, "null pointer");
+
+	try {
+		const zimg::graph::FilterGraph *graph = assert_dynamic_type<const zimg::graph::FilterGraph>(ptr);
+
+		for (unsigned p = 0; p < 3; ++p) {
+			if (graph->requires_64b_alignment()) {
+				POINTER_ALIGNMENT64_ASSERT(src->plane[p].data);
+				STRIDE_ALIGNMENT64_ASSERT(src->plane[p].stride);
+				POINTER_ALIGNMENT64_ASSERT(dst->plane[p].data);
+				STRIDE_ALIGNMENT64_ASSERT(dst->plane[p].stride);
+			} else {
+				POINTER_ALIGNMENT_ASSERT(src->plane[p].data);
+				STRIDE_ALIGNMENT_ASSERT(src->plane[p].stride);
+				POINTER_ALIGNMENT_ASSERT(dst->plane[p].data);
+				STRIDE_ALIGNMENT_ASSERT(dst->plane[p].stride);
+			}
+		}
+
+		auto src_buf = import_image_buffer(*src);
+		auto dst_buf = import_image_buffer(*dst);
+
+		zimg::AllocatorScope allocator_scope{ graph->get_allocator() };
+		return new zimg::graph::FilterGraph::stream{ *graph, src_buf, dst_buf, seed };
+	} catch (...) {
+		handle_exception(std::current_exception());
+		return nullptr;
 	}
+}
 
-	auto src_buf = import_image_buffer(*src);
-	auto dst_buf = import_image_buffer(*dst);
-	graph->process(src_buf, dst_buf, tmp, { unpack_cb, unpack_user }, { pack_cb, pack_user });
+zimg_error_code_e zimg_filter_graph_stream_push_rows(zimg_filter_graph_stream *ptr, unsigned count)
+{
+	zassert_d(ptr, "null pointer");
+
+	EX_BEGIN
+	assert_dynamic_type<zimg::graph::FilterGraph::stream>(ptr)->push_rows(count);
+	EX_END
+}
+
+zimg_error_code_e zimg_filter_graph_stream_pull_rows(zimg_filter_graph_stream *ptr, unsigned *first, unsigned *count)
+{
+	zassert_d(ptr, "null pointer");
+	zassert_d(first, "null pointer");
+	zassert_d(count, "null pointer");
+
+	EX_BEGIN
+	*count = assert_dynamic_type<zimg::graph::FilterGraph::stream>(ptr)->pull_rows(first);
 	EX_END
 }
 
+void zimg_filter_graph_stream_end(zimg_filter_graph_stream *ptr)
+{
+	delete ptr;
+}
+
 #undef EX_BEGIN
 #undef EX_END
 
@@ -656,6 +938,10 @@ void zimg_graph_builder_params_default(zimg_graph_builder_params *ptr, unsigned
 		ptr->nominal_peak_luminance = NAN;
 		ptr->allow_approximate_gamma = 0;
 	}
+	if (version >= API_VERSION_2_4) {
+		ptr->dither_threads = 1;
+		ptr->allocator = nullptr;
+	}
 }
 
 zimg_filter_graph *zimg_filter_graph_build(const zimg_image_format *src_format, const zimg_image_format *dst_format, const zimg_graph_builder_params *params)
@@ -672,6 +958,12 @@ zimg_filter_graph *zimg_filter_graph_build(const zimg_image_format *src_format,
 		if (params)
 			graph_params = import_graph_params(*params);
 
+		// Memory owned by the graph is allocated while the scope is active.
+		zimg::allocator_hooks allocator = zimg::current_allocator();
+		if (params && params->version >= API_VERSION_2_4 && params->allocator)
+			allocator = import_allocator(*params->allocator);
+		zimg::AllocatorScope allocator_scope{ allocator };
+
 		return zimg::graph::GraphBuilder{}.set_source(src_state)
 		                                  .connect_graph(dst_state, params ? &graph_params : nullptr)
 		                                  .complete_graph()
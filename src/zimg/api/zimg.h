@@ -29,7 +29,7 @@ extern "C" {
  */
 #define ZIMG_MAKE_API_VERSION(x, y) (((x) << 8) | (y))
 #define ZIMG_API_VERSION_MAJOR 2
-#define ZIMG_API_VERSION_MINOR 3
+#define ZIMG_API_VERSION_MINOR 4
 #define ZIMG_API_VERSION ZIMG_MAKE_API_VERSION(ZIMG_API_VERSION_MAJOR, ZIMG_API_VERSION_MINOR)
 
 /**
@@ -145,6 +145,59 @@ zimg_error_code_e zimg_get_last_error(char *err_msg, size_t n);
 ZIMG_VISIBILITY
 void zimg_clear_last_error(void);
 
+/**
+ * User-defined memory allocation functions.
+ *
+ * The functions may be called concurrently from any thread that uses the
+ * library. Memory is always returned to the allocator that provided it.
+ *
+ * Since API 2.4.
+ */
+typedef struct zimg_allocator {
+	/**
+	 * Allocate memory.
+	 *
+	 * @param user user-defined private data
+	 * @param size size in bytes
+	 * @param alignment required alignment in bytes, a power of two
+	 * @return pointer to memory, or NULL on failure
+	 */
+	void *(*alloc)(void *user, size_t size, size_t alignment);
+
+	/**
+	 * Free memory.
+	 *
+	 * @param user user-defined private data
+	 * @param ptr pointer returned by {@link alloc}
+	 * @param size size passed to {@link alloc}
+	 */
+	void (*free)(void *user, void *ptr, size_t size);
+
+	void *user; /**< User-defined private data. */
+} zimg_allocator;
+
+/**
+ * Set the allocator used by the library.
+ *
+ * The allocator is used for filter graphs built without an allocator in
+ * {@link zimg_graph_builder_params}: the graph, its filters and their
+ * coefficients, lookup tables and other buffers, its streams, trace buffer
+ * and asynchronous I/O state. It is also used for the scratch buffers drawn
+ * by {@link zimg_filter_graph_process}. Internal containers and the thread
+ * state of worker and I/O threads are still allocated by the C++ runtime.
+ *
+ * Memory allocated before the call is freed by the previous allocator. The
+ * allocator may be changed concurrently with other library calls, which use
+ * either the previous or the new allocator.
+ *
+ * Since API 2.4.
+ *
+ * @param allocator allocation functions, or NULL to restore the system allocator
+ * @return error code
+ */
+ZIMG_VISIBILITY
+zimg_error_code_e zimg_set_allocator(const zimg_allocator *allocator);
+
 
 /**
  * CPU feature set constants.
@@ -320,7 +373,9 @@ typedef enum zimg_dither_type_e {
 	ZIMG_DITHER_NONE            = 0, /**< Round to nearest. */
 	ZIMG_DITHER_ORDERED         = 1, /**< Bayer patterned dither. */
 	ZIMG_DITHER_RANDOM          = 2, /**< Pseudo-random noise of magnitude 0.5. */
-	ZIMG_DITHER_ERROR_DIFFUSION = 3  /**< Floyd-Steinberg error diffusion. */
+	ZIMG_DITHER_ERROR_DIFFUSION = 3, /**< Floyd-Steinberg error diffusion. */
+	ZIMG_DITHER_SIERRA_LITE     = 4, /**< Sierra Lite error diffusion. Faster, lower quality. Since API 2.4. */
+	ZIMG_DITHER_BLUE_NOISE      = 5  /**< Blue noise patterned dither. Since API 2.4. */
 } zimg_dither_type_e;
 
 /**
@@ -448,7 +503,9 @@ void zimg_filter_graph_free(zimg_filter_graph *ptr);
  *
  * The filter graph does not allocate memory during processing and generally
  * will not fail unless a user-provided callback fails. To facilitate this,
- * memory allocation is delegated to the caller.
+ * memory allocation is delegated to the caller. Alternatively, the buffer may
+ * be drawn from the scratch pool of the library, as described in
+ * {@link zimg_filter_graph_process}.
  *
  * @pre out != 0
  * @param ptr graph handle
@@ -488,10 +545,19 @@ zimg_error_code_e zimg_filter_graph_get_output_buffering(const zimg_filter_graph
 /**
  * Process an image with the filter graph.
  *
+ * Since API 2.4, the temporary buffer may be NULL. The buffer is then taken
+ * from a pool owned by the calling thread and returned to it afterwards, so
+ * that memory is reused by subsequent calls on the same thread, including
+ * calls with other graphs. Buffers are grouped into power-of-two size
+ * classes, so a buffer may be reused by any graph of a similar size. The
+ * pool is freed when the thread exits or by {@link zimg_scratch_pool_trim}.
+ * Processing then fails with {@link ZIMG_ERROR_OUT_OF_MEMORY} if a new
+ * buffer can not be allocated.
+ *
  * @param ptr graph handle
  * @param[in] src input image buffer
  * @param[out] dst output image buffer
- * @param tmp temporary buffer
+ * @param tmp temporary buffer, may be NULL
  * @param unpack_cb user-defined input callback, may be NULL
  * @param unpack_user private data for callback
  * @param pack_cb user-defined output callback, may be NULL
@@ -503,6 +569,425 @@ zimg_error_code_e zimg_filter_graph_process(const zimg_filter_graph *ptr, const
                                             zimg_filter_graph_callback unpack_cb, void *unpack_user,
                                             zimg_filter_graph_callback pack_cb, void *pack_user);
 
+/**
+ * Process an image with the filter graph, using a caller-provided seed.
+ *
+ * The seed selects the noise pattern of {@link ZIMG_DITHER_RANDOM}. The noise
+ * is a function of the seed and pixel position only, so the same seed always
+ * reproduces the same output. Passing a different seed for each frame, such
+ * as the frame number, prevents the pattern from remaining static in video.
+ * {@link zimg_filter_graph_process} is equivalent to a seed of zero.
+ *
+ * Since API 2.4.
+ *
+ * @param seed per-frame seed
+ * @see zimg_filter_graph_process
+ */
+ZIMG_VISIBILITY
+zimg_error_code_e zimg_filter_graph_process_seed(const zimg_filter_graph *ptr, const zimg_image_buffer_const *src, const zimg_image_buffer *dst, void *tmp,
+                                                 zimg_filter_graph_callback unpack_cb, void *unpack_user,
+                                                 zimg_filter_graph_callback pack_cb, void *pack_user, unsigned seed);
+
+/**
+ * User callback for custom input/output of multiple rows.
+ *
+ * Equivalent to {@link zimg_filter_graph_callback}, but invoked on
+ * {@p count} consecutive lines at once. The number of lines is a multiple
+ * of the chroma subsampling and is limited by
+ * {@link zimg_filter_graph_set_callback_batch}.
+ *
+ * Since API 2.4.
+ *
+ * @param user user-defined private data
+ * @param i index of first line to read/write
+ * @param count number of lines to read/write
+ * @param left index of left column in line
+ * @param right index of right column in line plus one
+ * @return zero on success or non-zero on failure
+ */
+typedef int (*zimg_filter_graph_batch_callback)(void *user, unsigned i, unsigned count, unsigned left, unsigned right);
+
+/**
+ * Process an image with the filter graph, using multi-row callbacks.
+ *
+ * Grouping rows amortizes the cost of invoking the callbacks and allows them
+ * to operate on larger blocks. Otherwise equivalent to
+ * {@link zimg_filter_graph_process_seed}.
+ *
+ * Since API 2.4.
+ *
+ * @see zimg_filter_graph_process_seed
+ */
+ZIMG_VISIBILITY
+zimg_error_code_e zimg_filter_graph_process_batch(const zimg_filter_graph *ptr, const zimg_image_buffer_const *src, const zimg_image_buffer *dst, void *tmp,
+                                                  zimg_filter_graph_batch_callback unpack_cb, void *unpack_user,
+                                                  zimg_filter_graph_batch_callback pack_cb, void *pack_user, unsigned seed);
+
+/**
+ * Free the unused buffers in the scratch pool of the calling thread.
+ *
+ * Buffers currently in use by other calls are not affected.
+ *
+ * Since API 2.4.
+ *
+ * @return error code
+ * @see zimg_filter_graph_process
+ */
+ZIMG_VISIBILITY
+zimg_error_code_e zimg_scratch_pool_trim(void);
+
+/**
+ * Query the memory held by the scratch pools of all threads.
+ *
+ * Since API 2.4.
+ *
+ * @param[out] allocated set to the size of all buffers currently allocated,
+ *                       including buffers in use, may be NULL
+ * @param[out] high_water set to the largest allocated size since the program
+ *                        started or the last reset, may be NULL
+ * @param reset if non-zero, reset the high-water mark to the current size
+ *              after reading it
+ * @return error code
+ */
+ZIMG_VISIBILITY
+zimg_error_code_e zimg_scratch_pool_get_usage(size_t *allocated, size_t *high_water, int reset);
+
+/**
+ * Execution statistics of a filter graph node.
+ *
+ * Since API 2.4.
+ */
+typedef struct zimg_filter_graph_node_stats {
+	/**
+	 * Name of the filter implementation, e.g. "ResizeImplH_U16_AVX2".
+	 *
+	 * The string is owned by the graph and is valid until the graph is freed.
+	 */
+	const char *name;
+
+	unsigned long long calls;         /**< Number of filter invocations. */
+	unsigned long long pixels;        /**< Pixels produced, counted once per plane. */
+	unsigned long long nanoseconds;   /**< Wall time spent in the filter. */
+	unsigned long long bytes_read;    /**< Size of the input region required by the filter. */
+	unsigned long long bytes_written; /**< Size of the output region produced by the filter. */
+} zimg_filter_graph_node_stats;
+
+/**
+ * Enable or disable collection of execution statistics.
+ *
+ * Statistics are disabled by default. When enabled, every filter invocation
+ * is timed, which adds a small overhead to {@link zimg_filter_graph_process}.
+ * The graph may still be processed by multiple threads simultaneously, in
+ * which case the statistics of all threads are accumulated.
+ *
+ * This function must not be called while the graph is being processed.
+ *
+ * Since API 2.4.
+ *
+ * @param ptr graph handle
+ * @param enabled non-zero to collect statistics
+ * @return error code
+ */
+ZIMG_VISIBILITY
+zimg_error_code_e zimg_filter_graph_set_stats_enabled(zimg_filter_graph *ptr, int enabled);
+
+/**
+ * Query the execution statistics accumulated since the graph was created or
+ * the statistics were last reset.
+ *
+ * One entry is produced for each filter in the graph, in order of execution.
+ * If {@p stats} is NULL, only the number of entries is returned. Otherwise,
+ * up to {@p *num_nodes} entries are written.
+ *
+ * Since API 2.4.
+ *
+ * @pre num_nodes != 0
+ * @param ptr graph handle
+ * @param[out] stats array of statistics, may be NULL
+ * @param[in,out] num_nodes capacity of {@p stats} on input, set to the number
+ *                of filters in the graph on output
+ * @param[out] cpu_type set to the instruction set selected for the graph after
+ *             autodetection, may be NULL
+ * @return error code
+ */
+ZIMG_VISIBILITY
+zimg_error_code_e zimg_filter_graph_get_stats(const zimg_filter_graph *ptr, zimg_filter_graph_node_stats *stats, unsigned *num_nodes, zimg_cpu_type_e *cpu_type);
+
+/**
+ * Reset the execution statistics of the graph.
+ *
+ * Since API 2.4.
+ *
+ * @param ptr graph handle
+ * @return error code
+ */
+ZIMG_VISIBILITY
+zimg_error_code_e zimg_filter_graph_reset_stats(const zimg_filter_graph *ptr);
+
+/**
+ * Output format of {@link zimg_filter_graph_dump_plan}.
+ *
+ * Since API 2.4.
+ */
+typedef enum zimg_graph_plan_format_e {
+	ZIMG_GRAPH_PLAN_JSON = 0, /**< JSON document */
+	ZIMG_GRAPH_PLAN_DOT  = 1  /**< Graphviz DOT */
+} zimg_graph_plan_format_e;
+
+/**
+ * Describe the execution plan of the graph.
+ *
+ * The plan lists the filters in the graph with their flags, cache assignment
+ * and buffered line counts, as well as the tile width, buffering and
+ * temporary buffer size of each execution strategy. The layout of the
+ * document is intended for diagnostics and may change between versions.
+ *
+ * If {@p buf} is not NULL, up to {@p *size} bytes of the plan are written,
+ * including a terminating null character.
+ *
+ * Since API 2.4.
+ *
+ * @pre size != 0
+ * @param ptr graph handle
+ * @param format output format
+ * @param[out] buf output buffer, may be NULL
+ * @param[in,out] size capacity of {@p buf} in bytes on input, set to the
+ *                size of the complete plan, including the terminating null
+ *                character, on output
+ * @return error code
+ */
+ZIMG_VISIBILITY
+zimg_error_code_e zimg_filter_graph_dump_plan(const zimg_filter_graph *ptr, zimg_graph_plan_format_e format, char *buf, size_t *size);
+
+/**
+ * Enable or disable tracing of graph execution.
+ *
+ * When enabled, the start time and duration of each tile, filter invocation
+ * and I/O callback are recorded, together with the calling thread. Events are
+ * kept in a ring buffer holding the most recent {@p capacity} events, so that
+ * tracing may be left enabled indefinitely. Any previous trace is discarded.
+ *
+ * This function must not be called while the graph is being processed.
+ *
+ * Since API 2.4.
+ *
+ * @param ptr graph handle
+ * @param capacity maximum number of events retained, or zero to disable
+ * @return error code
+ */
+ZIMG_VISIBILITY
+zimg_error_code_e zimg_filter_graph_set_trace_capacity(zimg_filter_graph *ptr, size_t capacity);
+
+/**
+ * Retrieve the recorded trace in the Chrome trace-event JSON format.
+ *
+ * The trace can be viewed in chrome://tracing or Perfetto. The buffer is
+ * filled as in {@link zimg_filter_graph_dump_plan}. This function must not be
+ * called while the graph is being processed.
+ *
+ * Since API 2.4.
+ *
+ * @pre size != 0
+ * @param ptr graph handle
+ * @param[out] buf output buffer, may be NULL
+ * @param[in,out] size capacity of {@p buf} in bytes on input, set to the
+ *                size of the complete trace, including the terminating null
+ *                character, on output
+ * @return error code
+ */
+ZIMG_VISIBILITY
+zimg_error_code_e zimg_filter_graph_dump_trace(const zimg_filter_graph *ptr, char *buf, size_t *size);
+
+/**
+ * Discard the recorded trace.
+ *
+ * Since API 2.4.
+ *
+ * @param ptr graph handle
+ * @return error code
+ */
+ZIMG_VISIBILITY
+zimg_error_code_e zimg_filter_graph_clear_trace(const zimg_filter_graph *ptr);
+
+/**
+ * Configure asynchronous execution of the user callbacks.
+ *
+ * By default, {@link zimg_filter_graph_process} invokes the unpack and pack
+ * callbacks on the calling thread, which waits for them to complete. When
+ * enabled, the callbacks are invoked on an I/O thread owned by the graph, so
+ * that I/O overlaps with computation. Each call to
+ * {@link zimg_filter_graph_process} with a callback takes an idle I/O thread
+ * of the graph, or starts a new one if none is idle, and returns it to the
+ * graph when the call completes. Concurrent calls therefore use distinct
+ * threads, and a thread may invoke the callbacks of many successive calls.
+ * A thread whose callback failed is not reused. The idle threads are
+ * destroyed with the graph. Input rows are unpacked up to {@p unpack_ahead}
+ * rows ahead of the rows being read by the graph, and output rows are packed
+ * up to {@p pack_behind} rows behind the rows being written. The callbacks
+ * are still invoked sequentially and in the same order relative to each
+ * other, but must not rely on the thread they are called from, or on
+ * thread-local state persisting between calls.
+ *
+ * The rows in flight are held in the existing input and output buffers.
+ * {@link zimg_filter_graph_get_input_buffering} and
+ * {@link zimg_filter_graph_get_output_buffering} account for the additional
+ * rows. If a smaller buffer is passed, the distance is reduced to fit.
+ * Setting both distances to zero disables asynchronous execution.
+ *
+ * This function must not be called while the graph is being processed.
+ *
+ * Since API 2.4.
+ *
+ * @param ptr graph handle
+ * @param unpack_ahead maximum number of input rows read ahead
+ * @param pack_behind maximum number of output rows written behind
+ * @return error code
+ */
+ZIMG_VISIBILITY
+zimg_error_code_e zimg_filter_graph_set_async_io(zimg_filter_graph *ptr, unsigned unpack_ahead, unsigned pack_behind);
+
+/**
+ * Configure grouping of rows in the user callbacks.
+ *
+ * The callbacks passed to {@link zimg_filter_graph_process_batch} are
+ * invoked on up to {@p rows} consecutive lines at once, rounded down to the
+ * chroma subsampling. Callbacks passed to {@link zimg_filter_graph_process}
+ * are still invoked once per line, but in the same grouped order.
+ *
+ * {@link zimg_filter_graph_get_input_buffering} and
+ * {@link zimg_filter_graph_get_output_buffering} account for the additional
+ * rows. If a smaller buffer is passed, the batches are reduced to fit.
+ *
+ * If {@p full_width} is non-zero and a buffer holds the entire image, such
+ * as a buffer with a mask of {@link ZIMG_BUFFER_MAX}, each line of that
+ * buffer is passed to the callback only once and across the full width of
+ * the image, instead of once per tile. Input lines are unpacked while
+ * processing the first tile and output lines are packed while processing the
+ * last tile.
+ *
+ * This function must not be called while the graph is being processed.
+ *
+ * Since API 2.4.
+ *
+ * @param ptr graph handle
+ * @param rows maximum number of lines per invocation, or zero for one line
+ * @param full_width whether to invoke the callbacks on entire lines
+ * @return error code
+ */
+ZIMG_VISIBILITY
+zimg_error_code_e zimg_filter_graph_set_callback_batch(zimg_filter_graph *ptr, unsigned rows, int full_width);
+
+/**
+ * Handle to an incremental execution of a filter graph.
+ *
+ * A stream processes an image whose rows are produced by the caller on its
+ * own schedule, such as a row-at-a-time decoder, without buffering the whole
+ * image. The caller writes input rows to the source buffer and announces them
+ * with {@link zimg_filter_graph_stream_push_rows}. Output rows are produced
+ * by {@link zimg_filter_graph_stream_pull_rows} as soon as all of the input
+ * they depend on has been announced.
+ *
+ * Since API 2.4.
+ */
+typedef struct zimg_filter_graph_stream zimg_filter_graph_stream;
+
+/**
+ * Query the minimum number of lines required in the input buffer of a stream.
+ *
+ * This may exceed {@link zimg_filter_graph_get_input_buffering}, as a stream
+ * requires all of the input rows of an output row group to be present before
+ * it is processed.
+ *
+ * Since API 2.4.
+ *
+ * @pre out != 0
+ * @param ptr graph handle
+ * @param[out] out set to the number of scanlines
+ * @return error code
+ */
+ZIMG_VISIBILITY
+zimg_error_code_e zimg_filter_graph_get_stream_input_buffering(const zimg_filter_graph *ptr, unsigned *out);
+
+/**
+ * Begin streaming an image through the filter graph.
+ *
+ * The source buffer must hold at least the number of lines returned by
+ * {@link zimg_filter_graph_get_stream_input_buffering}, and the destination
+ * buffer at least the number of lines returned by
+ * {@link zimg_filter_graph_get_output_buffering}. Both buffers must remain
+ * valid until the stream is ended. The graph must not be freed before the
+ * stream. Unlike {@link zimg_filter_graph_process}, the stream allocates its
+ * own temporary buffer.
+ *
+ * A stream must not be used by multiple threads simultaneously, but multiple
+ * streams may be created from the same graph.
+ *
+ * Since API 2.4.
+ *
+ * @param ptr graph handle
+ * @param[in] src input image buffer
+ * @param[out] dst output image buffer
+ * @param seed per-frame seed, see {@link zimg_filter_graph_process_seed}
+ * @return stream handle, or NULL on error
+ */
+ZIMG_VISIBILITY
+zimg_filter_graph_stream *zimg_filter_graph_stream_begin(const zimg_filter_graph *ptr, const zimg_image_buffer_const *src, const zimg_image_buffer *dst, unsigned seed);
+
+/**
+ * Announce input rows to a stream.
+ *
+ * The {@p count} rows following those previously announced must have been
+ * written to the source buffer. Rows are counted in units of luma rows. For
+ * vertically subsampled images, each chroma row must be written no later than
+ * the last luma row associated with it.
+ *
+ * Writing a row to the source buffer overwrites the row one buffer length
+ * above it. Announcing at most one row group of the input subsampling at a
+ * time, and pulling all available output rows in between, ensures that no
+ * row is overwritten while it is still required.
+ *
+ * Since API 2.4.
+ *
+ * @param ptr stream handle
+ * @param count number of rows
+ * @return error code, {@link ZIMG_ERROR_ILLEGAL_ARGUMENT} if the rows extend
+ *         past the image or would have overwritten required input
+ */
+ZIMG_VISIBILITY
+zimg_error_code_e zimg_filter_graph_stream_push_rows(zimg_filter_graph_stream *ptr, unsigned count);
+
+/**
+ * Produce output rows from a stream.
+ *
+ * As many output rows as the announced input allows are written to the
+ * destination buffer, in units of the output chroma subsampling and limited
+ * by the size of the buffer. The rows must be read before the next call.
+ * Zero rows are produced if more input is required or the image is complete.
+ *
+ * Since API 2.4.
+ *
+ * @pre first != 0
+ * @pre count != 0
+ * @param ptr stream handle
+ * @param[out] first set to the index of the first row produced
+ * @param[out] count set to the number of rows produced
+ * @return error code
+ */
+ZIMG_VISIBILITY
+zimg_error_code_e zimg_filter_graph_stream_pull_rows(zimg_filter_graph_stream *ptr, unsigned *first, unsigned *count);
+
+/**
+ * End a stream, releasing its resources.
+ *
+ * A stream may be ended before the image is complete.
+ *
+ * Since API 2.4.
+ *
+ * @param ptr stream handle, may be NULL
+ */
+ZIMG_VISIBILITY
+void zimg_filter_graph_stream_end(zimg_filter_graph_stream *ptr);
+
 
 /**
  * Image format descriptor.
@@ -590,6 +1075,37 @@ typedef struct zimg_graph_builder_params {
 
 	/** Allow evaluating transfer functions at reduced precision (default false). */
 	char allow_approximate_gamma;
+
+	/**
+	 * Number of threads used to evaluate {@link ZIMG_DITHER_ERROR_DIFFUSION} and
+	 * {@link ZIMG_DITHER_SIERRA_LITE}.
+	 *
+	 * Error diffusion is inherently sequential and can not be split into tiles.
+	 * If greater than one, consecutive rows are processed concurrently by the
+	 * specified number of threads in a wavefront pattern. The result is
+	 * identical to single-threaded output for the same CPU type. Different
+	 * CPU types may select different kernels and produce different output.
+	 *
+	 * Since API 2.4.
+	 *
+	 * The default value is 1, which disables threading.
+	 */
+	unsigned dither_threads;
+
+	/**
+	 * Allocator for the memory owned by the filter graph, such as the graph
+	 * and filter objects, filter coefficients and lookup tables, and for the
+	 * streams, trace buffer and asynchronous I/O state of the graph.
+	 *
+	 * The structure is copied by {@link zimg_filter_graph_build}, but the
+	 * functions must remain usable until the graph is freed.
+	 *
+	 * Since API 2.4.
+	 *
+	 * The default value is NULL, which selects the global allocator.
+	 * @see zimg_set_allocator
+	 */
+	const struct zimg_allocator *allocator;
 } zimg_graph_builder_params;
 
 /**
@@ -2,9 +2,9 @@
 
 #include <algorithm>
 #include <cstdint>
-#include <vector>
 #include <immintrin.h>
 #include "common/align.h"
+#include "common/alloc.h"
 #include "common/ccdep.h"
 #include "common/make_unique.h"
 #include "colorspace/gamma.h"
@@ -81,7 +81,7 @@ void to_gamma_lut_filter_line(const float *RESTRICT lut, const float *src, float
 
 
 class ToLinearLutOperationAVX2 final : public Operation {
-	std::vector<float> m_lut;
+	AlignedVector<float> m_lut;
 	unsigned m_lut_depth;
 public:
 	ToLinearLutOperationAVX2(gamma_func func, unsigned lut_depth, float postscale) :
@@ -106,7 +106,7 @@ public:
 };
 
 class ToGammaLutOperationAVX2 final : public Operation {
-	std::vector<float> m_lut;
+	AlignedVector<float> m_lut;
 public:
 	ToGammaLutOperationAVX2(gamma_func func, float prescale) :
 		m_lut(static_cast<uint32_t>(UINT16_MAX) + 1)
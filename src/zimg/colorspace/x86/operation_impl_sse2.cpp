@@ -3,9 +3,9 @@
 #include <algorithm>
 #include <cstddef>
 #include <cstdint>
-#include <vector>
 #include <emmintrin.h>
 #include "common/align.h"
+#include "common/alloc.h"
 #include "common/ccdep.h"
 #include "common/make_unique.h"
 #include "colorspace/gamma.h"
@@ -63,7 +63,7 @@ void lut_filter_line(const float *RESTRICT lut, unsigned lut_depth, float presca
 
 
 class LutOperationSSE2 final : public Operation {
-	std::vector<float> m_lut;
+	AlignedVector<float> m_lut;
 	unsigned m_lut_depth;
 	float m_prescale;
 public:
@@ -0,0 +1,113 @@
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <forward_list>
+#include <mutex>
+#include <new>
+#include "alloc.h"
+
+namespace zimg {
+
+namespace {
+
+struct hooked_header {
+	allocator_hooks hooks;
+	size_t size;
+};
+
+constexpr size_t HOOKED_ALIGNMENT = alignof(std::max_align_t);
+constexpr size_t HOOKED_HEADER_SIZE = (sizeof(hooked_header) + HOOKED_ALIGNMENT - 1) / HOOKED_ALIGNMENT * HOOKED_ALIGNMENT;
+
+const allocator_hooks g_system_allocator{};
+
+// Installed allocators are kept until exit, so that a reader never observes a
+// freed or partially written allocator.
+std::mutex g_global_mutex;
+std::forward_list<allocator_hooks> g_global_history;
+std::atomic<const allocator_hooks *> g_global_allocator{ &g_system_allocator };
+
+thread_local const allocator_hooks *g_scope_allocator = nullptr;
+
+} // namespace
+
+
+void *allocator_hooks::allocate(size_t size, size_t alignment) const noexcept
+{
+	return alloc ? alloc(user, size, alignment) : zimg_x_aligned_malloc(size, alignment);
+}
+
+void allocator_hooks::deallocate(void *ptr, size_t size) const noexcept
+{
+	if (alloc)
+		free(user, ptr, size);
+	else
+		zimg_x_aligned_free(ptr);
+}
+
+void set_global_allocator(const allocator_hooks &hooks)
+{
+	if (!hooks.alloc) {
+		g_global_allocator.store(&g_system_allocator, std::memory_order_release);
+		return;
+	}
+
+	std::lock_guard<std::mutex> lock{ g_global_mutex };
+
+	// Reuse a previous record, so that switching between allocators does not grow the history.
+	auto it = std::find(g_global_history.begin(), g_global_history.end(), hooks);
+	if (it == g_global_history.end()) {
+		try {
+			g_global_history.push_front(hooks);
+		} catch (const std::bad_alloc &) {
+			error::throw_<error::OutOfMemory>();
+		}
+		it = g_global_history.begin();
+	}
+	g_global_allocator.store(&*it, std::memory_order_release);
+}
+
+allocator_hooks current_allocator() noexcept
+{
+	return g_scope_allocator ? *g_scope_allocator : *g_global_allocator.load(std::memory_order_acquire);
+}
+
+
+AllocatorScope::AllocatorScope(const allocator_hooks &hooks) noexcept :
+	m_hooks(hooks),
+	m_prev{ g_scope_allocator }
+{
+	g_scope_allocator = &m_hooks;
+}
+
+AllocatorScope::~AllocatorScope()
+{
+	g_scope_allocator = m_prev;
+}
+
+
+void *HookAllocated::operator new(size_t size)
+{
+	if (size > SIZE_MAX - HOOKED_HEADER_SIZE)
+		throw std::bad_alloc{};
+
+	allocator_hooks hooks = current_allocator();
+	void *ptr = hooks.allocate(size + HOOKED_HEADER_SIZE, HOOKED_ALIGNMENT);
+	if (!ptr)
+		throw std::bad_alloc{};
+
+	new (ptr) hooked_header{ hooks, size + HOOKED_HEADER_SIZE };
+	return static_cast<char *>(ptr) + HOOKED_HEADER_SIZE;
+}
+
+void HookAllocated::operator delete(void *ptr) noexcept
+{
+	if (!ptr)
+		return;
+
+	void *base = static_cast<char *>(ptr) - HOOKED_HEADER_SIZE;
+	hooked_header header = *static_cast<hooked_header *>(base);
+	header.hooks.deallocate(base, header.size);
+}
+
+} // namespace zimg
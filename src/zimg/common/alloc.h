@@ -5,6 +5,7 @@
 
 #include <cstddef>
 #include <stdexcept>
+#include <type_traits>
 #include <vector>
 #include "align.h"
 #include "checked_int.h"
@@ -22,6 +23,114 @@
 
 namespace zimg {
 
+/**
+ * User-defined memory allocation functions.
+ *
+ * A null {@p alloc} function selects the system allocator.
+ */
+struct allocator_hooks {
+	void *(*alloc)(void *user, size_t size, size_t alignment);
+	void (*free)(void *user, void *ptr, size_t size);
+	void *user;
+
+	/**
+	 * Allocate a buffer.
+	 *
+	 * @param size size in bytes
+	 * @param alignment alignment in bytes, a power of two
+	 * @return pointer to buffer, or nullptr on failure
+	 */
+	void *allocate(size_t size, size_t alignment) const noexcept;
+
+	/**
+	 * Free a buffer returned by {@link allocate}.
+	 *
+	 * @param ptr pointer to buffer
+	 * @param size size passed to {@link allocate}
+	 */
+	void deallocate(void *ptr, size_t size) const noexcept;
+
+	bool operator==(const allocator_hooks &other) const noexcept
+	{
+		return alloc == other.alloc && free == other.free && user == other.user;
+	}
+
+	bool operator!=(const allocator_hooks &other) const noexcept { return !(*this == other); }
+};
+
+/**
+ * Set the allocator used when no {@link AllocatorScope} is active.
+ *
+ * Memory is always freed by the allocator that allocated it, so the global
+ * allocator may be changed while objects allocated by the previous allocator
+ * exist. The change is atomic: a concurrent allocation uses either the
+ * previous or the new allocator.
+ *
+ * @param hooks allocation functions
+ * @throw error::OutOfMemory if the allocator could not be recorded
+ */
+void set_global_allocator(const allocator_hooks &hooks);
+
+/**
+ * Get the allocator selected on the calling thread.
+ *
+ * @return innermost {@link AllocatorScope}, or the global allocator
+ */
+allocator_hooks current_allocator() noexcept;
+
+/**
+ * Selects the allocator of the calling thread during the lifetime of the object.
+ */
+class AllocatorScope {
+	allocator_hooks m_hooks;
+	const allocator_hooks *m_prev;
+public:
+	/**
+	 * Select an allocator.
+	 *
+	 * @param hooks allocation functions
+	 */
+	explicit AllocatorScope(const allocator_hooks &hooks) noexcept;
+
+	AllocatorScope(const AllocatorScope &) = delete;
+
+	/**
+	 * Restore the previous allocator.
+	 */
+	~AllocatorScope();
+
+	AllocatorScope &operator=(const AllocatorScope &) = delete;
+};
+
+/**
+ * Base class for objects allocated by the allocator selected on the calling
+ * thread.
+ *
+ * The allocator is recorded with each object, so that it is freed by the same
+ * allocator regardless of the allocator selected when it is deleted.
+ */
+class HookAllocated {
+protected:
+	HookAllocated() = default;
+	~HookAllocated() = default;
+public:
+	/**
+	 * Allocate an object from {@link current_allocator}.
+	 *
+	 * @param size object size
+	 * @return pointer to storage
+	 * @throw std::bad_alloc on allocation failure
+	 */
+	static void *operator new(size_t size);
+
+	/**
+	 * Free an object allocated by {@link operator new}.
+	 *
+	 * @param ptr pointer to storage
+	 */
+	static void operator delete(void *ptr) noexcept;
+};
+
 /**
  * Simple allocator that increments a base pointer.
  * This allocator is not STL compliant.
@@ -146,20 +255,31 @@ public:
 /**
  * STL allocator class which returns aligned buffers.
  *
+ * A default constructed allocator uses the allocator selected on the calling
+ * thread at the time of construction. The allocator is propagated with the
+ * container contents, so that memory is returned to its origin.
+ *
  * @tparam T type of object to allocate
  */
 template <class T>
 struct AlignedAllocator {
 	typedef T value_type;
+	typedef std::true_type propagate_on_container_copy_assignment;
+	typedef std::true_type propagate_on_container_move_assignment;
+	typedef std::true_type propagate_on_container_swap;
+
+	allocator_hooks hooks;
+
+	AlignedAllocator() noexcept : hooks(current_allocator()) {}
 
-	AlignedAllocator() = default;
+	explicit AlignedAllocator(const allocator_hooks &hooks) noexcept : hooks(hooks) {}
 
 	template <class U>
-	AlignedAllocator(const AlignedAllocator<U> &) noexcept {}
+	AlignedAllocator(const AlignedAllocator<U> &other) noexcept : hooks(other.hooks) {}
 
 	T *allocate(size_t n) const
 	{
-		T *ptr = static_cast<T *>(zimg_x_aligned_malloc(n * sizeof(T), ALIGNMENT));
+		T *ptr = static_cast<T *>(hooks.allocate(n * sizeof(T), ALIGNMENT));
 
 		if (!ptr)
 			throw std::bad_alloc{};
@@ -167,13 +287,16 @@ struct AlignedAllocator {
 		return ptr;
 	}
 
-	void deallocate(void *ptr, size_t) const noexcept
+	void deallocate(T *ptr, size_t n) const noexcept
 	{
-		zimg_x_aligned_free(ptr);
+		hooks.deallocate(ptr, n * sizeof(T));
 	}
 
-	bool operator==(const AlignedAllocator &) const noexcept { return true; }
-	bool operator!=(const AlignedAllocator &) const noexcept { return false; }
+	template <class U>
+	bool operator==(const AlignedAllocator<U> &other) const noexcept { return hooks == other.hooks; }
+
+	template <class U>
+	bool operator!=(const AlignedAllocator<U> &other) const noexcept { return hooks != other.hooks; }
 };
 
 /**
@@ -33,4 +33,13 @@ bool cpu_requires_64b_alignment(CPUClass cpu) noexcept
 	return ret;
 }
 
+CPUClass cpu_dispatch_class(CPUClass cpu) noexcept
+{
+#ifdef ZIMG_X86
+	return cpu_dispatch_class_x86(cpu);
+#else
+	return cpu_is_autodetect(cpu) ? CPUClass::NONE : cpu;
+#endif
+}
+
 } // namespace zimg
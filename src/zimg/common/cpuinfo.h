@@ -32,6 +32,15 @@ unsigned long cpu_cache_size() noexcept;
 bool cpu_has_fast_f16(CPUClass cpu) noexcept;
 bool cpu_requires_64b_alignment(CPUClass cpu) noexcept;
 
+/**
+ * Resolve autodetection to the most capable instruction set that filters may
+ * select on the current CPU.
+ *
+ * @param cpu CPU type
+ * @return CPU type, never autodetect
+ */
+CPUClass cpu_dispatch_class(CPUClass cpu) noexcept;
+
 } // namespace zimg
 
 #endif // ZIMG_CPUINFO_H_
@@ -0,0 +1,110 @@
+#include <algorithm>
+#include <new>
+#include <system_error>
+#include "thread_pool.h"
+
+namespace zimg {
+
+struct ThreadPool::job {
+	const std::function<void(unsigned)> *func;
+	unsigned next;
+	unsigned count;
+	unsigned active;
+};
+
+
+ThreadPool::ThreadPool(unsigned max_threads) :
+	m_max_threads{ max_threads },
+	m_stop{}
+{}
+
+ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> lock{ m_mutex };
+		m_stop = true;
+	}
+	m_work_cond.notify_all();
+
+	for (std::thread &th : m_threads) {
+		th.join();
+	}
+}
+
+void ThreadPool::start_threads(unsigned count)
+{
+	count = std::min(count, m_max_threads);
+
+	// A failure to create a thread only reduces parallelism.
+	try {
+		while (m_threads.size() < count) {
+			m_threads.emplace_back(&ThreadPool::worker_main, this);
+		}
+	} catch (const std::system_error &) {
+		m_max_threads = static_cast<unsigned>(m_threads.size());
+	} catch (const std::bad_alloc &) {
+		m_max_threads = static_cast<unsigned>(m_threads.size());
+	}
+}
+
+void ThreadPool::worker_main()
+{
+	std::unique_lock<std::mutex> lock{ m_mutex };
+
+	while (true) {
+		m_work_cond.wait(lock, [&]() { return m_stop || !m_queue.empty(); });
+		if (m_stop)
+			break;
+
+		job *j = m_queue.front();
+		unsigned n = j->next++;
+
+		if (j->next == j->count)
+			m_queue.erase(m_queue.begin());
+		++j->active;
+
+		lock.unlock();
+		(*j->func)(n);
+		lock.lock();
+
+		if (--j->active == 0)
+			m_done_cond.notify_all();
+	}
+}
+
+void ThreadPool::run(unsigned count, const std::function<void(unsigned)> &func)
+{
+	job j{ &func, 1, count, 0 };
+	bool queued = false;
+
+	if (count > 1) {
+		std::lock_guard<std::mutex> lock{ m_mutex };
+		start_threads(count - 1);
+
+		try {
+			if (!m_threads.empty()) {
+				m_queue.push_back(&j);
+				queued = true;
+			}
+		} catch (const std::bad_alloc &) {
+			// Run on the calling thread only.
+		}
+	}
+	if (queued)
+		m_work_cond.notify_all();
+
+	func(0);
+
+	if (queued) {
+		std::unique_lock<std::mutex> lock{ m_mutex };
+
+		// Participants that have not started are no longer needed.
+		auto it = std::find(m_queue.begin(), m_queue.end(), &j);
+		if (it != m_queue.end())
+			m_queue.erase(it);
+
+		m_done_cond.wait(lock, [&]() { return j.active == 0; });
+	}
+}
+
+} // namespace zimg
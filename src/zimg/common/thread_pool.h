@@ -0,0 +1,68 @@
+#pragma once
+
+#ifndef ZIMG_THREAD_POOL_H_
+#define ZIMG_THREAD_POOL_H_
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace zimg {
+
+/**
+ * Worker threads shared by successive parallel operations.
+ *
+ * Workers are started on first use and kept until the pool is destroyed, so
+ * that a filter invoked many times per frame does not create threads on each
+ * call. Operations may be submitted concurrently from multiple threads.
+ */
+class ThreadPool {
+	struct job;
+
+	std::vector<std::thread> m_threads;
+	std::vector<job *> m_queue;
+	std::mutex m_mutex;
+	std::condition_variable m_work_cond;
+	std::condition_variable m_done_cond;
+	unsigned m_max_threads;
+	bool m_stop;
+
+	void start_threads(unsigned count);
+
+	void worker_main();
+public:
+	/**
+	 * Initialize a pool.
+	 *
+	 * @param max_threads maximum number of worker threads
+	 */
+	explicit ThreadPool(unsigned max_threads);
+
+	ThreadPool(const ThreadPool &) = delete;
+
+	/**
+	 * Stop and join the worker threads.
+	 */
+	~ThreadPool();
+
+	ThreadPool &operator=(const ThreadPool &) = delete;
+
+	/**
+	 * Invoke a function on the calling thread and up to (count - 1) workers.
+	 *
+	 * Each invocation receives a distinct participant index in [0, count).
+	 * Fewer than count participants may run if workers could not be created
+	 * or are busy, so work must be claimed dynamically by the participants.
+	 * Index 0 always runs on the calling thread.
+	 *
+	 * @param count maximum number of participants, at least one
+	 * @param func function to invoke, must not throw
+	 */
+	void run(unsigned count, const std::function<void(unsigned)> &func);
+};
+
+} // namespace zimg
+
+#endif // ZIMG_THREAD_POOL_H_
@@ -279,6 +279,31 @@ bool cpu_requires_64b_alignment_x86(CPUClass cpu) noexcept
 	}
 }
 
+CPUClass cpu_dispatch_class_x86(CPUClass cpu) noexcept
+{
+	if (!cpu_is_autodetect(cpu))
+		return cpu;
+
+	X86Capabilities caps = query_x86_capabilities();
+
+#ifdef ZIMG_X86_AVX512
+	if (cpu == CPUClass::AUTO_64B && caps.avx512f && caps.avx512dq && caps.avx512bw && caps.avx512vl)
+		return CPUClass::X86_AVX512;
+#endif
+	if (caps.avx2)
+		return CPUClass::X86_AVX2;
+	if (caps.avx && caps.f16c)
+		return CPUClass::X86_F16C;
+	if (caps.avx)
+		return CPUClass::X86_AVX;
+	if (caps.sse2)
+		return CPUClass::X86_SSE2;
+	if (caps.sse)
+		return CPUClass::X86_SSE;
+
+	return CPUClass::NONE;
+}
+
 } // namespace zimg
 
 #endif // ZIMG_X86
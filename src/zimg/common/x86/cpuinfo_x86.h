@@ -41,6 +41,7 @@ unsigned long cpu_cache_size_x86() noexcept;
 
 bool cpu_has_fast_f16_x86(CPUClass cpu) noexcept;
 bool cpu_requires_64b_alignment_x86(CPUClass cpu) noexcept;
+CPUClass cpu_dispatch_class_x86(CPUClass cpu) noexcept;
 
 } // namespace zimg
 
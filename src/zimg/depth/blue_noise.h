@@ -0,0 +1,25 @@
+#pragma once
+
+#ifndef ZIMG_DEPTH_BLUE_NOISE_H_
+#define ZIMG_DEPTH_BLUE_NOISE_H_
+
+#include <cstdint>
+
+namespace zimg {
+namespace depth {
+
+constexpr unsigned BLUE_NOISE_LEN = 64;
+
+/**
+ * Blue noise threshold matrix, tiled over the image.
+ *
+ * Each element is the rank of the pixel, from 0 to {@p BLUE_NOISE_LEN}^2 - 1.
+ * The matrix was generated by the void-and-cluster method with a toroidal
+ * Gaussian filter (sigma 1.5), so that it tiles without seams.
+ */
+extern const uint16_t BLUE_NOISE_TABLE[BLUE_NOISE_LEN * BLUE_NOISE_LEN];
+
+} // namespace depth
+} // namespace zimg
+
+#endif // ZIMG_DEPTH_BLUE_NOISE_H_
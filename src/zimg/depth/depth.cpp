@@ -32,7 +32,8 @@ DepthConversion::DepthConversion(unsigned width, unsigned height) :
 	pixel_in{},
 	pixel_out{},
 	dither_type{ DitherType::NONE },
-	cpu{ CPUClass::NONE }
+	cpu{ CPUClass::NONE },
+	threads{ 1 }
 {}
 
 std::unique_ptr<graph::ImageFilter> DepthConversion::create() const try
@@ -44,10 +45,12 @@ std::unique_ptr<graph::ImageFilter> DepthConversion::create() const try
 		return ztd::make_unique<graph::CopyFilter>(width, height, pixel_in.type);
 	else if (is_lossless_conversion(pixel_in, pixel_out))
 		return create_left_shift(width, height, pixel_in, pixel_out, cpu);
+	else if (dither_type == DitherType::NONE && pixel_is_integer(pixel_in.type) && pixel_is_integer(pixel_out.type))
+		return create_integer_convert(width, height, pixel_in, pixel_out, cpu);
 	else if (pixel_is_float(pixel_out.type))
 		return create_convert_to_float(width, height, pixel_in, pixel_out, cpu);
 	else
-		return create_dither(dither_type, width, height, pixel_in, pixel_out, cpu);
+		return create_dither(dither_type, width, height, pixel_in, pixel_out, cpu, threads);
 } catch (const std::bad_alloc &) {
 	error::throw_<error::OutOfMemory>();
 }
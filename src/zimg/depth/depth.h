@@ -24,6 +24,8 @@ enum class DitherType {
 	ORDERED,
 	RANDOM,
 	ERROR_DIFFUSION,
+	SIERRA_LITE,
+	BLUE_NOISE,
 };
 
 struct DepthConversion {
@@ -35,6 +37,7 @@ struct DepthConversion {
 	BUILDER_MEMBER(PixelFormat, pixel_out)
 	BUILDER_MEMBER(DitherType, dither_type)
 	BUILDER_MEMBER(CPUClass, cpu)
+	BUILDER_MEMBER(unsigned, threads)
 #undef BUILDER_MEMBER
 
 	DepthConversion(unsigned width, unsigned height);
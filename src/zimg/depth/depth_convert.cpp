@@ -28,6 +28,26 @@ void integer_to_integer(const void *src, void *dst, unsigned shift, unsigned lef
 	std::transform(src_p + left, src_p + right, dst_p + left, [=](T x) { return static_cast<U>(static_cast<unsigned>(x) << shift); });
 }
 
+template <class T, class U>
+void integer_to_integer_scaled(const void *src, void *dst, const IntegerConvertParams &params, unsigned left, unsigned right)
+{
+	const T *src_p = static_cast<const T *>(src);
+	U *dst_p = static_cast<U *>(dst);
+
+	std::transform(src_p + left, src_p + right, dst_p + left, [&](T x)
+	{
+		uint64_t sum = x * params.mul + params.add;
+		uint64_t frac = sum & ((UINT64_C(1) << params.shift) - 1);
+		int32_t y = static_cast<int32_t>(sum >> params.shift) - params.bias;
+
+		// Round ties to even.
+		if (frac < params.tie)
+			y -= y & 1;
+
+		return static_cast<U>(std::min(std::max(y, static_cast<int32_t>(0)), params.max));
+	});
+}
+
 template <class T>
 void integer_to_float(const void *src, void *dst, float scale, float offset, unsigned left, unsigned right)
 {
@@ -68,6 +88,20 @@ left_shift_func select_left_shift_func(PixelType pixel_in, PixelType pixel_out)
 		error::throw_<error::InternalError>("no conversion between pixel types");
 }
 
+integer_convert_func select_integer_convert_func(PixelType pixel_in, PixelType pixel_out)
+{
+	if (pixel_in == PixelType::BYTE && pixel_out == PixelType::BYTE)
+		return integer_to_integer_scaled<uint8_t, uint8_t>;
+	else if (pixel_in == PixelType::BYTE && pixel_out == PixelType::WORD)
+		return integer_to_integer_scaled<uint8_t, uint16_t>;
+	else if (pixel_in == PixelType::WORD && pixel_out == PixelType::BYTE)
+		return integer_to_integer_scaled<uint16_t, uint8_t>;
+	else if (pixel_in == PixelType::WORD && pixel_out == PixelType::WORD)
+		return integer_to_integer_scaled<uint16_t, uint16_t>;
+	else
+		error::throw_<error::InternalError>("no conversion between pixel types");
+}
+
 depth_convert_func select_depth_convert_func(PixelType type_in, PixelType type_out)
 {
 	if (type_in == PixelType::HALF)
@@ -155,6 +189,69 @@ public:
 };
 
 
+class IntegerConvert final : public graph::ImageFilterBase {
+	integer_convert_func m_func;
+
+	PixelType m_pixel_in;
+	PixelType m_pixel_out;
+	IntegerConvertParams m_params;
+
+	unsigned m_width;
+	unsigned m_height;
+public:
+	IntegerConvert(integer_convert_func func, unsigned width, unsigned height, const PixelFormat &pixel_in, const PixelFormat &pixel_out) :
+		m_func{ func },
+		m_pixel_in{ pixel_in.type },
+		m_pixel_out{ pixel_out.type },
+		m_params{},
+		m_width{ width },
+		m_height{ height }
+	{
+		zassert_d(width <= pixel_max_width(pixel_in.type), "overflow");
+		zassert_d(width <= pixel_max_width(pixel_out.type), "overflow");
+
+		if (!pixel_is_integer(pixel_in.type) || !pixel_is_integer(pixel_out.type))
+			error::throw_<error::InternalError>("cannot convert floating point types");
+		if (pixel_in.depth > 16 || pixel_out.depth > 16)
+			error::throw_<error::InternalError>("bit depth out of range");
+
+		m_params = get_integer_convert_params(pixel_in, pixel_out);
+	}
+
+	filter_flags get_flags() const override
+	{
+		filter_flags flags{};
+
+		flags.same_row = true;
+		flags.in_place = (pixel_size(m_pixel_in) == pixel_size(m_pixel_out));
+
+		return flags;
+	}
+
+	image_attributes get_image_attributes() const override
+	{
+		return{ m_width, m_height, m_pixel_out };
+	}
+
+	void process(void *, const graph::ImageBuffer<const void> *src, const graph::ImageBuffer<void> *dst, void *, unsigned i, unsigned left, unsigned right) const override
+	{
+		const char *src_line = static_cast<const char *>((*src)[i]);
+		char *dst_line = static_cast<char *>((*dst)[i]);
+
+		unsigned pixel_align = std::max(pixel_alignment(m_pixel_in), pixel_alignment(m_pixel_out));
+		unsigned line_base = left & ~(pixel_align - 1); // floor_n(left, pixel_align);
+
+		src_line += pixel_size(m_pixel_in) * line_base;
+		dst_line += pixel_size(m_pixel_out) * line_base;
+
+		left -= line_base;
+		right -= line_base;
+
+		m_func(src_line, dst_line, m_params, left, right);
+	}
+};
+
+
 class ConvertToFloat final : public graph::ImageFilterBase {
 	depth_convert_func m_func;
 	depth_f16c_func m_f16c;
@@ -255,9 +352,61 @@ public:
 	}
 };
 
+
+unsigned bit_width(uint64_t x)
+{
+	unsigned n = 0;
+
+	while (x) {
+		x >>= 1;
+		++n;
+	}
+	return n;
+}
+
+// Compute floor(a * 2^shift / b) without overflowing the intermediate product.
+uint64_t fixed_div(uint64_t a, uint64_t b, unsigned shift)
+{
+	return ((a / b) << shift) + (((a % b) << shift) / b);
+}
+
 } // namespace
 
 
+IntegerConvertParams get_integer_convert_params(const PixelFormat &pixel_in, const PixelFormat &pixel_out)
+{
+	// The exact result is (x * range_out + num) / range_in.
+	int64_t range_in = integer_range(pixel_in);
+	int64_t range_out = integer_range(pixel_out);
+	int64_t num = static_cast<int64_t>(integer_offset(pixel_out)) * range_in - static_cast<int64_t>(integer_offset(pixel_in)) * range_out;
+
+	// Bias the offset to be non-negative, so that unsigned arithmetic can be used.
+	int64_t bias = num < 0 ? (-num + range_in - 1) / range_in : 0;
+	uint64_t num_biased = static_cast<uint64_t>(num + bias * range_in);
+
+	// Use as many fractional bits as possible without overflowing 64 bits.
+	uint64_t upper = static_cast<uint64_t>(numeric_max(pixel_in.depth)) * static_cast<uint64_t>(range_out / range_in + 1) + num_biased / range_in + 2;
+	unsigned shift = std::min(46U, 63 - bit_width(upper));
+
+	IntegerConvertParams params{};
+	params.mul = fixed_div(static_cast<uint64_t>(range_out), static_cast<uint64_t>(range_in), shift);
+	params.add = fixed_div(num_biased, static_cast<uint64_t>(range_in), shift);
+	params.shift = shift;
+	params.bias = static_cast<int32_t>(bias);
+	params.max = numeric_max(pixel_out.depth);
+
+	// Round to nearest. The exact result is a multiple of 1/(2 * range_in) from
+	// the rounding point, so a margin of 1/(4 * range_in) absorbs the truncation
+	// error of the coefficients and resolves ties upwards. Ties are then the only
+	// results with a fractional part below 1/(2 * range_in), and are corrected
+	// to even by the kernel.
+	params.add += UINT64_C(1) << (shift - 1);
+	params.add += (UINT64_C(1) << shift) / static_cast<uint64_t>(4 * range_in);
+	params.tie = (UINT64_C(1) << shift) / static_cast<uint64_t>(2 * range_in);
+
+	return params;
+}
+
 std::unique_ptr<graph::ImageFilter> create_left_shift(unsigned width, unsigned height, const PixelFormat &pixel_in, const PixelFormat &pixel_out, CPUClass cpu)
 {
 	left_shift_func func = nullptr;
@@ -272,6 +421,20 @@ std::unique_ptr<graph::ImageFilter> create_left_shift(unsigned width, unsigned h
 }
 
 
+std::unique_ptr<graph::ImageFilter> create_integer_convert(unsigned width, unsigned height, const PixelFormat &pixel_in, const PixelFormat &pixel_out, CPUClass cpu)
+{
+	integer_convert_func func = nullptr;
+
+#ifdef ZIMG_X86
+	func = select_integer_convert_func_x86(pixel_in.type, pixel_out.type, cpu);
+#endif
+	if (!func)
+		func = select_integer_convert_func(pixel_in.type, pixel_out.type);
+
+	return ztd::make_unique<IntegerConvert>(func, width, height, pixel_in, pixel_out);
+}
+
+
 std::unique_ptr<graph::ImageFilter> create_convert_to_float(unsigned width, unsigned height, const PixelFormat &pixel_in, const PixelFormat &pixel_out, CPUClass cpu)
 {
 	depth_convert_func func = nullptr;
@@ -3,6 +3,7 @@
 #ifndef ZIMG_DEPTH_DEPTH_CONVERT_H_
 #define ZIMG_DEPTH_DEPTH_CONVERT_H_
 
+#include <cstdint>
 #include <memory>
 
 namespace zimg {
@@ -25,8 +26,42 @@ typedef void (*left_shift_func)(const void *src, void *dst, unsigned shift, unsi
 typedef void (*depth_convert_func)(const void *src, void *dst, float scale, float offset, unsigned left, unsigned right);
 typedef void (*depth_f16c_func)(const void *src, void *dst, unsigned left, unsigned right);
 
+/**
+ * Fixed-point coefficients for integer range conversion.
+ *
+ * Each sample is converted as ((x * mul + add) >> shift) - bias and clamped to
+ * [0, max]. The rounding constant is folded into {@p add}. A result whose
+ * fractional bits, (x * mul + add) mod 2^shift, are less than {@p tie} was an
+ * exact tie, and is decremented if odd. Intermediate values are 64-bit, which
+ * is sufficient to round correctly for all 16-bit inputs.
+ */
+struct IntegerConvertParams {
+	uint64_t mul;
+	uint64_t add;
+	uint64_t tie;
+	unsigned shift;
+	int32_t bias;
+	int32_t max;
+};
+
+typedef void (*integer_convert_func)(const void *src, void *dst, const IntegerConvertParams &params, unsigned left, unsigned right);
+
+/**
+ * Compute fixed-point coefficients for conversion between integer formats.
+ *
+ * The result is the nearest integer to the exact rational value, with ties
+ * rounded to even, matching the rounding of the floating point path.
+ *
+ * @param pixel_in input format
+ * @param pixel_out output format
+ * @return coefficients
+ */
+IntegerConvertParams get_integer_convert_params(const PixelFormat &pixel_in, const PixelFormat &pixel_out);
+
 std::unique_ptr<graph::ImageFilter> create_left_shift(unsigned width, unsigned height, const PixelFormat &pixel_in, const PixelFormat &pixel_out, CPUClass cpu);
 
+std::unique_ptr<graph::ImageFilter> create_integer_convert(unsigned width, unsigned height, const PixelFormat &pixel_in, const PixelFormat &pixel_out, CPUClass cpu);
+
 std::unique_ptr<graph::ImageFilter> create_convert_to_float(unsigned width, unsigned height, const PixelFormat &pixel_in, const PixelFormat &pixel_out, CPUClass cpu);
 
 } // namespace depth
@@ -1,6 +1,10 @@
 #include <algorithm>
+#include <atomic>
+#include <climits>
+#include <cmath>
+#include <condition_variable>
 #include <memory>
-#include <random>
+#include <mutex>
 #include <stdexcept>
 #include <tuple>
 #include <utility>
@@ -9,8 +13,10 @@
 #include "common/except.h"
 #include "common/make_unique.h"
 #include "common/pixel.h"
+#include "common/thread_pool.h"
 #include "common/zassert.h"
 #include "graph/image_filter.h"
+#include "blue_noise.h"
 #include "depth.h"
 #include "dither.h"
 #include "hexfloat.h"
@@ -44,11 +50,22 @@ void dither_ordered(const float *dither, unsigned dither_offset, unsigned dither
 }
 
 template <class T, class U>
-void dither_ed(const void *src, void *dst, void *error_top, void *error_cur, float scale, float offset, unsigned bits, unsigned width)
+void quantize(const void *src, void *dst, float scale, float offset, unsigned bits, unsigned left, unsigned right)
 {
-	const float *error_top_p = static_cast<const float *>(error_top);
-	float *error_cur_p = static_cast<float *>(error_cur);
+	const T *src_p = static_cast<const T *>(src);
+	U *dst_p = static_cast<U *>(dst);
+
+	for (unsigned j = left; j < right; ++j) {
+		float x = static_cast<float>(src_p[j]) * scale + offset;
+		x = std::min(std::max(x, 0.0f), static_cast<float>(1UL << bits) - 1);
+
+		dst_p[j] = static_cast<U>(std::lrint(x));
+	}
+}
 
+template <class T, class U, class Weights>
+void dither_ed(const void *src, void *dst, const float *error_top, float *error_cur, float scale, float offset, unsigned bits, unsigned width)
+{
 	const T *src_p = static_cast<const T *>(src);
 	U *dst_p = static_cast<U *>(dst);
 
@@ -59,10 +76,11 @@ void dither_ed(const void *src, void *dst, void *error_top, void *error_cur, flo
 		float x = static_cast<float>(src_p[j]) * scale + offset;
 		float err = 0;
 
-		err += error_cur_p[j_err - 1] * (7.0f / 16.0f);
-		err += error_top_p[j_err + 1] * (3.0f / 16.0f);
-		err += error_top_p[j_err + 0] * (5.0f / 16.0f);
-		err += error_top_p[j_err - 1] * (1.0f / 16.0f);
+		err += error_cur[j_err - 1] * Weights::left;
+		err += error_top[j_err + 1] * Weights::top_right;
+		err += error_top[j_err + 0] * Weights::top;
+		if (Weights::top_left)
+			err += error_top[j_err - 1] * Weights::top_left;
 
 		x += err;
 		x = std::min(std::max(x, 0.0f), static_cast<float>(1UL << bits) - 1);
@@ -70,7 +88,14 @@ void dither_ed(const void *src, void *dst, void *error_top, void *error_cur, flo
 		U q = static_cast<U>(std::lrint(x));
 
 		dst_p[j] = q;
-		error_cur_p[j_err] = x - static_cast<float>(q);
+		error_cur[j_err] = x - static_cast<float>(q);
+	}
+}
+
+void random_dither_noise(float *dst, uint32_t key, unsigned col, unsigned n)
+{
+	for (unsigned j = 0; j < n; ++j) {
+		dst[j] = random_dither_value(key, col + j);
 	}
 }
 
@@ -104,23 +129,37 @@ dither_convert_func select_ordered_dither_func(PixelType pixel_in, PixelType pix
 		error::throw_<error::InternalError>("no conversion between pixel types");
 }
 
-decltype(&dither_ed<uint8_t, uint8_t>) select_error_diffusion_func(PixelType pixel_in, PixelType pixel_out)
+quantize_func select_quantize_func(PixelType pixel_in, PixelType pixel_out)
+{
+	if (pixel_in == PixelType::HALF)
+		pixel_in = PixelType::FLOAT;
+
+	if (pixel_in == PixelType::FLOAT && pixel_out == PixelType::BYTE)
+		return quantize<float, uint8_t>;
+	else if (pixel_in == PixelType::FLOAT && pixel_out == PixelType::WORD)
+		return quantize<float, uint16_t>;
+	else
+		error::throw_<error::InternalError>("no conversion between pixel types");
+}
+
+template <class Weights>
+error_diffusion_func select_error_diffusion_func(PixelType pixel_in, PixelType pixel_out)
 {
 	if (pixel_in == PixelType::HALF)
 		pixel_in = PixelType::FLOAT;
 
 	if (pixel_in == PixelType::BYTE && pixel_out == PixelType::BYTE)
-		return dither_ed<uint8_t, uint8_t>;
+		return dither_ed<uint8_t, uint8_t, Weights>;
 	else if (pixel_in == PixelType::BYTE && pixel_out == PixelType::WORD)
-		return dither_ed<uint8_t, uint16_t>;
+		return dither_ed<uint8_t, uint16_t, Weights>;
 	else if (pixel_in == PixelType::WORD && pixel_out == PixelType::BYTE)
-		return dither_ed<uint16_t, uint8_t>;
+		return dither_ed<uint16_t, uint8_t, Weights>;
 	else if (pixel_in == PixelType::WORD && pixel_out == PixelType::WORD)
-		return dither_ed<uint16_t, uint16_t>;
+		return dither_ed<uint16_t, uint16_t, Weights>;
 	else if (pixel_in == PixelType::FLOAT && pixel_out == PixelType::BYTE)
-		return dither_ed<float, uint8_t>;
+		return dither_ed<float, uint8_t, Weights>;
 	else if (pixel_in == PixelType::FLOAT && pixel_out == PixelType::WORD)
-		return dither_ed<float, uint16_t>;
+		return dither_ed<float, uint16_t, Weights>;
 	else
 		error::throw_<error::InternalError>("no conversion between pixel types");
 }
@@ -183,52 +222,41 @@ public:
 	}
 };
 
-class RandomDitherTable final : public OrderedDitherTable {
-	static constexpr size_t RAND_NUM = 1 << 14;
-
+class BlueNoiseDitherTable final : public OrderedDitherTable {
 	AlignedVector<float> m_table;
-	std::vector<unsigned> m_row_offset;
 public:
-	RandomDitherTable(unsigned, unsigned height)
+	BlueNoiseDitherTable()
 	{
 		// The greatest value such that rint(65535.0f + x) yields 65535.0f unchanged.
-		float safe_min = HEX_LF_C(-0x1.fdfffep-2);
 		float safe_max = HEX_LF_C(0x1.fdfffep-2);
 
-		std::mt19937 mt;
-		double mt_min = std::mt19937::min();
-		double mt_max = std::mt19937::max();
-
-		m_table.resize(RAND_NUM);
-
-		std::generate(m_table.begin(), m_table.end(), [&]()
-		{
-			double x = mt();
-			float f = static_cast<float>((x - mt_min) / (mt_max - mt_min) - 0.5);
-			return std::min(std::max(f, safe_min), safe_max);
-		});
-
-		m_row_offset.resize(height);
+		m_table.resize(BLUE_NOISE_LEN * BLUE_NOISE_LEN);
 
-		for (unsigned i = 0; i < height; ++i) {
-			std::mt19937 mt{ i };
-			m_row_offset[i] = floor_n(mt(), 16);
+		// Map ranks to the open interval (-0.5, 0.5), then shrink to the safe range.
+		for (unsigned i = 0; i < BLUE_NOISE_LEN * BLUE_NOISE_LEN; ++i) {
+			double x = (BLUE_NOISE_TABLE[i] + 0.5) / (BLUE_NOISE_LEN * BLUE_NOISE_LEN) - 0.5;
+			m_table[i] = static_cast<float>(x * 2.0 * safe_max);
 		}
 	}
 
 	std::tuple<const float *, unsigned, unsigned> get_dither_coeffs(unsigned i, unsigned left) const override
 	{
-		unsigned offset = (m_row_offset[i] + left) % RAND_NUM;
-		unsigned mask = RAND_NUM - 1;
+		// Each row of the matrix is a multiple of the vector length, so loads remain aligned.
+		const float *data = m_table.data() + (i % BLUE_NOISE_LEN) * BLUE_NOISE_LEN;
 
-		return std::make_tuple(m_table.data(), offset, mask);
+		return std::make_tuple(data, left % BLUE_NOISE_LEN, BLUE_NOISE_LEN - 1);
 	}
 };
 
 class OrderedDither final : public graph::ImageFilterBase {
+	// Random dither noise is generated per row into the temporary buffer in
+	// blocks of this many pixels, covering all vector loads made by the kernel.
+	static constexpr unsigned NOISE_BLOCK = 16;
+
 	std::unique_ptr<OrderedDitherTable> m_dither_table;
 	dither_convert_func m_func;
 	dither_f16c_func m_f16c;
+	dither_noise_func m_noise;
 
 	PixelType m_pixel_in;
 	PixelType m_pixel_out;
@@ -240,10 +268,11 @@ class OrderedDither final : public graph::ImageFilterBase {
 	unsigned m_width;
 	unsigned m_height;
 public:
-	OrderedDither(std::unique_ptr<OrderedDitherTable> &&table, dither_convert_func func, dither_f16c_func f16c, unsigned width, unsigned height,
-	              const PixelFormat &format_in, const PixelFormat &format_out) :
+	OrderedDither(std::unique_ptr<OrderedDitherTable> &&table, dither_convert_func func, dither_f16c_func f16c, dither_noise_func noise,
+	              unsigned width, unsigned height, const PixelFormat &format_in, const PixelFormat &format_out) :
 		m_func{ func },
 		m_f16c{ f16c },
+		m_noise{ noise },
 		m_pixel_in{ format_in.type },
 		m_pixel_out{ format_out.type },
 		m_scale{},
@@ -258,6 +287,8 @@ public:
 		if (!pixel_is_integer(format_out.type))
 			error::throw_<error::InternalError>("cannot dither to non-integer format");
 
+		zassert_d(!table != !noise, "must have exactly one dither source");
+
 		std::tie(m_scale, m_offset) = get_scale_offset(format_in, format_out);
 		m_dither_table = std::move(table);
 	}
@@ -277,19 +308,25 @@ public:
 		return{ m_width, m_height, m_pixel_out };
 	}
 
+	size_t get_context_size() const override
+	{
+		return m_noise ? sizeof(unsigned) : 0;
+	}
+
 	size_t get_tmp_size(unsigned left, unsigned right) const override
 	{
 		checked_size_t size = 0;
 
 		try {
-			if (m_f16c) {
-				unsigned pixel_align = std::max(pixel_alignment(m_pixel_in), pixel_alignment(m_pixel_out));
+			unsigned pixel_align = std::max(pixel_alignment(m_pixel_in), pixel_alignment(m_pixel_out));
 
-				left = floor_n(left, pixel_align);
-				right = ceil_n(right, pixel_align);
+			left = floor_n(left, pixel_align);
+			right = ceil_n(right, pixel_align);
 
+			if (m_noise)
+				size += static_cast<checked_size_t>(ceil_n(right - left, NOISE_BLOCK)) * sizeof(float);
+			if (m_f16c)
 				size += static_cast<checked_size_t>(right - left) * sizeof(float);
-			}
 		} catch (const std::overflow_error &) {
 			error::throw_<error::OutOfMemory>();
 		}
@@ -297,6 +334,12 @@ public:
 		return size.get();
 	}
 
+	void init_context(void *ctx, unsigned seed) const override
+	{
+		if (m_noise)
+			*static_cast<unsigned *>(ctx) = seed;
+	}
+
 	void process(void *ctx, const graph::ImageBuffer<const void> *src, const graph::ImageBuffer<void> *dst, void *tmp, unsigned i, unsigned left, unsigned right) const override
 	{
 		const char *src_line = static_cast<const char *>((*src)[i]);
@@ -312,11 +355,25 @@ public:
 		src_line += pixel_size(m_pixel_in) * line_base;
 		dst_line += pixel_size(m_pixel_out) * line_base;
 
-		std::tie(dither_table, dither_offset, dither_mask) = m_dither_table->get_dither_coeffs(i, line_base);
-
 		left -= line_base;
 		right -= line_base;
 
+		if (m_noise) {
+			float *noise = static_cast<float *>(tmp);
+			unsigned noise_left = floor_n(left, NOISE_BLOCK);
+			unsigned noise_right = ceil_n(right, NOISE_BLOCK);
+			uint32_t key = random_dither_row_key(*static_cast<const unsigned *>(ctx), i);
+
+			m_noise(noise + noise_left, key, line_base + noise_left, noise_right - noise_left);
+			dither_table = noise;
+			dither_offset = 0;
+			dither_mask = UINT_MAX;
+
+			tmp = noise + noise_right;
+		} else {
+			std::tie(dither_table, dither_offset, dither_mask) = m_dither_table->get_dither_coeffs(i, line_base);
+		}
+
 		if (m_f16c) {
 			m_f16c(src_line, tmp, left, right);
 			src_line = static_cast<char *>(tmp);
@@ -326,11 +383,102 @@ public:
 	}
 };
 
-class ErrorDiffusion final : public graph::ImageFilterBase {
+class Quantize final : public graph::ImageFilterBase {
+	quantize_func m_func;
+	dither_f16c_func m_f16c;
+
+	PixelType m_pixel_in;
+	PixelType m_pixel_out;
+
+	float m_scale;
+	float m_offset;
+	unsigned m_depth;
+
+	unsigned m_width;
+	unsigned m_height;
 public:
-	typedef void (*ed_func)(const void *src, void *dst, void *error_top, void *error_cur, float scale, float offset, unsigned bits, unsigned width);
-private:
-	ed_func m_func;
+	Quantize(quantize_func func, dither_f16c_func f16c, unsigned width, unsigned height, const PixelFormat &format_in, const PixelFormat &format_out) :
+		m_func{ func },
+		m_f16c{ f16c },
+		m_pixel_in{ format_in.type },
+		m_pixel_out{ format_out.type },
+		m_scale{},
+		m_offset{},
+		m_depth{ format_out.depth },
+		m_width{ width },
+		m_height{ height }
+	{
+		zassert_d(width <= pixel_max_width(format_in.type), "overflow");
+		zassert_d(width <= pixel_max_width(format_out.type), "overflow");
+
+		if (!pixel_is_float(format_in.type))
+			error::throw_<error::InternalError>("cannot quantize non-float format");
+		if (!pixel_is_integer(format_out.type))
+			error::throw_<error::InternalError>("cannot quantize to non-integer format");
+
+		std::tie(m_scale, m_offset) = get_scale_offset(format_in, format_out);
+	}
+
+	filter_flags get_flags() const override
+	{
+		filter_flags flags{};
+
+		flags.same_row = true;
+		flags.in_place = (pixel_size(m_pixel_in) == pixel_size(m_pixel_out));
+
+		return flags;
+	}
+
+	image_attributes get_image_attributes() const override
+	{
+		return{ m_width, m_height, m_pixel_out };
+	}
+
+	size_t get_tmp_size(unsigned left, unsigned right) const override
+	{
+		checked_size_t size = 0;
+
+		try {
+			if (m_f16c) {
+				unsigned pixel_align = std::max(pixel_alignment(m_pixel_in), pixel_alignment(m_pixel_out));
+
+				left = floor_n(left, pixel_align);
+				right = ceil_n(right, pixel_align);
+
+				size += static_cast<checked_size_t>(right - left) * sizeof(float);
+			}
+		} catch (const std::overflow_error &) {
+			error::throw_<error::OutOfMemory>();
+		}
+
+		return size.get();
+	}
+
+	void process(void *, const graph::ImageBuffer<const void> *src, const graph::ImageBuffer<void> *dst, void *tmp, unsigned i, unsigned left, unsigned right) const override
+	{
+		const char *src_line = static_cast<const char *>((*src)[i]);
+		char *dst_line = static_cast<char *>((*dst)[i]);
+
+		unsigned pixel_align = std::max(pixel_alignment(m_pixel_in), pixel_alignment(m_pixel_out));
+		unsigned line_base = left & ~(pixel_align - 1); // floor_n(left, pixel_align);
+
+		src_line += pixel_size(m_pixel_in) * line_base;
+		dst_line += pixel_size(m_pixel_out) * line_base;
+
+		left -= line_base;
+		right -= line_base;
+
+		if (m_f16c) {
+			m_f16c(src_line, tmp, left, right);
+			src_line = static_cast<char *>(tmp);
+		}
+
+		m_func(src_line, dst_line, m_scale, m_offset, m_depth, left, right);
+	}
+};
+
+class ErrorDiffusion final : public graph::ImageFilterBase {
+	error_diffusion_func m_func;
 	dither_f16c_func m_f16c;
 
 	PixelType m_pixel_in;
@@ -343,7 +491,7 @@ private:
 	unsigned m_width;
 	unsigned m_height;
 public:
-	ErrorDiffusion(ed_func func, dither_f16c_func f16c, unsigned width, unsigned height, const PixelFormat &format_in, const PixelFormat &format_out) :
+	ErrorDiffusion(error_diffusion_func func, dither_f16c_func f16c, unsigned width, unsigned height, const PixelFormat &format_in, const PixelFormat &format_out) :
 		m_func{ func },
 		m_f16c{ f16c },
 		m_pixel_in{ format_in.type },
@@ -405,7 +553,7 @@ public:
 		}
 	}
 
-	void init_context(void *ctx) const override
+	void init_context(void *ctx, unsigned) const override
 	{
 		std::fill_n(static_cast<float *>(ctx), get_context_size() / sizeof(float), 0.0f);
 	}
@@ -415,11 +563,11 @@ public:
 		const void *src_p = (*src)[i];
 		void *dst_p = (*dst)[i];
 
-		void *error_a = ctx;
-		void *error_b = static_cast<unsigned char *>(ctx) + get_context_size() / 2;
+		float *error_a = static_cast<float *>(ctx);
+		float *error_b = reinterpret_cast<float *>(static_cast<unsigned char *>(ctx) + get_context_size() / 2);
 
-		void *error_top = i % 2 ? error_a : error_b;
-		void *error_cur = i % 2 ? error_b : error_a;
+		float *error_top = i % 2 ? error_a : error_b;
+		float *error_cur = i % 2 ? error_b : error_a;
 
 		if (m_f16c) {
 			m_f16c(src_p, tmp, 0, m_width);
@@ -431,33 +579,388 @@ public:
 };
 
 
-std::unique_ptr<OrderedDitherTable> create_dither_table(DitherType type, unsigned width, unsigned height)
+class ErrorDiffusionParallel final : public graph::ImageFilter {
+	// Number of rows assigned to each thread in a single call to process.
+	static constexpr unsigned ROWS_PER_THREAD = 8;
+	// Granularity at which single rows publish their progress to the next row.
+	static constexpr unsigned COLUMN_BLOCK = 64;
+
+	// Progress of the bands in a single call to process.
+	class Wavefront {
+		std::atomic_uint *m_progress;
+		std::mutex m_mutex;
+		std::condition_variable m_cond;
+		std::atomic_uint m_waiters;
+	public:
+		std::atomic_uint next_band;
+
+		explicit Wavefront(std::atomic_uint *progress) : m_progress{ progress }, m_waiters{}, next_band{} {}
+
+		void wait(unsigned n, unsigned col)
+		{
+			if (m_progress[n].load(std::memory_order_acquire) >= col)
+				return;
+
+			std::unique_lock<std::mutex> lock{ m_mutex };
+			++m_waiters;
+			m_cond.wait(lock, [&]() { return m_progress[n].load() >= col; });
+			--m_waiters;
+		}
+
+		void signal(unsigned n, unsigned col)
+		{
+			m_progress[n].store(col);
+
+			// Waiters register before checking the progress, so none can be missed.
+			if (m_waiters.load()) {
+				std::lock_guard<std::mutex> lock{ m_mutex };
+				m_cond.notify_all();
+			}
+		}
+	};
+
+	class BandSync final : public ErrorDiffusionSync {
+		Wavefront *m_wavefront;
+		unsigned m_band;
+	public:
+		BandSync(Wavefront *wavefront, unsigned band) : m_wavefront{ wavefront }, m_band{ band } {}
+
+		void wait(unsigned col) override
+		{
+			// The band above the first band was completed by the previous call.
+			if (m_band)
+				m_wavefront->wait(m_band - 1, col);
+		}
+
+		void signal(unsigned col) override { m_wavefront->signal(m_band, col); }
+	};
+
+	error_diffusion_kernel m_kernel;
+
+	PixelType m_pixel_in;
+	PixelType m_pixel_out;
+
+	float m_scale;
+	float m_offset;
+	unsigned m_depth;
+
+	unsigned m_width;
+	unsigned m_height;
+	unsigned m_threads;
+	unsigned m_band_rows;
+	unsigned m_batch_bands;
+
+	mutable ThreadPool m_pool;
+
+	unsigned batch_lines() const { return m_batch_bands * m_band_rows; }
+
+	size_t error_row_size() const
+	{
+		// Padded by one on each side, plus one pixel read ahead by some implementations.
+		return ceil_n((static_cast<size_t>(m_width) + 3) * sizeof(float), ALIGNMENT);
+	}
+
+	size_t f16c_row_size() const
+	{
+		return m_kernel.f16c ? ceil_n(static_cast<size_t>(m_width) * sizeof(float), ALIGNMENT) : 0;
+	}
+
+	size_t progress_table_size() const
+	{
+		return ceil_n(m_batch_bands * sizeof(std::atomic_uint), ALIGNMENT);
+	}
+
+	checked_size_t thread_tmp_size() const
+	{
+		checked_size_t size = static_cast<checked_size_t>(f16c_row_size()) * m_band_rows;
+
+		// Intermediate error of the last band, if the image height is not a multiple.
+		if (m_band_rows > 1)
+			size += static_cast<checked_size_t>(error_row_size()) * 2;
+
+		return size;
+	}
+
+	std::atomic_uint *get_progress_table(void *ctx) const
+	{
+		return static_cast<std::atomic_uint *>(ctx);
+	}
+
+	float *get_error_row(void *ctx, unsigned band) const
+	{
+		// Each band in flight requires its own error row, plus the completed band above it.
+		unsigned char *ptr = static_cast<unsigned char *>(ctx) + progress_table_size();
+		return reinterpret_cast<float *>(ptr + static_cast<size_t>(band % (m_threads + 1)) * error_row_size());
+	}
+
+	void process_row(const void *src, void *dst, void *tmp, const float *error_top, float *error_cur, ErrorDiffusionSync *sync) const
+	{
+		unsigned src_pixel_size = m_kernel.f16c ? static_cast<unsigned>(sizeof(float)) : pixel_size(m_pixel_in);
+		unsigned dst_pixel_size = pixel_size(m_pixel_out);
+
+		if (m_kernel.f16c) {
+			m_kernel.f16c(src, tmp, 0, m_width);
+			src = tmp;
+		}
+
+		const char *src_p = static_cast<const char *>(src);
+		char *dst_p = static_cast<char *>(dst);
+
+		for (unsigned j = 0; j < m_width; j += COLUMN_BLOCK) {
+			unsigned j_end = std::min(j + COLUMN_BLOCK, m_width);
+
+			// Pixel (i, j) depends on the error at (i - 1, j + 1), and some
+			// implementations read one pixel further ahead.
+			if (sync)
+				sync->wait(std::min(j_end + 2, m_width));
+
+			m_kernel.row(src_p + static_cast<size_t>(j) * src_pixel_size, dst_p + static_cast<size_t>(j) * dst_pixel_size,
+			             error_top + j, error_cur + j, m_scale, m_offset, m_depth, j_end - j);
+
+			if (sync)
+				sync->signal(j_end);
+		}
+	}
+
+	void process_band(void *ctx, const graph::ImageBuffer<const void> &src, const graph::ImageBuffer<void> &dst, void *tmp,
+	                  unsigned band, ErrorDiffusionSync *sync) const
+	{
+		unsigned top = band * m_band_rows;
+		const float *error_top = get_error_row(ctx, band + m_threads);
+		float *error_cur = get_error_row(ctx, band);
+
+		if (m_band_rows == 1) {
+			process_row(src[top], dst[top], tmp, error_top, error_cur, sync);
+		} else if (m_height - top >= m_band_rows) {
+			graph::ImageBuffer<const void> src_buf = src;
+
+			if (m_kernel.f16c) {
+				size_t stride = f16c_row_size();
+
+				for (unsigned n = 0; n < m_band_rows; ++n) {
+					m_kernel.f16c(src[top + n], static_cast<unsigned char *>(tmp) + n * stride, 0, m_width);
+				}
+				src_buf = graph::ImageBuffer<const void>{ tmp, static_cast<ptrdiff_t>(stride), m_band_rows - 1 };
+			}
+
+			m_kernel.band(src_buf, dst, top, error_top, error_cur, m_scale, m_offset, m_depth, m_width, sync);
+		} else {
+			// The last band is processed one row at a time.
+			unsigned char *scratch_p = static_cast<unsigned char *>(tmp) + f16c_row_size() * m_band_rows;
+			float *scratch[2] = { reinterpret_cast<float *>(scratch_p), reinterpret_cast<float *>(scratch_p + error_row_size()) };
+
+			std::fill_n(scratch[0], error_row_size() * 2 / sizeof(float), 0.0f);
+			sync->wait(m_width);
+
+			for (unsigned ii = top; ii < m_height; ++ii) {
+				float *cur = ii == m_height - 1 ? error_cur : scratch[(ii - top) % 2];
+
+				process_row(src[ii], dst[ii], tmp, error_top, cur, nullptr);
+				error_top = cur;
+			}
+
+			sync->signal(m_width);
+		}
+	}
+public:
+	ErrorDiffusionParallel(const error_diffusion_kernel &kernel, unsigned width, unsigned height,
+	                       const PixelFormat &format_in, const PixelFormat &format_out, unsigned threads) :
+		m_kernel(kernel),
+		m_pixel_in{ format_in.type },
+		m_pixel_out{ format_out.type },
+		m_scale{},
+		m_offset{},
+		m_depth{ format_out.depth },
+		m_width{ width },
+		m_height{ height },
+		m_threads{ threads },
+		m_band_rows{ kernel.band ? kernel.band_rows : 1 },
+		m_batch_bands{},
+		m_pool{ threads - 1 }
+	{
+		zassert_d(width <= pixel_max_width(format_in.type), "overflow");
+		zassert_d(width <= pixel_max_width(format_out.type), "overflow");
+
+		if (!pixel_is_integer(format_out.type))
+			error::throw_<error::InternalError>("cannot dither to non-integer format");
+		if (threads < 2 || threads > UINT_MAX / std::max(static_cast<unsigned>(ROWS_PER_THREAD), m_band_rows))
+			error::throw_<error::InternalError>("invalid thread count");
+
+		m_batch_bands = m_threads * std::max(ROWS_PER_THREAD / m_band_rows, 1U);
+		std::tie(m_scale, m_offset) = get_scale_offset(format_in, format_out);
+	}
+
+	filter_flags get_flags() const override
+	{
+		filter_flags flags{};
+
+		flags.has_state = true;
+		flags.same_row = true;
+		flags.in_place = pixel_size(m_pixel_in) == pixel_size(m_pixel_out);
+		flags.entire_row = true;
+
+		return flags;
+	}
+
+	image_attributes get_image_attributes() const override
+	{
+		return{ m_width, m_height, m_pixel_out };
+	}
+
+	pair_unsigned get_required_row_range(unsigned i) const override
+	{
+		unsigned last = std::min(i, UINT_MAX - batch_lines()) + batch_lines();
+		return{ i, std::min(last, m_height) };
+	}
+
+	pair_unsigned get_required_col_range(unsigned, unsigned) const override
+	{
+		return{ 0, get_image_attributes().width };
+	}
+
+	unsigned get_simultaneous_lines() const override { return batch_lines(); }
+
+	unsigned get_max_buffering() const override { return batch_lines(); }
+
+	size_t get_context_size() const override
+	{
+		try {
+			checked_size_t size = static_cast<checked_size_t>(error_row_size()) * (m_threads + 1);
+			size += progress_table_size();
+			return size.get();
+		} catch (const std::overflow_error &) {
+			error::throw_<error::OutOfMemory>();
+		}
+	}
+
+	size_t get_tmp_size(unsigned, unsigned) const override
+	{
+		try {
+			checked_size_t size = thread_tmp_size() * m_threads;
+			return size.get();
+		} catch (const std::overflow_error &) {
+			error::throw_<error::OutOfMemory>();
+		}
+	}
+
+	void init_context(void *ctx, unsigned) const override
+	{
+		std::fill_n(static_cast<unsigned char *>(ctx), get_context_size(), 0);
+
+		for (unsigned n = 0; n < m_batch_bands; ++n) {
+			new (get_progress_table(ctx) + n) std::atomic_uint{ 0 };
+		}
+	}
+
+	void process(void *ctx, const graph::ImageBuffer<const void> *src, const graph::ImageBuffer<void> *dst, void *tmp, unsigned i, unsigned, unsigned) const override
+	{
+		unsigned first_band = i / m_band_rows;
+		unsigned count = (get_required_row_range(i).second - i + m_band_rows - 1) / m_band_rows;
+		size_t tmp_stride = thread_tmp_size().get();
+
+		std::atomic_uint *progress = get_progress_table(ctx);
+
+		for (unsigned n = 0; n < count; ++n) {
+			progress[n].store(0, std::memory_order_relaxed);
+		}
+
+		// Bands are claimed in order, so the band above each claimed band is always in progress.
+		Wavefront wavefront{ progress };
+
+		m_pool.run(std::min(m_threads, count), [&](unsigned t)
+		{
+			void *thread_tmp = static_cast<unsigned char *>(tmp) + t * tmp_stride;
+
+			while (true) {
+				unsigned n = wavefront.next_band.fetch_add(1);
+				if (n >= count)
+					break;
+
+				BandSync sync{ &wavefront, n };
+				process_band(ctx, *src, *dst, thread_tmp, first_band + n, &sync);
+			}
+		});
+	}
+};
+
+
+std::unique_ptr<OrderedDitherTable> create_dither_table(DitherType type)
 {
 	switch (type) {
 	case DitherType::NONE:
 		return ztd::make_unique<NoneDitherTable>();
 	case DitherType::ORDERED:
 		return ztd::make_unique<BayerDitherTable>();
-	case DitherType::RANDOM:
-		return ztd::make_unique<RandomDitherTable>(width, height);
+	case DitherType::BLUE_NOISE:
+		return ztd::make_unique<BlueNoiseDitherTable>();
 	default:
 		error::throw_<error::InternalError>("unrecognized dither type");
 	}
 }
 
-std::unique_ptr<graph::ImageFilter> create_error_diffusion(unsigned width, unsigned height, const PixelFormat &pixel_in, const PixelFormat &pixel_out, CPUClass cpu)
+std::unique_ptr<graph::ImageFilter> create_quantize(unsigned width, unsigned height, const PixelFormat &pixel_in, const PixelFormat &pixel_out, CPUClass cpu)
+{
+	quantize_func func = nullptr;
+	dither_f16c_func f16c = nullptr;
+	bool needs_f16c = (pixel_in.type == PixelType::HALF);
+
+#ifdef ZIMG_X86
+	func = select_quantize_func_x86(pixel_in, pixel_out, cpu);
+	needs_f16c = needs_f16c && needs_dither_f16c_func_x86(cpu);
+
+	if (needs_f16c)
+		f16c = select_dither_f16c_func_x86(cpu);
+#endif
+
+	if (!func)
+		func = select_quantize_func(pixel_in.type, pixel_out.type);
+
+	if (needs_f16c && !f16c)
+		f16c = half_to_float_n;
+
+	return ztd::make_unique<Quantize>(func, f16c, width, height, pixel_in, pixel_out);
+}
+
+error_diffusion_kernel select_error_diffusion_kernel(DitherType type, unsigned width, const PixelFormat &pixel_in, const PixelFormat &pixel_out, CPUClass cpu)
+{
+	error_diffusion_kernel kernel{};
+
+#ifdef ZIMG_X86
+	kernel = select_error_diffusion_kernel_x86(type, width, pixel_in, pixel_out, cpu);
+#endif
+
+	if (!kernel.row) {
+		if (type == DitherType::SIERRA_LITE)
+			kernel.row = select_error_diffusion_func<SierraLiteWeights>(pixel_in.type, pixel_out.type);
+		else
+			kernel.row = select_error_diffusion_func<FloydSteinbergWeights>(pixel_in.type, pixel_out.type);
+
+		if (pixel_in.type == PixelType::HALF)
+			kernel.f16c = half_to_float_n;
+	}
+
+	return kernel;
+}
+
+std::unique_ptr<graph::ImageFilter> create_error_diffusion(DitherType type, unsigned width, unsigned height, const PixelFormat &pixel_in, const PixelFormat &pixel_out,
+                                                           CPUClass cpu, unsigned threads)
 {
+	if (threads > 1 && height > 1)
+		return ztd::make_unique<ErrorDiffusionParallel>(select_error_diffusion_kernel(type, width, pixel_in, pixel_out, cpu), width, height, pixel_in, pixel_out, threads);
+
 #ifdef ZIMG_X86
-	if (auto ret = create_error_diffusion_x86(width, height, pixel_in, pixel_out, cpu))
+	if (auto ret = create_error_diffusion_x86(type, width, height, pixel_in, pixel_out, cpu))
 		return ret;
 #endif
 
-	ErrorDiffusion::ed_func func = nullptr;
+	error_diffusion_func func = nullptr;
 	dither_f16c_func f16c = nullptr;
 	bool needs_f16c = (pixel_in.type == PixelType::HALF);
 
+	if (!func && type == DitherType::SIERRA_LITE)
+		func = select_error_diffusion_func<SierraLiteWeights>(pixel_in.type, pixel_out.type);
 	if (!func)
-		func = select_error_diffusion_func(pixel_in.type, pixel_out.type);
+		func = select_error_diffusion_func<FloydSteinbergWeights>(pixel_in.type, pixel_out.type);
 	if (needs_f16c && !f16c)
 		f16c = half_to_float_n;
 
@@ -467,15 +970,22 @@ std::unique_ptr<graph::ImageFilter> create_error_diffusion(unsigned width, unsig
 } // namespace
 
 
-std::unique_ptr<graph::ImageFilter> create_dither(DitherType type, unsigned width, unsigned height, const PixelFormat &pixel_in, const PixelFormat &pixel_out, CPUClass cpu)
+std::unique_ptr<graph::ImageFilter> create_dither(DitherType type, unsigned width, unsigned height, const PixelFormat &pixel_in, const PixelFormat &pixel_out, CPUClass cpu, unsigned threads)
 {
-	if (type == DitherType::ERROR_DIFFUSION)
-		return create_error_diffusion(width, height, pixel_in, pixel_out, cpu);
+	if (type == DitherType::ERROR_DIFFUSION || type == DitherType::SIERRA_LITE)
+		return create_error_diffusion(type, width, height, pixel_in, pixel_out, cpu, threads);
+	if (type == DitherType::NONE && pixel_is_float(pixel_in.type))
+		return create_quantize(width, height, pixel_in, pixel_out, cpu);
 
-	auto table = create_dither_table(type, width, height);
+	std::unique_ptr<OrderedDitherTable> table;
 	dither_convert_func func = nullptr;
 	dither_f16c_func f16c = nullptr;
+	dither_noise_func noise = nullptr;
 	bool needs_f16c = (pixel_in.type == PixelType::HALF);
+	bool needs_noise = (type == DitherType::RANDOM);
+
+	if (!needs_noise)
+		table = create_dither_table(type);
 
 #ifdef ZIMG_X86
 	func = select_ordered_dither_func_x86(pixel_in, pixel_out, cpu);
@@ -483,6 +993,8 @@ std::unique_ptr<graph::ImageFilter> create_dither(DitherType type, unsigned widt
 
 	if (needs_f16c)
 		f16c = select_dither_f16c_func_x86(cpu);
+	if (needs_noise)
+		noise = select_dither_noise_func_x86(cpu);
 #endif
 
 	if (!func)
@@ -490,8 +1002,10 @@ std::unique_ptr<graph::ImageFilter> create_dither(DitherType type, unsigned widt
 
 	if (needs_f16c && !f16c)
 		f16c = half_to_float_n;
+	if (needs_noise && !noise)
+		noise = random_dither_noise;
 
-	return ztd::make_unique<OrderedDither>(std::move(table), func, f16c, width, height, pixel_in, pixel_out);
+	return ztd::make_unique<OrderedDither>(std::move(table), func, f16c, noise, width, height, pixel_in, pixel_out);
 }
 
 } // namespace depth
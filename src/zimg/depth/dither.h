@@ -3,6 +3,8 @@
 #ifndef ZIMG_DEPTH_DITHER_H_
 #define ZIMG_DEPTH_DITHER_H_
 
+#include <algorithm>
+#include <cstdint>
 #include <memory>
 
 namespace zimg {
@@ -13,6 +15,9 @@ struct PixelFormat;
 
 namespace graph {
 
+template <class T>
+class ImageBuffer;
+
 class ImageFilter;
 
 } // namespace graph
@@ -24,9 +29,140 @@ enum class DitherType;
 
 typedef void (*dither_convert_func)(const float *dither, unsigned dither_offset, unsigned dither_mask,
                                     const void *src, void *dst, float scale, float offset, unsigned bits, unsigned left, unsigned right);
+typedef void (*quantize_func)(const void *src, void *dst, float scale, float offset, unsigned bits, unsigned left, unsigned right);
 typedef void (*dither_f16c_func)(const void *src, void *dst, unsigned left, unsigned right);
+typedef void (*dither_noise_func)(float *dst, uint32_t key, unsigned col, unsigned n);
+typedef void (*error_diffusion_func)(const void *src, void *dst, const float *error_top, float *error_cur, float scale, float offset, unsigned bits, unsigned width);
+
+// Multipliers of the integer hash underlying random dither.
+// See: https://nullprogram.com/blog/2018/07/31/
+constexpr uint32_t RANDOM_DITHER_MUL1 = 0x7FEB352DUL;
+constexpr uint32_t RANDOM_DITHER_MUL2 = 0x846CA68BUL;
+
+// Maps a 24-bit hash, centered at zero, into the range of the random dither.
+// The product with the greatest magnitude input is the greatest value such that
+// rint(65535.0f + x) yields 65535.0f unchanged.
+constexpr float RANDOM_DITHER_BIAS = 8388607.5f;
+constexpr float RANDOM_DITHER_SCALE = static_cast<float>(0x1FDFFFEUL) / 281474976710656.0f; // 0x1.fdfffep-25
+
+inline uint32_t random_dither_hash(uint32_t x)
+{
+	x ^= x >> 16;
+	x *= RANDOM_DITHER_MUL1;
+	x ^= x >> 15;
+	x *= RANDOM_DITHER_MUL2;
+	x ^= x >> 16;
+	return x;
+}
+
+// Random dither is stateless. Each row is assigned a key derived from the seed
+// and row index, and each pixel is the hash of its column and the row key.
+inline uint32_t random_dither_row_key(unsigned seed, unsigned i)
+{
+	return random_dither_hash(random_dither_hash(seed + 0x9E3779B9UL) + i);
+}
+
+inline float random_dither_value(uint32_t key, unsigned col)
+{
+	uint32_t h = random_dither_hash(col ^ key);
+	return (static_cast<float>(static_cast<int32_t>(h >> 8)) - RANDOM_DITHER_BIAS) * RANDOM_DITHER_SCALE;
+}
+
+// Weights applied to the quantization error of neighbouring pixels in error
+// diffusion. Shared by the portable and vectorized implementations.
+struct FloydSteinbergWeights {
+	static constexpr float left = 7.0f / 16.0f;
+	static constexpr float top_right = 3.0f / 16.0f;
+	static constexpr float top = 5.0f / 16.0f;
+	static constexpr float top_left = 1.0f / 16.0f;
+};
+
+// Sierra Lite (Sierra-2-4A) does not depend on the top-left pixel.
+struct SierraLiteWeights {
+	static constexpr float left = 2.0f / 4.0f;
+	static constexpr float top_right = 1.0f / 4.0f;
+	static constexpr float top = 1.0f / 4.0f;
+	static constexpr float top_left = 0.0f;
+};
+
+/**
+ * Synchronization between adjacent bands of rows in parallel error diffusion.
+ *
+ * Columns are counted in pixels. The error of a row is padded by one on each
+ * side, so the error of pixel N is stored at index (N + 1).
+ */
+class ErrorDiffusionSync {
+public:
+	virtual ~ErrorDiffusionSync() = default;
+
+	/**
+	 * Wait until the error of the row above the band is available.
+	 *
+	 * @param col number of leading pixels required
+	 */
+	virtual void wait(unsigned col) = 0;
+
+	/**
+	 * Publish the error of the last row in the band.
+	 *
+	 * @param col number of leading pixels completed
+	 */
+	virtual void signal(unsigned col) = 0;
+};
+
+// Error diffusion on a band of rows [i, i + N), where N is fixed by the implementation.
+typedef void (*error_diffusion_band_func)(const graph::ImageBuffer<const void> &src, const graph::ImageBuffer<void> &dst, unsigned i,
+                                          const float *error_top, float *error_cur, float scale, float offset, unsigned bits, unsigned width,
+                                          ErrorDiffusionSync *sync);
+
+/**
+ * Functions used by the wavefront-parallel error diffusion.
+ *
+ * The row function is always present. The band function, if present,
+ * processes {@p band_rows} rows at once, a power of two. If {@p f16c} is
+ * present, half precision input is converted to single precision first.
+ */
+struct error_diffusion_kernel {
+	error_diffusion_func row;
+	error_diffusion_band_func band;
+	unsigned band_rows;
+	dither_f16c_func f16c;
+};
+
+/**
+ * Run the wavefront of a band of rows in blocks of columns.
+ *
+ * Each row of the band is offset by two pixels from the row above it. Before
+ * each block, waits for the error above the first row, which is read up to two
+ * pixels ahead. After each block, publishes the error of the last row.
+ *
+ * @param sync synchronization, may be null
+ * @param skew offset of the first row relative to the last row
+ * @param count number of columns in the wavefront
+ * @param width width of the image
+ * @param func function taking the left and right column of the block
+ */
+template <class F>
+void error_diffusion_wavefront(ErrorDiffusionSync *sync, unsigned skew, unsigned count, unsigned width, F func)
+{
+	constexpr unsigned COLUMN_BLOCK = 64;
+
+	if (!sync) {
+		func(0U, count);
+		return;
+	}
+
+	for (unsigned j = 0; j < count; j += COLUMN_BLOCK) {
+		unsigned j_end = std::min(j + COLUMN_BLOCK, count);
+
+		sync->wait(std::min(j_end + skew + 2, width));
+		func(j, j_end);
+		sync->signal(j_end);
+	}
+}
 
-std::unique_ptr<graph::ImageFilter> create_dither(DitherType type, unsigned width, unsigned height, const PixelFormat &pixel_in, const PixelFormat &pixel_out, CPUClass cpu);
+std::unique_ptr<graph::ImageFilter> create_dither(DitherType type, unsigned width, unsigned height, const PixelFormat &pixel_in, const PixelFormat &pixel_out, CPUClass cpu,
+                                                  unsigned threads = 1);
 
 } // namespace depth
 } // namespace zimg
@@ -96,9 +96,246 @@ inline FORCE_INLINE void depth_convert_avx2_impl(const void *src, void *dst, flo
 	}
 }
 
+struct IntegerConvertCoeffs {
+	__m256i mul_lo;
+	__m256i mul_hi;
+	__m256i add;
+	__m256i frac_mask;
+	__m256i tie;
+	__m256i parity;
+	__m128i shift;
+	__m256i bias;
+	__m256i max;
+
+	explicit IntegerConvertCoeffs(const IntegerConvertParams &params) :
+		mul_lo{ _mm256_set1_epi64x(params.mul & 0xFFFFFFFFU) },
+		mul_hi{ _mm256_set1_epi64x(params.mul >> 32) },
+		add{ _mm256_set1_epi64x(params.add) },
+		frac_mask{ _mm256_set1_epi64x((UINT64_C(1) << params.shift) - 1) },
+		tie{ _mm256_set1_epi64x(params.tie) },
+		parity{ _mm256_set1_epi64x(params.bias & 1) },
+		shift{ _mm_set1_epi64x(params.shift) },
+		bias{ _mm256_set1_epi32(params.bias) },
+		max{ _mm256_set1_epi32(params.max) }
+	{}
+};
+
+// Apply fixed-point conversion to the low 32 bits of each 64-bit element.
+inline FORCE_INLINE __m256i integer_convert_epi64(__m256i x, const IntegerConvertCoeffs &coeffs)
+{
+	__m256i lo = _mm256_mul_epu32(x, coeffs.mul_lo);
+	__m256i hi = _mm256_mul_epu32(x, coeffs.mul_hi);
+
+	lo = _mm256_add_epi64(lo, _mm256_slli_epi64(hi, 32));
+	lo = _mm256_add_epi64(lo, coeffs.add);
+
+	// Round ties to even: ties have a fractional part below the threshold.
+	__m256i y = _mm256_srl_epi64(lo, coeffs.shift);
+	__m256i tie = _mm256_srli_epi64(_mm256_sub_epi64(_mm256_and_si256(lo, coeffs.frac_mask), coeffs.tie), 63);
+	tie = _mm256_and_si256(tie, _mm256_xor_si256(y, coeffs.parity));
+	return _mm256_sub_epi64(y, tie);
+}
+
+// Apply fixed-point conversion to unsigned 32-bit elements, producing clamped results.
+inline FORCE_INLINE __m256i integer_convert_epi32(__m256i x, const IntegerConvertCoeffs &coeffs)
+{
+	__m256i even = integer_convert_epi64(x, coeffs);
+	__m256i odd = integer_convert_epi64(_mm256_srli_epi64(x, 32), coeffs);
+
+	x = _mm256_or_si256(even, _mm256_slli_epi64(odd, 32));
+	x = _mm256_sub_epi32(x, coeffs.bias);
+	x = _mm256_max_epi32(x, _mm256_setzero_si256());
+	x = _mm256_min_epi32(x, coeffs.max);
+	return x;
+}
+
+inline FORCE_INLINE __m256i integer_convert_load8(const uint8_t *ptr)
+{
+	return _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i *)ptr));
+}
+
+inline FORCE_INLINE __m256i integer_convert_load8(const uint16_t *ptr)
+{
+	return _mm256_cvtepu16_epi32(_mm_load_si128((const __m128i *)ptr));
+}
+
+// Convert 16 pixels, returning the result as unsigned 16-bit.
+template <class T>
+inline FORCE_INLINE __m256i integer_convert_avx2_xiter(unsigned j, const T *src_p, const IntegerConvertCoeffs &coeffs)
+{
+	__m256i lo = integer_convert_epi32(integer_convert_load8(src_p + j + 0), coeffs);
+	__m256i hi = integer_convert_epi32(integer_convert_load8(src_p + j + 8), coeffs);
+
+	lo = _mm256_packus_epi32(lo, hi);
+	return _mm256_permute4x64_epi64(lo, _MM_SHUFFLE(3, 1, 2, 0));
+}
+
+inline FORCE_INLINE __m128i mm256_cvtepi16_epu8(__m256i x)
+{
+	return _mm_packus_epi16(_mm256_castsi256_si128(x), _mm256_extracti128_si256(x, 1));
+}
+
+template <class T>
+inline FORCE_INLINE void integer_convert_to_byte_avx2(const void *src, void *dst, const IntegerConvertParams &params, unsigned left, unsigned right)
+{
+	const T *src_p = static_cast<const T *>(src);
+	uint8_t *dst_p = static_cast<uint8_t *>(dst);
+
+	unsigned vec_left = ceil_n(left, 16);
+	unsigned vec_right = floor_n(right, 16);
+
+	const IntegerConvertCoeffs coeffs{ params };
+
+	if (left != vec_left) {
+		__m128i x = mm256_cvtepi16_epu8(integer_convert_avx2_xiter(vec_left - 16, src_p, coeffs));
+		mm_store_idxhi_epi8((__m128i *)(dst_p + vec_left - 16), x, left % 16);
+	}
+
+	for (unsigned j = vec_left; j < vec_right; j += 16) {
+		__m128i x = mm256_cvtepi16_epu8(integer_convert_avx2_xiter(j, src_p, coeffs));
+		_mm_store_si128((__m128i *)(dst_p + j), x);
+	}
+
+	if (right != vec_right) {
+		__m128i x = mm256_cvtepi16_epu8(integer_convert_avx2_xiter(vec_right, src_p, coeffs));
+		mm_store_idxlo_epi8((__m128i *)(dst_p + vec_right), x, right % 16);
+	}
+}
+
+template <class T>
+inline FORCE_INLINE void integer_convert_to_word_avx2(const void *src, void *dst, const IntegerConvertParams &params, unsigned left, unsigned right)
+{
+	const T *src_p = static_cast<const T *>(src);
+	uint16_t *dst_p = static_cast<uint16_t *>(dst);
+
+	unsigned vec_left = ceil_n(left, 16);
+	unsigned vec_right = floor_n(right, 16);
+
+	const IntegerConvertCoeffs coeffs{ params };
+
+	if (left != vec_left) {
+		__m256i x = integer_convert_avx2_xiter(vec_left - 16, src_p, coeffs);
+		mm256_store_idxhi_epi16((__m256i *)(dst_p + vec_left - 16), x, left % 16);
+	}
+
+	for (unsigned j = vec_left; j < vec_right; j += 16) {
+		__m256i x = integer_convert_avx2_xiter(j, src_p, coeffs);
+		_mm256_store_si256((__m256i *)(dst_p + j), x);
+	}
+
+	if (right != vec_right) {
+		__m256i x = integer_convert_avx2_xiter(vec_right, src_p, coeffs);
+		mm256_store_idxlo_epi16((__m256i *)(dst_p + vec_right), x, right % 16);
+	}
+}
+
+inline FORCE_INLINE __m256i left_shift_load16(const uint8_t *ptr)
+{
+	return _mm256_cvtepu8_epi16(_mm_load_si128((const __m128i *)ptr));
+}
+
+inline FORCE_INLINE __m256i left_shift_load16(const uint16_t *ptr)
+{
+	return _mm256_load_si256((const __m256i *)ptr);
+}
+
+template <class T>
+inline FORCE_INLINE void left_shift_to_byte_avx2(const void *src, void *dst, unsigned shift, unsigned left, unsigned right)
+{
+	const T *src_p = static_cast<const T *>(src);
+	uint8_t *dst_p = static_cast<uint8_t *>(dst);
+
+	unsigned vec_left = ceil_n(left, 16);
+	unsigned vec_right = floor_n(right, 16);
+
+	const __m128i count = _mm_set1_epi64x(shift);
+
+	if (left != vec_left) {
+		__m256i x = _mm256_sll_epi16(left_shift_load16(src_p + vec_left - 16), count);
+		mm_store_idxhi_epi8((__m128i *)(dst_p + vec_left - 16), mm256_cvtepi16_epu8(x), left % 16);
+	}
+
+	for (unsigned j = vec_left; j < vec_right; j += 16) {
+		__m256i x = _mm256_sll_epi16(left_shift_load16(src_p + j), count);
+		_mm_store_si128((__m128i *)(dst_p + j), mm256_cvtepi16_epu8(x));
+	}
+
+	if (right != vec_right) {
+		__m256i x = _mm256_sll_epi16(left_shift_load16(src_p + vec_right), count);
+		mm_store_idxlo_epi8((__m128i *)(dst_p + vec_right), mm256_cvtepi16_epu8(x), right % 16);
+	}
+}
+
+template <class T>
+inline FORCE_INLINE void left_shift_to_word_avx2(const void *src, void *dst, unsigned shift, unsigned left, unsigned right)
+{
+	const T *src_p = static_cast<const T *>(src);
+	uint16_t *dst_p = static_cast<uint16_t *>(dst);
+
+	unsigned vec_left = ceil_n(left, 16);
+	unsigned vec_right = floor_n(right, 16);
+
+	const __m128i count = _mm_set1_epi64x(shift);
+
+	if (left != vec_left) {
+		__m256i x = _mm256_sll_epi16(left_shift_load16(src_p + vec_left - 16), count);
+		mm256_store_idxhi_epi16((__m256i *)(dst_p + vec_left - 16), x, left % 16);
+	}
+
+	for (unsigned j = vec_left; j < vec_right; j += 16) {
+		__m256i x = _mm256_sll_epi16(left_shift_load16(src_p + j), count);
+		_mm256_store_si256((__m256i *)(dst_p + j), x);
+	}
+
+	if (right != vec_right) {
+		__m256i x = _mm256_sll_epi16(left_shift_load16(src_p + vec_right), count);
+		mm256_store_idxlo_epi16((__m256i *)(dst_p + vec_right), x, right % 16);
+	}
+}
+
 } // namespace
 
 
+void left_shift_b2b_avx2(const void *src, void *dst, unsigned shift, unsigned left, unsigned right)
+{
+	left_shift_to_byte_avx2<uint8_t>(src, dst, shift, left, right);
+}
+
+void left_shift_b2w_avx2(const void *src, void *dst, unsigned shift, unsigned left, unsigned right)
+{
+	left_shift_to_word_avx2<uint8_t>(src, dst, shift, left, right);
+}
+
+void left_shift_w2b_avx2(const void *src, void *dst, unsigned shift, unsigned left, unsigned right)
+{
+	left_shift_to_byte_avx2<uint16_t>(src, dst, shift, left, right);
+}
+
+void left_shift_w2w_avx2(const void *src, void *dst, unsigned shift, unsigned left, unsigned right)
+{
+	left_shift_to_word_avx2<uint16_t>(src, dst, shift, left, right);
+}
+
+void integer_convert_b2b_avx2(const void *src, void *dst, const IntegerConvertParams &params, unsigned left, unsigned right)
+{
+	integer_convert_to_byte_avx2<uint8_t>(src, dst, params, left, right);
+}
+
+void integer_convert_b2w_avx2(const void *src, void *dst, const IntegerConvertParams &params, unsigned left, unsigned right)
+{
+	integer_convert_to_word_avx2<uint8_t>(src, dst, params, left, right);
+}
+
+void integer_convert_w2b_avx2(const void *src, void *dst, const IntegerConvertParams &params, unsigned left, unsigned right)
+{
+	integer_convert_to_byte_avx2<uint16_t>(src, dst, params, left, right);
+}
+
+void integer_convert_w2w_avx2(const void *src, void *dst, const IntegerConvertParams &params, unsigned left, unsigned right)
+{
+	integer_convert_to_word_avx2<uint16_t>(src, dst, params, left, right);
+}
+
 void depth_convert_b2h_avx2(const void *src, void *dst, float scale, float offset, unsigned left, unsigned right)
 {
 	depth_convert_avx2_impl<LoadU8, StoreF16>(src, dst, scale, offset, left, right);
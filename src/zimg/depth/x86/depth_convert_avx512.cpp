@@ -85,9 +85,214 @@ inline FORCE_INLINE void depth_convert_avx512_impl(const void *src, void *dst, f
 	}
 }
 
+struct IntegerConvertCoeffs {
+	__m512i mul_lo;
+	__m512i mul_hi;
+	__m512i add;
+	__m512i frac_mask;
+	__m512i tie;
+	__m512i parity;
+	__m128i shift;
+	__m512i bias;
+	__m512i max;
+
+	explicit IntegerConvertCoeffs(const IntegerConvertParams &params) :
+		mul_lo{ _mm512_set1_epi64(params.mul & 0xFFFFFFFFU) },
+		mul_hi{ _mm512_set1_epi64(params.mul >> 32) },
+		add{ _mm512_set1_epi64(params.add) },
+		frac_mask{ _mm512_set1_epi64((UINT64_C(1) << params.shift) - 1) },
+		tie{ _mm512_set1_epi64(params.tie) },
+		parity{ _mm512_set1_epi64(params.bias & 1) },
+		shift{ _mm_set1_epi64x(params.shift) },
+		bias{ _mm512_set1_epi32(params.bias) },
+		max{ _mm512_set1_epi32(params.max) }
+	{}
+};
+
+// Apply fixed-point conversion to the low 32 bits of each 64-bit element.
+inline FORCE_INLINE __m512i integer_convert_epi64(__m512i x, const IntegerConvertCoeffs &coeffs)
+{
+	__m512i lo = _mm512_mul_epu32(x, coeffs.mul_lo);
+	__m512i hi = _mm512_mul_epu32(x, coeffs.mul_hi);
+
+	lo = _mm512_add_epi64(lo, _mm512_slli_epi64(hi, 32));
+	lo = _mm512_add_epi64(lo, coeffs.add);
+
+	// Round ties to even: ties have a fractional part below the threshold.
+	__m512i y = _mm512_srl_epi64(lo, coeffs.shift);
+	__m512i tie = _mm512_srli_epi64(_mm512_sub_epi64(_mm512_and_si512(lo, coeffs.frac_mask), coeffs.tie), 63);
+	tie = _mm512_and_si512(tie, _mm512_xor_si512(y, coeffs.parity));
+	return _mm512_sub_epi64(y, tie);
+}
+
+inline FORCE_INLINE __m512i integer_convert_load16(const uint8_t *ptr)
+{
+	return _mm512_cvtepu8_epi32(_mm_load_si128((const __m128i *)ptr));
+}
+
+inline FORCE_INLINE __m512i integer_convert_load16(const uint16_t *ptr)
+{
+	return _mm512_cvtepu16_epi32(_mm256_load_si256((const __m256i *)ptr));
+}
+
+// Convert 16 pixels, returning clamped 32-bit results.
+template <class T>
+inline FORCE_INLINE __m512i integer_convert_avx512_xiter(unsigned j, const T *src_p, const IntegerConvertCoeffs &coeffs)
+{
+	__m512i x = integer_convert_load16(src_p + j);
+	__m512i even = integer_convert_epi64(x, coeffs);
+	__m512i odd = integer_convert_epi64(_mm512_srli_epi64(x, 32), coeffs);
+
+	x = _mm512_or_si512(even, _mm512_slli_epi64(odd, 32));
+	x = _mm512_sub_epi32(x, coeffs.bias);
+	x = _mm512_max_epi32(x, _mm512_setzero_si512());
+	x = _mm512_min_epi32(x, coeffs.max);
+	return x;
+}
+
+struct StoreU8 {
+	typedef uint8_t dst_type;
+
+	static void mask_store16(uint8_t *ptr, __mmask16 mask, __m512i x)
+	{
+		_mm_mask_storeu_epi8(ptr, mask, _mm512_cvtepi32_epi8(x));
+	}
+};
+
+struct StoreU16 {
+	typedef uint16_t dst_type;
+
+	static void mask_store16(uint16_t *ptr, __mmask16 mask, __m512i x)
+	{
+		_mm256_mask_storeu_epi16(ptr, mask, _mm512_cvtepi32_epi16(x));
+	}
+};
+
+template <class T, class Store>
+inline FORCE_INLINE void integer_convert_avx512_impl(const void *src, void *dst, const IntegerConvertParams &params, unsigned left, unsigned right)
+{
+	const T *src_p = static_cast<const T *>(src);
+	typename Store::dst_type *dst_p = static_cast<typename Store::dst_type *>(dst);
+
+	unsigned vec_left = ceil_n(left, 16);
+	unsigned vec_right = floor_n(right, 16);
+
+	const IntegerConvertCoeffs coeffs{ params };
+
+	if (left != vec_left) {
+		__m512i x = integer_convert_avx512_xiter(vec_left - 16, src_p, coeffs);
+		Store::mask_store16(dst_p + vec_left - 16, mmask16_set_hi(vec_left - left), x);
+	}
+
+	for (unsigned j = vec_left; j < vec_right; j += 16) {
+		__m512i x = integer_convert_avx512_xiter(j, src_p, coeffs);
+		Store::mask_store16(dst_p + j, 0xFFFFU, x);
+	}
+
+	if (right != vec_right) {
+		__m512i x = integer_convert_avx512_xiter(vec_right, src_p, coeffs);
+		Store::mask_store16(dst_p + vec_right, mmask16_set_lo(right - vec_right), x);
+	}
+}
+
+inline FORCE_INLINE __m512i left_shift_load32(const uint8_t *ptr)
+{
+	return _mm512_cvtepu8_epi16(_mm256_load_si256((const __m256i *)ptr));
+}
+
+inline FORCE_INLINE __m512i left_shift_load32(const uint16_t *ptr)
+{
+	return _mm512_load_si512(ptr);
+}
+
+struct LeftShiftStoreU8 {
+	typedef uint8_t dst_type;
+
+	static void mask_store32(uint8_t *ptr, __mmask32 mask, __m512i x)
+	{
+		_mm256_mask_storeu_epi8(ptr, mask, _mm512_cvtepi16_epi8(x));
+	}
+};
+
+struct LeftShiftStoreU16 {
+	typedef uint16_t dst_type;
+
+	static void mask_store32(uint16_t *ptr, __mmask32 mask, __m512i x)
+	{
+		_mm512_mask_storeu_epi16(ptr, mask, x);
+	}
+};
+
+template <class T, class Store>
+inline FORCE_INLINE void left_shift_avx512_impl(const void *src, void *dst, unsigned shift, unsigned left, unsigned right)
+{
+	const T *src_p = static_cast<const T *>(src);
+	typename Store::dst_type *dst_p = static_cast<typename Store::dst_type *>(dst);
+
+	unsigned vec_left = ceil_n(left, 32);
+	unsigned vec_right = floor_n(right, 32);
+
+	const __m128i count = _mm_set1_epi64x(shift);
+
+	if (left != vec_left) {
+		__m512i x = _mm512_sll_epi16(left_shift_load32(src_p + vec_left - 32), count);
+		Store::mask_store32(dst_p + vec_left - 32, mmask32_set_hi(vec_left - left), x);
+	}
+
+	for (unsigned j = vec_left; j < vec_right; j += 32) {
+		__m512i x = _mm512_sll_epi16(left_shift_load32(src_p + j), count);
+		Store::mask_store32(dst_p + j, 0xFFFFFFFFU, x);
+	}
+
+	if (right != vec_right) {
+		__m512i x = _mm512_sll_epi16(left_shift_load32(src_p + vec_right), count);
+		Store::mask_store32(dst_p + vec_right, mmask32_set_lo(right - vec_right), x);
+	}
+}
+
 } // namespace
 
 
+void left_shift_b2b_avx512(const void *src, void *dst, unsigned shift, unsigned left, unsigned right)
+{
+	left_shift_avx512_impl<uint8_t, LeftShiftStoreU8>(src, dst, shift, left, right);
+}
+
+void left_shift_b2w_avx512(const void *src, void *dst, unsigned shift, unsigned left, unsigned right)
+{
+	left_shift_avx512_impl<uint8_t, LeftShiftStoreU16>(src, dst, shift, left, right);
+}
+
+void left_shift_w2b_avx512(const void *src, void *dst, unsigned shift, unsigned left, unsigned right)
+{
+	left_shift_avx512_impl<uint16_t, LeftShiftStoreU8>(src, dst, shift, left, right);
+}
+
+void left_shift_w2w_avx512(const void *src, void *dst, unsigned shift, unsigned left, unsigned right)
+{
+	left_shift_avx512_impl<uint16_t, LeftShiftStoreU16>(src, dst, shift, left, right);
+}
+
+void integer_convert_b2b_avx512(const void *src, void *dst, const IntegerConvertParams &params, unsigned left, unsigned right)
+{
+	integer_convert_avx512_impl<uint8_t, StoreU8>(src, dst, params, left, right);
+}
+
+void integer_convert_b2w_avx512(const void *src, void *dst, const IntegerConvertParams &params, unsigned left, unsigned right)
+{
+	integer_convert_avx512_impl<uint8_t, StoreU16>(src, dst, params, left, right);
+}
+
+void integer_convert_w2b_avx512(const void *src, void *dst, const IntegerConvertParams &params, unsigned left, unsigned right)
+{
+	integer_convert_avx512_impl<uint16_t, StoreU8>(src, dst, params, left, right);
+}
+
+void integer_convert_w2w_avx512(const void *src, void *dst, const IntegerConvertParams &params, unsigned left, unsigned right)
+{
+	integer_convert_avx512_impl<uint16_t, StoreU16>(src, dst, params, left, right);
+}
+
 void depth_convert_b2h_avx512(const void *src, void *dst, float scale, float offset, unsigned left, unsigned right)
 {
 	depth_convert_avx512_impl<LoadU8, StoreF16>(src, dst, scale, offset, left, right);
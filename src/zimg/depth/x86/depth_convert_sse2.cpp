@@ -90,6 +90,180 @@ inline FORCE_INLINE void depth_convert_w2f_sse2_xiter(unsigned j, const uint16_t
 	hi_out = hi;
 }
 
+struct IntegerConvertCoeffs {
+	__m128i mul_lo;
+	__m128i mul_hi;
+	__m128i add;
+	__m128i frac_mask;
+	__m128i tie;
+	__m128i parity;
+	__m128i shift;
+	__m128i bias;
+
+	explicit IntegerConvertCoeffs(const IntegerConvertParams &params) :
+		mul_lo{ _mm_set1_epi64x(params.mul & 0xFFFFFFFFU) },
+		mul_hi{ _mm_set1_epi64x(params.mul >> 32) },
+		add{ _mm_set1_epi64x(params.add) },
+		frac_mask{ _mm_set1_epi64x((UINT64_C(1) << params.shift) - 1) },
+		tie{ _mm_set1_epi64x(params.tie) },
+		parity{ _mm_set1_epi64x(params.bias & 1) },
+		shift{ _mm_set1_epi64x(params.shift) },
+		bias{ _mm_set1_epi32(params.bias) }
+	{}
+};
+
+// Apply fixed-point conversion to the low 32 bits of each 64-bit element.
+inline FORCE_INLINE __m128i integer_convert_epi64(__m128i x, const IntegerConvertCoeffs &coeffs)
+{
+	__m128i lo = _mm_mul_epu32(x, coeffs.mul_lo);
+	__m128i hi = _mm_mul_epu32(x, coeffs.mul_hi);
+
+	lo = _mm_add_epi64(lo, _mm_slli_epi64(hi, 32));
+	lo = _mm_add_epi64(lo, coeffs.add);
+
+	// Round ties to even: ties have a fractional part below the threshold.
+	__m128i y = _mm_srl_epi64(lo, coeffs.shift);
+	__m128i tie = _mm_srli_epi64(_mm_sub_epi64(_mm_and_si128(lo, coeffs.frac_mask), coeffs.tie), 63);
+	tie = _mm_and_si128(tie, _mm_xor_si128(y, coeffs.parity));
+	return _mm_sub_epi64(y, tie);
+}
+
+// Apply fixed-point conversion to unsigned 32-bit elements, producing unclamped signed 32-bit results.
+inline FORCE_INLINE __m128i integer_convert_epi32(__m128i x, const IntegerConvertCoeffs &coeffs)
+{
+	__m128i even = integer_convert_epi64(x, coeffs);
+	__m128i odd = integer_convert_epi64(_mm_srli_epi64(x, 32), coeffs);
+
+	x = _mm_or_si128(even, _mm_slli_epi64(odd, 32));
+	return _mm_sub_epi32(x, coeffs.bias);
+}
+
+inline FORCE_INLINE void integer_convert_epu16(__m128i x, const IntegerConvertCoeffs &coeffs, __m128i &lo, __m128i &hi)
+{
+	lo = integer_convert_epi32(_mm_unpacklo_epi16(x, _mm_setzero_si128()), coeffs);
+	hi = integer_convert_epi32(_mm_unpackhi_epi16(x, _mm_setzero_si128()), coeffs);
+}
+
+inline FORCE_INLINE void integer_convert_sse2_xiter(unsigned j, const uint8_t *src_p, const IntegerConvertCoeffs &coeffs,
+                                                    __m128i &lolo, __m128i &lohi, __m128i &hilo, __m128i &hihi)
+{
+	__m128i x = _mm_load_si128((const __m128i *)(src_p + j));
+
+	integer_convert_epu16(_mm_unpacklo_epi8(x, _mm_setzero_si128()), coeffs, lolo, lohi);
+	integer_convert_epu16(_mm_unpackhi_epi8(x, _mm_setzero_si128()), coeffs, hilo, hihi);
+}
+
+inline FORCE_INLINE void integer_convert_sse2_xiter(unsigned j, const uint16_t *src_p, const IntegerConvertCoeffs &coeffs,
+                                                    __m128i &lolo, __m128i &lohi, __m128i &hilo, __m128i &hihi)
+{
+	integer_convert_epu16(_mm_load_si128((const __m128i *)(src_p + j + 0)), coeffs, lolo, lohi);
+	integer_convert_epu16(_mm_load_si128((const __m128i *)(src_p + j + 8)), coeffs, hilo, hihi);
+}
+
+// Saturated convert signed 32-bit to unsigned 16-bit, clamped to [max].
+inline FORCE_INLINE __m128i integer_convert_pack_epu16(__m128i lo, __m128i hi, __m128i max_bias)
+{
+	const __m128i i16_min_epi16 = _mm_set1_epi16(INT16_MIN);
+
+	__m128i x = mm_packus_epi32_bias(lo, hi);
+	x = _mm_min_epi16(x, max_bias);
+	return _mm_sub_epi16(x, i16_min_epi16);
+}
+
+template <class T>
+inline FORCE_INLINE void integer_convert_to_byte_sse2(const void *src, void *dst, const IntegerConvertParams &params, unsigned left, unsigned right)
+{
+	const T *src_p = static_cast<const T *>(src);
+	uint8_t *dst_p = static_cast<uint8_t *>(dst);
+
+	unsigned vec_left = ceil_n(left, 16);
+	unsigned vec_right = floor_n(right, 16);
+
+	const IntegerConvertCoeffs coeffs{ params };
+	const __m128i max_epi8 = _mm_set1_epi8(static_cast<uint8_t>(params.max));
+
+	__m128i lolo, lohi, hilo, hihi, x;
+
+#define XITER integer_convert_sse2_xiter
+#define XARGS src_p, coeffs, lolo, lohi, hilo, hihi
+#define XPACK() _mm_min_epu8(_mm_packus_epi16(_mm_packs_epi32(lolo, lohi), _mm_packs_epi32(hilo, hihi)), max_epi8)
+	if (left != vec_left) {
+		XITER(vec_left - 16, XARGS);
+		x = XPACK();
+		mm_store_idxhi_epi8((__m128i *)(dst_p + vec_left - 16), x, left % 16);
+	}
+
+	for (unsigned j = vec_left; j < vec_right; j += 16) {
+		XITER(j, XARGS);
+		x = XPACK();
+		_mm_store_si128((__m128i *)(dst_p + j), x);
+	}
+
+	if (right != vec_right) {
+		XITER(vec_right, XARGS);
+		x = XPACK();
+		mm_store_idxlo_epi8((__m128i *)(dst_p + vec_right), x, right % 16);
+	}
+#undef XITER
+#undef XARGS
+#undef XPACK
+}
+
+template <class T>
+inline FORCE_INLINE void integer_convert_to_word_sse2(const void *src, void *dst, const IntegerConvertParams &params, unsigned left, unsigned right)
+{
+	const T *src_p = static_cast<const T *>(src);
+	uint16_t *dst_p = static_cast<uint16_t *>(dst);
+
+	unsigned vec_left = ceil_n(left, 16);
+	unsigned vec_right = floor_n(right, 16);
+
+	const IntegerConvertCoeffs coeffs{ params };
+	const __m128i max_bias = _mm_set1_epi16(static_cast<int16_t>(params.max + INT16_MIN));
+
+	__m128i lolo, lohi, hilo, hihi, lo, hi;
+
+#define XITER integer_convert_sse2_xiter
+#define XARGS src_p, coeffs, lolo, lohi, hilo, hihi
+	if (left != vec_left) {
+		XITER(vec_left - 16, XARGS);
+		lo = integer_convert_pack_epu16(lolo, lohi, max_bias);
+		hi = integer_convert_pack_epu16(hilo, hihi, max_bias);
+
+		if (vec_left - left > 8) {
+			mm_store_idxhi_epi16((__m128i *)(dst_p + vec_left - 16), lo, left % 8);
+			_mm_store_si128((__m128i *)(dst_p + vec_left - 8), hi);
+		} else {
+			mm_store_idxhi_epi16((__m128i *)(dst_p + vec_left - 8), hi, left % 8);
+		}
+	}
+
+	for (unsigned j = vec_left; j < vec_right; j += 16) {
+		XITER(j, XARGS);
+		lo = integer_convert_pack_epu16(lolo, lohi, max_bias);
+		hi = integer_convert_pack_epu16(hilo, hihi, max_bias);
+
+		_mm_store_si128((__m128i *)(dst_p + j + 0), lo);
+		_mm_store_si128((__m128i *)(dst_p + j + 8), hi);
+	}
+
+	if (right != vec_right) {
+		XITER(vec_right, XARGS);
+		lo = integer_convert_pack_epu16(lolo, lohi, max_bias);
+		hi = integer_convert_pack_epu16(hilo, hihi, max_bias);
+
+		if (right - vec_right > 8) {
+			_mm_store_si128((__m128i *)(dst_p + vec_right), lo);
+			mm_store_idxlo_epi16((__m128i *)(dst_p + vec_right + 8), hi, right % 8);
+		} else {
+			// Modulo does not handle the case where there are exactly 8 remaining pixels.
+			mm_store_idxlo_epi16((__m128i *)(dst_p + vec_right), lo, right - vec_right);
+		}
+	}
+#undef XITER
+#undef XARGS
+}
+
 } // namespace
 
 
@@ -242,6 +416,26 @@ void left_shift_w2w_sse2(const void *src, void *dst, unsigned shift, unsigned le
 	}
 }
 
+void integer_convert_b2b_sse2(const void *src, void *dst, const IntegerConvertParams &params, unsigned left, unsigned right)
+{
+	integer_convert_to_byte_sse2<uint8_t>(src, dst, params, left, right);
+}
+
+void integer_convert_b2w_sse2(const void *src, void *dst, const IntegerConvertParams &params, unsigned left, unsigned right)
+{
+	integer_convert_to_word_sse2<uint8_t>(src, dst, params, left, right);
+}
+
+void integer_convert_w2b_sse2(const void *src, void *dst, const IntegerConvertParams &params, unsigned left, unsigned right)
+{
+	integer_convert_to_byte_sse2<uint16_t>(src, dst, params, left, right);
+}
+
+void integer_convert_w2w_sse2(const void *src, void *dst, const IntegerConvertParams &params, unsigned left, unsigned right)
+{
+	integer_convert_to_word_sse2<uint16_t>(src, dst, params, left, right);
+}
+
 void depth_convert_b2f_sse2(const void *src, void *dst, float scale, float offset, unsigned left, unsigned right)
 {
 	const uint8_t *src_p = static_cast<const uint8_t *>(src);
@@ -12,6 +12,8 @@ namespace depth {
 
 #define DECLARE_LEFT_SHIFT(x, cpu) \
 void left_shift_##x##_##cpu(const void *src, void *dst, unsigned shift, unsigned left, unsigned right)
+#define DECLARE_INTEGER_CONVERT(x, cpu) \
+void integer_convert_##x##_##cpu(const void *src, void *dst, const IntegerConvertParams &params, unsigned left, unsigned right)
 #define DECLARE_DEPTH_CONVERT(x, cpu) \
 void depth_convert_##x##_##cpu(const void *src, void *dst, float scale, float offset, unsigned left, unsigned right)
 
@@ -19,6 +21,27 @@ DECLARE_LEFT_SHIFT(b2b, sse2);
 DECLARE_LEFT_SHIFT(b2w, sse2);
 DECLARE_LEFT_SHIFT(w2b, sse2);
 DECLARE_LEFT_SHIFT(w2w, sse2);
+DECLARE_LEFT_SHIFT(b2b, avx2);
+DECLARE_LEFT_SHIFT(b2w, avx2);
+DECLARE_LEFT_SHIFT(w2b, avx2);
+DECLARE_LEFT_SHIFT(w2w, avx2);
+DECLARE_LEFT_SHIFT(b2b, avx512);
+DECLARE_LEFT_SHIFT(b2w, avx512);
+DECLARE_LEFT_SHIFT(w2b, avx512);
+DECLARE_LEFT_SHIFT(w2w, avx512);
+
+DECLARE_INTEGER_CONVERT(b2b, sse2);
+DECLARE_INTEGER_CONVERT(b2w, sse2);
+DECLARE_INTEGER_CONVERT(w2b, sse2);
+DECLARE_INTEGER_CONVERT(w2w, sse2);
+DECLARE_INTEGER_CONVERT(b2b, avx2);
+DECLARE_INTEGER_CONVERT(b2w, avx2);
+DECLARE_INTEGER_CONVERT(w2b, avx2);
+DECLARE_INTEGER_CONVERT(w2w, avx2);
+DECLARE_INTEGER_CONVERT(b2b, avx512);
+DECLARE_INTEGER_CONVERT(b2w, avx512);
+DECLARE_INTEGER_CONVERT(w2b, avx512);
+DECLARE_INTEGER_CONVERT(w2w, avx512);
 
 DECLARE_DEPTH_CONVERT(b2f, sse2);
 DECLARE_DEPTH_CONVERT(w2f, sse2);
@@ -32,10 +55,13 @@ DECLARE_DEPTH_CONVERT(w2h, avx512);
 DECLARE_DEPTH_CONVERT(w2f, avx512);
 
 #undef DECLARE_LEFT_SHIFT
+#undef DECLARE_INTEGER_CONVERT
 #undef DECLARE_DEPTH_CONVERT
 
 left_shift_func select_left_shift_func_x86(PixelType pixel_in, PixelType pixel_out, CPUClass cpu);
 
+integer_convert_func select_integer_convert_func_x86(PixelType pixel_in, PixelType pixel_out, CPUClass cpu);
+
 depth_convert_func select_depth_convert_func_x86(const PixelFormat &format_in, const PixelFormat &format_out, CPUClass cpu);
 
 depth_f16c_func select_depth_f16c_func_x86(bool to_half, CPUClass cpu);
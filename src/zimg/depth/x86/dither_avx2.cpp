@@ -152,6 +152,71 @@ inline FORCE_INLINE void ordered_dither_avx2_impl(const float *dither, unsigned
 #undef XARGS
 }
 
+inline FORCE_INLINE __m256i quantize_avx2_xiter(__m256 lo, __m256 hi, const __m256 &scale, const __m256 &offset, const __m256i &out_max)
+{
+	__m256i x;
+
+	lo = _mm256_fmadd_ps(scale, lo, offset);
+	hi = _mm256_fmadd_ps(scale, hi, offset);
+
+	x = mm256_cvt2ps_epu16(lo, hi);
+	x = _mm256_min_epu16(x, out_max);
+
+	return x;
+}
+
+template <class Load, class Store>
+inline FORCE_INLINE void quantize_avx2_impl(const void *src, void *dst, float scale, float offset, unsigned bits, unsigned left, unsigned right)
+{
+	const typename Load::type *src_p = static_cast<const typename Load::type *>(src);
+	typename Store::type *dst_p = static_cast<typename Store::type *>(dst);
+
+	unsigned vec_left = ceil_n(left, 16);
+	unsigned vec_right = floor_n(right, 16);
+
+	const __m256 scale_ps = _mm256_set1_ps(scale);
+	const __m256 offset_ps = _mm256_set1_ps(offset);
+	const __m256i out_max = _mm256_set1_epi16(static_cast<uint16_t>((1 << bits) - 1));
+
+#define XARGS scale_ps, offset_ps, out_max
+	if (left != vec_left) {
+		__m256 lo = Load::load8(src_p + vec_left - 16 + 0);
+		__m256 hi = Load::load8(src_p + vec_left - 16 + 8);
+		__m256i x = quantize_avx2_xiter(lo, hi, XARGS);
+		Store::store16_idxhi(dst_p + vec_left - 16, x, left % 16);
+	}
+	for (unsigned j = vec_left; j < vec_right; j += 16) {
+		__m256 lo = Load::load8(src_p + j + 0);
+		__m256 hi = Load::load8(src_p + j + 8);
+		__m256i x = quantize_avx2_xiter(lo, hi, XARGS);
+		Store::store16(dst_p + j, x);
+	}
+	if (right != vec_right) {
+		__m256 lo = Load::load8(src_p + vec_right + 0);
+		__m256 hi = Load::load8(src_p + vec_right + 8);
+		__m256i x = quantize_avx2_xiter(lo, hi, XARGS);
+		Store::store16_idxlo(dst_p + vec_right, x, right % 16);
+	}
+#undef XARGS
+}
+
+inline FORCE_INLINE __m256 random_dither_noise_avx2_xiter(__m256i col, __m256i key)
+{
+	const __m256i mul1 = _mm256_set1_epi32(static_cast<int32_t>(RANDOM_DITHER_MUL1));
+	const __m256i mul2 = _mm256_set1_epi32(static_cast<int32_t>(RANDOM_DITHER_MUL2));
+
+	__m256i x = _mm256_xor_si256(col, key);
+	x = _mm256_xor_si256(x, _mm256_srli_epi32(x, 16));
+	x = _mm256_mullo_epi32(x, mul1);
+	x = _mm256_xor_si256(x, _mm256_srli_epi32(x, 15));
+	x = _mm256_mullo_epi32(x, mul2);
+	x = _mm256_xor_si256(x, _mm256_srli_epi32(x, 16));
+
+	__m256 f = _mm256_cvtepi32_ps(_mm256_srli_epi32(x, 8));
+	f = _mm256_sub_ps(f, _mm256_set1_ps(RANDOM_DITHER_BIAS));
+	return _mm256_mul_ps(f, _mm256_set1_ps(RANDOM_DITHER_SCALE));
+}
+
 } // namespace
 
 
@@ -203,6 +268,37 @@ void ordered_dither_f2w_avx2(const float *dither, unsigned dither_offset, unsign
 	ordered_dither_avx2_impl<LoadF32, StoreU16>(dither, dither_offset, dither_mask, src, dst, scale, offset, bits, left, right);
 }
 
+void quantize_h2b_avx2(const void *src, void *dst, float scale, float offset, unsigned bits, unsigned left, unsigned right)
+{
+	quantize_avx2_impl<LoadF16, StoreU8>(src, dst, scale, offset, bits, left, right);
+}
+
+void quantize_h2w_avx2(const void *src, void *dst, float scale, float offset, unsigned bits, unsigned left, unsigned right)
+{
+	quantize_avx2_impl<LoadF16, StoreU16>(src, dst, scale, offset, bits, left, right);
+}
+
+void quantize_f2b_avx2(const void *src, void *dst, float scale, float offset, unsigned bits, unsigned left, unsigned right)
+{
+	quantize_avx2_impl<LoadF32, StoreU8>(src, dst, scale, offset, bits, left, right);
+}
+
+void quantize_f2w_avx2(const void *src, void *dst, float scale, float offset, unsigned bits, unsigned left, unsigned right)
+{
+	quantize_avx2_impl<LoadF32, StoreU16>(src, dst, scale, offset, bits, left, right);
+}
+
+void random_dither_noise_avx2(float *dst, uint32_t key, unsigned col, unsigned n)
+{
+	__m256i key_epi32 = _mm256_set1_epi32(static_cast<int32_t>(key));
+	__m256i col_epi32 = _mm256_add_epi32(_mm256_set1_epi32(static_cast<int32_t>(col)), _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+
+	for (unsigned j = 0; j < n; j += 8) {
+		_mm256_store_ps(dst + j, random_dither_noise_avx2_xiter(col_epi32, key_epi32));
+		col_epi32 = _mm256_add_epi32(col_epi32, _mm256_set1_epi32(8));
+	}
+}
+
 } // namespace depth
 } // namespace zimg
 
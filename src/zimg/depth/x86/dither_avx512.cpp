@@ -118,6 +118,72 @@ inline FORCE_INLINE void ordered_dither_avx512_impl(const float *dither, unsigne
 #undef XARGS
 }
 
+inline FORCE_INLINE __m512i quantize_avx512_xiter(__m512 x, const __m512 &scale, const __m512 &offset, const __m512i &out_max)
+{
+	__m512i out;
+
+	x = _mm512_fmadd_ps(scale, x, offset);
+	out = _mm512_cvtps_epi32(x);
+	out = _mm512_min_epi32(out, out_max);
+	out = _mm512_max_epi32(out, _mm512_setzero_si512());
+
+	return out;
+}
+
+template <class Load, class Store>
+inline FORCE_INLINE void quantize_avx512_impl(const void *src, void *dst, float scale, float offset, unsigned bits, unsigned left, unsigned right)
+{
+	const typename Load::type *src_p = static_cast<const typename Load::type *>(src);
+	typename Store::type *dst_p = static_cast<typename Store::type *>(dst);
+
+	unsigned vec_left = ceil_n(left, 16);
+	unsigned vec_right = floor_n(right, 16);
+
+	const __m512 scale_ps = _mm512_set1_ps(scale);
+	const __m512 offset_ps = _mm512_set1_ps(offset);
+	const __m512i out_max = _mm512_set1_epi32((1 << bits) - 1);
+
+#define XARGS scale_ps, offset_ps, out_max
+	if (left != vec_left) {
+		__m512 x = Load::load16(src_p + vec_left - 16);
+		__m512i out = quantize_avx512_xiter(x, XARGS);
+
+		Store::mask_store16(dst_p + vec_left - 16, mmask16_set_hi(vec_left - left), out);
+	}
+
+	for (unsigned j = vec_left; j < vec_right; j += 16) {
+		__m512 x = Load::load16(src_p + j);
+		__m512i out = quantize_avx512_xiter(x, XARGS);
+
+		Store::mask_store16(dst_p + j, 0xFFFFU, out);
+	}
+
+	if (right != vec_right) {
+		__m512 x = Load::load16(src_p + vec_right);
+		__m512i out = quantize_avx512_xiter(x, XARGS);
+
+		Store::mask_store16(dst_p + vec_right, mmask16_set_lo(right - vec_right), out);
+	}
+#undef XARGS
+}
+
+inline FORCE_INLINE __m512 random_dither_noise_avx512_xiter(__m512i col, __m512i key)
+{
+	const __m512i mul1 = _mm512_set1_epi32(static_cast<int32_t>(RANDOM_DITHER_MUL1));
+	const __m512i mul2 = _mm512_set1_epi32(static_cast<int32_t>(RANDOM_DITHER_MUL2));
+
+	__m512i x = _mm512_xor_si512(col, key);
+	x = _mm512_xor_si512(x, _mm512_srli_epi32(x, 16));
+	x = _mm512_mullo_epi32(x, mul1);
+	x = _mm512_xor_si512(x, _mm512_srli_epi32(x, 15));
+	x = _mm512_mullo_epi32(x, mul2);
+	x = _mm512_xor_si512(x, _mm512_srli_epi32(x, 16));
+
+	__m512 f = _mm512_cvtepi32_ps(_mm512_srli_epi32(x, 8));
+	f = _mm512_sub_ps(f, _mm512_set1_ps(RANDOM_DITHER_BIAS));
+	return _mm512_mul_ps(f, _mm512_set1_ps(RANDOM_DITHER_SCALE));
+}
+
 } // namespace
 
 
@@ -169,6 +235,38 @@ void ordered_dither_f2w_avx512(const float *dither, unsigned dither_offset, unsi
 	ordered_dither_avx512_impl<LoadF32, StoreU16>(dither, dither_offset, dither_mask, src, dst, scale, offset, bits, left, right);
 }
 
+void quantize_h2b_avx512(const void *src, void *dst, float scale, float offset, unsigned bits, unsigned left, unsigned right)
+{
+	quantize_avx512_impl<LoadF16, StoreU8>(src, dst, scale, offset, bits, left, right);
+}
+
+void quantize_h2w_avx512(const void *src, void *dst, float scale, float offset, unsigned bits, unsigned left, unsigned right)
+{
+	quantize_avx512_impl<LoadF16, StoreU16>(src, dst, scale, offset, bits, left, right);
+}
+
+void quantize_f2b_avx512(const void *src, void *dst, float scale, float offset, unsigned bits, unsigned left, unsigned right)
+{
+	quantize_avx512_impl<LoadF32, StoreU8>(src, dst, scale, offset, bits, left, right);
+}
+
+void quantize_f2w_avx512(const void *src, void *dst, float scale, float offset, unsigned bits, unsigned left, unsigned right)
+{
+	quantize_avx512_impl<LoadF32, StoreU16>(src, dst, scale, offset, bits, left, right);
+}
+
+void random_dither_noise_avx512(float *dst, uint32_t key, unsigned col, unsigned n)
+{
+	__m512i key_epi32 = _mm512_set1_epi32(static_cast<int32_t>(key));
+	__m512i col_epi32 = _mm512_add_epi32(_mm512_set1_epi32(static_cast<int32_t>(col)),
+	                                     _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15));
+
+	for (unsigned j = 0; j < n; j += 16) {
+		_mm512_store_ps(dst + j, random_dither_noise_avx512_xiter(col_epi32, key_epi32));
+		col_epi32 = _mm512_add_epi32(col_epi32, _mm512_set1_epi32(16));
+	}
+}
+
 } // namespace depth
 } // namespace zimg
 
@@ -265,6 +265,71 @@ inline FORCE_INLINE __m128i ordered_dither_f2w_sse2_xiter(unsigned j, const floa
 	return x;
 }
 
+inline FORCE_INLINE __m128i quantize_f2b_sse2_xiter(unsigned j, const float *src_p, __m128 scale, __m128 offset, __m128i out_max)
+{
+	__m128 lolo = _mm_load_ps(src_p + j + 0);
+	__m128 lohi = _mm_load_ps(src_p + j + 4);
+	__m128 hilo = _mm_load_ps(src_p + j + 8);
+	__m128 hihi = _mm_load_ps(src_p + j + 12);
+	__m128i x;
+
+	lolo = _mm_add_ps(_mm_mul_ps(lolo, scale), offset);
+	lohi = _mm_add_ps(_mm_mul_ps(lohi, scale), offset);
+	hilo = _mm_add_ps(_mm_mul_ps(hilo, scale), offset);
+	hihi = _mm_add_ps(_mm_mul_ps(hihi, scale), offset);
+
+	x = mm_cvtps_epu8(lolo, lohi, hilo, hihi);
+	x = _mm_min_epu8(x, out_max);
+
+	return x;
+}
+
+inline FORCE_INLINE __m128i quantize_f2w_sse2_xiter(unsigned j, const float *src_p, __m128 scale, __m128 offset, __m128i out_max)
+{
+	const __m128i i16_min_epi16 = _mm_set1_epi16(INT16_MIN);
+
+	__m128 lo = _mm_load_ps(src_p + j + 0);
+	__m128 hi = _mm_load_ps(src_p + j + 4);
+	__m128i x;
+
+	lo = _mm_add_ps(_mm_mul_ps(lo, scale), offset);
+	hi = _mm_add_ps(_mm_mul_ps(hi, scale), offset);
+
+	x = mm_cvtps_epu16_bias(lo, hi);
+	x = _mm_min_epi16(x, out_max);
+	x = _mm_sub_epi16(x, i16_min_epi16);
+
+	return x;
+}
+
+// Multiply packed 32-bit integers, keeping the low half. SSE2 lacks PMULLD.
+inline FORCE_INLINE __m128i mm_mullo_epi32(__m128i a, __m128i b)
+{
+	__m128i even = _mm_mul_epu32(a, b);
+	__m128i odd = _mm_mul_epu32(_mm_srli_epi64(a, 32), _mm_srli_epi64(b, 32));
+
+	even = _mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0));
+	odd = _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0));
+	return _mm_unpacklo_epi32(even, odd);
+}
+
+inline FORCE_INLINE __m128 random_dither_noise_sse2_xiter(__m128i col, __m128i key)
+{
+	const __m128i mul1 = _mm_set1_epi32(static_cast<int32_t>(RANDOM_DITHER_MUL1));
+	const __m128i mul2 = _mm_set1_epi32(static_cast<int32_t>(RANDOM_DITHER_MUL2));
+
+	__m128i x = _mm_xor_si128(col, key);
+	x = _mm_xor_si128(x, _mm_srli_epi32(x, 16));
+	x = mm_mullo_epi32(x, mul1);
+	x = _mm_xor_si128(x, _mm_srli_epi32(x, 15));
+	x = mm_mullo_epi32(x, mul2);
+	x = _mm_xor_si128(x, _mm_srli_epi32(x, 16));
+
+	__m128 f = _mm_cvtepi32_ps(_mm_srli_epi32(x, 8));
+	f = _mm_sub_ps(f, _mm_set1_ps(RANDOM_DITHER_BIAS));
+	return _mm_mul_ps(f, _mm_set1_ps(RANDOM_DITHER_SCALE));
+}
+
 } // namespace
 
 
@@ -483,6 +548,81 @@ void ordered_dither_f2w_sse2(const float *dither, unsigned dither_offset, unsign
 #undef XARGS
 }
 
+void quantize_f2b_sse2(const void *src, void *dst, float scale, float offset, unsigned bits, unsigned left, unsigned right)
+{
+	const float *src_p = static_cast<const float *>(src);
+	uint8_t *dst_p = static_cast<uint8_t *>(dst);
+
+	unsigned vec_left = ceil_n(left, 16);
+	unsigned vec_right = floor_n(right, 16);
+
+	const __m128 scale_ps = _mm_set_ps1(scale);
+	const __m128 offset_ps = _mm_set_ps1(offset);
+	const __m128i out_max = _mm_set1_epi8(static_cast<uint8_t>((1 << bits) - 1));
+
+#define XITER quantize_f2b_sse2_xiter
+#define XARGS src_p, scale_ps, offset_ps, out_max
+	if (left != vec_left) {
+		__m128i x = XITER(vec_left - 16, XARGS);
+		mm_store_idxhi_epi8((__m128i *)(dst_p + vec_left - 16), x, left % 16);
+	}
+
+	for (unsigned j = vec_left; j < vec_right; j += 16) {
+		__m128i x = XITER(j, XARGS);
+		_mm_store_si128((__m128i *)(dst_p + j), x);
+	}
+
+	if (right != vec_right) {
+		__m128i x = XITER(vec_right, XARGS);
+		mm_store_idxlo_epi8((__m128i *)(dst_p + vec_right), x, right % 16);
+	}
+#undef XITER
+#undef XARGS
+}
+
+void quantize_f2w_sse2(const void *src, void *dst, float scale, float offset, unsigned bits, unsigned left, unsigned right)
+{
+	const float *src_p = static_cast<const float *>(src);
+	uint16_t *dst_p = static_cast<uint16_t *>(dst);
+
+	unsigned vec_left = ceil_n(left, 8);
+	unsigned vec_right = floor_n(right, 8);
+
+	const __m128 scale_ps = _mm_set_ps1(scale);
+	const __m128 offset_ps = _mm_set_ps1(offset);
+	const __m128i out_max = _mm_set1_epi16((int16_t)((1UL << bits) - 1) + INT16_MIN);
+
+#define XITER quantize_f2w_sse2_xiter
+#define XARGS src_p, scale_ps, offset_ps, out_max
+	if (left != vec_left) {
+		__m128i x = XITER(vec_left - 8, XARGS);
+		mm_store_idxhi_epi16((__m128i *)(dst_p + vec_left - 8), x, left % 8);
+	}
+
+	for (unsigned j = vec_left; j < vec_right; j += 8) {
+		__m128i x = XITER(j, XARGS);
+		_mm_store_si128((__m128i *)(dst_p + j), x);
+	}
+
+	if (right != vec_right) {
+		__m128i x = XITER(vec_right, XARGS);
+		mm_store_idxlo_epi16((__m128i *)(dst_p + vec_right), x, right % 8);
+	}
+#undef XITER
+#undef XARGS
+}
+
+void random_dither_noise_sse2(float *dst, uint32_t key, unsigned col, unsigned n)
+{
+	__m128i key_epi32 = _mm_set1_epi32(static_cast<int32_t>(key));
+	__m128i col_epi32 = _mm_add_epi32(_mm_set1_epi32(static_cast<int32_t>(col)), _mm_setr_epi32(0, 1, 2, 3));
+
+	for (unsigned j = 0; j < n; j += 4) {
+		_mm_store_ps(dst + j, random_dither_noise_sse2_xiter(col_epi32, key_epi32));
+		col_epi32 = _mm_add_epi32(col_epi32, _mm_set1_epi32(4));
+	}
+}
+
 } // namespace depth
 } // namespace zimg
 
@@ -3,6 +3,7 @@
 #include "common/cpuinfo.h"
 #include "common/pixel.h"
 #include "common/x86/cpuinfo_x86.h"
+#include "depth/depth.h"
 #include "graph/image_filter.h"
 #include "dither_x86.h"
 #include "f16c_x86.h"
@@ -79,6 +80,49 @@ dither_convert_func select_ordered_dither_func_avx512(PixelType pixel_in, PixelT
 }
 #endif
 
+quantize_func select_quantize_func_sse2(PixelType pixel_in, PixelType pixel_out)
+{
+	if (pixel_in == PixelType::HALF)
+		pixel_in = PixelType::FLOAT;
+
+	if (pixel_in == PixelType::FLOAT && pixel_out == PixelType::BYTE)
+		return quantize_f2b_sse2;
+	else if (pixel_in == PixelType::FLOAT && pixel_out == PixelType::WORD)
+		return quantize_f2w_sse2;
+	else
+		return nullptr;
+}
+
+quantize_func select_quantize_func_avx2(PixelType pixel_in, PixelType pixel_out)
+{
+	if (pixel_in == PixelType::HALF && pixel_out == PixelType::BYTE)
+		return quantize_h2b_avx2;
+	else if (pixel_in == PixelType::HALF && pixel_out == PixelType::WORD)
+		return quantize_h2w_avx2;
+	else if (pixel_in == PixelType::FLOAT && pixel_out == PixelType::BYTE)
+		return quantize_f2b_avx2;
+	else if (pixel_in == PixelType::FLOAT && pixel_out == PixelType::WORD)
+		return quantize_f2w_avx2;
+	else
+		return nullptr;
+}
+
+#ifdef ZIMG_X86_AVX512
+quantize_func select_quantize_func_avx512(PixelType pixel_in, PixelType pixel_out)
+{
+	if (pixel_in == PixelType::HALF && pixel_out == PixelType::BYTE)
+		return quantize_h2b_avx512;
+	else if (pixel_in == PixelType::HALF && pixel_out == PixelType::WORD)
+		return quantize_h2w_avx512;
+	else if (pixel_in == PixelType::FLOAT && pixel_out == PixelType::BYTE)
+		return quantize_f2b_avx512;
+	else if (pixel_in == PixelType::FLOAT && pixel_out == PixelType::WORD)
+		return quantize_f2w_avx512;
+	else
+		return nullptr;
+}
+#endif
+
 } // namespace
 
 
@@ -110,6 +154,62 @@ dither_convert_func select_ordered_dither_func_x86(const PixelFormat &pixel_in,
 	return func;
 }
 
+quantize_func select_quantize_func_x86(const PixelFormat &pixel_in, const PixelFormat &pixel_out, CPUClass cpu)
+{
+	X86Capabilities caps = query_x86_capabilities();
+	quantize_func func = nullptr;
+
+	if (cpu_is_autodetect(cpu)) {
+#ifdef ZIMG_X86_AVX512
+		if (!func && cpu == CPUClass::AUTO_64B && caps.avx512f && caps.avx512bw && caps.avx512vl)
+			func = select_quantize_func_avx512(pixel_in.type, pixel_out.type);
+#endif
+		if (!func && caps.avx2 && caps.fma)
+			func = select_quantize_func_avx2(pixel_in.type, pixel_out.type);
+		if (!func && caps.sse2)
+			func = select_quantize_func_sse2(pixel_in.type, pixel_out.type);
+	} else {
+#ifdef ZIMG_X86_AVX512
+		if (!func && cpu >= CPUClass::X86_AVX512)
+			func = select_quantize_func_avx512(pixel_in.type, pixel_out.type);
+#endif
+		if (!func && cpu >= CPUClass::X86_AVX2)
+			func = select_quantize_func_avx2(pixel_in.type, pixel_out.type);
+		if (!func && cpu >= CPUClass::X86_SSE2)
+			func = select_quantize_func_sse2(pixel_in.type, pixel_out.type);
+	}
+
+	return func;
+}
+
+dither_noise_func select_dither_noise_func_x86(CPUClass cpu)
+{
+	X86Capabilities caps = query_x86_capabilities();
+	dither_noise_func func = nullptr;
+
+	if (cpu_is_autodetect(cpu)) {
+#ifdef ZIMG_X86_AVX512
+		if (!func && cpu == CPUClass::AUTO_64B && caps.avx512f && caps.avx512bw && caps.avx512vl)
+			func = random_dither_noise_avx512;
+#endif
+		if (!func && caps.avx2)
+			func = random_dither_noise_avx2;
+		if (!func && caps.sse2)
+			func = random_dither_noise_sse2;
+	} else {
+#ifdef ZIMG_X86_AVX512
+		if (!func && cpu >= CPUClass::X86_AVX512)
+			func = random_dither_noise_avx512;
+#endif
+		if (!func && cpu >= CPUClass::X86_AVX2)
+			func = random_dither_noise_avx2;
+		if (!func && cpu >= CPUClass::X86_SSE2)
+			func = random_dither_noise_sse2;
+	}
+
+	return func;
+}
+
 dither_f16c_func select_dither_f16c_func_x86(CPUClass cpu)
 {
 	X86Capabilities caps = query_x86_capabilities();
@@ -140,26 +240,62 @@ bool needs_dither_f16c_func_x86(CPUClass cpu)
 		return cpu < CPUClass::X86_AVX2;
 }
 
-std::unique_ptr<graph::ImageFilter> create_error_diffusion_x86(unsigned width, unsigned height, const PixelFormat &pixel_in, const PixelFormat &pixel_out, CPUClass cpu)
+std::unique_ptr<graph::ImageFilter> create_error_diffusion_x86(DitherType type, unsigned width, unsigned height, const PixelFormat &pixel_in, const PixelFormat &pixel_out, CPUClass cpu)
 {
 	X86Capabilities caps = query_x86_capabilities();
 	std::unique_ptr<graph::ImageFilter> ret;
 
 	if (cpu_is_autodetect(cpu)) {
+#ifdef ZIMG_X86_AVX512
+		if (!ret && cpu == CPUClass::AUTO_64B && caps.avx512f && caps.avx512bw && caps.avx512vl)
+			ret = create_error_diffusion_avx512(type, width, height, pixel_in, pixel_out);
+#endif
 		if (!ret && caps.avx2 && caps.f16c && caps.fma)
-			ret = create_error_diffusion_avx2(width, height, pixel_in, pixel_out);
-		if (!ret && caps.sse2)
+			ret = create_error_diffusion_avx2(type, width, height, pixel_in, pixel_out);
+		if (!ret && type == DitherType::ERROR_DIFFUSION && caps.sse2)
 			ret = create_error_diffusion_sse2(width, height, pixel_in, pixel_out, cpu);
 	} else {
+#ifdef ZIMG_X86_AVX512
+		if (!ret && cpu >= CPUClass::X86_AVX512)
+			ret = create_error_diffusion_avx512(type, width, height, pixel_in, pixel_out);
+#endif
 		if (!ret && cpu >= CPUClass::X86_AVX2)
-			ret = create_error_diffusion_avx2(width, height, pixel_in, pixel_out);
-		if (!ret && cpu >= CPUClass::X86_SSE2)
+			ret = create_error_diffusion_avx2(type, width, height, pixel_in, pixel_out);
+		if (!ret && type == DitherType::ERROR_DIFFUSION && cpu >= CPUClass::X86_SSE2)
 			ret = create_error_diffusion_sse2(width, height, pixel_in, pixel_out, cpu);
 	}
 
 	return ret;
 }
 
+error_diffusion_kernel select_error_diffusion_kernel_x86(DitherType type, unsigned width, const PixelFormat &pixel_in, const PixelFormat &pixel_out, CPUClass cpu)
+{
+	X86Capabilities caps = query_x86_capabilities();
+	error_diffusion_kernel ret{};
+
+	if (cpu_is_autodetect(cpu)) {
+#ifdef ZIMG_X86_AVX512
+		if (!ret.row && cpu == CPUClass::AUTO_64B && caps.avx512f && caps.avx512bw && caps.avx512vl)
+			ret = select_error_diffusion_kernel_avx512(type, width, pixel_in, pixel_out);
+#endif
+		if (!ret.row && caps.avx2 && caps.f16c && caps.fma)
+			ret = select_error_diffusion_kernel_avx2(type, width, pixel_in, pixel_out);
+		if (!ret.row && type == DitherType::ERROR_DIFFUSION && caps.sse2)
+			ret = select_error_diffusion_kernel_sse2(width, pixel_in, pixel_out, cpu);
+	} else {
+#ifdef ZIMG_X86_AVX512
+		if (!ret.row && cpu >= CPUClass::X86_AVX512)
+			ret = select_error_diffusion_kernel_avx512(type, width, pixel_in, pixel_out);
+#endif
+		if (!ret.row && cpu >= CPUClass::X86_AVX2)
+			ret = select_error_diffusion_kernel_avx2(type, width, pixel_in, pixel_out);
+		if (!ret.row && type == DitherType::ERROR_DIFFUSION && cpu >= CPUClass::X86_SSE2)
+			ret = select_error_diffusion_kernel_sse2(width, pixel_in, pixel_out, cpu);
+	}
+
+	return ret;
+}
+
 } // namespace depth
 } // namespace zimg
 
@@ -5,6 +5,7 @@
 #ifndef ZIMG_DEPTH_X86_DITHER_X86_H_
 #define ZIMG_DEPTH_X86_DITHER_X86_H_
 
+#include <cstdint>
 #include <memory>
 #include "depth/dither.h"
 
@@ -48,19 +49,51 @@ DECLARE_ORDERED_DITHER(h2w, avx512);
 DECLARE_ORDERED_DITHER(f2b, avx512);
 DECLARE_ORDERED_DITHER(f2w, avx512);
 
+#define DECLARE_QUANTIZE(x, cpu) \
+void quantize_##x##_##cpu(const void *src, void *dst, float scale, float offset, unsigned bits, unsigned left, unsigned right)
+
+DECLARE_QUANTIZE(f2b, sse2);
+DECLARE_QUANTIZE(f2w, sse2);
+
+DECLARE_QUANTIZE(h2b, avx2);
+DECLARE_QUANTIZE(h2w, avx2);
+DECLARE_QUANTIZE(f2b, avx2);
+DECLARE_QUANTIZE(f2w, avx2);
+
+DECLARE_QUANTIZE(h2b, avx512);
+DECLARE_QUANTIZE(h2w, avx512);
+DECLARE_QUANTIZE(f2b, avx512);
+DECLARE_QUANTIZE(f2w, avx512);
+
+void random_dither_noise_sse2(float *dst, uint32_t key, unsigned col, unsigned n);
+void random_dither_noise_avx2(float *dst, uint32_t key, unsigned col, unsigned n);
+void random_dither_noise_avx512(float *dst, uint32_t key, unsigned col, unsigned n);
+
 #undef DECLARE_ORDERED_DITHER
+#undef DECLARE_QUANTIZE
 
 dither_convert_func select_ordered_dither_func_x86(const PixelFormat &pixel_in, const PixelFormat &pixel_out, CPUClass cpu);
 
+quantize_func select_quantize_func_x86(const PixelFormat &pixel_in, const PixelFormat &pixel_out, CPUClass cpu);
+
+dither_noise_func select_dither_noise_func_x86(CPUClass cpu);
+
 dither_f16c_func select_dither_f16c_func_x86(CPUClass cpu);
 
 bool needs_dither_f16c_func_x86(CPUClass cpu);
 
 
 std::unique_ptr<graph::ImageFilter> create_error_diffusion_sse2(unsigned width, unsigned height, const PixelFormat &pixel_in, const PixelFormat &pixel_out, CPUClass cpu);
-std::unique_ptr<graph::ImageFilter> create_error_diffusion_avx2(unsigned width, unsigned height, const PixelFormat &pixel_in, const PixelFormat &pixel_out);
+std::unique_ptr<graph::ImageFilter> create_error_diffusion_avx2(DitherType type, unsigned width, unsigned height, const PixelFormat &pixel_in, const PixelFormat &pixel_out);
+std::unique_ptr<graph::ImageFilter> create_error_diffusion_avx512(DitherType type, unsigned width, unsigned height, const PixelFormat &pixel_in, const PixelFormat &pixel_out);
+
+error_diffusion_kernel select_error_diffusion_kernel_sse2(unsigned width, const PixelFormat &pixel_in, const PixelFormat &pixel_out, CPUClass cpu);
+error_diffusion_kernel select_error_diffusion_kernel_avx2(DitherType type, unsigned width, const PixelFormat &pixel_in, const PixelFormat &pixel_out);
+error_diffusion_kernel select_error_diffusion_kernel_avx512(DitherType type, unsigned width, const PixelFormat &pixel_in, const PixelFormat &pixel_out);
+
+error_diffusion_kernel select_error_diffusion_kernel_x86(DitherType type, unsigned width, const PixelFormat &pixel_in, const PixelFormat &pixel_out, CPUClass cpu);
 
-std::unique_ptr<graph::ImageFilter> create_error_diffusion_x86(unsigned width, unsigned height, const PixelFormat &pixel_in, const PixelFormat &pixel_out, CPUClass cpu);
+std::unique_ptr<graph::ImageFilter> create_error_diffusion_x86(DitherType type, unsigned width, unsigned height, const PixelFormat &pixel_in, const PixelFormat &pixel_out, CPUClass cpu);
 
 } // namespace depth
 } // namespace zimg
@@ -13,6 +13,7 @@
 #include "common/make_unique.h"
 #include "common/pixel.h"
 #include "common/zassert.h"
+#include "depth/depth.h"
 #include "depth/quantize.h"
 #include "graph/image_buffer.h"
 #include "graph/image_filter.h"
@@ -116,7 +117,7 @@ inline FORCE_INLINE float min(float x, float y)
 }
 
 
-template <PixelType SrcType, PixelType DstType>
+template <PixelType SrcType, PixelType DstType, class Weights>
 void error_diffusion_scalar(const void *src, void *dst, const float * RESTRICT error_top, float * RESTRICT error_cur,
                             float scale, float offset, unsigned bits, unsigned width)
 {
@@ -138,10 +139,11 @@ void error_diffusion_scalar(const void *src, void *dst, const float * RESTRICT e
 		float x = fma(src_traits::load1(src_p + j), scale, offset);
 		float err, err0, err1;
 
-		err0 = err_left * (7.0f / 16.0f);
-		err0 = fma(err_top_right, 3.0f / 16.0f, err0);
-		err1 = err_top * (5.0f / 16.0f);
-		err1 = fma(err_top_left, 1.0f / 16.0f, err1);
+		err0 = err_left * Weights::left;
+		err0 = fma(err_top_right, Weights::top_right, err0);
+		err1 = err_top * Weights::top;
+		if (Weights::top_left)
+			err1 = fma(err_top_left, Weights::top_left, err1);
 		err = err0 + err1;
 
 		x += err;
@@ -160,29 +162,31 @@ void error_diffusion_scalar(const void *src, void *dst, const float * RESTRICT e
 	}
 }
 
-decltype(&error_diffusion_scalar<PixelType::BYTE, PixelType::BYTE>) select_error_diffusion_scalar_func(PixelType pixel_in, PixelType pixel_out)
+template <class Weights>
+decltype(&error_diffusion_scalar<PixelType::BYTE, PixelType::BYTE, Weights>) select_error_diffusion_scalar_func(PixelType pixel_in, PixelType pixel_out)
 {
 	if (pixel_in == PixelType::BYTE && pixel_out == PixelType::BYTE)
-		return error_diffusion_scalar<PixelType::BYTE, PixelType::BYTE>;
+		return error_diffusion_scalar<PixelType::BYTE, PixelType::BYTE, Weights>;
 	else if (pixel_in == PixelType::BYTE && pixel_out == PixelType::WORD)
-		return error_diffusion_scalar<PixelType::BYTE, PixelType::WORD>;
+		return error_diffusion_scalar<PixelType::BYTE, PixelType::WORD, Weights>;
 	else if (pixel_in == PixelType::WORD && pixel_out == PixelType::BYTE)
-		return error_diffusion_scalar<PixelType::WORD, PixelType::BYTE>;
+		return error_diffusion_scalar<PixelType::WORD, PixelType::BYTE, Weights>;
 	else if (pixel_in == PixelType::WORD && pixel_out == PixelType::WORD)
-		return error_diffusion_scalar<PixelType::WORD, PixelType::WORD>;
+		return error_diffusion_scalar<PixelType::WORD, PixelType::WORD, Weights>;
 	else if (pixel_in == PixelType::HALF && pixel_out == PixelType::BYTE)
-		return error_diffusion_scalar<PixelType::HALF, PixelType::BYTE>;
+		return error_diffusion_scalar<PixelType::HALF, PixelType::BYTE, Weights>;
 	else if (pixel_in == PixelType::HALF && pixel_out == PixelType::WORD)
-		return error_diffusion_scalar<PixelType::HALF, PixelType::WORD>;
+		return error_diffusion_scalar<PixelType::HALF, PixelType::WORD, Weights>;
 	else if (pixel_in == PixelType::FLOAT && pixel_out == PixelType::BYTE)
-		return error_diffusion_scalar<PixelType::FLOAT, PixelType::BYTE>;
+		return error_diffusion_scalar<PixelType::FLOAT, PixelType::BYTE, Weights>;
 	else if (pixel_in == PixelType::FLOAT && pixel_out == PixelType::WORD)
-		return error_diffusion_scalar<PixelType::FLOAT, PixelType::WORD>;
+		return error_diffusion_scalar<PixelType::FLOAT, PixelType::WORD, Weights>;
 	else
 		error::throw_<error::InternalError>("no conversion between pixel types");
 }
 
 
+template <class Weights>
 inline FORCE_INLINE void error_diffusion_wf_avx2_xiter(__m256 &v, unsigned j, const float *error_top, float *error_cur, const __m256 &max_val,
                                                        const __m256 &err_left_w, const __m256 &err_top_right_w, const __m256 &err_top_w, const __m256 &err_top_left_w,
                                                        __m256 &err_left, __m256 &err_top_right, __m256 &err_top, __m256 &err_top_left)
@@ -197,7 +201,8 @@ inline FORCE_INLINE void error_diffusion_wf_avx2_xiter(__m256 &v, unsigned j, co
 	err0 = _mm256_mul_ps(err_left_w, err_left);
 	err0 = _mm256_fmadd_ps(err_top_right_w, err_top_right, err0);
 	err1 = _mm256_mul_ps(err_top_w, err_top);
-	err1 = _mm256_fmadd_ps(err_top_left_w, err_top_left, err1);
+	if (Weights::top_left)
+		err1 = _mm256_fmadd_ps(err_top_left_w, err_top_left, err1);
 	err0 = _mm256_add_ps(err0, err1);
 
 	x = _mm256_add_ps(v, err0);
@@ -224,9 +229,9 @@ inline FORCE_INLINE void error_diffusion_wf_avx2_xiter(__m256 &v, unsigned j, co
 	err_top_right = err_rot;
 }
 
-template <PixelType SrcType, PixelType DstType, class T, class U>
+template <PixelType SrcType, PixelType DstType, class Weights, class T, class U>
 void error_diffusion_wf_avx2(const graph::ImageBuffer<const T> &src, const graph::ImageBuffer<U> &dst, unsigned i,
-                             const float *error_top, float *error_cur, error_state *state, float scale, float offset, unsigned bits, unsigned width)
+                             const float *error_top, float *error_cur, error_state *state, float scale, float offset, unsigned bits, unsigned left, unsigned right)
 {
 	typedef error_diffusion_traits<SrcType> src_traits;
 	typedef error_diffusion_traits<DstType> dst_traits;
@@ -237,10 +242,10 @@ void error_diffusion_wf_avx2(const graph::ImageBuffer<const T> &src, const graph
 	static_assert(std::is_same<T, src_type>::value, "wrong type");
 	static_assert(std::is_same<U, dst_type>::value, "wrong type");
 
-	const __m256 err_left_w = _mm256_set1_ps(7.0f / 16.0f);
-	const __m256 err_top_right_w = _mm256_set1_ps(3.0f / 16.0f);
-	const __m256 err_top_w = _mm256_set1_ps(5.0f / 16.0f);
-	const __m256 err_top_left_w = _mm256_set1_ps(1.0f / 16.0f);
+	const __m256 err_left_w = _mm256_set1_ps(Weights::left);
+	const __m256 err_top_right_w = _mm256_set1_ps(Weights::top_right);
+	const __m256 err_top_w = _mm256_set1_ps(Weights::top);
+	const __m256 err_top_left_w = _mm256_set1_ps(Weights::top_left);
 
 	const __m256 scale_ps = _mm256_set1_ps(scale);
 	const __m256 offset_ps = _mm256_set1_ps(offset);
@@ -252,9 +257,9 @@ void error_diffusion_wf_avx2(const graph::ImageBuffer<const T> &src, const graph
 	__m256 err_top = _mm256_load_ps(state->err_top);
 	__m256 err_top_left = _mm256_load_ps(state->err_top_left);
 
-#define XITER error_diffusion_wf_avx2_xiter
+#define XITER error_diffusion_wf_avx2_xiter<Weights>
 #define XARGS error_top, error_cur, max_val, err_left_w, err_top_right_w, err_top_w, err_top_left_w, err_left, err_top_right, err_top, err_top_left
-	for (unsigned j = 0; j < width; j += 8) {
+	for (unsigned j = left; j < right; j += 8) {
 		__m256 v0 = src_traits::load8(src[i + 0] + j + 14);
 		__m256 v1 = src_traits::load8(src[i + 1] + j + 12);
 		__m256 v2 = src_traits::load8(src[i + 2] + j + 10);
@@ -304,9 +309,9 @@ void error_diffusion_wf_avx2(const graph::ImageBuffer<const T> &src, const graph
 	_mm256_store_ps(state->err_top_left, err_top_left);
 }
 
-template <PixelType SrcType, PixelType DstType>
+template <PixelType SrcType, PixelType DstType, class Weights>
 void error_diffusion_avx2(const graph::ImageBuffer<const void> &src, const graph::ImageBuffer<void> &dst, unsigned i,
-                          const float *error_top, float *error_cur, float scale, float offset, unsigned bits, unsigned width)
+                          const float *error_top, float *error_cur, float scale, float offset, unsigned bits, unsigned width, ErrorDiffusionSync *sync)
 {
 	typedef error_diffusion_traits<SrcType> src_traits;
 	typedef error_diffusion_traits<DstType> dst_traits;
@@ -320,14 +325,17 @@ void error_diffusion_avx2(const graph::ImageBuffer<const void> &src, const graph
 	error_state state alignas(32) = {};
 	float error_tmp[7][24] = {};
 
+	if (sync)
+		sync->wait(std::min(14U + 2, width));
+
 	// Prologue.
-	error_diffusion_scalar<SrcType, DstType>(src_buf[i + 0], dst_buf[i + 0], error_top, error_tmp[0], scale, offset, bits, 14);
-	error_diffusion_scalar<SrcType, DstType>(src_buf[i + 1], dst_buf[i + 1], error_tmp[0], error_tmp[1], scale, offset, bits, 12);
-	error_diffusion_scalar<SrcType, DstType>(src_buf[i + 2], dst_buf[i + 2], error_tmp[1], error_tmp[2], scale, offset, bits, 10);
-	error_diffusion_scalar<SrcType, DstType>(src_buf[i + 3], dst_buf[i + 3], error_tmp[2], error_tmp[3], scale, offset, bits, 8);
-	error_diffusion_scalar<SrcType, DstType>(src_buf[i + 4], dst_buf[i + 4], error_tmp[3], error_tmp[4], scale, offset, bits, 6);
-	error_diffusion_scalar<SrcType, DstType>(src_buf[i + 5], dst_buf[i + 5], error_tmp[4], error_tmp[5], scale, offset, bits, 4);
-	error_diffusion_scalar<SrcType, DstType>(src_buf[i + 6], dst_buf[i + 6], error_tmp[5], error_tmp[6], scale, offset, bits, 2);
+	error_diffusion_scalar<SrcType, DstType, Weights>(src_buf[i + 0], dst_buf[i + 0], error_top, error_tmp[0], scale, offset, bits, 14);
+	error_diffusion_scalar<SrcType, DstType, Weights>(src_buf[i + 1], dst_buf[i + 1], error_tmp[0], error_tmp[1], scale, offset, bits, 12);
+	error_diffusion_scalar<SrcType, DstType, Weights>(src_buf[i + 2], dst_buf[i + 2], error_tmp[1], error_tmp[2], scale, offset, bits, 10);
+	error_diffusion_scalar<SrcType, DstType, Weights>(src_buf[i + 3], dst_buf[i + 3], error_tmp[2], error_tmp[3], scale, offset, bits, 8);
+	error_diffusion_scalar<SrcType, DstType, Weights>(src_buf[i + 4], dst_buf[i + 4], error_tmp[3], error_tmp[4], scale, offset, bits, 6);
+	error_diffusion_scalar<SrcType, DstType, Weights>(src_buf[i + 5], dst_buf[i + 5], error_tmp[4], error_tmp[5], scale, offset, bits, 4);
+	error_diffusion_scalar<SrcType, DstType, Weights>(src_buf[i + 6], dst_buf[i + 6], error_tmp[5], error_tmp[6], scale, offset, bits, 2);
 
 	// Wavefront.
 	state.err_left[0] = error_tmp[0][13 + 1];
@@ -367,7 +375,10 @@ void error_diffusion_avx2(const graph::ImageBuffer<const void> &src, const graph
 	state.err_top_left[7] = 0.0f;
 
 	unsigned vec_count = floor_n(width - 14, 8);
-	error_diffusion_wf_avx2<SrcType, DstType>(src_buf, dst_buf, i, error_top, error_cur, &state, scale, offset, bits, vec_count);
+	error_diffusion_wavefront(sync, 14, vec_count, width, [&](unsigned left, unsigned right)
+	{
+		error_diffusion_wf_avx2<SrcType, DstType, Weights>(src_buf, dst_buf, i, error_top, error_cur, &state, scale, offset, bits, left, right);
+	});
 
 	error_tmp[0][13 + 1] = state.err_top_right[1];
 	error_tmp[0][12 + 1] = state.err_top[1];
@@ -398,50 +409,57 @@ void error_diffusion_avx2(const graph::ImageBuffer<const void> &src, const graph
 	error_tmp[6][0] = state.err_top_left[7];
 
 	// Epilogue.
-	error_diffusion_scalar<SrcType, DstType>(src_buf[i + 0] + vec_count + 14, dst_buf[i + 0] + vec_count + 14, error_top + vec_count + 14, error_tmp[0] + 14,
+	if (sync)
+		sync->wait(width);
+
+	error_diffusion_scalar<SrcType, DstType, Weights>(src_buf[i + 0] + vec_count + 14, dst_buf[i + 0] + vec_count + 14, error_top + vec_count + 14, error_tmp[0] + 14,
 	                                         scale, offset, bits, width - vec_count - 14);
-	error_diffusion_scalar<SrcType, DstType>(src_buf[i + 1] + vec_count + 12, dst_buf[i + 1] + vec_count + 12, error_tmp[0] + 12, error_tmp[1] + 12,
+	error_diffusion_scalar<SrcType, DstType, Weights>(src_buf[i + 1] + vec_count + 12, dst_buf[i + 1] + vec_count + 12, error_tmp[0] + 12, error_tmp[1] + 12,
 	                                         scale, offset, bits, width - vec_count - 12);
-	error_diffusion_scalar<SrcType, DstType>(src_buf[i + 2] + vec_count + 10, dst_buf[i + 2] + vec_count + 10, error_tmp[1] + 10, error_tmp[2] + 10,
+	error_diffusion_scalar<SrcType, DstType, Weights>(src_buf[i + 2] + vec_count + 10, dst_buf[i + 2] + vec_count + 10, error_tmp[1] + 10, error_tmp[2] + 10,
 	                                         scale, offset, bits, width - vec_count - 10);
-	error_diffusion_scalar<SrcType, DstType>(src_buf[i + 3] + vec_count + 8, dst_buf[i + 3] + vec_count + 8, error_tmp[2] + 8, error_tmp[3] + 8,
+	error_diffusion_scalar<SrcType, DstType, Weights>(src_buf[i + 3] + vec_count + 8, dst_buf[i + 3] + vec_count + 8, error_tmp[2] + 8, error_tmp[3] + 8,
 	                                         scale, offset, bits, width - vec_count - 8);
-	error_diffusion_scalar<SrcType, DstType>(src_buf[i + 4] + vec_count + 6, dst_buf[i + 4] + vec_count + 6, error_tmp[3] + 6, error_tmp[4] + 6,
+	error_diffusion_scalar<SrcType, DstType, Weights>(src_buf[i + 4] + vec_count + 6, dst_buf[i + 4] + vec_count + 6, error_tmp[3] + 6, error_tmp[4] + 6,
 	                                         scale, offset, bits, width - vec_count - 6);
-	error_diffusion_scalar<SrcType, DstType>(src_buf[i + 5] + vec_count + 4, dst_buf[i + 5] + vec_count + 4, error_tmp[4] + 4, error_tmp[5] + 4,
+	error_diffusion_scalar<SrcType, DstType, Weights>(src_buf[i + 5] + vec_count + 4, dst_buf[i + 5] + vec_count + 4, error_tmp[4] + 4, error_tmp[5] + 4,
 	                                         scale, offset, bits, width - vec_count - 4);
-	error_diffusion_scalar<SrcType, DstType>(src_buf[i + 6] + vec_count + 2, dst_buf[i + 6] + vec_count + 2, error_tmp[5] + 2, error_tmp[6] + 2,
+	error_diffusion_scalar<SrcType, DstType, Weights>(src_buf[i + 6] + vec_count + 2, dst_buf[i + 6] + vec_count + 2, error_tmp[5] + 2, error_tmp[6] + 2,
 	                                         scale, offset, bits, width - vec_count - 2);
-	error_diffusion_scalar<SrcType, DstType>(src_buf[i + 7] + vec_count + 0, dst_buf[i + 7] + vec_count + 0, error_tmp[6] + 0, error_cur + vec_count + 0,
+	error_diffusion_scalar<SrcType, DstType, Weights>(src_buf[i + 7] + vec_count + 0, dst_buf[i + 7] + vec_count + 0, error_tmp[6] + 0, error_cur + vec_count + 0,
 	                                         scale, offset, bits, width - vec_count - 0);
+
+	if (sync)
+		sync->signal(width);
 }
 
-decltype(&error_diffusion_avx2<PixelType::BYTE, PixelType::BYTE>) select_error_diffusion_avx2_func(PixelType pixel_in, PixelType pixel_out)
+template <class Weights>
+decltype(&error_diffusion_avx2<PixelType::BYTE, PixelType::BYTE, Weights>) select_error_diffusion_avx2_func(PixelType pixel_in, PixelType pixel_out)
 {
 	if (pixel_in == PixelType::BYTE && pixel_out == PixelType::BYTE)
-		return error_diffusion_avx2<PixelType::BYTE, PixelType::BYTE>;
+		return error_diffusion_avx2<PixelType::BYTE, PixelType::BYTE, Weights>;
 	else if (pixel_in == PixelType::BYTE && pixel_out == PixelType::WORD)
-		return error_diffusion_avx2<PixelType::BYTE, PixelType::WORD>;
+		return error_diffusion_avx2<PixelType::BYTE, PixelType::WORD, Weights>;
 	else if (pixel_in == PixelType::WORD && pixel_out == PixelType::BYTE)
-		return error_diffusion_avx2<PixelType::WORD, PixelType::BYTE>;
+		return error_diffusion_avx2<PixelType::WORD, PixelType::BYTE, Weights>;
 	else if (pixel_in == PixelType::WORD && pixel_out == PixelType::WORD)
-		return error_diffusion_avx2<PixelType::WORD, PixelType::WORD>;
+		return error_diffusion_avx2<PixelType::WORD, PixelType::WORD, Weights>;
 	else if (pixel_in == PixelType::HALF && pixel_out == PixelType::BYTE)
-		return error_diffusion_avx2<PixelType::HALF, PixelType::BYTE>;
+		return error_diffusion_avx2<PixelType::HALF, PixelType::BYTE, Weights>;
 	else if (pixel_in == PixelType::HALF && pixel_out == PixelType::WORD)
-		return error_diffusion_avx2<PixelType::HALF, PixelType::WORD>;
+		return error_diffusion_avx2<PixelType::HALF, PixelType::WORD, Weights>;
 	else if (pixel_in == PixelType::FLOAT && pixel_out == PixelType::BYTE)
-		return error_diffusion_avx2<PixelType::FLOAT, PixelType::BYTE>;
+		return error_diffusion_avx2<PixelType::FLOAT, PixelType::BYTE, Weights>;
 	else if (pixel_in == PixelType::FLOAT && pixel_out == PixelType::WORD)
-		return error_diffusion_avx2<PixelType::FLOAT, PixelType::WORD>;
+		return error_diffusion_avx2<PixelType::FLOAT, PixelType::WORD, Weights>;
 	else
 		error::throw_<error::InternalError>("no conversion between pixel types");
 }
 
 
 class ErrorDiffusionAVX2 final : public graph::ImageFilter {
-	decltype(&error_diffusion_scalar<PixelType::BYTE, PixelType::BYTE>) m_scalar_func;
-	decltype(&error_diffusion_avx2<PixelType::BYTE, PixelType::BYTE>) m_avx2_func;
+	decltype(&error_diffusion_scalar<PixelType::BYTE, PixelType::BYTE, FloydSteinbergWeights>) m_scalar_func;
+	decltype(&error_diffusion_avx2<PixelType::BYTE, PixelType::BYTE, FloydSteinbergWeights>) m_avx2_func;
 
 	PixelType m_pixel_in;
 	PixelType m_pixel_out;
@@ -472,12 +490,12 @@ class ErrorDiffusionAVX2 final : public graph::ImageFilter {
 		float *error_top = (i / 8) % 2 ? ctx_a : ctx_b;
 		float *error_cur = (i / 8) % 2 ? ctx_b : ctx_a;
 
-		m_avx2_func(src, dst, i, error_top, error_cur, m_scale, m_offset, m_depth, m_width);
+		m_avx2_func(src, dst, i, error_top, error_cur, m_scale, m_offset, m_depth, m_width, nullptr);
 	}
 public:
-	ErrorDiffusionAVX2(unsigned width, unsigned height, const PixelFormat &format_in, const PixelFormat &format_out) :
-		m_scalar_func{ select_error_diffusion_scalar_func(format_in.type, format_out.type) },
-		m_avx2_func{ select_error_diffusion_avx2_func(format_in.type, format_out.type) },
+	ErrorDiffusionAVX2(DitherType type, unsigned width, unsigned height, const PixelFormat &format_in, const PixelFormat &format_out) :
+		m_scalar_func{},
+		m_avx2_func{},
 		m_pixel_in{ format_in.type },
 		m_pixel_out{ format_out.type },
 		m_scale{},
@@ -492,6 +510,14 @@ public:
 		if (!pixel_is_integer(format_out.type))
 			error::throw_<error::InternalError>("cannot dither to non-integer format");
 
+		if (type == DitherType::SIERRA_LITE) {
+			m_scalar_func = select_error_diffusion_scalar_func<SierraLiteWeights>(format_in.type, format_out.type);
+			m_avx2_func = select_error_diffusion_avx2_func<SierraLiteWeights>(format_in.type, format_out.type);
+		} else {
+			m_scalar_func = select_error_diffusion_scalar_func<FloydSteinbergWeights>(format_in.type, format_out.type);
+			m_avx2_func = select_error_diffusion_avx2_func<FloydSteinbergWeights>(format_in.type, format_out.type);
+		}
+
 		std::tie(m_scale, m_offset) = get_scale_offset(format_in, format_out);
 	}
 
@@ -539,7 +565,7 @@ public:
 
 	size_t get_tmp_size(unsigned, unsigned) const override { return 0; }
 
-	void init_context(void *ctx) const override
+	void init_context(void *ctx, unsigned) const override
 	{
 		std::fill_n(static_cast<unsigned char *>(ctx), get_context_size(), 0);
 	}
@@ -562,12 +588,31 @@ public:
 } // namespace
 
 
-std::unique_ptr<graph::ImageFilter> create_error_diffusion_avx2(unsigned width, unsigned height, const PixelFormat &pixel_in, const PixelFormat &pixel_out)
+error_diffusion_kernel select_error_diffusion_kernel_avx2(DitherType type, unsigned width, const PixelFormat &pixel_in, const PixelFormat &pixel_out)
+{
+	if (width < 14)
+		return{};
+
+	error_diffusion_kernel kernel{};
+
+	if (type == DitherType::SIERRA_LITE) {
+		kernel.row = select_error_diffusion_scalar_func<SierraLiteWeights>(pixel_in.type, pixel_out.type);
+		kernel.band = select_error_diffusion_avx2_func<SierraLiteWeights>(pixel_in.type, pixel_out.type);
+	} else {
+		kernel.row = select_error_diffusion_scalar_func<FloydSteinbergWeights>(pixel_in.type, pixel_out.type);
+		kernel.band = select_error_diffusion_avx2_func<FloydSteinbergWeights>(pixel_in.type, pixel_out.type);
+	}
+	kernel.band_rows = 8;
+
+	return kernel;
+}
+
+std::unique_ptr<graph::ImageFilter> create_error_diffusion_avx2(DitherType type, unsigned width, unsigned height, const PixelFormat &pixel_in, const PixelFormat &pixel_out)
 {
 	if (width < 14)
 		return nullptr;
 
-	return ztd::make_unique<ErrorDiffusionAVX2>(width, height, pixel_in, pixel_out);
+	return ztd::make_unique<ErrorDiffusionAVX2>(type, width, height, pixel_in, pixel_out);
 }
 
 } // namespace depth
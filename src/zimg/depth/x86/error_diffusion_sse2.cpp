@@ -188,7 +188,7 @@ inline FORCE_INLINE void error_diffusion_wf_sse2_xiter(__m128 &v, unsigned j, co
 
 template <class T, class U>
 void error_diffusion_wf_sse2(const graph::ImageBuffer<const T> &src, const graph::ImageBuffer<U> &dst, unsigned i,
-                             const float *error_top, float *error_cur, error_state *state, float scale, float offset, unsigned bits, unsigned width)
+                             const float *error_top, float *error_cur, error_state *state, float scale, float offset, unsigned bits, unsigned left, unsigned right)
 {
 	typedef error_diffusion_traits<T> src_traits;
 	typedef error_diffusion_traits<U> dst_traits;
@@ -220,7 +220,7 @@ void error_diffusion_wf_sse2(const graph::ImageBuffer<const T> &src, const graph
 
 #define XITER error_diffusion_wf_sse2_xiter
 #define XARGS error_top, error_cur, max_val, err_left_w, err_top_right_w, err_top_w, err_top_left_w, err_left, err_top_right, err_top, err_top_left
-	for (unsigned j = 0; j < width; j += 4) {
+	for (unsigned j = left; j < right; j += 4) {
 		__m128 v0 = src_traits::load4(src_p0 + j + 6);
 		__m128 v1 = src_traits::load4(src_p1 + j + 4);
 		__m128 v2 = src_traits::load4(src_p2 + j + 2);
@@ -256,7 +256,7 @@ void error_diffusion_wf_sse2(const graph::ImageBuffer<const T> &src, const graph
 
 template <class T, class U>
 void error_diffusion_sse2(const graph::ImageBuffer<const void> &src, const graph::ImageBuffer<void> &dst, unsigned i,
-                          const float *error_top, float *error_cur, float scale, float offset, unsigned bits, unsigned width)
+                          const float *error_top, float *error_cur, float scale, float offset, unsigned bits, unsigned width, ErrorDiffusionSync *sync)
 {
 	const graph::ImageBuffer<const T> &src_buf = graph::static_buffer_cast<const T>(src);
 	const graph::ImageBuffer<U> &dst_buf = graph::static_buffer_cast<U>(dst);
@@ -264,6 +264,9 @@ void error_diffusion_sse2(const graph::ImageBuffer<const void> &src, const graph
 	error_state state alignas(16) = {};
 	float error_tmp[3][12] = {};
 
+	if (sync)
+		sync->wait(std::min(6U + 2, width));
+
 	// Prologue.
 	error_diffusion_scalar<T, U>(src_buf[i + 0], dst_buf[i + 0], error_top, error_tmp[0], scale, offset, bits, 6);
 	error_diffusion_scalar<T, U>(src_buf[i + 1], dst_buf[i + 1], error_tmp[0], error_tmp[1], scale, offset, bits, 4);
@@ -291,7 +294,10 @@ void error_diffusion_sse2(const graph::ImageBuffer<const void> &src, const graph
 	state.err_top_left[3] = 0.0f;
 
 	unsigned vec_count = floor_n(width - 6, 4);
-	error_diffusion_wf_sse2<T, U>(src_buf, dst_buf, i, error_top, error_cur, &state, scale, offset, bits, vec_count);
+	error_diffusion_wavefront(sync, 6, vec_count, width, [&](unsigned left, unsigned right)
+	{
+		error_diffusion_wf_sse2<T, U>(src_buf, dst_buf, i, error_top, error_cur, &state, scale, offset, bits, left, right);
+	});
 
 	error_tmp[0][5 + 1] = state.err_top_right[1];
 	error_tmp[0][4 + 1] = state.err_top[1];
@@ -306,6 +312,9 @@ void error_diffusion_sse2(const graph::ImageBuffer<const void> &src, const graph
 	error_tmp[2][0] = state.err_top_left[3];
 
 	// Epilogue.
+	if (sync)
+		sync->wait(width);
+
 	error_diffusion_scalar<T, U>(src_buf[i + 0] + vec_count + 6, dst_buf[i + 0] + vec_count + 6, error_top + vec_count + 6, error_tmp[0] + 6,
 	                             scale, offset, bits, width - vec_count - 6);
 	error_diffusion_scalar<T, U>(src_buf[i + 1] + vec_count + 4, dst_buf[i + 1] + vec_count + 4, error_tmp[0] + 4, error_tmp[1] + 4,
@@ -314,6 +323,9 @@ void error_diffusion_sse2(const graph::ImageBuffer<const void> &src, const graph
 	                             scale, offset, bits, width - vec_count - 2);
 	error_diffusion_scalar<T, U>(src_buf[i + 3] + vec_count + 0, dst_buf[i + 3] + vec_count + 0, error_tmp[2] + 0, error_cur + vec_count + 0,
 	                             scale, offset, bits, width - vec_count - 0);
+
+	if (sync)
+		sync->signal(width);
 }
 
 decltype(&error_diffusion_sse2<uint8_t, uint8_t>) select_error_diffusion_sse2_func(PixelType pixel_in, PixelType pixel_out)
@@ -376,7 +388,7 @@ class ErrorDiffusionSSE2 final : public graph::ImageFilter {
 		float *error_top = (i / 4) % 2 ? ctx_a : ctx_b;
 		float *error_cur = (i / 4) % 2 ? ctx_b : ctx_a;
 
-		m_sse2_func(src, dst, i, error_top, error_cur, m_scale, m_offset, m_depth, m_width);
+		m_sse2_func(src, dst, i, error_top, error_cur, m_scale, m_offset, m_depth, m_width, nullptr);
 	}
 public:
 	ErrorDiffusionSSE2(unsigned width, unsigned height, const PixelFormat &format_in, const PixelFormat &format_out, CPUClass cpu) :
@@ -454,7 +466,7 @@ public:
 		}
 	}
 
-	void init_context(void *ctx) const override
+	void init_context(void *ctx, unsigned) const override
 	{
 		std::fill_n(static_cast<unsigned char *>(ctx), get_context_size(), 0);
 	}
@@ -487,6 +499,22 @@ public:
 } // namespace
 
 
+error_diffusion_kernel select_error_diffusion_kernel_sse2(unsigned width, const PixelFormat &pixel_in, const PixelFormat &pixel_out, CPUClass cpu)
+{
+	if (width < 6)
+		return{};
+
+	error_diffusion_kernel kernel{};
+	kernel.row = select_error_diffusion_scalar_func(pixel_in.type, pixel_out.type);
+	kernel.band = select_error_diffusion_sse2_func(pixel_in.type, pixel_out.type);
+	kernel.band_rows = 4;
+
+	if (pixel_in.type == PixelType::HALF)
+		kernel.f16c = select_dither_f16c_func_x86(cpu);
+
+	return kernel;
+}
+
 std::unique_ptr<graph::ImageFilter> create_error_diffusion_sse2(unsigned width, unsigned height, const PixelFormat &pixel_in, const PixelFormat &pixel_out, CPUClass cpu)
 {
 	if (width < 6)
@@ -1,9 +1,20 @@
 #include <algorithm>
 #include <array>
+#include <atomic>
+#include <chrono>
 #include <climits>
 #include <cmath>
+#include <condition_variable>
 #include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <mutex>
 #include <stdexcept>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <typeinfo>
+#include <utility>
 #include <vector>
 #include "common/align.h"
 #include "common/alloc.h"
@@ -15,6 +26,12 @@
 #include "copy_filter.h"
 #include "filtergraph.h"
 #include "image_filter.h"
+#include "scratch_pool.h"
+#include "trace.h"
+
+#ifdef __GNUC__
+  #include <cxxabi.h>
+#endif
 
 namespace zimg {
 namespace graph {
@@ -124,9 +141,253 @@ enum class ExecutionStrategy {
 struct SimulationState {
 	unsigned pos;
 	unsigned lines;
+	unsigned first; // Lowest source line read by the current row group.
 	bool hit;
 };
 
+// Rows passed to an I/O callback.
+struct CallbackRows {
+	unsigned height;
+	unsigned step;  // Rows in a row group.
+	unsigned batch; // Maximum rows per invocation, a multiple of step.
+};
+
+// Invokes the I/O callbacks of a graph execution on a separate thread.
+//
+// Input rows are unpacked ahead of the graph, up to the distance that the
+// input buffer can hold without overwriting rows which are still required.
+// Output rows are packed behind the graph, which waits before overwriting
+// rows that have not yet been packed. The thread is kept between executions,
+// which are configured with {@link start}.
+class AsyncIO : public HookAllocated {
+	FilterGraph::callback m_unpack_cb;
+	FilterGraph::callback m_pack_cb;
+	TraceBuffer *m_trace;
+	CallbackRows m_unpack_rows;
+	CallbackRows m_pack_rows;
+	unsigned m_unpack_ahead;
+	unsigned m_pack_behind;
+
+	std::mutex m_mutex;
+	std::condition_variable m_io_cond;
+	std::condition_variable m_graph_cond;
+	unsigned m_unpack_left;
+	unsigned m_unpack_right;
+	unsigned m_unpack_next;
+	unsigned m_unpack_limit;
+	unsigned m_pack_left;
+	unsigned m_pack_right;
+	unsigned m_pack_next;
+	unsigned m_pack_ready;
+	bool m_busy;
+	bool m_stop;
+	std::exception_ptr m_error;
+	std::thread m_thread;
+
+	void invoke(const FilterGraph::callback &cb, const char *name, TraceBuffer::category cat, unsigned i, unsigned count, unsigned step, unsigned left, unsigned right)
+	{
+		if (!m_trace) {
+			cb(i, count, step, left, right);
+			return;
+		}
+
+		auto start = TraceBuffer::clock::now();
+		cb(i, count, step, left, right);
+		m_trace->record(name, cat, start, TraceBuffer::clock::now(), i, left, right);
+	}
+
+	bool io_pending() const
+	{
+		return m_pack_next < m_pack_ready || m_unpack_next < m_unpack_limit;
+	}
+
+	void run()
+	{
+		std::unique_lock<std::mutex> lock{ m_mutex };
+
+		while (true) {
+			m_io_cond.wait(lock, [this]() { return m_stop || io_pending(); });
+			if (m_stop)
+				break;
+
+			// Packing takes priority, as it releases space in the output buffer.
+			bool pack = m_pack_next < m_pack_ready;
+			unsigned i = pack ? m_pack_next : m_unpack_next;
+			unsigned count = pack ? std::min(m_pack_ready - i, m_pack_rows.batch) : std::min(m_unpack_limit - i, m_unpack_rows.batch);
+			unsigned left = pack ? m_pack_left : m_unpack_left;
+			unsigned right = pack ? m_pack_right : m_unpack_right;
+
+			m_busy = true;
+			lock.unlock();
+
+			try {
+				if (pack)
+					invoke(m_pack_cb, "pack", TraceBuffer::category::PACK, i, count, m_pack_rows.step, left, right);
+				else
+					invoke(m_unpack_cb, "unpack", TraceBuffer::category::UNPACK, i, count, m_unpack_rows.step, left, right);
+			} catch (...) {
+				lock.lock();
+				m_error = std::current_exception();
+				m_busy = false;
+				m_graph_cond.notify_one();
+				break;
+			}
+
+			lock.lock();
+			if (pack)
+				m_pack_next += count;
+			else
+				m_unpack_next += count;
+			m_busy = false;
+			m_graph_cond.notify_one();
+		}
+	}
+
+	template <class Pred>
+	void wait(std::unique_lock<std::mutex> &lock, Pred pred)
+	{
+		m_graph_cond.wait(lock, [&]() { return m_error || pred(); });
+		if (m_error)
+			std::rethrow_exception(m_error);
+	}
+public:
+	/**
+	 * Start the I/O thread.
+	 *
+	 * @throw std::system_error if the thread could not be created
+	 */
+	AsyncIO() :
+		m_unpack_cb{},
+		m_pack_cb{},
+		m_trace{},
+		m_unpack_rows{},
+		m_pack_rows{},
+		m_unpack_ahead{},
+		m_pack_behind{},
+		m_unpack_left{},
+		m_unpack_right{},
+		m_unpack_next{},
+		m_unpack_limit{},
+		m_pack_left{},
+		m_pack_right{},
+		m_pack_next{},
+		m_pack_ready{},
+		m_busy{},
+		m_stop{},
+		m_error{}
+	{
+		m_thread = std::thread{ &AsyncIO::run, this };
+	}
+
+	AsyncIO(const AsyncIO &) = delete;
+
+	~AsyncIO()
+	{
+		{
+			std::lock_guard<std::mutex> lock{ m_mutex };
+			m_stop = true;
+		}
+		m_io_cond.notify_one();
+		m_thread.join();
+	}
+
+	AsyncIO &operator=(const AsyncIO &) = delete;
+
+	/**
+	 * Configure the thread for a graph execution. The thread must be idle.
+	 *
+	 * @param unpack_ahead number of rows which may be unpacked ahead of the graph
+	 * @param pack_behind number of rows which may be packed behind the graph
+	 */
+	void start(FilterGraph::callback unpack_cb, FilterGraph::callback pack_cb, TraceBuffer *trace,
+	           const CallbackRows &unpack_rows, unsigned unpack_ahead, const CallbackRows &pack_rows, unsigned pack_behind)
+	{
+		std::lock_guard<std::mutex> lock{ m_mutex };
+
+		m_unpack_cb = unpack_cb;
+		m_pack_cb = pack_cb;
+		m_trace = trace;
+		m_unpack_rows = unpack_rows;
+		m_pack_rows = pack_rows;
+		m_unpack_ahead = floor_n(unpack_ahead, unpack_rows.step);
+		m_pack_behind = floor_n(pack_behind, pack_rows.step);
+		m_unpack_left = 0;
+		m_unpack_right = 0;
+		m_unpack_next = 0;
+		m_unpack_limit = 0;
+		m_pack_left = 0;
+		m_pack_right = 0;
+		m_pack_next = 0;
+		m_pack_ready = 0;
+	}
+
+	// Check if the thread may be reused. A failed callback terminates the
+	// thread, and an interrupted execution may leave callbacks outstanding.
+	bool reusable()
+	{
+		std::lock_guard<std::mutex> lock{ m_mutex };
+		return !m_error && !m_busy && !io_pending();
+	}
+
+	// Wait for all outstanding I/O, and start a new tile. An empty range skips the callback.
+	void begin_tile(unsigned unpack_left, unsigned unpack_right, unsigned pack_left, unsigned pack_right)
+	{
+		std::unique_lock<std::mutex> lock{ m_mutex };
+		wait(lock, [this]() { return !m_busy && m_pack_next == m_pack_ready; });
+
+		m_unpack_left = unpack_left;
+		m_unpack_right = unpack_right;
+		m_unpack_next = 0;
+		m_unpack_limit = m_unpack_cb && unpack_left != unpack_right ? std::min(m_unpack_ahead, m_unpack_rows.height) : 0;
+		m_pack_left = pack_left;
+		m_pack_right = pack_right;
+		m_pack_next = 0;
+		m_pack_ready = 0;
+		m_io_cond.notify_one();
+	}
+
+	// Wait for all outstanding I/O.
+	void finish()
+	{
+		std::unique_lock<std::mutex> lock{ m_mutex };
+		wait(lock, [this]() { return !m_busy && m_pack_next == m_pack_ready; });
+	}
+
+	// Wait until input row {@p i} is unpacked.
+	void unpack(unsigned i)
+	{
+		if (m_unpack_left == m_unpack_right)
+			return;
+
+		std::unique_lock<std::mutex> lock{ m_mutex };
+
+		m_unpack_limit = std::max(m_unpack_limit, std::min(i + m_unpack_rows.step + m_unpack_ahead, m_unpack_rows.height));
+		m_io_cond.notify_one();
+		wait(lock, [=]() { return m_unpack_next > i; });
+	}
+
+	// Wait until the output row group at row {@p i} may be written.
+	void reserve_output(unsigned i)
+	{
+		if (!m_pack_cb || m_pack_left == m_pack_right || i <= m_pack_behind)
+			return;
+
+		std::unique_lock<std::mutex> lock{ m_mutex };
+		wait(lock, [=]() { return m_pack_next + m_pack_behind >= i; });
+	}
+
+	// Queue the output row group at row {@p i}.
+	void pack(unsigned i)
+	{
+		if (m_pack_left == m_pack_right)
+			return;
+
+		std::lock_guard<std::mutex> lock{ m_mutex };
+		m_pack_ready = i + m_pack_rows.step;
+		m_io_cond.notify_one();
+	}
+};
+
 class ExecutionState {
 	struct guard_page {
 #ifndef NDEBUG
@@ -156,6 +417,7 @@ class ExecutionState {
 public:
 	struct cache_state {
 		ColorImageBuffer<void> buffer;
+		size_t origin;
 		bool external;
 	};
 
@@ -170,8 +432,21 @@ private:
 	FilterGraph::callback m_pack_cb;
 	cache_state *m_cache_table;
 	node_cache_state *m_node_table;
+	ptrdiff_t *m_stride_table;
 	void **m_context_table;
 	void *m_base;
+	unsigned m_seed;
+	bool m_stats;
+	TraceBuffer *m_trace;
+	AsyncIO *m_async;
+	CallbackRows m_unpack_rows;
+	CallbackRows m_pack_rows;
+	unsigned m_unpack_left;
+	unsigned m_unpack_right;
+	unsigned m_unpack_next;
+	unsigned m_pack_left;
+	unsigned m_pack_right;
+	unsigned m_pack_next;
 
 	guard_page **m_guard;
 	size_t m_guard_idx;
@@ -189,6 +464,7 @@ public:
 
 		alloc.allocate_n<cache_state>(num_contexts);
 		alloc.allocate_n<node_cache_state>(num_contexts);
+		alloc.allocate_n<ptrdiff_t>(num_contexts);
 		alloc.allocate_n<void *>(num_contexts);
 		alloc.allocate_n<guard_page *>(num_contexts * 8);
 		alloc.allocate_n<guard_page>(num_contexts * 8);
@@ -196,14 +472,27 @@ public:
 		return alloc.count();
 	}
 
-	ExecutionState(unsigned num_contexts, void *pool, FilterGraph::callback unpack_cb, FilterGraph::callback pack_cb) :
+	ExecutionState(unsigned num_contexts, void *pool, FilterGraph::callback unpack_cb, FilterGraph::callback pack_cb, unsigned seed, bool stats, TraceBuffer *trace) :
 		m_alloc{ pool },
 		m_unpack_cb{ unpack_cb },
 		m_pack_cb{ pack_cb },
 		m_cache_table{},
 		m_node_table{},
+		m_stride_table{},
 		m_context_table{},
 		m_base{ pool },
+		m_seed{ seed },
+		m_stats{ stats },
+		m_trace{ trace },
+		m_async{},
+		m_unpack_rows{},
+		m_pack_rows{},
+		m_unpack_left{},
+		m_unpack_right{},
+		m_unpack_next{},
+		m_pack_left{},
+		m_pack_right{},
+		m_pack_next{},
 		m_guard{},
 		m_guard_idx{}
 	{
@@ -213,6 +502,9 @@ public:
 		m_node_table = m_alloc.allocate_n<node_cache_state>(num_contexts);
 		std::fill_n(m_node_table, num_contexts, node_cache_state{});
 
+		m_stride_table = m_alloc.allocate_n<ptrdiff_t>(num_contexts);
+		std::fill_n(m_stride_table, num_contexts, 0);
+
 		m_context_table = m_alloc.allocate_n<void *>(num_contexts);
 		std::fill_n(m_context_table, num_contexts, nullptr);
 
@@ -252,6 +544,23 @@ public:
 		}
 	}
 
+	// Move the cache so that its first byte holds the given byte offset within each row.
+	void set_cache_origin(unsigned id, size_t origin)
+	{
+		cache_state *cache = m_cache_table + id;
+		if (cache->external)
+			return;
+
+		for (unsigned p = 0; p < 3; ++p) {
+			if (cache->buffer[p].data()) {
+				char *data = static_cast<char *>(cache->buffer[p].data()) + (static_cast<ptrdiff_t>(cache->origin) - static_cast<ptrdiff_t>(origin));
+				cache->buffer[p] = { data, cache->buffer[p].stride(), cache->buffer[p].mask() };
+			}
+		}
+
+		cache->origin = origin;
+	}
+
 	void set_external_buffer(unsigned id, const ColorImageBuffer<void> &buffer)
 	{
 		cache_state *cache = m_cache_table + id;
@@ -266,16 +575,162 @@ public:
 		cache->external = true;
 	}
 
+	void set_async_io(AsyncIO *async) { m_async = async; }
+
+	void set_callback_rows(const CallbackRows &unpack_rows, const CallbackRows &pack_rows)
+	{
+		m_unpack_rows = unpack_rows;
+		m_pack_rows = pack_rows;
+	}
+
 	cache_state *get_cache(unsigned id) const { return m_cache_table + id; }
 	node_cache_state *get_node_state(unsigned id) const { return m_node_table + id; }
+	node_cache_state *get_node_table() const { return m_node_table; }
+	ptrdiff_t *get_stride_table() const { return m_stride_table; }
 	void *get_context(unsigned id) const { return m_context_table[id]; }
 	void *get_tmp() const { return static_cast<char *>(m_base) + m_alloc.count(); }
 
 	FilterGraph::callback get_unpack_cb() const { return m_unpack_cb; }
 	FilterGraph::callback get_pack_cb() const { return m_pack_cb; }
+	unsigned get_seed() const { return m_seed; }
+	bool stats_enabled() const { return m_stats; }
+	TraceBuffer *get_trace() const { return m_trace; }
+	AsyncIO *get_async_io() const { return m_async; }
+
+	// Start a new tile. An empty range skips the callback.
+	void begin_tile(unsigned unpack_left, unsigned unpack_right, unsigned pack_left, unsigned pack_right)
+	{
+		if (m_async) {
+			m_async->begin_tile(unpack_left, unpack_right, pack_left, pack_right);
+			return;
+		}
+
+		m_unpack_left = unpack_left;
+		m_unpack_right = unpack_right;
+		m_unpack_next = 0;
+		m_pack_left = pack_left;
+		m_pack_right = pack_right;
+		m_pack_next = 0;
+	}
+
+	// Unpack the input row group at row {@p i}, together with the rest of its batch.
+	void unpack(unsigned i)
+	{
+		if (m_async) {
+			m_async->unpack(i);
+			return;
+		}
+		if (i < m_unpack_next || m_unpack_left == m_unpack_right)
+			return;
+
+		unsigned count = std::min(m_unpack_rows.batch, m_unpack_rows.height - i);
+		invoke_callback(m_unpack_cb, "unpack", TraceBuffer::category::UNPACK, i, count, m_unpack_rows.step, m_unpack_left, m_unpack_right);
+		m_unpack_next = i + count;
+	}
+
+	// Pack the output row group at row {@p i}, once its batch is complete.
+	void pack(unsigned i)
+	{
+		if (m_async) {
+			m_async->pack(i);
+			return;
+		}
+		if (m_pack_left == m_pack_right)
+			return;
+
+		unsigned end = i + m_pack_rows.step;
+		if (end - m_pack_next < m_pack_rows.batch && end < m_pack_rows.height)
+			return;
+
+		invoke_callback(m_pack_cb, "pack", TraceBuffer::category::PACK, m_pack_next, end - m_pack_next, m_pack_rows.step, m_pack_left, m_pack_right);
+		m_pack_next = end;
+	}
+private:
+	void invoke_callback(const FilterGraph::callback &cb, const char *name, TraceBuffer::category cat, unsigned i, unsigned count, unsigned step, unsigned left, unsigned right) const
+	{
+		if (!m_trace) {
+			cb(i, count, step, left, right);
+			return;
+		}
+
+		auto start = TraceBuffer::clock::now();
+		cb(i, count, step, left, right);
+		m_trace->record(name, cat, start, TraceBuffer::clock::now(), i, left, right);
+	}
+};
+
+// Get the class name of a type, without namespace qualifiers.
+std::string unqualified_type_name(const std::type_info &type)
+{
+	std::string name = type.name();
+
+#ifdef __GNUC__
+	int status = 0;
+	std::unique_ptr<char, void (*)(void *)> demangled{ abi::__cxa_demangle(type.name(), nullptr, nullptr, &status), std::free };
+
+	if (!status && demangled)
+		name = demangled.get();
+#endif
+
+	// Skip namespaces and keywords (e.g. "class " on MSVC), except within template arguments.
+	size_t pos = 0;
+	int depth = 0;
+
+	for (size_t i = 0; i < name.size(); ++i) {
+		char c = name[i];
+
+		if (c == '<' || c == '(')
+			++depth;
+		else if (c == '>' || c == ')')
+			--depth;
+		else if (!depth && c == ' ')
+			pos = i + 1;
+		else if (!depth && c == ':' && i + 1 < name.size() && name[i + 1] == ':')
+			pos = i + 2;
+	}
+
+	return name.substr(pos);
+}
+
+class NodeStatistics {
+	std::atomic<unsigned long long> m_calls;
+	std::atomic<unsigned long long> m_pixels;
+	std::atomic<unsigned long long> m_nanoseconds;
+	std::atomic<unsigned long long> m_bytes_read;
+	std::atomic<unsigned long long> m_bytes_written;
+public:
+	NodeStatistics() { reset(); }
+
+	// Counters may be updated by multiple threads executing the same graph.
+	void record(unsigned long long pixels, unsigned long long nanoseconds, unsigned long long bytes_read, unsigned long long bytes_written)
+	{
+		m_calls.fetch_add(1, std::memory_order_relaxed);
+		m_pixels.fetch_add(pixels, std::memory_order_relaxed);
+		m_nanoseconds.fetch_add(nanoseconds, std::memory_order_relaxed);
+		m_bytes_read.fetch_add(bytes_read, std::memory_order_relaxed);
+		m_bytes_written.fetch_add(bytes_written, std::memory_order_relaxed);
+	}
+
+	void reset()
+	{
+		m_calls.store(0, std::memory_order_relaxed);
+		m_pixels.store(0, std::memory_order_relaxed);
+		m_nanoseconds.store(0, std::memory_order_relaxed);
+		m_bytes_read.store(0, std::memory_order_relaxed);
+		m_bytes_written.store(0, std::memory_order_relaxed);
+	}
+
+	void get(FilterGraph::node_stats *stats) const
+	{
+		stats->calls = m_calls.load(std::memory_order_relaxed);
+		stats->pixels = m_pixels.load(std::memory_order_relaxed);
+		stats->nanoseconds = m_nanoseconds.load(std::memory_order_relaxed);
+		stats->bytes_read = m_bytes_read.load(std::memory_order_relaxed);
+		stats->bytes_written = m_bytes_written.load(std::memory_order_relaxed);
+	}
 };
 
-class GraphNode {
+class GraphNode : public HookAllocated {
 private:
 	unsigned m_id;
 	unsigned m_cache_id;
@@ -351,7 +806,7 @@ public:
 
 	virtual void simulate(SimulationState *state, unsigned first, unsigned last, bool uv) = 0;
 
-	virtual size_t get_context_size(ExecutionStrategy strategy) const = 0;
+	virtual size_t get_context_size(ExecutionStrategy strategy, const ptrdiff_t *cache_stride) const = 0;
 
 	virtual size_t get_tmp_size(unsigned left, unsigned right) const = 0;
 
@@ -359,9 +814,13 @@ public:
 
 	virtual void reset_context(ExecutionState *state) const = 0;
 
-	virtual void set_tile_region(ExecutionState *state, unsigned left, unsigned right, bool uv) const = 0;
+	virtual void set_tile_region(ExecutionState::node_cache_state *regions, unsigned left, unsigned right, bool uv) const = 0;
 
 	virtual void generate_line(ExecutionState *state, unsigned i, bool uv) const = 0;
+
+	virtual const char *get_kind() const = 0;
+
+	virtual std::array<const GraphNode *, 2> get_parents() const { return{}; }
 };
 
 class NullNode final : public GraphNode {
@@ -375,12 +834,13 @@ public:
 	void request_external_cache(unsigned) override {}
 	void complete() override {}
 	void simulate(SimulationState *, unsigned, unsigned, bool) override {}
-	size_t get_context_size(ExecutionStrategy) const override { return 0; }
+	size_t get_context_size(ExecutionStrategy, const ptrdiff_t *) const override { return 0; }
 	size_t get_tmp_size(unsigned, unsigned) const override { return 0; }
 	void init_context(ExecutionState *, ExecutionStrategy) const override {}
 	void reset_context(ExecutionState *) const override {}
-	void set_tile_region(ExecutionState *, unsigned, unsigned, bool) const override {}
+	void set_tile_region(ExecutionState::node_cache_state *, unsigned, unsigned, bool) const override {}
 	void generate_line(ExecutionState *, unsigned, bool) const override {}
+	const char *get_kind() const override { return "null"; }
 };
 
 class SourceNode final : public GraphNode {
@@ -429,19 +889,20 @@ public:
 			pos = floor_n(last - 1, step) + step;
 
 		state[get_id()].pos = pos;
+		state[get_id()].first = std::min(state[get_id()].first, first);
 		state[get_id()].hit = true;
 		update_cache_state(state, pos - first);
 	}
 
-	size_t get_context_size(ExecutionStrategy) const override { return 0; }
+	size_t get_context_size(ExecutionStrategy, const ptrdiff_t *) const override { return 0; }
 	size_t get_tmp_size(unsigned left, unsigned right) const override { return 0; }
 
 	void init_context(ExecutionState *state, ExecutionStrategy) const override { init_cache_context(state->get_node_state(get_id())); }
 	void reset_context(ExecutionState *state) const override { reset_cache_context(state->get_node_state(get_id())); }
 
-	void set_tile_region(ExecutionState *state, unsigned left, unsigned right, bool uv) const override
+	void set_tile_region(ExecutionState::node_cache_state *regions, unsigned left, unsigned right, bool uv) const override
 	{
-		auto *context = state->get_node_state(get_id());
+		auto *context = regions + get_id();
 
 		left <<= uv ? m_subsample_w : 0;
 		right <<= uv ? m_subsample_w : 0;
@@ -461,7 +922,7 @@ public:
 		if (line >= pos) {
 			if (state->get_unpack_cb()) {
 				for (; pos <= line; pos += step) {
-					state->get_unpack_cb()(pos, context->source_left, context->source_right);
+					state->unpack(pos);
 				}
 			} else {
 				pos = floor_n(line, step) + step;
@@ -470,6 +931,8 @@ public:
 			context->cache_pos = pos;
 		}
 	}
+
+	const char *get_kind() const override { return "source"; }
 };
 
 class FilterNode : public GraphNode {
@@ -478,6 +941,8 @@ protected:
 	ImageFilter::filter_flags m_flags;
 	GraphNode *m_parent;
 	unsigned m_step;
+	std::string m_name;
+	mutable NodeStatistics m_stats;
 
 	bool is_inplace_capable(const GraphNode *parent) const
 	{
@@ -490,23 +955,49 @@ protected:
 		return attr.width == parent_attr.width && pixel_size(attr.type) == pixel_size(parent_attr.type);
 	}
 
-	ptrdiff_t get_cache_stride() const
-	{
-		auto attr = get_image_attributes();
-		return ceil_n(get_image_attributes().width * pixel_size(attr.type), ALIGNMENT);
-	}
-
 	unsigned get_real_cache_lines(ExecutionStrategy strategy) const
 	{
 		return get_cache_lines(strategy) == BUFFER_MAX ? get_image_attributes().height : get_cache_lines(strategy);
 	}
 
-	size_t get_cache_size(ExecutionStrategy strategy, unsigned num_planes) const
+	size_t get_cache_size(ExecutionStrategy strategy, ptrdiff_t stride, unsigned num_planes) const
 	{
-		checked_size_t rowsize = get_cache_stride();
+		checked_size_t rowsize = static_cast<size_t>(stride);
 		checked_size_t size = rowsize * get_real_cache_lines(strategy) * num_planes;
 		return size.get();
 	}
+
+	void run_filter(ExecutionState *state, void *filter_ctx, const ImageBuffer<const void> *src, const ImageBuffer<void> *dst, unsigned pos, unsigned num_planes) const
+	{
+		auto *context = state->get_node_state(get_id());
+
+		if (!state->stats_enabled() && !state->get_trace()) {
+			m_filter->process(filter_ctx, src, dst, state->get_tmp(), pos, context->source_left, context->source_right);
+			state->check_guard();
+			return;
+		}
+
+		auto start = std::chrono::steady_clock::now();
+		m_filter->process(filter_ctx, src, dst, state->get_tmp(), pos, context->source_left, context->source_right);
+		auto end = std::chrono::steady_clock::now();
+		state->check_guard();
+
+		if (state->get_trace())
+			state->get_trace()->record(m_name.c_str(), TraceBuffer::category::FILTER, start, end, pos, context->source_left, context->source_right);
+		if (!state->stats_enabled())
+			return;
+
+		auto attr = get_image_attributes();
+		auto row_range = m_filter->get_required_row_range(pos);
+		auto col_range = m_filter->get_required_col_range(context->source_left, context->source_right);
+		unsigned lines = std::min(m_step, attr.height - pos);
+
+		unsigned long long pixels = static_cast<unsigned long long>(lines) * (context->source_right - context->source_left) * num_planes;
+		unsigned long long bytes_read = static_cast<unsigned long long>(row_range.second - row_range.first) * (col_range.second - col_range.first) *
+			pixel_size(m_parent->get_image_attributes().type) * num_planes;
+
+		m_stats.record(pixels, std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count(), bytes_read, pixels * pixel_size(attr.type));
+	}
 public:
 	FilterNode(unsigned id, std::shared_ptr<ImageFilter> filter, GraphNode *parent) :
 		GraphNode(id),
@@ -514,7 +1005,25 @@ public:
 		m_flags(m_filter->get_flags()),
 		m_parent{ parent },
 		m_step{ m_filter->get_simultaneous_lines() }
-	{}
+	{
+		const ImageFilter &filter_ref = *m_filter;
+		m_name = unqualified_type_name(typeid(filter_ref));
+	}
+
+	FilterGraph::node_stats get_stats() const
+	{
+		FilterGraph::node_stats stats{};
+		stats.name = m_name.c_str();
+		m_stats.get(&stats);
+		return stats;
+	}
+
+	void reset_stats() const { m_stats.reset(); }
+
+	const ImageFilter &get_filter() const { return *m_filter; }
+	const char *get_name() const { return m_name.c_str(); }
+
+	std::array<const GraphNode *, 2> get_parents() const override { return{ { m_parent, nullptr } }; }
 
 	ImageFilter::image_attributes get_image_attributes() const override { return m_filter->get_image_attributes(); }
 	ImageFilter::image_attributes get_image_attributes(bool) const override { return m_filter->get_image_attributes(); }
@@ -555,15 +1064,15 @@ public:
 		return std::max(m_filter->get_tmp_size(left, right), m_parent->get_tmp_size(range.first, range.second));
 	}
 
-	void set_tile_region(ExecutionState *state, unsigned left, unsigned right, bool uv) const override
+	void set_tile_region(ExecutionState::node_cache_state *regions, unsigned left, unsigned right, bool uv) const override
 	{
-		auto *context = state->get_node_state(get_id());
+		auto *context = regions + get_id();
 		auto range = m_filter->get_required_col_range(left, right);
 
 		context->source_left = std::min(context->source_left, left);
 		context->source_right = std::max(context->source_right, right);
 
-		m_parent->set_tile_region(state, range.first, range.second, uv);
+		m_parent->set_tile_region(regions, range.first, range.second, uv);
 	}
 };
 
@@ -583,7 +1092,7 @@ public:
 		FilterNode::simulate(state, first, last, false);
 	}
 
-	size_t get_context_size(ExecutionStrategy strategy) const override
+	size_t get_context_size(ExecutionStrategy strategy, const ptrdiff_t *cache_stride) const override
 	{
 		if (strategy != ExecutionStrategy::LUMA && strategy != ExecutionStrategy::COLOR)
 			return 0;
@@ -592,7 +1101,7 @@ public:
 
 		alloc.allocate(m_filter->get_context_size());
 		if (get_cache_id() == get_id())
-			alloc.allocate(get_cache_size(strategy, 1));
+			alloc.allocate(get_cache_size(strategy, cache_stride[get_id()], 1));
 
 		return alloc.count();
 	}
@@ -603,22 +1112,22 @@ public:
 
 		init_cache_context(state->get_node_state(get_id()));
 		if (get_cache_id() == get_id())
-			state->alloc_cache(get_cache_id(), get_cache_stride(), get_real_cache_lines(strategy), select_zimg_buffer_mask(get_cache_lines(strategy)), enabled_planes);
+			state->alloc_cache(get_cache_id(), state->get_stride_table()[get_id()], get_real_cache_lines(strategy), select_zimg_buffer_mask(get_cache_lines(strategy)), enabled_planes);
 
 		void *filter_ctx = state->alloc_context(get_id(), m_filter->get_context_size());
-		m_filter->init_context(filter_ctx);
+		m_filter->init_context(filter_ctx, state->get_seed());
 	}
 
 	void reset_context(ExecutionState *state) const override
 	{
 		reset_cache_context(state->get_node_state(get_id()));
-		m_filter->init_context(state->get_context(get_id()));
+		m_filter->init_context(state->get_context(get_id()), state->get_seed());
 	}
 
-	void set_tile_region(ExecutionState *state, unsigned left, unsigned right, bool uv) const override
+	void set_tile_region(ExecutionState::node_cache_state *regions, unsigned left, unsigned right, bool uv) const override
 	{
 		zassert_d(!uv, "request for chroma plane on luma node");
-		FilterNode::set_tile_region(state, left, right, false);
+		FilterNode::set_tile_region(regions, left, right, false);
 	}
 
 	void generate_line(ExecutionState *state, unsigned i, bool uv) const override
@@ -639,11 +1148,12 @@ public:
 				m_parent->generate_line(state, ii, false);
 			}
 
-			m_filter->process(state->get_context(get_id()), input_buffer, output_buffer, state->get_tmp(), pos, context->source_left, context->source_right);
-			state->check_guard();
+			run_filter(state, state->get_context(get_id()), input_buffer, output_buffer, pos, 1);
 		}
 		context->cache_pos = pos;
 	}
+
+	const char *get_kind() const override { return "luma"; }
 };
 
 class ChromaNode final : public FilterNode {
@@ -668,7 +1178,7 @@ public:
 		FilterNode::simulate(state, first, last, true);
 	}
 
-	size_t get_context_size(ExecutionStrategy strategy) const override
+	size_t get_context_size(ExecutionStrategy strategy, const ptrdiff_t *cache_stride) const override
 	{
 		if (strategy != ExecutionStrategy::CHROMA && strategy != ExecutionStrategy::COLOR)
 			return 0;
@@ -678,7 +1188,7 @@ public:
 		alloc.allocate(m_filter->get_context_size());
 		alloc.allocate(m_filter->get_context_size());
 		if (get_cache_id() == get_id())
-			alloc.allocate(get_cache_size(strategy, 2));
+			alloc.allocate(get_cache_size(strategy, cache_stride[get_id()], 2));
 
 		return alloc.count();
 	}
@@ -689,13 +1199,13 @@ public:
 
 		init_cache_context(state->get_node_state(get_id()));
 		if (get_cache_id() == get_id())
-			state->alloc_cache(get_cache_id(), get_cache_stride(), get_real_cache_lines(strategy), select_zimg_buffer_mask(get_cache_lines(strategy)), enabled_planes);
+			state->alloc_cache(get_cache_id(), state->get_stride_table()[get_id()], get_real_cache_lines(strategy), select_zimg_buffer_mask(get_cache_lines(strategy)), enabled_planes);
 
 		size_t filter_ctx_size = m_filter->get_context_size();
 		void *filter_ctx = state->alloc_context(get_id(), m_filter->get_context_size() * 2);
 
-		m_filter->init_context(filter_ctx);
-		m_filter->init_context(static_cast<unsigned char *>(filter_ctx) + filter_ctx_size);
+		m_filter->init_context(filter_ctx, state->get_seed());
+		m_filter->init_context(static_cast<unsigned char *>(filter_ctx) + filter_ctx_size, state->get_seed());
 	}
 
 	void reset_context(ExecutionState *state) const override
@@ -704,14 +1214,14 @@ public:
 		void *filter_ctx = state->get_context(get_id());
 
 		reset_cache_context(state->get_node_state(get_id()));
-		m_filter->init_context(filter_ctx);
-		m_filter->init_context(static_cast<unsigned char *>(filter_ctx) + filter_ctx_size);
+		m_filter->init_context(filter_ctx, state->get_seed());
+		m_filter->init_context(static_cast<unsigned char *>(filter_ctx) + filter_ctx_size, state->get_seed());
 	}
 
-	void set_tile_region(ExecutionState *state, unsigned left, unsigned right, bool uv) const override
+	void set_tile_region(ExecutionState::node_cache_state *regions, unsigned left, unsigned right, bool uv) const override
 	{
 		zassert_d(uv, "request for luma plane on chroma node");
-		FilterNode::set_tile_region(state, left, right, true);
+		FilterNode::set_tile_region(regions, left, right, true);
 	}
 
 	void generate_line(ExecutionState *state, unsigned i, bool uv) const
@@ -735,13 +1245,13 @@ public:
 				m_parent->generate_line(state, ii, true);
 			}
 
-			m_filter->process(filter_ctx_u, input_buffer + 1, output_buffer + 1, state->get_tmp(), pos, context->source_left, context->source_right);
-			state->check_guard();
-			m_filter->process(filter_ctx_v, input_buffer + 2, output_buffer + 2, state->get_tmp(), pos, context->source_left, context->source_right);
-			state->check_guard();
+			run_filter(state, filter_ctx_u, input_buffer + 1, output_buffer + 1, pos, 1);
+			run_filter(state, filter_ctx_v, input_buffer + 2, output_buffer + 2, pos, 1);
 		}
 		context->cache_pos = pos;
 	}
+
+	const char *get_kind() const override { return "chroma"; }
 };
 
 class ColorNode final : public FilterNode {
@@ -790,7 +1300,7 @@ public:
 		update_cache_state(state, pos - first);
 	}
 
-	size_t get_context_size(ExecutionStrategy strategy) const override
+	size_t get_context_size(ExecutionStrategy strategy, const ptrdiff_t *cache_stride) const override
 	{
 		zassert_d(strategy == ExecutionStrategy::COLOR, "can not access channels independently in color node");
 
@@ -798,7 +1308,7 @@ public:
 
 		alloc.allocate(m_filter->get_context_size());
 		if (get_cache_id() == get_id())
-			alloc.allocate(get_cache_size(strategy, 3));
+			alloc.allocate(get_cache_size(strategy, cache_stride[get_id()], 3));
 
 		return alloc.count();
 	}
@@ -820,28 +1330,28 @@ public:
 
 		init_cache_context(state->get_node_state(get_id()));
 		if (get_cache_id() == get_id())
-			state->alloc_cache(get_cache_id(), get_cache_stride(), get_real_cache_lines(strategy), select_zimg_buffer_mask(get_cache_lines(strategy)), enabled_planes);
+			state->alloc_cache(get_cache_id(), state->get_stride_table()[get_id()], get_real_cache_lines(strategy), select_zimg_buffer_mask(get_cache_lines(strategy)), enabled_planes);
 
 		void *filter_ctx = state->alloc_context(get_id(), m_filter->get_context_size());
-		m_filter->init_context(filter_ctx);
+		m_filter->init_context(filter_ctx, state->get_seed());
 	}
 
 	void reset_context(ExecutionState *state) const override
 	{
 		reset_cache_context(state->get_node_state(get_id()));
-		m_filter->init_context(state->get_context(get_id()));
+		m_filter->init_context(state->get_context(get_id()), state->get_seed());
 	}
 
-	void set_tile_region(ExecutionState *state, unsigned left, unsigned right, bool) const override
+	void set_tile_region(ExecutionState::node_cache_state *regions, unsigned left, unsigned right, bool) const override
 	{
-		auto *context = state->get_node_state(get_id());
+		auto *context = regions + get_id();
 		auto range = m_filter->get_required_col_range(left, right);
 
 		context->source_left = std::min(context->source_left, left);
 		context->source_right = std::max(context->source_right, right);
 
-		m_parent->set_tile_region(state, range.first, range.second, false);
-		m_parent_uv->set_tile_region(state, range.first, range.second, true);
+		m_parent->set_tile_region(regions, range.first, range.second, false);
+		m_parent_uv->set_tile_region(regions, range.first, range.second, true);
 	}
 
 	void generate_line(ExecutionState *state, unsigned i, bool uv) const override
@@ -872,17 +1382,95 @@ public:
 				m_parent_uv->generate_line(state, ii, true);
 			}
 
-			m_filter->process(state->get_context(get_id()), *real_input_buffer, output_buffer, state->get_tmp(), pos, context->source_left, context->source_right);
-			state->check_guard();
+			run_filter(state, state->get_context(get_id()), *real_input_buffer, output_buffer, pos, 3);
 		}
 		context->cache_pos = pos;
 	}
+
+	const char *get_kind() const override { return "color"; }
+
+	std::array<const GraphNode *, 2> get_parents() const override { return{ { m_parent, m_parent_uv } }; }
+};
+
+const char *strategy_name(ExecutionStrategy strategy)
+{
+	switch (strategy) {
+	case ExecutionStrategy::LUMA:
+		return "luma";
+	case ExecutionStrategy::CHROMA:
+		return "chroma";
+	default:
+		return "color";
+	}
+}
+
+const char *pixel_type_name(PixelType type)
+{
+	switch (type) {
+	case PixelType::BYTE:
+		return "byte";
+	case PixelType::WORD:
+		return "word";
+	case PixelType::HALF:
+		return "half";
+	default:
+		return "float";
+	}
+}
+
+std::string quote(const char *str)
+{
+	std::string ret = "\"";
+
+	for (; *str; ++str) {
+		if (*str == '"' || *str == '\\')
+			ret += '\\';
+		ret += *str;
+	}
+
+	ret += '"';
+	return ret;
+}
+
+std::string lines_to_string(unsigned lines)
+{
+	return lines == BUFFER_MAX ? quote("all") : std::to_string(lines);
+}
+
+// Records the processing time of a tile on scope exit.
+class TileTrace {
+	TraceBuffer *m_trace;
+	const char *m_name;
+	unsigned m_left;
+	unsigned m_right;
+	TraceBuffer::clock::time_point m_start;
+public:
+	TileTrace(TraceBuffer *trace, const char *name, unsigned left, unsigned right) :
+		m_trace{ trace },
+		m_name{ name },
+		m_left{ left },
+		m_right{ right },
+		m_start{}
+	{
+		if (m_trace)
+			m_start = TraceBuffer::clock::now();
+	}
+
+	TileTrace(const TileTrace &) = delete;
+
+	~TileTrace()
+	{
+		if (m_trace)
+			m_trace->record(m_name, TraceBuffer::category::TILE, m_start, TraceBuffer::clock::now(), 0, m_left, m_right);
+	}
+
+	TileTrace &operator=(const TileTrace &) = delete;
 };
 
 } // namespace
 
 
-class FilterGraph::impl {
+class FilterGraph::impl : public HookAllocated {
 	static constexpr unsigned TILE_WIDTH_MIN = 128;
 
 	std::vector<std::unique_ptr<GraphNode>> m_node_set;
@@ -895,10 +1483,28 @@ class FilterGraph::impl {
 	unsigned m_subsample_w;
 	unsigned m_subsample_h;
 	unsigned m_tile_width;
+	CPUClass m_cpu;
 	bool m_color_input;
 	bool m_color_filter;
 	bool m_requires_64b_alignment;
+	bool m_stats_enabled;
 	bool m_is_complete;
+	std::unique_ptr<TraceBuffer> m_trace;
+
+	// Streaming plan, computed by the first stream.
+	mutable std::once_flag m_stream_once;
+	mutable std::vector<std::pair<unsigned, unsigned>> m_stream_rows;
+	mutable unsigned m_stream_input_buffering;
+
+	unsigned m_async_unpack_ahead;
+	unsigned m_async_pack_behind;
+	unsigned m_callback_batch;
+	bool m_callback_full_width;
+	allocator_hooks m_allocator;
+
+	// Idle I/O threads, shared by executions of the graph.
+	mutable std::mutex m_async_mutex;
+	mutable std::vector<std::unique_ptr<AsyncIO>> m_async_idle;
 
 	void check_incomplete() const
 	{
@@ -912,10 +1518,104 @@ class FilterGraph::impl {
 			error::throw_<error::InternalError>("cannot query properties on incomplete graph");
 	}
 
+	void set_tile_region(ExecutionStrategy strategy, ExecutionState::node_cache_state *regions, unsigned left, unsigned right) const
+	{
+		if (strategy == ExecutionStrategy::LUMA || strategy == ExecutionStrategy::COLOR)
+			m_node->set_tile_region(regions, left, right, false);
+		if (m_node_uv && (strategy == ExecutionStrategy::CHROMA || strategy == ExecutionStrategy::COLOR))
+			m_node_uv->set_tile_region(regions, left >> m_subsample_w, right >> m_subsample_w, true);
+	}
+
+	// Columns of a cache accessed in a tile, including those written in-place by its ancestors.
+	std::pair<unsigned, unsigned> get_cache_region(const ExecutionState::node_cache_state *regions, unsigned id) const
+	{
+		unsigned left = UINT_MAX;
+		unsigned right = 0;
+
+		for (const auto &node : m_node_set) {
+			if (node->get_cache_id() != id)
+				continue;
+
+			left = std::min(left, regions[node->get_id()].source_left);
+			right = std::max(right, regions[node->get_id()].source_right);
+		}
+		return{ left, right };
+	}
+
+	// Byte offset within each row of the first column of a cache region.
+	static size_t get_cache_origin(const GraphNode &node, unsigned left)
+	{
+		return floor_n(static_cast<size_t>(left) * pixel_size(node.get_image_attributes().type), ALIGNMENT);
+	}
+
+	bool is_cache_owner(const GraphNode &node) const
+	{
+		return node.get_cache_id() == node.get_id() && !node.has_external_buffer();
+	}
+
+	// Compute the row size of each cache when processing tiles of the given
+	// width. A cache only holds the columns accessed within a tile, so a
+	// filter buffering the full image height does not hold the full width.
+	void plan_cache_strides(ExecutionStrategy strategy, unsigned tile_width, ExecutionState::node_cache_state *regions, ptrdiff_t *stride) const
+	{
+		auto attr = m_node->get_image_attributes(false);
+		unsigned step = tile_width;
+
+		std::fill_n(stride, m_id_counter, 0);
+
+		for (unsigned j = 0; j < attr.width; j += step) {
+			unsigned j_end = std::min(j + step, attr.width);
+
+			if (attr.width - j_end < TILE_WIDTH_MIN) {
+				j_end = attr.width;
+				step = attr.width - j;
+			}
+
+			std::fill_n(regions, m_id_counter, ExecutionState::node_cache_state{ 0, UINT_MAX, 0 });
+			set_tile_region(strategy, regions, j, j_end);
+
+			for (const auto &node : m_node_set) {
+				if (!is_cache_owner(*node))
+					continue;
+
+				auto region = get_cache_region(regions, node->get_id());
+				if (region.first >= region.second)
+					continue;
+
+				size_t right = ceil_n(static_cast<size_t>(region.second) * pixel_size(node->get_image_attributes().type), ALIGNMENT);
+				size_t size = right - get_cache_origin(*node, region.first);
+				stride[node->get_id()] = std::max(stride[node->get_id()], static_cast<ptrdiff_t>(size));
+			}
+		}
+	}
+
+	std::vector<ptrdiff_t> plan_cache_strides(ExecutionStrategy strategy, unsigned tile_width) const
+	{
+		std::vector<ExecutionState::node_cache_state> regions(m_id_counter);
+		std::vector<ptrdiff_t> stride(m_id_counter);
+
+		plan_cache_strides(strategy, tile_width, regions.data(), stride.data());
+		return stride;
+	}
+
+	// Move the caches so that the columns of the current tile start at the beginning of each row.
+	void set_cache_origins(ExecutionState *state) const
+	{
+		for (const auto &node : m_node_set) {
+			if (!is_cache_owner(*node))
+				continue;
+
+			auto region = get_cache_region(state->get_node_table(), node->get_id());
+			if (region.first < region.second)
+				state->set_cache_origin(node->get_id(), get_cache_origin(*node, region.first));
+		}
+	}
+
 	size_t get_tmp_size(ExecutionStrategy strategy, unsigned tile_width) const
 	{
 		auto attr = m_node->get_image_attributes(false);
 		unsigned step = tile_width;
+		std::vector<ptrdiff_t> cache_stride = plan_cache_strides(strategy, tile_width);
 
 		FakeAllocator alloc;
 		size_t tmp_size = 0;
@@ -923,7 +1623,7 @@ class FilterGraph::impl {
 		alloc.allocate(ExecutionState::table_size(m_id_counter));
 
 		for (const auto &node : m_node_set) {
-			alloc.allocate(node->get_context_size(strategy));
+			alloc.allocate(node->get_context_size(strategy, cache_stride.data()));
 		}
 
 		for (unsigned j = 0; j < attr.width; j += step) {
@@ -998,13 +1698,294 @@ class FilterGraph::impl {
 		return tile_width;
 	}
 
-	void process_color(const ImageBuffer<const void> src[], const ImageBuffer<void> dst[], void *tmp, callback unpack_cb, callback pack_cb) const
+	// Number of luma lines held by the buffers of a color image, capped at the image height.
+	template <class T>
+	static unsigned get_buffer_lines(const ImageBuffer<T> buf[], unsigned height, unsigned subsample_h, bool color)
 	{
-		ExecutionState state{ m_id_counter, tmp, unpack_cb, pack_cb };
-		auto attr = m_node->get_image_attributes(false);
-		unsigned h_step = get_tile_width(ExecutionStrategy::COLOR);
+		unsigned lines = buf[0].mask() == BUFFER_MAX ? height : std::min(buf[0].mask() + 1, height);
+
+		for (unsigned p = 1; p < (color ? 3U : 1U); ++p) {
+			if (buf[p].mask() != BUFFER_MAX)
+				lines = std::min(lines, (buf[p].mask() + 1) << subsample_h);
+		}
+		return lines;
+	}
+
+	// Add the rows held by asynchronous or batched I/O to a buffer size.
+	static unsigned add_async_lines(unsigned lines, unsigned extra, unsigned height)
+	{
+		if (!extra || lines == BUFFER_MAX)
+			return lines;
+		if (lines >= height || extra >= height - lines)
+			return BUFFER_MAX;
+
+		unsigned mask = select_zimg_buffer_mask(lines + extra);
+		return mask == BUFFER_MAX ? BUFFER_MAX : mask + 1;
+	}
+
+	// Rows added to a buffer to hold a batch of the I/O callbacks.
+	unsigned get_batch_lines(unsigned step) const
+	{
+		return m_callback_batch > step ? floor_n(m_callback_batch, step) - step : 0;
+	}
+
+	// Rows of a buffer beyond the buffering required by the graph are available for I/O.
+	static unsigned get_spare_lines(unsigned lines, unsigned buffering, unsigned height)
+	{
+		return lines - std::min(std::min(buffering, height), lines);
+	}
+
+	CallbackRows get_callback_rows(unsigned height, unsigned step, unsigned spare_lines) const
+	{
+		unsigned batch = step + floor_n(std::min(get_batch_lines(step), spare_lines), step);
+		return{ height, step, batch };
+	}
+
+	// Returns an I/O thread to the graph when an execution ends.
+	struct async_io_deleter {
+		const impl *graph;
+
+		void operator()(AsyncIO *async) const noexcept { graph->release_async_io(async); }
+	};
+
+	typedef std::unique_ptr<AsyncIO, async_io_deleter> async_io_ptr;
+
+	void release_async_io(AsyncIO *async) const noexcept
+	{
+		std::unique_ptr<AsyncIO> owner{ async };
+
+		if (!async->reusable())
+			return;
+
+		try {
+			std::lock_guard<std::mutex> lock{ m_async_mutex };
+			m_async_idle.push_back(std::move(owner));
+		} catch (const std::bad_alloc &) {
+			// Destroy the thread.
+		}
+	}
+
+	async_io_ptr create_async_io(callback unpack_cb, callback pack_cb, const CallbackRows &unpack_rows, unsigned unpack_spare,
+	                             const CallbackRows &pack_rows, unsigned pack_spare) const
+	{
+		if ((!m_async_unpack_ahead && !m_async_pack_behind) || (!unpack_cb && !pack_cb))
+			return async_io_ptr{ nullptr, async_io_deleter{ this } };
+
+		// The distance also covers a full batch, so that batches are not split.
+		unsigned unpack_ahead = std::min(std::max(m_async_unpack_ahead, unpack_rows.batch - unpack_rows.step), unpack_spare);
+		unsigned pack_behind = std::min(std::max(m_async_pack_behind, pack_rows.batch - pack_rows.step), pack_spare);
+
+		std::unique_ptr<AsyncIO> async;
+
+		{
+			std::lock_guard<std::mutex> lock{ m_async_mutex };
+
+			if (!m_async_idle.empty()) {
+				async = std::move(m_async_idle.back());
+				m_async_idle.pop_back();
+			}
+		}
+
+		// Failure to create the thread only results in synchronous I/O.
+		if (!async) {
+			try {
+				AllocatorScope allocator_scope{ m_allocator };
+				async = ztd::make_unique<AsyncIO>();
+			} catch (const std::system_error &) {
+				return async_io_ptr{ nullptr, async_io_deleter{ this } };
+			}
+		}
+
+		async->start(unpack_cb, pack_cb, m_trace.get(), unpack_rows, unpack_ahead, pack_rows, pack_behind);
+		return async_io_ptr{ async.release(), async_io_deleter{ this } };
+	}
+
+	std::vector<ExecutionStrategy> get_strategies() const
+	{
+		std::vector<ExecutionStrategy> strategies{ ExecutionStrategy::COLOR };
+
+		if (!m_color_filter) {
+			strategies.push_back(ExecutionStrategy::LUMA);
+			if (m_node_uv)
+				strategies.push_back(ExecutionStrategy::CHROMA);
+		}
+		return strategies;
+	}
+
+	std::string dump_plan_json() const
+	{
+		std::string out = "{\n";
+
+		out += "  \"width\": " + std::to_string(m_node->get_image_attributes().width) + ",\n";
+		out += "  \"height\": " + std::to_string(m_node->get_image_attributes().height) + ",\n";
+		out += "  \"tmp_size\": " + std::to_string(get_tmp_size()) + ",\n";
+		out += "  \"requires_64b_alignment\": " + std::string{ m_requires_64b_alignment ? "true" : "false" } + ",\n";
+		out += "  \"source\": " + std::to_string(m_head->get_id()) + ",\n";
+		out += "  \"output\": " + std::to_string(m_node->get_id()) + ",\n";
+		if (m_node_uv)
+			out += "  \"output_uv\": " + std::to_string(m_node_uv->get_id()) + ",\n";
+
+		// The color strategy is used with I/O callbacks, else the planes are processed separately.
+		std::vector<ptrdiff_t> cache_stride[3];
+		out += "  \"strategies\": [\n";
+		for (ExecutionStrategy strategy : get_strategies()) {
+			unsigned tile_width = get_tile_width(strategy);
+			size_t tmp_size = get_tmp_size(strategy, tile_width);
+			size_t tables = ceil_n(ExecutionState::table_size(m_id_counter), ALIGNMENT);
+			size_t contexts = 0;
+
+			cache_stride[static_cast<int>(strategy)] = plan_cache_strides(strategy, tile_width);
+			for (const auto &node : m_node_set) {
+				contexts += ceil_n(node->get_context_size(strategy, cache_stride[static_cast<int>(strategy)].data()), ALIGNMENT);
+			}
+
+			if (strategy != ExecutionStrategy::COLOR)
+				out += ",\n";
+
+			out += "    { \"strategy\": " + quote(strategy_name(strategy));
+			out += ", \"tile_width\": " + std::to_string(tile_width);
+			out += ", \"input_buffering\": " + lines_to_string(get_input_buffering(strategy));
+			out += ", \"output_buffering\": " + lines_to_string(get_output_buffering(strategy));
+			out += ", \"cache_footprint\": " + std::to_string(get_cache_footprint(strategy));
+			out += ", \"tmp_size\": " + std::to_string(tmp_size);
+			out += ", \"tmp_tables\": " + std::to_string(tables);
+			out += ", \"tmp_contexts\": " + std::to_string(contexts);
+			out += ", \"tmp_scratch\": " + std::to_string(tmp_size - tables - contexts) + " }";
+		}
+		out += "\n  ],\n";
+
+		out += "  \"nodes\": [\n";
+		for (const auto &node : m_node_set) {
+			auto attr = node->get_image_attributes();
+			const FilterNode *filter_node = dynamic_cast<const FilterNode *>(node.get());
+
+			if (node != m_node_set.front())
+				out += ",\n";
+
+			out += "    { \"id\": " + std::to_string(node->get_id());
+			out += ", \"kind\": " + quote(node->get_kind());
+			if (filter_node)
+				out += ", \"filter\": " + quote(filter_node->get_name());
+			out += ", \"width\": " + std::to_string(attr.width);
+			out += ", \"height\": " + std::to_string(attr.height);
+			out += ", \"type\": " + quote(pixel_type_name(attr.type));
+
+			out += ", \"parents\": [";
+			for (const GraphNode *parent : node->get_parents()) {
+				if (!parent)
+					continue;
+				if (out.back() != '[')
+					out += ", ";
+				out += std::to_string(parent->get_id());
+			}
+			out += "]";
+
+			if (filter_node) {
+				const ImageFilter &filter = filter_node->get_filter();
+				ImageFilter::filter_flags flags = filter.get_flags();
+
+				out += ", \"flags\": [";
+				const struct {
+					bool value;
+					const char *name;
+				} flag_names[] = {
+					{ flags.has_state, "has_state" },
+					{ flags.same_row, "same_row" },
+					{ flags.in_place, "in_place" },
+					{ flags.entire_row, "entire_row" },
+					{ flags.entire_plane, "entire_plane" },
+					{ flags.color, "color" },
+				};
+				for (const auto &flag : flag_names) {
+					if (!flag.value)
+						continue;
+					if (out.back() != '[')
+						out += ", ";
+					out += quote(flag.name);
+				}
+				out += "]";
+				out += ", \"simultaneous_lines\": " + lines_to_string(filter.get_simultaneous_lines());
+				out += ", \"filter_context_size\": " + std::to_string(filter.get_context_size());
+			}
+
+			out += ", \"cache_id\": " + std::to_string(node->get_cache_id());
+			out += ", \"external\": " + std::string{ node->has_external_buffer() ? "true" : "false" };
+
+			for (ExecutionStrategy strategy : get_strategies()) {
+				out += ", \"" + std::string{ strategy_name(strategy) } + "\": { \"cache_lines\": " + lines_to_string(node->get_cache_lines(strategy));
+				out += ", \"cache_stride\": " + std::to_string(cache_stride[static_cast<int>(strategy)][node->get_id()]);
+				out += ", \"context_size\": " + std::to_string(node->get_context_size(strategy, cache_stride[static_cast<int>(strategy)].data())) + " }";
+			}
+			out += " }";
+		}
+		out += "\n  ]\n";
+		out += "}\n";
+
+		return out;
+	}
+
+	std::string dump_plan_dot() const
+	{
+		std::string out = "digraph zimg {\n";
+
+		out += "  label=" + quote(("tile width " + std::to_string(get_tile_width(ExecutionStrategy::COLOR)) +
+		                           ", tmp size " + std::to_string(get_tmp_size())).c_str()) + ";\n";
+		out += "  node [shape=box];\n";
+
+		for (const auto &node : m_node_set) {
+			auto attr = node->get_image_attributes();
+			const FilterNode *filter_node = dynamic_cast<const FilterNode *>(node.get());
+			std::string label = filter_node ? std::string{ filter_node->get_name() } + "\\n" : std::string{};
+
+			label += std::string{ node->get_kind() } + " " + std::to_string(attr.width) + "x" + std::to_string(attr.height) + " " + pixel_type_name(attr.type);
+
+			if (node->get_cache_id() == node->get_id()) {
+				unsigned lines = node->get_cache_lines(ExecutionStrategy::COLOR);
+				label += "\\ncache " + (lines == BUFFER_MAX ? std::string{ "all" } : std::to_string(lines)) + " lines";
+			} else {
+				label += "\\nin-place, cache of node " + std::to_string(node->get_cache_id());
+			}
+
+			out += "  n" + std::to_string(node->get_id()) + " [label=\"" + label + "\"";
+			if (node->has_external_buffer())
+				out += ", style=bold";
+			out += "];\n";
+
+			for (const GraphNode *parent : node->get_parents()) {
+				if (parent)
+					out += "  n" + std::to_string(parent->get_id()) + " -> n" + std::to_string(node->get_id()) + ";\n";
+			}
+		}
+
+		out += "}\n";
+		return out;
+	}
+
+	void process_color(const ImageBuffer<const void> src[], const ImageBuffer<void> dst[], void *tmp, callback unpack_cb, callback pack_cb, unsigned seed) const
+	{
+		ExecutionState state{ m_id_counter, tmp, unpack_cb, pack_cb, seed, m_stats_enabled, m_trace.get() };
+		auto attr = m_node->get_image_attributes(false);
+		unsigned input_width = m_head->get_image_attributes().width;
+		unsigned input_height = get_input_height();
+		unsigned h_step = get_tile_width(ExecutionStrategy::COLOR);
 		unsigned v_step = 1U << m_subsample_h;
 
+		unsigned input_lines = get_buffer_lines(src, input_height, m_input_subsample_h, m_color_input);
+		unsigned output_lines = get_buffer_lines(dst, attr.height, m_subsample_h, !!m_node_uv);
+		unsigned unpack_spare = get_spare_lines(input_lines, get_input_buffering(), input_height);
+		unsigned pack_spare = get_spare_lines(output_lines, get_output_buffering(), attr.height);
+
+		CallbackRows unpack_rows = get_callback_rows(input_height, 1U << m_input_subsample_h, unpack_spare);
+		CallbackRows pack_rows = get_callback_rows(attr.height, v_step, pack_spare);
+		state.set_callback_rows(unpack_rows, pack_rows);
+
+		// Rows of a buffer holding the entire image remain valid across tiles.
+		bool unpack_full_width = m_callback_full_width && input_lines >= input_height;
+		bool pack_full_width = m_callback_full_width && output_lines >= attr.height;
+
+		async_io_ptr async_io = create_async_io(unpack_cb, pack_cb, unpack_rows, unpack_spare, pack_rows, pack_spare);
+		state.set_async_io(async_io.get());
+
 		ColorImageBuffer<void> src_;
 		ColorImageBuffer<void> dst_;
 
@@ -1018,6 +1999,7 @@ class FilterGraph::impl {
 		if (m_node_uv && m_node != m_node_uv)
 			state.set_external_buffer(m_node_uv->get_id(), dst_);
 
+		plan_cache_strides(ExecutionStrategy::COLOR, h_step, state.get_node_table(), state.get_stride_table());
 		for (const auto &node : m_node_set) {
 			node->init_context(&state, ExecutionStrategy::COLOR);
 		}
@@ -1030,15 +2012,39 @@ class FilterGraph::impl {
 				h_step = attr.width - j;
 			}
 
+			TileTrace tile_trace{ state.get_trace(), "color tile", j, j_end };
+
 			for (const auto &node : m_node_set) {
 				node->reset_context(&state);
 			}
 
-			m_node->set_tile_region(&state, j, j_end, false);
-			if (m_node_uv)
-				m_node_uv->set_tile_region(&state, j >> m_subsample_w, j_end >> m_subsample_w, true);
+			set_tile_region(ExecutionStrategy::COLOR, state.get_node_table(), j, j_end);
+			set_cache_origins(&state);
+
+			if (unpack_cb || pack_cb) {
+				auto *source_state = state.get_node_state(m_head->get_id());
+				unsigned unpack_left = source_state->source_left;
+				unsigned unpack_right = source_state->source_right;
+				unsigned pack_left = j;
+				unsigned pack_right = j_end;
+
+				// Unpack entire rows in the first tile, and pack them in the last.
+				if (unpack_full_width) {
+					unpack_left = 0;
+					unpack_right = j ? 0 : input_width;
+				}
+				if (pack_full_width) {
+					pack_left = 0;
+					pack_right = j_end == attr.width ? attr.width : 0;
+				}
+
+				state.begin_tile(unpack_left, unpack_right, pack_left, pack_right);
+			}
 
 			for (unsigned i = 0; i < attr.height; i += v_step) {
+				if (async_io)
+					async_io->reserve_output(i);
+
 				for (unsigned ii = i; ii < i + v_step; ++ii) {
 					m_node->generate_line(&state, ii, false);
 				}
@@ -1046,14 +2052,17 @@ class FilterGraph::impl {
 					m_node_uv->generate_line(&state, i >> m_subsample_h, true);
 
 				if (state.get_pack_cb())
-					state.get_pack_cb()(i, j, j_end);
+					state.pack(i);
 			}
 		}
+
+		if (async_io)
+			async_io->finish();
 	}
 
-	void process_luma(const ImageBuffer<const void> src[], const ImageBuffer<void> dst[], void *tmp) const
+	void process_luma(const ImageBuffer<const void> src[], const ImageBuffer<void> dst[], void *tmp, unsigned seed) const
 	{
-		ExecutionState state{ m_id_counter, tmp, nullptr, nullptr };
+		ExecutionState state{ m_id_counter, tmp, nullptr, nullptr, seed, m_stats_enabled, m_trace.get() };
 		auto attr = m_node->get_image_attributes(false);
 		unsigned step = get_tile_width(ExecutionStrategy::LUMA);
 
@@ -1070,6 +2079,7 @@ class FilterGraph::impl {
 		if (m_node_uv && m_node != m_node_uv)
 			state.set_external_buffer(m_node_uv->get_id(), dst_);
 
+		plan_cache_strides(ExecutionStrategy::LUMA, step, state.get_node_table(), state.get_stride_table());
 		for (const auto &node : m_node_set) {
 			node->init_context(&state, ExecutionStrategy::LUMA);
 		}
@@ -1082,11 +2092,14 @@ class FilterGraph::impl {
 				step = attr.width - j;
 			}
 
+			TileTrace tile_trace{ state.get_trace(), "luma tile", j, j_end };
+
 			for (const auto &node : m_node_set) {
 				node->reset_context(&state);
 			}
 
-			m_node->set_tile_region(&state, j, j_end, false);
+			set_tile_region(ExecutionStrategy::LUMA, state.get_node_table(), j, j_end);
+			set_cache_origins(&state);
 
 			for (unsigned i = 0; i < attr.height; ++i) {
 				m_node->generate_line(&state, i, false);
@@ -1094,9 +2107,9 @@ class FilterGraph::impl {
 		}
 	}
 
-	void process_chroma(const ImageBuffer<const void> src[], const ImageBuffer<void> dst[], void *tmp) const
+	void process_chroma(const ImageBuffer<const void> src[], const ImageBuffer<void> dst[], void *tmp, unsigned seed) const
 	{
-		ExecutionState state{ m_id_counter, tmp, nullptr, nullptr };
+		ExecutionState state{ m_id_counter, tmp, nullptr, nullptr, seed, m_stats_enabled, m_trace.get() };
 		auto attr = m_node->get_image_attributes(false);
 		unsigned h_step = get_tile_width(ExecutionStrategy::CHROMA);
 		unsigned v_step = 1U << m_subsample_h;
@@ -1112,6 +2125,7 @@ class FilterGraph::impl {
 		state.set_external_buffer(m_head->get_id(), src_);
 		state.set_external_buffer(m_node_uv->get_id(), dst_);
 
+		plan_cache_strides(ExecutionStrategy::CHROMA, h_step, state.get_node_table(), state.get_stride_table());
 		for (const auto &node : m_node_set) {
 			node->init_context(&state, ExecutionStrategy::CHROMA);
 		}
@@ -1124,11 +2138,14 @@ class FilterGraph::impl {
 				h_step = attr.width - j;
 			}
 
+			TileTrace tile_trace{ state.get_trace(), "chroma tile", j, j_end };
+
 			for (const auto &node : m_node_set) {
 				node->reset_context(&state);
 			}
 
-			m_node_uv->set_tile_region(&state, j >> m_subsample_w, j_end >> m_subsample_w, true);
+			set_tile_region(ExecutionStrategy::CHROMA, state.get_node_table(), j, j_end);
+			set_cache_origins(&state);
 
 			for (unsigned i = 0; i < attr.height; i += v_step) {
 				m_node_uv->generate_line(&state, i >> m_subsample_h, true);
@@ -1146,10 +2163,20 @@ public:
 		m_subsample_w{},
 		m_subsample_h{},
 		m_tile_width{},
+		m_cpu{ CPUClass::NONE },
 		m_color_input{ color },
 		m_color_filter{},
 		m_requires_64b_alignment{},
-		m_is_complete{}
+		m_stats_enabled{},
+		m_is_complete{},
+		m_trace{},
+		m_stream_input_buffering{},
+		m_async_unpack_ahead{},
+		m_async_pack_behind{},
+		m_callback_batch{},
+		m_callback_full_width{},
+		m_allocator(current_allocator()),
+		m_async_idle{}
 	{
 		zassert_d(width <= pixel_max_width(type), "image stride causes overflow");
 
@@ -1262,6 +2289,28 @@ public:
 
 	void set_tile_width(unsigned tile_width) { m_tile_width = tile_width; }
 
+	void set_cpu(CPUClass cpu) { m_cpu = cpu; }
+
+	void set_stats_enabled(bool enabled) { m_stats_enabled = enabled; }
+
+	void set_trace_capacity(size_t capacity)
+	{
+		AllocatorScope allocator_scope{ m_allocator };
+		m_trace = capacity ? ztd::make_unique<TraceBuffer>(capacity) : nullptr;
+	}
+
+	void set_async_io(unsigned unpack_ahead, unsigned pack_behind)
+	{
+		m_async_unpack_ahead = unpack_ahead;
+		m_async_pack_behind = pack_behind;
+	}
+
+	void set_callback_batch(unsigned rows, bool full_width)
+	{
+		m_callback_batch = rows;
+		m_callback_full_width = full_width;
+	}
+
 	void complete()
 	{
 		check_incomplete();
@@ -1338,6 +2387,41 @@ public:
 		m_is_complete = true;
 	}
 
+	// Record the source lines read by each row group. Only needed by streams,
+	// so the simulation is repeated on first use instead of in {@link complete}.
+	void plan_stream() const
+	{
+		std::call_once(m_stream_once, [&]()
+		{
+			unsigned height = m_node->get_image_attributes().height;
+			std::vector<SimulationState> cache_state(m_id_counter);
+			std::vector<std::pair<unsigned, unsigned>> stream_rows;
+			SimulationState &source_state = cache_state[m_head->get_id()];
+
+			for (unsigned i = 0; i < height; i += (1U << m_subsample_h)) {
+				source_state.first = UINT_MAX;
+
+				m_node->simulate(cache_state.data(), i, i + (1U << m_subsample_h), false);
+				if (m_node_uv)
+					m_node_uv->simulate(cache_state.data(), i >> m_subsample_h, (i >> m_subsample_h) + 1, true);
+
+				stream_rows.emplace_back(std::min(source_state.first, source_state.pos), source_state.pos);
+			}
+
+			// Lines read by a later row group must also remain buffered when streaming.
+			unsigned stream_lines = 0;
+			for (size_t n = stream_rows.size(); n-- > 0;) {
+				if (n + 1 < stream_rows.size())
+					stream_rows[n].first = std::min(stream_rows[n].first, stream_rows[n + 1].first);
+				stream_lines = std::max(stream_lines, stream_rows[n].second - stream_rows[n].first);
+			}
+
+			unsigned stream_mask = select_zimg_buffer_mask(stream_lines);
+			m_stream_rows = std::move(stream_rows);
+			m_stream_input_buffering = (stream_lines >= get_input_height() || stream_mask == BUFFER_MAX) ? BUFFER_MAX : stream_mask + 1;
+		});
+	}
+
 	size_t get_tmp_size() const
 	{
 		check_complete();
@@ -1376,6 +2460,25 @@ public:
 		return lines;
 	}
 
+	unsigned get_stream_input_buffering() const
+	{
+		check_complete();
+		plan_stream();
+		return m_stream_input_buffering;
+	}
+
+	unsigned get_callback_input_buffering() const
+	{
+		unsigned extra = std::max(m_async_unpack_ahead, get_batch_lines(1U << m_input_subsample_h));
+		return add_async_lines(get_input_buffering(), extra, get_input_height());
+	}
+
+	unsigned get_callback_output_buffering() const
+	{
+		unsigned extra = std::max(m_async_pack_behind, get_batch_lines(1U << m_subsample_h));
+		return add_async_lines(get_output_buffering(), extra, get_output_height());
+	}
+
 	bool requires_64b_alignment() const
 	{
 		check_complete();
@@ -1388,33 +2491,229 @@ public:
 		return get_tile_width(ExecutionStrategy::COLOR);
 	}
 
-	void process(const ImageBuffer<const void> src[], const ImageBuffer<void> dst[], void *tmp, callback unpack_cb, callback pack_cb) const
+	CPUClass get_cpu() const { return m_cpu; }
+
+	std::string dump_plan(plan_format format) const
+	{
+		check_complete();
+		return format == plan_format::DOT ? dump_plan_dot() : dump_plan_json();
+	}
+
+	std::vector<node_stats> get_stats() const
+	{
+		std::vector<node_stats> stats;
+
+		for (const auto &node : m_node_set) {
+			if (const FilterNode *filter_node = dynamic_cast<const FilterNode *>(node.get()))
+				stats.push_back(filter_node->get_stats());
+		}
+		return stats;
+	}
+
+	std::string dump_trace() const
+	{
+		return m_trace ? m_trace->to_json() : TraceBuffer{ 0 }.to_json();
+	}
+
+	void clear_trace() const
+	{
+		if (m_trace)
+			m_trace->clear();
+	}
+
+	void reset_stats() const
+	{
+		for (const auto &node : m_node_set) {
+			if (const FilterNode *filter_node = dynamic_cast<const FilterNode *>(node.get()))
+				filter_node->reset_stats();
+		}
+	}
+
+	void process(const ImageBuffer<const void> src[], const ImageBuffer<void> dst[], void *tmp, callback unpack_cb, callback pack_cb, unsigned seed) const
 	{
 		check_complete();
 
 		if (m_color_filter || unpack_cb || pack_cb) {
-			process_color(src, dst, tmp, unpack_cb, pack_cb);
+			process_color(src, dst, tmp, unpack_cb, pack_cb, seed);
 		} else {
-			process_luma(src, dst, tmp);
+			process_luma(src, dst, tmp, seed);
 			if (m_node_uv)
-				process_chroma(src, dst, tmp);
+				process_chroma(src, dst, tmp, seed);
+		}
+	}
+
+	unsigned get_input_height() const { return m_head->get_image_attributes().height; }
+	unsigned get_output_height() const { return m_node->get_image_attributes().height; }
+	unsigned get_output_row_step() const { return 1U << m_subsample_h; }
+
+	// Source lines which must be buffered to produce the row group at output row {@p i}.
+	std::pair<unsigned, unsigned> get_stream_rows(unsigned i) const { return m_stream_rows[i >> m_subsample_h]; }
+
+	const allocator_hooks &get_allocator() const { return m_allocator; }
+
+	size_t get_stream_tmp_size() const
+	{
+		check_complete();
+		return get_tmp_size(ExecutionStrategy::COLOR, m_node->get_image_attributes().width);
+	}
+
+	unsigned get_stream_input_lines(const ImageBuffer<const void> src[]) const
+	{
+		unsigned height = get_input_height();
+		unsigned lines = get_buffer_lines(src, height, m_input_subsample_h, m_color_input);
+
+		plan_stream();
+		if (lines < (m_stream_input_buffering == BUFFER_MAX ? height : m_stream_input_buffering))
+			error::throw_<error::IllegalArgument>("input buffer too small for streaming");
+
+		return lines;
+	}
+
+	unsigned get_stream_output_lines(const ImageBuffer<void> dst[]) const
+	{
+		unsigned height = get_output_height();
+		unsigned lines = get_buffer_lines(dst, height, m_subsample_h, !!m_node_uv);
+		unsigned buffering = get_output_buffering();
+
+		if (lines < (buffering == BUFFER_MAX ? height : std::min(buffering, height)))
+			error::throw_<error::IllegalArgument>("output buffer too small for streaming");
+
+		return lines;
+	}
+
+	// Streaming executes the color strategy in a single tile spanning the image width.
+	ExecutionState begin_stream(void *tmp, const ImageBuffer<const void> src[], const ImageBuffer<void> dst[], unsigned seed) const
+	{
+		check_complete();
+
+		ExecutionState state{ m_id_counter, tmp, nullptr, nullptr, seed, m_stats_enabled, m_trace.get() };
+		auto attr = m_node->get_image_attributes(false);
+
+		ColorImageBuffer<void> src_;
+		ColorImageBuffer<void> dst_;
+
+		for (unsigned p = 0; p < 3; ++p) {
+			src_[p] = { const_cast<void *>(src[p].data()), src[p].stride(), src[p].mask() };
+			dst_[p] = dst[p];
 		}
+
+		state.set_external_buffer(m_head->get_id(), src_);
+		state.set_external_buffer(m_node->get_id(), dst_);
+		if (m_node_uv && m_node != m_node_uv)
+			state.set_external_buffer(m_node_uv->get_id(), dst_);
+
+		plan_cache_strides(ExecutionStrategy::COLOR, attr.width, state.get_node_table(), state.get_stride_table());
+		for (const auto &node : m_node_set) {
+			node->init_context(&state, ExecutionStrategy::COLOR);
+		}
+		for (const auto &node : m_node_set) {
+			node->reset_context(&state);
+		}
+
+		set_tile_region(ExecutionStrategy::COLOR, state.get_node_table(), 0, attr.width);
+		set_cache_origins(&state);
+
+		return state;
+	}
+
+	void process_stream_rows(ExecutionState *state, unsigned i) const
+	{
+		for (unsigned ii = i; ii < i + get_output_row_step(); ++ii) {
+			m_node->generate_line(state, ii, false);
+		}
+		if (m_node_uv)
+			m_node_uv->generate_line(state, i >> m_subsample_h, true);
 	}
 };
 
 
-FilterGraph::callback::callback(std::nullptr_t) : m_func{}, m_user{} {}
+class FilterGraph::stream::impl : public HookAllocated {
+	const FilterGraph::impl &m_graph;
+	AlignedVector<char> m_tmp;
+	ExecutionState m_state;
+	unsigned m_input_lines;
+	unsigned m_output_lines;
+	unsigned m_rows_pushed;
+	unsigned m_rows_pulled;
+public:
+	impl(const FilterGraph::impl &graph, const ImageBuffer<const void> src[], const ImageBuffer<void> dst[], unsigned seed) try :
+		m_graph(graph),
+		m_tmp(graph.get_stream_tmp_size(), AlignedAllocator<char>{ graph.get_allocator() }),
+		m_state{ graph.begin_stream(m_tmp.data(), src, dst, seed) },
+		m_input_lines{ graph.get_stream_input_lines(src) },
+		m_output_lines{ graph.get_stream_output_lines(dst) },
+		m_rows_pushed{},
+		m_rows_pulled{}
+	{
+	} catch (const std::bad_alloc &) {
+		error::throw_<error::OutOfMemory>();
+	}
+
+	unsigned get_rows_pushed() const { return m_rows_pushed; }
+	unsigned get_rows_pulled() const { return m_rows_pulled; }
+
+	void push_rows(unsigned count)
+	{
+		unsigned height = m_graph.get_input_height();
 
-FilterGraph::callback::callback(func_type func, void *user) : m_func{ func }, m_user{ user } {}
+		if (count > height - m_rows_pushed)
+			error::throw_<error::IllegalArgument>("rows pushed past end of image");
 
-FilterGraph::callback::operator bool() const { return m_func != nullptr; }
+		// Rows below the first line still required by the graph may be overwritten.
+		if (m_input_lines < height && m_rows_pulled < m_graph.get_output_height()) {
+			unsigned first = m_graph.get_stream_rows(m_rows_pulled).first;
+
+			if (m_rows_pushed + count > first + m_input_lines)
+				error::throw_<error::IllegalArgument>("input buffer overflow");
+		}
+
+		m_rows_pushed += count;
+	}
+
+	unsigned pull_rows(unsigned *first)
+	{
+		unsigned height = m_graph.get_output_height();
+		unsigned step = m_graph.get_output_row_step();
+		unsigned buffering = m_graph.get_output_buffering();
 
-void FilterGraph::callback::operator()(unsigned i, unsigned left, unsigned right) const
+		// The output node may write ahead of the current row group by up to its
+		// buffering, which must not overwrite the rows produced by this call.
+		unsigned limit = m_output_lines >= height ? height : m_output_lines - std::min(buffering, m_output_lines) + step;
+		unsigned count = 0;
+
+		*first = m_rows_pulled;
+
+		while (m_rows_pulled < height && count + step <= limit && m_graph.get_stream_rows(m_rows_pulled).second <= m_rows_pushed) {
+			m_graph.process_stream_rows(&m_state, m_rows_pulled);
+			m_rows_pulled += step;
+			count += step;
+		}
+
+		return count;
+	}
+};
+
+
+FilterGraph::callback::callback(std::nullptr_t) : m_func{}, m_batch_func{}, m_user{} {}
+
+FilterGraph::callback::callback(func_type func, void *user) : m_func{ func }, m_batch_func{}, m_user{ user } {}
+
+FilterGraph::callback::callback(batch_func_type func, void *user) : m_func{}, m_batch_func{ func }, m_user{ user } {}
+
+FilterGraph::callback::operator bool() const { return m_func != nullptr || m_batch_func != nullptr; }
+
+void FilterGraph::callback::operator()(unsigned i, unsigned count, unsigned step, unsigned left, unsigned right) const
 {
-	int ret;
+	int ret = 0;
 
 	try {
-		ret = m_func(m_user, i, left, right);
+		if (m_batch_func) {
+			ret = m_batch_func(m_user, i, count, left, right);
+		} else {
+			for (unsigned ii = i; ii < i + count && !ret; ii += step) {
+				ret = m_func(m_user, ii, left, right);
+			}
+		}
 	} catch (...) {
 		ret = 1;
 		zassert_d(false, "user callback must not throw");
@@ -1465,6 +2764,31 @@ void FilterGraph::set_tile_width(unsigned tile_width)
 	get_impl()->set_tile_width(tile_width);
 }
 
+void FilterGraph::set_cpu(CPUClass cpu)
+{
+	get_impl()->set_cpu(cpu);
+}
+
+void FilterGraph::set_stats_enabled(bool enabled)
+{
+	get_impl()->set_stats_enabled(enabled);
+}
+
+void FilterGraph::set_trace_capacity(size_t capacity)
+{
+	get_impl()->set_trace_capacity(capacity);
+}
+
+void FilterGraph::set_async_io(unsigned unpack_ahead, unsigned pack_behind)
+{
+	get_impl()->set_async_io(unpack_ahead, pack_behind);
+}
+
+void FilterGraph::set_callback_batch(unsigned rows, bool full_width)
+{
+	get_impl()->set_callback_batch(rows, full_width);
+}
+
 void FilterGraph::complete()
 {
 	get_impl()->complete();
@@ -1475,14 +2799,24 @@ size_t FilterGraph::get_tmp_size() const
 	return get_impl()->get_tmp_size();
 }
 
+const allocator_hooks &FilterGraph::get_allocator() const
+{
+	return get_impl()->get_allocator();
+}
+
 unsigned FilterGraph::get_input_buffering() const
 {
-	return get_impl()->get_input_buffering();
+	return get_impl()->get_callback_input_buffering();
 }
 
 unsigned FilterGraph::get_output_buffering() const
 {
-	return get_impl()->get_output_buffering();
+	return get_impl()->get_callback_output_buffering();
+}
+
+unsigned FilterGraph::get_stream_input_buffering() const
+{
+	return get_impl()->get_stream_input_buffering();
 }
 
 bool FilterGraph::requires_64b_alignment() const
@@ -1495,9 +2829,73 @@ unsigned FilterGraph::tile_width() const
 	return get_impl()->tile_width();
 }
 
-void FilterGraph::process(const ImageBuffer<const void> *src, const ImageBuffer<void> *dst, void *tmp, callback unpack_cb, callback pack_cb) const
+CPUClass FilterGraph::get_cpu() const
+{
+	return get_impl()->get_cpu();
+}
+
+std::string FilterGraph::dump_plan(plan_format format) const
+{
+	return get_impl()->dump_plan(format);
+}
+
+std::vector<FilterGraph::node_stats> FilterGraph::get_stats() const
+{
+	return get_impl()->get_stats();
+}
+
+void FilterGraph::reset_stats() const
+{
+	get_impl()->reset_stats();
+}
+
+std::string FilterGraph::dump_trace() const
+{
+	return get_impl()->dump_trace();
+}
+
+void FilterGraph::clear_trace() const
+{
+	get_impl()->clear_trace();
+}
+
+void FilterGraph::process(const ImageBuffer<const void> *src, const ImageBuffer<void> *dst, void *tmp, callback unpack_cb, callback pack_cb, unsigned seed) const
+{
+	ScratchPool::lease scratch;
+
+	if (!tmp) {
+		scratch = ScratchPool::local().acquire(get_tmp_size());
+		tmp = scratch.get();
+	}
+
+	get_impl()->process(src, dst, tmp, unpack_cb, pack_cb, seed);
+}
+
+
+FilterGraph::stream::stream(const FilterGraph &graph, const ImageBuffer<const void> src[], const ImageBuffer<void> dst[], unsigned seed) :
+	m_impl{ ztd::make_unique<impl>(*graph.get_impl(), src, dst, seed) }
+{}
+
+FilterGraph::stream::~stream() = default;
+
+unsigned FilterGraph::stream::get_rows_pushed() const
+{
+	return m_impl->get_rows_pushed();
+}
+
+unsigned FilterGraph::stream::get_rows_pulled() const
+{
+	return m_impl->get_rows_pulled();
+}
+
+void FilterGraph::stream::push_rows(unsigned count)
+{
+	m_impl->push_rows(count);
+}
+
+unsigned FilterGraph::stream::pull_rows(unsigned *first)
 {
-	get_impl()->process(src, dst, tmp, unpack_cb, pack_cb);
+	return m_impl->pull_rows(first);
 }
 
 } // namespace graph
@@ -4,6 +4,9 @@
 #define ZIMG_GRAPH_FILTERGRAPH_H_
 
 #include <memory>
+#include <string>
+#include <vector>
+#include "common/alloc.h"
 
 // Base class in global namespace for API export.
 struct zimg_filter_graph {
@@ -12,9 +15,16 @@ struct zimg_filter_graph {
 
 zimg_filter_graph::~zimg_filter_graph() = default;
 
+struct zimg_filter_graph_stream {
+	virtual inline ~zimg_filter_graph_stream() = 0;
+};
+
+zimg_filter_graph_stream::~zimg_filter_graph_stream() = default;
+
 
 namespace zimg {
 
+enum class CPUClass;
 enum class PixelType;
 
 namespace graph {
@@ -28,7 +38,7 @@ class ImageBuffer;
 /**
  * Manages dynamic traversal and execution of filter graphs.
  */
-class FilterGraph : public zimg_filter_graph {
+class FilterGraph : public zimg_filter_graph, public HookAllocated {
 	class impl;
 public:
 	/**
@@ -36,8 +46,10 @@ public:
 	 */
 	class callback {
 		typedef int (*func_type)(void *user, unsigned i, unsigned left, unsigned right);
+		typedef int (*batch_func_type)(void *user, unsigned i, unsigned count, unsigned left, unsigned right);
 
 		func_type m_func;
+		batch_func_type m_batch_func;
 		void *m_user;
 	public:
 		/**
@@ -53,6 +65,15 @@ public:
 		 */
 		callback(func_type func, void *user);
 
+		/**
+		 * Construct a callback from user-defined function operating on
+		 * multiple rows.
+		 *
+		 * @param func function pointer
+		 * @param user user private data
+		 */
+		callback(batch_func_type func, void *user);
+
 		/**
 		 * Check if callback is set.
 		 *
@@ -63,11 +84,38 @@ public:
 		/**
 		 * Invoke user-defined callback.
 		 *
-		 * @param i row index of line to read/write
+		 * A single-row function is invoked once for each group of {@p step}
+		 * rows, and a multi-row function once for all rows.
+		 *
+		 * @param i row index of first line to read/write
+		 * @param count number of lines, a multiple of {@p step}
+		 * @param step number of lines in a row group
 		 * @param left left column index
 		 * @param right right column index, plus one
 		 */
-		void operator()(unsigned i, unsigned left, unsigned right) const;
+		void operator()(unsigned i, unsigned count, unsigned step, unsigned left, unsigned right) const;
+	};
+
+	class stream;
+
+	/**
+	 * Execution statistics of a filter node.
+	 */
+	struct node_stats {
+		const char *name;                 /**< Unqualified class name of the filter. */
+		unsigned long long calls;         /**< Number of filter invocations. */
+		unsigned long long pixels;        /**< Pixels produced, counted once per plane. */
+		unsigned long long nanoseconds;   /**< Wall time spent in the filter. */
+		unsigned long long bytes_read;    /**< Size of the input region required by the filter. */
+		unsigned long long bytes_written; /**< Size of the output region produced by the filter. */
+	};
+
+	/**
+	 * Output format of {@link dump_plan}.
+	 */
+	enum class plan_format {
+		JSON,
+		DOT,
 	};
 private:
 	std::unique_ptr<impl> m_impl;
@@ -154,6 +202,73 @@ public:
 	 */
 	void set_tile_width(unsigned tile_width);
 
+	/**
+	 * Set the instruction set selected for the filters in the graph.
+	 *
+	 * The value is informational and does not affect graph execution.
+	 *
+	 * @param cpu CPU type
+	 */
+	void set_cpu(CPUClass cpu);
+
+	/**
+	 * Enable or disable collection of execution statistics.
+	 *
+	 * Must not be called while the graph is being processed.
+	 *
+	 * @param enabled whether to collect statistics
+	 */
+	void set_stats_enabled(bool enabled);
+
+	/**
+	 * Enable or disable tracing of graph execution.
+	 *
+	 * When enabled, the start time and duration of each tile, filter
+	 * invocation and I/O callback are recorded in a ring buffer holding the
+	 * most recent {@p capacity} events. Any previous trace is discarded.
+	 *
+	 * Must not be called while the graph is being processed.
+	 *
+	 * @param capacity maximum number of events retained, or zero to disable
+	 */
+	void set_trace_capacity(size_t capacity);
+
+	/**
+	 * Configure asynchronous execution of the I/O callbacks.
+	 *
+	 * When enabled, the callbacks passed to {@link process} are invoked on a
+	 * separate thread, so that I/O overlaps with computation. Input is unpacked
+	 * up to {@p unpack_ahead} rows ahead of the graph, and output is packed up
+	 * to {@p pack_behind} rows behind it. The input and output buffering are
+	 * increased accordingly. Buffers smaller than the increased buffering
+	 * reduce the distance, but remain valid.
+	 *
+	 * Must not be called while the graph is being processed.
+	 *
+	 * @param unpack_ahead maximum number of input rows read ahead
+	 * @param pack_behind maximum number of output rows written behind
+	 */
+	void set_async_io(unsigned unpack_ahead, unsigned pack_behind);
+
+	/**
+	 * Configure grouping of rows in the I/O callbacks.
+	 *
+	 * Consecutive row groups are passed to the callbacks in batches of up to
+	 * {@p rows} rows, rounded down to the vertical subsampling. The input and
+	 * output buffering are increased accordingly. Buffers smaller than the
+	 * increased buffering reduce the batch size, but remain valid.
+	 *
+	 * If {@p full_width} is set and a buffer holds the entire image, each row
+	 * of that buffer is passed to the callback once across the full width of
+	 * the image, rather than once per tile.
+	 *
+	 * Must not be called while the graph is being processed.
+	 *
+	 * @param rows maximum number of rows per invocation, or zero for one row group
+	 * @param full_width whether to invoke the callbacks on entire rows
+	 */
+	void set_callback_batch(unsigned rows, bool full_width);
+
 	/**
 	 * Finalize graph.
 	 *
@@ -169,20 +284,52 @@ public:
 	 */
 	size_t get_tmp_size() const;
 
+	/**
+	 * Get the allocator selected when the graph was created.
+	 *
+	 * Objects owned by the graph, and streams of the graph, are allocated by
+	 * this allocator.
+	 *
+	 * @return allocation functions
+	 */
+	const allocator_hooks &get_allocator() const;
+
 	/**
 	 * Get number of input lines used simultaneously during graph execution.
 	 *
+	 * Includes the lines read ahead by asynchronous I/O and the lines
+	 * grouped into batches for the I/O callbacks.
+	 *
 	 * @return number of lines
+	 * @see set_async_io
+	 * @see set_callback_batch
 	 */
 	unsigned get_input_buffering() const;
 
 	/**
 	 * Get number of output lines used simultaneously during graph execution.
 	 *
+	 * Includes the lines written behind by asynchronous I/O and the lines
+	 * grouped into batches for the I/O callbacks.
+	 *
 	 * @return number of lines
+	 * @see set_async_io
+	 * @see set_callback_batch
 	 */
 	unsigned get_output_buffering() const;
 
+	/**
+	 * Get number of input lines used simultaneously when streaming.
+	 *
+	 * Streaming requires the input of an entire output row group to be
+	 * present before it is processed, which may exceed the buffering
+	 * required by {@link process}.
+	 *
+	 * @return number of lines
+	 * @see stream
+	 */
+	unsigned get_stream_input_buffering() const;
+
 	/**
 	 * Check if the graph requires 64-byte data alignment.
 	 *
@@ -197,16 +344,143 @@ public:
 	 */
 	unsigned tile_width() const;
 
+	/**
+	 * Get the instruction set selected for the filters in the graph.
+	 *
+	 * @return CPU type
+	 */
+	CPUClass get_cpu() const;
+
+	/**
+	 * Describe the execution plan of the graph.
+	 *
+	 * The plan lists each node with its filter, flags, cache assignment and
+	 * the number of cached lines and row size under each execution strategy,
+	 * as well as the tile width, buffering and temporary buffer size of each
+	 * strategy.
+	 *
+	 * @param format output format
+	 * @return plan as JSON or Graphviz DOT
+	 */
+	std::string dump_plan(plan_format format) const;
+
+	/**
+	 * Get the execution statistics accumulated since the last reset.
+	 *
+	 * Statistics are reported for every filter node, in the order of
+	 * attachment. Node names are valid for the lifetime of the graph.
+	 *
+	 * @return statistics for each node
+	 */
+	std::vector<node_stats> get_stats() const;
+
+	/**
+	 * Reset the execution statistics of all nodes.
+	 */
+	void reset_stats() const;
+
+	/**
+	 * Get the recorded trace in the Chrome trace-event format.
+	 *
+	 * @return JSON document
+	 */
+	std::string dump_trace() const;
+
+	/**
+	 * Discard the recorded trace.
+	 */
+	void clear_trace() const;
+
 	/**
 	 * Process an image frame with filter graph.
 	 *
 	 * @param src pointer to input buffers
 	 * @param dst pointer to output buffers
-	 * @param tmp temporary buffer
+	 * @param tmp temporary buffer, or nullptr to borrow one from the
+	 *            {@link ScratchPool} of the calling thread
 	 * @param unpack_cb user-defined input callback
 	 * @param pack_cb user-defined output callback
+	 * @param seed per-frame seed for pseudo-random filters
+	 */
+	void process(const ImageBuffer<const void> src[], const ImageBuffer<void> dst[], void *tmp, callback unpack_cb, callback pack_cb, unsigned seed = 0) const;
+};
+
+/**
+ * Incremental execution of a filter graph, driven by the producer of the input.
+ *
+ * The image is processed from top to bottom in a single tile. The caller
+ * writes input rows to the source buffer as they become available and
+ * announces them with {@link push_rows}. Each call to {@link pull_rows} then
+ * produces as many output rows as the announced input allows. The graph must
+ * outlive the stream, and the stream must not be used by multiple threads.
+ */
+class FilterGraph::stream : public zimg_filter_graph_stream, public HookAllocated {
+	class impl;
+
+	std::unique_ptr<impl> m_impl;
+public:
+	/**
+	 * Begin streaming an image.
+	 *
+	 * The source buffer must hold at least {@link FilterGraph::get_stream_input_buffering}
+	 * lines and the destination buffer at least {@link FilterGraph::get_output_buffering}
+	 * lines. The buffers must remain valid until the stream is destroyed.
+	 *
+	 * @param graph completed filter graph
+	 * @param src pointer to input buffers
+	 * @param dst pointer to output buffers
+	 * @param seed per-frame seed for pseudo-random filters
+	 */
+	stream(const FilterGraph &graph, const ImageBuffer<const void> src[], const ImageBuffer<void> dst[], unsigned seed = 0);
+
+	/**
+	 * Destroy stream.
+	 */
+	~stream();
+
+	/**
+	 * Get the number of input rows announced so far.
+	 *
+	 * @return number of rows
+	 */
+	unsigned get_rows_pushed() const;
+
+	/**
+	 * Get the number of output rows produced so far.
+	 *
+	 * @return number of rows
+	 */
+	unsigned get_rows_pulled() const;
+
+	/**
+	 * Announce input rows.
+	 *
+	 * The rows following those previously announced must have been written to
+	 * the source buffer. For subsampled images, rows are counted in units of
+	 * luma rows, and a chroma row must be written together with the last luma
+	 * row it is associated with.
+	 *
+	 * Rows may be announced until they would overwrite buffered input which is
+	 * still required. Announcing the rows of one input row group at a time and
+	 * pulling all available output in between always satisfies this limit.
+	 *
+	 * @param count number of rows
+	 * @throw error::IllegalArgument if the input buffer would overflow
+	 */
+	void push_rows(unsigned count);
+
+	/**
+	 * Produce output rows.
+	 *
+	 * Output rows are produced in units of the output row group, for as long
+	 * as the input is available and the rows fit in the destination buffer.
+	 * The produced rows must be read before the next call. Zero rows are
+	 * produced when more input is needed or the image is complete.
+	 *
+	 * @param[out] first index of the first row produced
+	 * @return number of rows produced
 	 */
-	void process(const ImageBuffer<const void> src[], const ImageBuffer<void> dst[], void *tmp, callback unpack_cb, callback pack_cb) const;
+	unsigned pull_rows(unsigned *first);
 };
 
 } // namespace graph
@@ -233,7 +233,9 @@ auto DefaultFilterFactory::create_unresize(const unresize::UnresizeConversion &c
 
 GraphBuilder::params::params() noexcept :
 	unresize{},
+	unresize_threads{ 1 },
 	dither_type {},
+	dither_threads{ 1 },
 	peak_luminance{ NAN },
 	approximate_gamma{},
 	scene_referred{},
@@ -364,12 +366,14 @@ void GraphBuilder::convert_depth(const PixelFormat &format, const params *params
 
 	CPUClass cpu = params ? params->cpu : CPUClass::AUTO;
 	depth::DitherType dither_type = params ? params->dither_type : depth::DitherType::NONE;
+	unsigned dither_threads = params ? params->dither_threads : 1;
 
 	auto conv = depth::DepthConversion{ m_state.width, m_state.height }
 		.set_pixel_in(src_format)
 		.set_pixel_out(format)
 		.set_dither_type(dither_type)
-		.set_cpu(cpu);
+		.set_cpu(cpu)
+		.set_threads(dither_threads);
 
 	for (auto &&filter : factory->create_depth(conv)) {
 		std::shared_ptr<ImageFilter> shared_filter{ std::move(filter) };
@@ -432,6 +436,8 @@ void GraphBuilder::convert_resize(const resize_spec &spec, const params *params,
 	const resize::Filter *resample_filter = params ? params->filter.get() : &bicubic_filter;
 	const resize::Filter *resample_filter_uv = params ? params->filter_uv.get() : &bilinear_filter;
 	bool unresize = params && params->unresize;
+	const resize::Filter *unresize_filter = params ? params->unresize_filter.get() : nullptr;
+	unsigned unresize_threads = params ? params->unresize_threads : 1;
 	CPUClass cpu = params ? params->cpu : CPUClass::AUTO;
 
 	bool do_resize_luma = m_state.width != spec.width || m_state.height != spec.height || image_shifted;
@@ -451,11 +457,14 @@ void GraphBuilder::convert_resize(const resize_spec &spec, const params *params,
 
 		if (unresize) {
 			auto conv = unresize::UnresizeConversion{ m_state.width, m_state.height, m_state.type }
+				.set_depth(m_state.depth)
 				.set_orig_width(spec.width)
 				.set_orig_height(spec.height)
 				.set_shift_w(spec.shift_w)
 				.set_shift_h(spec.shift_h + extra_shift_h)
-				.set_cpu(cpu);
+				.set_filter(unresize_filter)
+				.set_cpu(cpu)
+				.set_threads(unresize_threads);
 
 			filter_list = factory->create_unresize(conv);
 		} else {
@@ -500,11 +509,14 @@ void GraphBuilder::convert_resize(const resize_spec &spec, const params *params,
 
 		if (unresize) {
 			auto conv = unresize::UnresizeConversion{ chroma_width_in, chroma_height_in, m_state.type }
+				.set_depth(m_state.depth)
 				.set_orig_width(chroma_width_out)
 				.set_orig_height(chroma_height_out)
 				.set_shift_w(spec.shift_w / (1 << m_state.subsample_w) + extra_shift_w)
 				.set_shift_h(spec.shift_h / (1 << m_state.subsample_h) + extra_shift_h)
-				.set_cpu(cpu);
+				.set_filter(unresize_filter)
+				.set_cpu(cpu)
+				.set_threads(unresize_threads);
 
 			filter_list_uv = factory->create_unresize(conv);
 		} else {
@@ -574,6 +586,8 @@ GraphBuilder &GraphBuilder::connect_graph(const state &target, const params *par
 	if (params && cpu_requires_64b_alignment(params->cpu))
 		m_graph->set_requires_64b_alignment();
 
+	m_graph->set_cpu(cpu_dispatch_class(params ? params->cpu : CPUClass::AUTO));
+
 	while (true) {
 		if (needs_colorspace(m_state, target)) {
 			resize_spec spec{ m_state };
@@ -604,9 +618,16 @@ GraphBuilder &GraphBuilder::connect_graph(const state &target, const params *par
 			// Convert to the target pixel format to reduce the required number of conversions.
 			// If neither the source nor target pixel format is directly supported, select a different format.
 			// Direct operation on half-precision is slightly slower, so avoid it if the target is not also half.
-			if (params && params->unresize)
-				convert_depth(PixelType::FLOAT, params, factory);
-			else if (target.type == PixelType::WORD)
+			// Unresize operates directly on integer samples only if the source is already in the target format and no
+			// dithering is requested, since the integer output is rounded. Otherwise, dithering must follow the unresize.
+			if (params && params->unresize) {
+				bool direct = m_state.type == PixelType::WORD && target.type == PixelType::WORD &&
+				              m_state.depth == target.depth && m_state.fullrange == target.fullrange &&
+				              params->dither_type == depth::DitherType::NONE;
+
+				if (!direct)
+					convert_depth(PixelType::FLOAT, params, factory);
+			} else if (target.type == PixelType::WORD)
 				convert_depth(PixelFormat{ target.type, target.depth, target.fullrange, false, is_ycgco(target) }, params, factory);
 			else if (target.type == PixelType::HALF && fast_f16)
 				convert_depth(PixelType::HALF, params, factory);
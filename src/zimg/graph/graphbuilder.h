@@ -112,7 +112,10 @@ public:
 		std::unique_ptr<const resize::Filter> filter;
 		std::unique_ptr<const resize::Filter> filter_uv;
 		bool unresize;
+		std::unique_ptr<const resize::Filter> unresize_filter;
+		unsigned unresize_threads;
 		depth::DitherType dither_type;
+		unsigned dither_threads;
 		double peak_luminance;
 		bool approximate_gamma;
 		bool scene_referred;
@@ -6,6 +6,7 @@
 #include <cstddef>
 #include <limits>
 #include <utility>
+#include "common/alloc.h"
 #include "image_buffer.h"
 
 namespace zimg {
@@ -17,7 +18,7 @@ namespace graph {
 /**
  * Interface for image filters.
  */
-class ImageFilter {
+class ImageFilter : public HookAllocated {
 public:
 	/**
 	 * Flags structure.
@@ -139,8 +140,9 @@ public:
 	 * Initialize per-frame filter context.
 	 *
 	 * @param ctx context
+	 * @param seed per-frame seed for filters with pseudo-random output
 	 */
-	virtual void init_context(void *ctx) const = 0;
+	virtual void init_context(void *ctx, unsigned seed) const = 0;
 
 	/**
 	 * Produce a range of output pixels.
@@ -179,7 +181,7 @@ public:
 	size_t get_context_size() const override { return 0; }
 	size_t get_tmp_size(unsigned, unsigned) const override { return 0; }
 
-	void init_context(void *ctx) const override {}
+	void init_context(void *ctx, unsigned seed) const override {}
 };
 
 inline ImageFilter::~ImageFilter() = default;
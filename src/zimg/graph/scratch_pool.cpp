@@ -0,0 +1,173 @@
+#include <atomic>
+#include <new>
+#include "common/alloc.h"
+#include "common/except.h"
+#include "scratch_pool.h"
+
+namespace zimg {
+namespace graph {
+
+namespace {
+
+std::atomic<size_t> g_allocated_size{};
+std::atomic<size_t> g_high_water_mark{};
+
+void add_allocated_size(size_t size) noexcept
+{
+	size_t allocated = g_allocated_size.fetch_add(size) + size;
+	size_t high_water = g_high_water_mark.load();
+
+	// A failed exchange reloads the current maximum.
+	while (high_water < allocated && !g_high_water_mark.compare_exchange_weak(high_water, allocated)) {}
+}
+
+} // namespace
+
+
+ScratchPool::lease::lease() noexcept : m_pool{}, m_ptr{}, m_class{} {}
+
+ScratchPool::lease::lease(ScratchPool *pool, void *ptr, unsigned size_class) noexcept :
+	m_pool{ pool },
+	m_ptr{ ptr },
+	m_class{ size_class }
+{}
+
+ScratchPool::lease::lease(lease &&other) noexcept :
+	m_pool{ other.m_pool },
+	m_ptr{ other.m_ptr },
+	m_class{ other.m_class }
+{
+	other.m_pool = nullptr;
+	other.m_ptr = nullptr;
+}
+
+ScratchPool::lease::~lease()
+{
+	if (m_ptr)
+		m_pool->release(m_ptr, m_class);
+}
+
+ScratchPool::lease &ScratchPool::lease::operator=(lease &&other) noexcept
+{
+	if (this != &other) {
+		if (m_ptr)
+			m_pool->release(m_ptr, m_class);
+
+		m_pool = other.m_pool;
+		m_ptr = other.m_ptr;
+		m_class = other.m_class;
+		other.m_pool = nullptr;
+		other.m_ptr = nullptr;
+	}
+	return *this;
+}
+
+
+ScratchPool::ScratchPool() : m_count{}, m_allocator(current_allocator()) {}
+
+ScratchPool::~ScratchPool()
+{
+	trim();
+}
+
+ScratchPool &ScratchPool::local()
+{
+	thread_local ScratchPool pool;
+	return pool;
+}
+
+size_t ScratchPool::allocated_size() noexcept
+{
+	return g_allocated_size.load();
+}
+
+size_t ScratchPool::high_water_mark() noexcept
+{
+	return g_high_water_mark.load();
+}
+
+void ScratchPool::reset_high_water_mark() noexcept
+{
+	g_high_water_mark.store(g_allocated_size.load());
+}
+
+void ScratchPool::release(void *ptr, unsigned size_class) noexcept
+{
+	// Capacity for every buffer of the class was reserved in advance.
+	m_free[size_class].push_back(ptr);
+}
+
+ScratchPool::lease ScratchPool::acquire(size_t size)
+{
+	unsigned size_class = MIN_CLASS;
+
+	while (size_class < NUM_CLASSES - 1 && (static_cast<size_t>(1) << size_class) < size) {
+		++size_class;
+	}
+
+	size_t class_size = static_cast<size_t>(1) << size_class;
+	if (class_size < size)
+		error::throw_<error::OutOfMemory>();
+
+	std::vector<void *> &free_list = m_free[size_class];
+
+	if (current_allocator() != m_allocator) {
+		bool idle = true;
+
+		for (unsigned n = 0; n < NUM_CLASSES; ++n) {
+			idle = idle && m_free[n].size() == m_count[n];
+		}
+		if (idle) {
+			trim();
+			m_allocator = current_allocator();
+		}
+	}
+
+	if (!free_list.empty()) {
+		void *ptr = free_list.back();
+		free_list.pop_back();
+		return{ this, ptr, size_class };
+	}
+
+	try {
+		free_list.reserve(m_count[size_class] + 1);
+	} catch (const std::bad_alloc &) {
+		error::throw_<error::OutOfMemory>();
+	}
+
+	void *ptr = m_allocator.allocate(class_size, ALIGNMENT);
+	if (!ptr)
+		error::throw_<error::OutOfMemory>();
+
+	++m_count[size_class];
+	add_allocated_size(class_size);
+	return{ this, ptr, size_class };
+}
+
+void ScratchPool::trim() noexcept
+{
+	for (unsigned size_class = 0; size_class < NUM_CLASSES; ++size_class) {
+		std::vector<void *> &free_list = m_free[size_class];
+
+		for (void *ptr : free_list) {
+			m_allocator.deallocate(ptr, static_cast<size_t>(1) << size_class);
+		}
+
+		g_allocated_size.fetch_sub(free_list.size() << size_class);
+		m_count[size_class] -= free_list.size();
+		free_list.clear();
+	}
+}
+
+size_t ScratchPool::cached_size() const noexcept
+{
+	size_t size = 0;
+
+	for (unsigned size_class = 0; size_class < NUM_CLASSES; ++size_class) {
+		size += m_free[size_class].size() << size_class;
+	}
+	return size;
+}
+
+} // namespace graph
+} // namespace zimg
@@ -0,0 +1,124 @@
+#pragma once
+
+#ifndef ZIMG_GRAPH_SCRATCH_POOL_H_
+#define ZIMG_GRAPH_SCRATCH_POOL_H_
+
+#include <array>
+#include <cstddef>
+#include <vector>
+#include "common/alloc.h"
+
+namespace zimg {
+namespace graph {
+
+/**
+ * Cache of temporary buffers for graph execution.
+ *
+ * Buffers are grouped into power-of-two size classes, so that a buffer
+ * released after processing one graph can be reused by any graph whose
+ * temporary buffer fits the same class. Each thread owns a separate pool,
+ * which is released when the thread exits.
+ *
+ * Buffers are allocated by the allocator selected when the pool was created.
+ * Once all of its buffers are returned, the pool switches to the allocator
+ * currently selected.
+ */
+class ScratchPool {
+	static constexpr unsigned MIN_CLASS = 12;
+	static constexpr unsigned NUM_CLASSES = sizeof(size_t) * 8;
+
+	std::array<std::vector<void *>, NUM_CLASSES> m_free;
+	std::array<size_t, NUM_CLASSES> m_count;
+	allocator_hooks m_allocator;
+
+	void release(void *ptr, unsigned size_class) noexcept;
+public:
+	/**
+	 * Buffer borrowed from a pool.
+	 *
+	 * The buffer is returned to the pool when the lease is destroyed.
+	 */
+	class lease {
+		ScratchPool *m_pool;
+		void *m_ptr;
+		unsigned m_class;
+	public:
+		lease() noexcept;
+
+		lease(ScratchPool *pool, void *ptr, unsigned size_class) noexcept;
+
+		lease(lease &&other) noexcept;
+
+		~lease();
+
+		lease &operator=(lease &&other) noexcept;
+
+		/**
+		 * Get the buffer.
+		 *
+		 * @return pointer to buffer, or null if no buffer is held
+		 */
+		void *get() const noexcept { return m_ptr; }
+	};
+
+	ScratchPool();
+
+	ScratchPool(const ScratchPool &) = delete;
+
+	~ScratchPool();
+
+	ScratchPool &operator=(const ScratchPool &) = delete;
+
+	/**
+	 * Get the pool of the calling thread.
+	 *
+	 * @return pool
+	 */
+	static ScratchPool &local();
+
+	/**
+	 * Get the total size of the buffers allocated by all pools.
+	 *
+	 * @return size in bytes, including buffers in use
+	 */
+	static size_t allocated_size() noexcept;
+
+	/**
+	 * Get the largest value of {@link allocated_size} since the program
+	 * started or the statistic was reset.
+	 *
+	 * @return size in bytes
+	 */
+	static size_t high_water_mark() noexcept;
+
+	/**
+	 * Reset the high-water mark to the current allocated size.
+	 */
+	static void reset_high_water_mark() noexcept;
+
+	/**
+	 * Borrow a buffer aligned to {@link ALIGNMENT}.
+	 *
+	 * @param size minimum size in bytes
+	 * @return lease of buffer
+	 * @throw error::OutOfMemory if the buffer could not be allocated
+	 */
+	lease acquire(size_t size);
+
+	/**
+	 * Free all buffers not currently in use.
+	 */
+	void trim() noexcept;
+
+	/**
+	 * Get the total size of the buffers not currently in use.
+	 *
+	 * @return size in bytes
+	 */
+	size_t cached_size() const noexcept;
+};
+
+} // namespace graph
+} // namespace zimg
+
+#endif // ZIMG_GRAPH_SCRATCH_POOL_H_
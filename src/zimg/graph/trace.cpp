@@ -0,0 +1,146 @@
+#include <algorithm>
+#include <stdexcept>
+#include <thread>
+#include "common/except.h"
+#include "trace.h"
+
+namespace zimg {
+namespace graph {
+
+namespace {
+
+// Number threads in order of first use, as required by the trace-event format.
+unsigned current_thread_id()
+{
+	static std::atomic_uint counter{};
+	thread_local unsigned id = counter++;
+	return id;
+}
+
+const char *category_name(TraceBuffer::category cat)
+{
+	switch (cat) {
+	case TraceBuffer::category::TILE:
+		return "tile";
+	case TraceBuffer::category::FILTER:
+		return "filter";
+	case TraceBuffer::category::UNPACK:
+		return "unpack";
+	default:
+		return "pack";
+	}
+}
+
+// Format nanoseconds as fractional microseconds.
+std::string format_us(uint64_t ns)
+{
+	std::string frac = std::to_string(ns % 1000);
+	return std::to_string(ns / 1000) + '.' + std::string(3 - frac.size(), '0') + frac;
+}
+
+} // namespace
+
+
+TraceBuffer::TraceBuffer(size_t capacity) try :
+	m_slots(capacity),
+	m_count{},
+	m_epoch{ clock::now() }
+{
+} catch (const std::length_error &) {
+	error::throw_<error::OutOfMemory>();
+}
+
+void TraceBuffer::record(const char *name, category cat, clock::time_point start, clock::time_point end, unsigned row, unsigned left, unsigned right)
+{
+	if (m_slots.empty())
+		return;
+
+	uint64_t idx = m_count.fetch_add(1, std::memory_order_relaxed);
+	slot &s = m_slots[static_cast<size_t>(idx % m_slots.size())];
+	uint64_t seq = s.seq.load(std::memory_order_relaxed);
+
+	// Claim the slot, unless a newer event has claimed it. An older event still
+	// being written finishes quickly, so wait for it.
+	while (true) {
+		if (seq >= idx * 2 + 1)
+			return;
+		if (seq % 2)
+			std::this_thread::yield();
+		else if (s.seq.compare_exchange_weak(seq, idx * 2 + 1, std::memory_order_acquire, std::memory_order_relaxed))
+			break;
+
+		seq = s.seq.load(std::memory_order_relaxed);
+	}
+
+	event &e = s.e;
+	e.name = name;
+	e.cat = cat;
+	e.tid = current_thread_id();
+	e.start = std::chrono::duration_cast<std::chrono::nanoseconds>(start - m_epoch).count();
+	e.duration = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+	e.row = row;
+	e.left = left;
+	e.right = right;
+
+	s.seq.store(idx * 2 + 2, std::memory_order_release);
+}
+
+void TraceBuffer::clear()
+{
+	for (slot &s : m_slots) {
+		s.seq.store(0, std::memory_order_relaxed);
+	}
+	m_count.store(0, std::memory_order_relaxed);
+}
+
+std::vector<TraceBuffer::event> TraceBuffer::get_events() const
+{
+	uint64_t count = m_count.load(std::memory_order_relaxed);
+	uint64_t first = count > m_slots.size() ? count - m_slots.size() : 0;
+
+	std::vector<event> events;
+	events.reserve(static_cast<size_t>(count - first));
+
+	// Skip slots that do not hold a complete copy of the expected event.
+	for (uint64_t idx = first; idx < count; ++idx) {
+		const slot &s = m_slots[static_cast<size_t>(idx % m_slots.size())];
+
+		if (s.seq.load(std::memory_order_acquire) == idx * 2 + 2)
+			events.push_back(s.e);
+	}
+	return events;
+}
+
+std::string TraceBuffer::to_json() const
+{
+	std::string out = "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+	bool first = true;
+
+	for (const event &e : get_events()) {
+		if (!first)
+			out += ',';
+		first = false;
+
+		out += "\n{\"name\":\"";
+		for (const char *p = e.name; *p; ++p) {
+			if (*p == '"' || *p == '\\')
+				out += '\\';
+			out += *p;
+		}
+		out += "\",\"cat\":\"";
+		out += category_name(e.cat);
+		out += "\",\"ph\":\"X\",\"pid\":1,\"tid\":" + std::to_string(e.tid);
+		out += ",\"ts\":" + format_us(e.start);
+		out += ",\"dur\":" + format_us(e.duration);
+		out += ",\"args\":{";
+		if (e.cat != category::TILE)
+			out += "\"row\":" + std::to_string(e.row) + ',';
+		out += "\"left\":" + std::to_string(e.left) + ",\"right\":" + std::to_string(e.right) + "}}";
+	}
+
+	out += "\n]}\n";
+	return out;
+}
+
+} // namespace graph
+} // namespace zimg
@@ -0,0 +1,107 @@
+#pragma once
+
+#ifndef ZIMG_GRAPH_TRACE_H_
+#define ZIMG_GRAPH_TRACE_H_
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "common/alloc.h"
+
+namespace zimg {
+namespace graph {
+
+/**
+ * Bounded ring buffer of timed graph execution events.
+ *
+ * Events may be recorded concurrently by all threads executing a graph. Once
+ * the capacity is reached, the oldest events are overwritten. Each slot holds
+ * the sequence number of its event, which writers claim before writing, so
+ * that concurrent writers to the same slot can not interleave. The buffer
+ * must not be read or cleared while events are being recorded.
+ *
+ * The slots are allocated by the allocator selected on the constructing thread.
+ */
+class TraceBuffer : public HookAllocated {
+public:
+	typedef std::chrono::steady_clock clock;
+
+	enum class category {
+		TILE,
+		FILTER,
+		UNPACK,
+		PACK,
+	};
+
+	struct event {
+		const char *name;
+		category cat;
+		unsigned tid;
+		uint64_t start;
+		uint64_t duration;
+		unsigned row;
+		unsigned left;
+		unsigned right;
+	};
+private:
+	struct slot {
+		// 0 if empty, (2 * n + 1) while event n is written, or (2 * n + 2) when complete.
+		std::atomic<uint64_t> seq;
+		event e;
+
+		slot() : seq{}, e{} {}
+	};
+
+	AlignedVector<slot> m_slots;
+	std::atomic<uint64_t> m_count;
+	clock::time_point m_epoch;
+public:
+	/**
+	 * Initialize a TraceBuffer.
+	 *
+	 * @param capacity maximum number of events retained
+	 */
+	explicit TraceBuffer(size_t capacity);
+
+	/**
+	 * Record an event.
+	 *
+	 * @param name event name, must outlive the buffer
+	 * @param cat event category
+	 * @param start start time
+	 * @param end end time
+	 * @param row image row, or first row of the event
+	 * @param left left column
+	 * @param right right column, plus one
+	 */
+	void record(const char *name, category cat, clock::time_point start, clock::time_point end, unsigned row, unsigned left, unsigned right);
+
+	/**
+	 * Discard all events.
+	 */
+	void clear();
+
+	/**
+	 * Get the retained events, from oldest to newest.
+	 *
+	 * @return events
+	 */
+	std::vector<event> get_events() const;
+
+	/**
+	 * Serialize the retained events in the Chrome trace-event format.
+	 *
+	 * The output may be loaded in chrome://tracing or Perfetto.
+	 *
+	 * @return JSON document
+	 */
+	std::string to_json() const;
+};
+
+} // namespace graph
+} // namespace zimg
+
+#endif // ZIMG_GRAPH_TRACE_H_
@@ -6,6 +6,7 @@
 #include "common/except.h"
 #include "common/matrix.h"
 #include "common/zassert.h"
+#include "resize/filter.h"
 #include "bilinear.h"
 
 namespace zimg {
@@ -19,37 +20,65 @@ T epsilon()
 	return std::numeric_limits<T>::epsilon();
 }
 
+/**
+ * LU factorization of a band matrix with [bandwidth] diagonals on either side
+ * of the main diagonal. U has a main diagonal of ones.
+ *
+ * c(i, k) = L(i, i - k - 1)
+ * u(i, k) = U(i, i + k + 1)
+ */
 template <class T>
-struct TridiagonalLU {
+struct BandedLU {
 	std::vector<T> l;
 	std::vector<T> u;
 	std::vector<T> c;
+	size_t bandwidth;
 
-	explicit TridiagonalLU(size_t n) : l(n), u(n), c(n)
+	BandedLU(size_t n, size_t bandwidth) : l(n), u(n * bandwidth), c(n * bandwidth), bandwidth{ bandwidth }
 	{}
+
+	T &lower(size_t i, size_t j) { return c[i * bandwidth + (i - j - 1)]; }
+	T &upper(size_t i, size_t j) { return u[i * bandwidth + (j - i - 1)]; }
 };
 
 template <class T>
-TridiagonalLU<T> tridiagonal_decompose(const RowMatrix<T> &m)
+BandedLU<T> banded_decompose(const RowMatrix<T> &m, size_t bandwidth)
 {
 	size_t n = m.rows();
-	TridiagonalLU<T> lu{ n };
-	T zero = static_cast<T>(0);
+	BandedLU<T> lu{ n, bandwidth };
 	T eps = epsilon<T>();
 
-	lu.c[0] = zero;
-	lu.l[0] = m[0][0];
-	lu.u[0] = m[0][1] / (m[0][0] + eps);
+	// Crout factorization. Elements outside of the band are zero in both L and U.
+	for (size_t i = 0; i < n; ++i) {
+		size_t first = i - std::min(i, bandwidth);
+		size_t last = std::min(i + bandwidth, n - 1);
 
-	for (size_t i = 1; i < n - 1; ++i) {
-		lu.c[i] = m[i][i - 1];
-		lu.l[i] = m[i][i] - lu.c[i] * lu.u[i - 1];
-		lu.u[i] = m[i][i + 1] / (lu.l[i] + eps);
-	}
+		for (size_t j = first; j < i; ++j) {
+			T x = m[i][j];
+
+			for (size_t k = first; k < j; ++k) {
+				if (j - k <= bandwidth)
+					x -= lu.lower(i, k) * lu.upper(k, j);
+			}
+			lu.lower(i, j) = x;
+		}
+
+		T diag = m[i][i];
+		for (size_t k = first; k < i; ++k) {
+			diag -= lu.lower(i, k) * lu.upper(k, i);
+		}
+		lu.l[i] = diag;
+
+		for (size_t j = i + 1; j <= last; ++j) {
+			T x = m[i][j];
 
-	lu.c[n - 1] = m[n - 1][n - 2];
-	lu.l[n - 1] = m[n - 1][n - 1] - lu.c[n - 1] * lu.u[n - 2];
-	lu.u[n - 1] = zero;
+			for (size_t k = first; k < i; ++k) {
+				if (j - k <= bandwidth)
+					x -= lu.lower(i, k) * lu.upper(k, j);
+			}
+			lu.upper(i, j) = x / (diag + eps);
+		}
+	}
 
 	return lu;
 }
@@ -102,68 +131,120 @@ RowMatrix<double> bilinear_weights(unsigned in, unsigned out, double shift)
 	return m;
 }
 
-} // namespace
+/**
+ * Compute the scaling matrix applied by the resizer for an arbitrary filter.
+ *
+ * @param f filter
+ * @param in input (unscaled) dimension
+ * @param out output (scaled) dimension
+ * @param shift center shift applied to input
+ * @return the scaling matrix
+ */
+RowMatrix<double> filter_weights(const resize::Filter &f, unsigned in, unsigned out, double shift)
+{
+	resize::FilterContext filter = resize::compute_filter(f, in, out, shift, in);
+	RowMatrix<double> m{ out, in };
+
+	for (unsigned i = 0; i < out; ++i) {
+		for (unsigned k = 0; k < filter.filter_width; ++k) {
+			m[i][filter.left[i] + k] = filter.data[static_cast<size_t>(i) * filter.stride + k];
+		}
+	}
 
+	return m;
+}
 
-BilinearContext create_bilinear_context(unsigned in, unsigned out, double shift)
+BilinearContext create_context_from_weights(const RowMatrix<double> &m, unsigned in, unsigned out)
 {
 	BilinearContext ctx;
 
-	if (in > out)
-		error::throw_<error::ResamplingNotAvailable>("unresize can not upscale");
+	RowMatrix<double> transpose_m = ~m;
+	RowMatrix<double> pinv_m = transpose_m * m;
 
-	try {
-		// Map output shift to input shift.
-		RowMatrix<double> m = bilinear_weights(in, out, -shift * in / out);
-		RowMatrix<double> transpose_m = ~m;
-		RowMatrix<double> pinv_m = transpose_m * m;
-		TridiagonalLU<double> lu = tridiagonal_decompose(pinv_m);
+	size_t rows = transpose_m.rows();
+	size_t cols = transpose_m.cols();
 
-		size_t rows = transpose_m.rows();
-		size_t cols = transpose_m.cols();
+	// (A' A) is symmetric, so the upper bandwidth is also the lower bandwidth.
+	size_t bandwidth = 0;
+	for (size_t i = 0; i < rows; ++i) {
+		if (pinv_m.row_right(i) > i + 1)
+			bandwidth = std::max(pinv_m.row_right(i) - i - 1, bandwidth);
+	}
+	bandwidth = std::max(bandwidth, static_cast<size_t>(1));
 
-		ctx.input_width = out;
-		ctx.output_width = in;
+	BandedLU<double> lu = banded_decompose(pinv_m, bandwidth);
 
-		size_t rowsize = 0;
-		for (size_t i = 0; i < rows; ++i) {
-			rowsize = std::max(transpose_m.row_right(i) - transpose_m.row_left(i), rowsize);
-		}
-		zassert_d(rowsize, "empty matrix");
+	ctx.input_width = out;
+	ctx.output_width = in;
 
-		if (rowsize > floor_n(SIZE_MAX, AlignmentOf<float>::value))
-			error::throw_<error::OutOfMemory>();
+	size_t rowsize = 0;
+	for (size_t i = 0; i < rows; ++i) {
+		rowsize = std::max(transpose_m.row_right(i) - transpose_m.row_left(i), rowsize);
+	}
+	zassert_d(rowsize, "empty matrix");
 
-		size_t rowstride = ceil_n(rowsize, AlignmentOf<float>::value);
-		if (rows > SIZE_MAX / rowstride)
-			error::throw_<error::OutOfMemory>();
+	if (rowsize > floor_n(SIZE_MAX, AlignmentOf<float>::value))
+		error::throw_<error::OutOfMemory>();
 
-		ctx.matrix_coefficients.resize(rowstride * rows);
-		ctx.matrix_row_offsets.resize(rows);
-		ctx.matrix_row_size = static_cast<unsigned>(rowsize);
-		ctx.matrix_row_stride = static_cast<unsigned>(rowstride);
-		for (size_t i = 0; i < rows; ++i) {
-			size_t left = std::min(transpose_m.row_left(i), cols - rowsize);
+	size_t rowstride = ceil_n(rowsize, AlignmentOf<float>::value);
+	if (rows > SIZE_MAX / rowstride || rows > SIZE_MAX / bandwidth)
+		error::throw_<error::OutOfMemory>();
 
-			for (size_t j = 0; j < transpose_m.row_right(i) - left; ++j) {
-				ctx.matrix_coefficients[i * rowstride + j] = static_cast<float>(transpose_m[i][left + j]);
-			}
-			ctx.matrix_row_offsets[i] = static_cast<unsigned>(left);
-		}
+	ctx.matrix_coefficients.resize(rowstride * rows);
+	ctx.matrix_row_offsets.resize(rows);
+	ctx.matrix_row_size = static_cast<unsigned>(rowsize);
+	ctx.matrix_row_stride = static_cast<unsigned>(rowstride);
+	for (size_t i = 0; i < rows; ++i) {
+		size_t left = std::min(transpose_m.row_left(i), cols - rowsize);
 
-		ctx.lu_c.resize(rows);
-		ctx.lu_l.resize(rows);
-		ctx.lu_u.resize(rows);
-		for (size_t i = 0; i < rows; ++i) {
-			ctx.lu_c[i] = static_cast<float>(lu.c[i]);
-			ctx.lu_l[i] = static_cast<float>((1.0 / (lu.l[i] + epsilon<float>()))); // Pre-invert this value, as it is used in division.
-			ctx.lu_u[i] = static_cast<float>(lu.u[i]);
+		for (size_t j = 0; j < transpose_m.row_right(i) - left; ++j) {
+			ctx.matrix_coefficients[i * rowstride + j] = static_cast<float>(transpose_m[i][left + j]);
 		}
+		ctx.matrix_row_offsets[i] = static_cast<unsigned>(left);
+	}
+
+	ctx.lu_bandwidth = static_cast<unsigned>(bandwidth);
+	ctx.lu_c.resize(rows * bandwidth);
+	ctx.lu_l.resize(rows);
+	ctx.lu_u.resize(rows * bandwidth);
+	for (size_t i = 0; i < rows; ++i) {
+		ctx.lu_l[i] = static_cast<float>((1.0 / (lu.l[i] + epsilon<float>()))); // Pre-invert this value, as it is used in division.
+	}
+	for (size_t i = 0; i < rows * bandwidth; ++i) {
+		ctx.lu_c[i] = static_cast<float>(lu.c[i]);
+		ctx.lu_u[i] = static_cast<float>(lu.u[i]);
+	}
+
+	return ctx;
+}
+
+} // namespace
+
+
+BilinearContext create_bilinear_context(unsigned in, unsigned out, double shift)
+{
+	if (in > out)
+		error::throw_<error::ResamplingNotAvailable>("unresize can not upscale");
+
+	try {
+		// Map output shift to input shift.
+		return create_context_from_weights(bilinear_weights(in, out, -shift * in / out), in, out);
 	} catch (const std::length_error &) {
 		error::throw_<error::OutOfMemory>();
 	}
+}
 
-	return ctx;
+BilinearContext create_unresize_context(const resize::Filter &filter, unsigned in, unsigned out, double shift)
+{
+	if (in > out)
+		error::throw_<error::ResamplingNotAvailable>("unresize can not upscale");
+
+	try {
+		// Map output shift to input shift.
+		return create_context_from_weights(filter_weights(filter, in, out, shift * in / out), in, out);
+	} catch (const std::length_error &) {
+		error::throw_<error::OutOfMemory>();
+	}
 }
 
 } // namespace unresize
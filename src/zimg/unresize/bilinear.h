@@ -6,6 +6,14 @@
 #include "common/alloc.h"
 
 namespace zimg {
+
+namespace resize {
+
+class Filter;
+
+} // namespace resize
+
+
 namespace unresize {
 
 /**
@@ -46,17 +54,26 @@ struct BilinearContext {
 	unsigned matrix_row_stride;
 
 	/**
-	 * LU decomposition of (A' A) stored as three arrays of dimension (N).
+	 * LU decomposition of (A' A), a band matrix with lu_bandwidth diagonals on
+	 * either side of the main diagonal. The bilinear filter gives a tridiagonal
+	 * matrix (lu_bandwidth = 1), and filters with wider support give wider bands.
+	 *
+	 * lu_l is stored as an array of dimension (N), and lu_c and lu_u as arrays
+	 * of dimension (N * lu_bandwidth), with k = 1 ... lu_bandwidth.
 	 *
 	 * The relationship to L and U is given by the following.
 	 *
-	 * lu_c(i) = L(i, i - 1)
+	 * lu_c(i, k) = L(i, i - k)
 	 * lu_l(i) = 1 / L(i, i)
-	 * lu_u(i) = U(i, i + 1)
+	 * lu_u(i, k) = U(i, i + k)
 	 *
-	 * lu_c(1) and lu_u(N) are set to 0 to simplify the execution loop.
+	 * lu_c(i, k) = lu_c[i * lu_bandwidth + k - 1]
+	 * lu_u(i, k) = lu_u[i * lu_bandwidth + k - 1]
+	 *
+	 * Elements outside of the matrix are set to 0.
 	 * lu_l is stored inverted as it is used in forward substitution as a divisor.
 	 */
+	unsigned lu_bandwidth;
 	AlignedVector<float> lu_c;
 	AlignedVector<float> lu_l;
 	AlignedVector<float> lu_u;
@@ -72,6 +89,18 @@ struct BilinearContext {
  */
 BilinearContext create_bilinear_context(unsigned in, unsigned out, double shift);
 
+/**
+ * Initialize a BilinearContext inverting the scaling performed by the resizer
+ * with a given filter.
+ *
+ * @param filter resampling filter
+ * @param in dimension of original vector
+ * @param out dimension of upscaled vector
+ * @param shift center shift relative to upscaled vector
+ * @return an initialized context
+ */
+BilinearContext create_unresize_context(const resize::Filter &filter, unsigned in, unsigned out, double shift);
+
 } // namespace unresize
 } // namespace zimg
 
@@ -27,11 +27,14 @@ UnresizeConversion::UnresizeConversion(unsigned up_width, unsigned up_height, Pi
 	up_width{ up_width },
 	up_height{ up_height },
 	type{ type },
+	depth{ pixel_depth(type) },
 	orig_width{ up_width },
 	orig_height{ up_height },
 	shift_w{},
 	shift_h{},
-	cpu{ CPUClass::NONE }
+	filter{},
+	cpu{ CPUClass::NONE },
+	threads{ 1 }
 {}
 
 auto UnresizeConversion::create() const -> filter_pair try
@@ -45,7 +48,11 @@ auto UnresizeConversion::create() const -> filter_pair try
 	if (skip_h && skip_v)
 		return{ ztd::make_unique<graph::CopyFilter>(up_width, up_height, type), nullptr };
 
-	auto builder = UnresizeImplBuilder{ up_width, up_height, type }.set_cpu(cpu);
+	auto builder = UnresizeImplBuilder{ up_width, up_height, type }
+		.set_depth(depth)
+		.set_filter(filter)
+		.set_cpu(cpu)
+		.set_threads(threads);
 	filter_pair ret{};
 
 	if (skip_h) {
@@ -61,6 +68,9 @@ auto UnresizeConversion::create() const -> filter_pair try
 	} else {
 		bool h_first = unresize_h_first(static_cast<double>(orig_width) / up_width, static_cast<double>(orig_height) / up_height);
 
+		// Keep the intermediate image in floating point.
+		builder.set_dst_type(PixelType::FLOAT);
+
 		if (h_first) {
 			ret.first = builder.set_horizontal(true)
 			                   .set_orig_dim(orig_width)
@@ -68,7 +78,9 @@ auto UnresizeConversion::create() const -> filter_pair try
 			                   .create();
 
 			builder.up_width = orig_width;
-			ret.second = builder.set_horizontal(false)
+			builder.type = PixelType::FLOAT;
+			ret.second = builder.set_dst_type(type)
+			                    .set_horizontal(false)
 			                    .set_orig_dim(orig_height)
 			                    .set_shift(shift_h)
 			                    .create();
@@ -79,7 +91,9 @@ auto UnresizeConversion::create() const -> filter_pair try
 			                   .create();
 
 			builder.up_height = orig_height;
-			ret.second = builder.set_horizontal(true)
+			builder.type = PixelType::FLOAT;
+			ret.second = builder.set_dst_type(type)
+			                    .set_horizontal(true)
 			                    .set_orig_dim(orig_width)
 			                    .set_shift(shift_w)
 			                    .create();
@@ -78,6 +78,23 @@
  * performing the tridiagonal algorithm to obtain x.
  *
  * Generalization to two dimensions is done by processing each dimension.
+ *
+ * Integer (WORD) samples are converted to floating point on load, and are
+ * rounded to the nearest integer when stored. The intermediate image between
+ * the two passes is always floating point.
+ *
+ * Other filters are inverted in the same way. A filter with support S gives
+ * rows of A with up to 2S non-zero entries, so P is a band matrix with 2S - 1
+ * diagonals on either side of the main diagonal (e.g. heptadiagonal for
+ * bicubic). The factorization and substitution generalize to the band, with
+ * L(i, i - k) and U(i, i + k) taking the place of c(i) and u(i). If no filter
+ * is given, the bilinear filter is inverted.
+ *
+ * The vertical pass is independent per column, so it accepts column tiles and
+ * can distribute blocks of columns across threads. Its input and output are
+ * buffered over the full height, but only over the columns of one tile. The
+ * horizontal pass requires entire rows, which disables tiling in any graph
+ * containing it, so only a graph unresizing the height alone is tiled.
  */
 
 #include <memory>
@@ -95,6 +112,13 @@ class ImageFilter;
 } // namespace graph
 
 
+namespace resize {
+
+class Filter;
+
+} // namespace resize
+
+
 namespace unresize {
 
 struct UnresizeConversion {
@@ -105,11 +129,14 @@ struct UnresizeConversion {
 	PixelType type;
 
 #include "common/builder.h"
+	BUILDER_MEMBER(unsigned, depth)
 	BUILDER_MEMBER(unsigned, orig_width)
 	BUILDER_MEMBER(unsigned, orig_height)
 	BUILDER_MEMBER(double, shift_w)
 	BUILDER_MEMBER(double, shift_h)
+	BUILDER_MEMBER(const resize::Filter *, filter)
 	BUILDER_MEMBER(CPUClass, cpu)
+	BUILDER_MEMBER(unsigned, threads)
 #undef BUILDER_MEMBER
 
 	UnresizeConversion(unsigned up_width, unsigned up_height, PixelType type);
@@ -1,5 +1,11 @@
 #include <algorithm>
+#include <atomic>
 #include <climits>
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
+#include "common/align.h"
+#include "common/checked_int.h"
 #include "common/cpuinfo.h"
 #include "common/except.h"
 #include "common/make_unique.h"
@@ -7,19 +13,38 @@
 #include "common/zassert.h"
 #include "unresize_impl.h"
 
+#ifdef ZIMG_X86
+  #include "x86/unresize_impl_x86.h"
+#endif
+
 namespace zimg {
 namespace unresize {
 
 namespace {
 
+void load_line_u16_c(const uint16_t *src, float *dst, unsigned width)
+{
+	std::transform(src, src + width, dst, [](uint16_t x) { return static_cast<float>(x); });
+}
+
+void store_line_u16_c(const float *src, uint16_t *dst, unsigned width, int32_t pixel_max)
+{
+	std::transform(src, src + width, dst, [=](float x)
+	{
+		int32_t y = static_cast<int32_t>(std::lrint(x));
+		return static_cast<uint16_t>(std::min(std::max(y, static_cast<int32_t>(0)), pixel_max));
+	});
+}
+
+template <class T>
+float load_pixel(const T *p, unsigned j) { return static_cast<float>(p[j]); }
+
 void unresize_line_h_f32_c(const BilinearContext &ctx, const float *src, float *dst)
 {
 	const float *c = ctx.lu_c.data();
 	const float *l = ctx.lu_l.data();
 	const float *u = ctx.lu_u.data();
-
-	float z = 0.0f;
-	float w = 0.0f;
+	unsigned bandwidth = ctx.lu_bandwidth;
 
 	for (unsigned j = 0; j < ctx.output_width; ++j) {
 		float accum = 0.0f;
@@ -32,98 +57,169 @@ void unresize_line_h_f32_c(const BilinearContext &ctx, const float *src, float *
 			accum += coeff * x;
 		}
 
-		z = (accum - c[j] * z) * l[j];
-		dst[j] = z;
+		for (unsigned k = 1; k <= std::min(j, bandwidth); ++k) {
+			accum -= c[j * bandwidth + k - 1] * dst[j - k];
+		}
+		dst[j] = accum * l[j];
 	}
 
 	for (unsigned j = ctx.output_width; j != 0; --j) {
-		w = dst[j - 1] - u[j - 1] * w;
+		float w = dst[j - 1];
+
+		for (unsigned k = 1; k <= std::min(ctx.output_width - j, bandwidth); ++k) {
+			w -= u[(j - 1) * bandwidth + k - 1] * dst[j - 1 + k];
+		}
 		dst[j - 1] = w;
 	}
 }
 
-void unresize_line_forward_v_f32_c(const BilinearContext &ctx, const graph::ImageBuffer<const float> &src, const graph::ImageBuffer<float> &dst, unsigned i, unsigned width)
+template <class T>
+void unresize_line_forward_v_c(const BilinearContext &ctx, const graph::ImageBuffer<const T> &src, const graph::ImageBuffer<float> &dst, unsigned i, unsigned left, unsigned right)
 {
-	const float *c = ctx.lu_c.data();
-	const float *l = ctx.lu_l.data();
+	unsigned bandwidth = std::min(i, ctx.lu_bandwidth);
+	const float *c = &ctx.lu_c[i * ctx.lu_bandwidth];
+	float l = ctx.lu_l[i];
 
 	const float *coeffs = &ctx.matrix_coefficients[i * ctx.matrix_row_stride];
 	unsigned top = ctx.matrix_row_offsets[i];
 
-	for (unsigned j = 0; j < width; ++j) {
-		float z = i ? dst[i - 1][j] : 0.0f;
+	for (unsigned j = left; j < right; ++j) {
 		float accum = 0.0f;
 
 		for (unsigned k = 0; k < ctx.matrix_row_size; ++k) {
 			float coeff = coeffs[k];
-			float x = src[top + k][j];
+			float x = load_pixel(src[top + k], j);
 
 			accum += coeff * x;
 		}
 
-		z = (accum - c[i] * z) * l[i];
-		dst[i][j] = z;
+		for (unsigned k = 1; k <= bandwidth; ++k) {
+			accum -= c[k - 1] * dst[i - k][j];
+		}
+		dst[i][j] = accum * l;
 	}
 }
 
-void unresize_line_back_v_f32_c(const BilinearContext &ctx, const graph::ImageBuffer<float> &dst, unsigned i, unsigned width)
+void unresize_line_back_v_f32_c(const BilinearContext &ctx, const graph::ImageBuffer<float> &dst, unsigned i, unsigned left, unsigned right)
 {
-	const float *u = ctx.lu_u.data();
+	unsigned bandwidth = std::min(ctx.output_width - i, ctx.lu_bandwidth);
+	const float *u = &ctx.lu_u[(i - 1) * ctx.lu_bandwidth];
 
-	for (unsigned j = 0; j < width; ++j) {
-		float w = i < ctx.output_width ? dst[i][j] : 0.0f;
+	for (unsigned j = left; j < right; ++j) {
+		float w = dst[i - 1][j];
 
-		w = dst[i - 1][j] - u[i - 1] * w;
+		for (unsigned k = 1; k <= bandwidth; ++k) {
+			w -= u[k - 1] * dst[i - 1 + k][j];
+		}
 		dst[i - 1][j] = w;
 	}
 }
 
 
 class UnresizeImplH_C final : public UnresizeImplH {
+	PixelType m_src_type;
+	int32_t m_pixel_max;
 public:
-	UnresizeImplH_C(const BilinearContext &context, unsigned height, PixelType type) :
-		UnresizeImplH(context, image_attributes{ context.output_width, height, type })
+	UnresizeImplH_C(const BilinearContext &context, unsigned height, PixelType src_type, PixelType dst_type, unsigned depth) :
+		UnresizeImplH(context, image_attributes{ context.output_width, height, dst_type }),
+		m_src_type{ src_type },
+		m_pixel_max{ static_cast<int32_t>((1UL << depth) - 1) }
 	{
-		zassert_d(context.input_width <= pixel_max_width(type), "overflow");
-		zassert_d(context.output_width <= pixel_max_width(type), "overflow");
+		zassert_d(context.input_width <= pixel_max_width(PixelType::FLOAT), "overflow");
+		zassert_d(context.output_width <= pixel_max_width(PixelType::FLOAT), "overflow");
 
-		if (type != PixelType::FLOAT)
+		if (src_type != PixelType::WORD && src_type != PixelType::FLOAT)
+			error::throw_<error::InternalError>("pixel type not supported");
+		if (dst_type != PixelType::WORD && dst_type != PixelType::FLOAT)
 			error::throw_<error::InternalError>("pixel type not supported");
 	}
 
-	void process(void *, const graph::ImageBuffer<const void> *src, const graph::ImageBuffer<void> *dst, void *, unsigned i, unsigned, unsigned) const override
+	size_t get_tmp_size(unsigned, unsigned) const override
 	{
-		unresize_line_h_f32_c(m_context, static_cast<const float *>((*src)[i]), static_cast<float *>((*dst)[i]));
+		try {
+			checked_size_t size = 0;
+
+			if (m_src_type == PixelType::WORD)
+				size += ceil_n(static_cast<checked_size_t>(m_context.input_width) * sizeof(float), ALIGNMENT);
+			if (m_attr.type == PixelType::WORD)
+				size += ceil_n(static_cast<checked_size_t>(m_context.output_width) * sizeof(float), ALIGNMENT);
+
+			return size.get();
+		} catch (const std::overflow_error &) {
+			error::throw_<error::OutOfMemory>();
+		}
 	}
-};
 
-class UnresizeImplV_C final : public UnresizeImplV {
-public:
-	UnresizeImplV_C(const BilinearContext &context, unsigned width, PixelType type) :
-		UnresizeImplV(context, image_attributes{ width, context.output_width, type })
+	void process(void *, const graph::ImageBuffer<const void> *src, const graph::ImageBuffer<void> *dst, void *tmp, unsigned i, unsigned, unsigned) const override
 	{
-		zassert_d(context.input_width <= pixel_max_width(type), "overflow");
-		zassert_d(context.output_width <= pixel_max_width(type), "overflow");
+		const float *src_p = static_cast<const float *>((*src)[i]);
+		float *dst_p = static_cast<float *>((*dst)[i]);
+		char *tmp_p = static_cast<char *>(tmp);
+
+		if (m_src_type == PixelType::WORD) {
+			float *line = reinterpret_cast<float *>(tmp_p);
+			load_line_u16_c(static_cast<const uint16_t *>((*src)[i]), line, m_context.input_width);
+			src_p = line;
+			tmp_p += ceil_n(static_cast<size_t>(m_context.input_width) * sizeof(float), ALIGNMENT);
+		}
+		if (m_attr.type == PixelType::WORD)
+			dst_p = reinterpret_cast<float *>(tmp_p);
 
-		if (type != PixelType::FLOAT)
-			error::throw_<error::InternalError>("pixel type not supported");
+		unresize_line_h_f32_c(m_context, src_p, dst_p);
+
+		if (m_attr.type == PixelType::WORD)
+			store_line_u16_c(dst_p, static_cast<uint16_t *>((*dst)[i]), m_context.output_width, m_pixel_max);
 	}
+};
 
-	void process(void *, const graph::ImageBuffer<const void> *src, const graph::ImageBuffer<void> *dst, void *, unsigned, unsigned, unsigned) const override
-	{
-		const auto &src_buf = graph::static_buffer_cast<const float>(*src);
-		const auto &dst_buf = graph::static_buffer_cast<float>(*dst);
+class UnresizeImplV_C final : public UnresizeImplV {
+	PixelType m_src_type;
+	int32_t m_pixel_max;
 
-		unsigned width = get_image_attributes().width;
+	template <class T>
+	void process_plane(const graph::ImageBuffer<const T> &src, const graph::ImageBuffer<float> &work, const graph::ImageBuffer<uint16_t> &dst_u16,
+	                   unsigned left, unsigned right) const
+	{
 		unsigned height = get_image_attributes().height;
 
 		for (unsigned i = 0; i < height; ++i) {
-			unresize_line_forward_v_f32_c(m_context, src_buf, dst_buf, i, width);
+			unresize_line_forward_v_c(m_context, src, work, i, left, right);
 		}
 		for (unsigned i = height; i != 0; --i) {
-			unresize_line_back_v_f32_c(m_context, dst_buf, i, width);
+			unresize_line_back_v_f32_c(m_context, work, i, left, right);
+
+			if (dst_u16.data())
+				store_line_u16_c(work[i - 1] + left, dst_u16[i - 1] + left, right - left, m_pixel_max);
 		}
 	}
+
+	void process_columns(const graph::ImageBuffer<const void> &src, const graph::ImageBuffer<void> &dst, const graph::ImageBuffer<float> &work,
+	                     unsigned left, unsigned right) const override
+	{
+		graph::ImageBuffer<uint16_t> dst_u16;
+
+		if (m_attr.type == PixelType::WORD)
+			dst_u16 = graph::static_buffer_cast<uint16_t>(dst);
+
+		if (m_src_type == PixelType::WORD)
+			process_plane(graph::static_buffer_cast<const uint16_t>(src), work, dst_u16, left, right);
+		else
+			process_plane(graph::static_buffer_cast<const float>(src), work, dst_u16, left, right);
+	}
+public:
+	UnresizeImplV_C(const BilinearContext &context, unsigned width, PixelType src_type, PixelType dst_type, unsigned depth, unsigned threads) :
+		UnresizeImplV(context, image_attributes{ width, context.output_width, dst_type }, threads),
+		m_src_type{ src_type },
+		m_pixel_max{ static_cast<int32_t>((1UL << depth) - 1) }
+	{
+		zassert_d(context.input_width <= pixel_max_width(PixelType::FLOAT), "overflow");
+		zassert_d(context.output_width <= pixel_max_width(PixelType::FLOAT), "overflow");
+
+		if (src_type != PixelType::WORD && src_type != PixelType::FLOAT)
+			error::throw_<error::InternalError>("pixel type not supported");
+		if (dst_type != PixelType::WORD && dst_type != PixelType::FLOAT)
+			error::throw_<error::InternalError>("pixel type not supported");
+	}
 };
 
 } // namespace
@@ -155,7 +251,7 @@ auto UnresizeImplH::get_required_row_range(unsigned i) const -> pair_unsigned
 
 auto UnresizeImplH::get_required_col_range(unsigned left, unsigned right) const -> pair_unsigned
 {
-	return{ 0, get_image_attributes().width };
+	return{ 0, m_context.input_width };
 }
 
 unsigned UnresizeImplH::get_max_buffering() const
@@ -164,18 +260,21 @@ unsigned UnresizeImplH::get_max_buffering() const
 }
 
 
-UnresizeImplV::UnresizeImplV(const BilinearContext &context, const image_attributes &attr) :
+UnresizeImplV::UnresizeImplV(const BilinearContext &context, const image_attributes &attr, unsigned threads) :
 	m_context(context),
-	m_attr(attr)
-{}
+	m_attr(attr),
+	m_threads{ threads },
+	m_pool{ threads - 1 }
+{
+	if (!threads)
+		error::throw_<error::InternalError>("invalid thread count");
+}
 
 auto UnresizeImplV::get_flags() const -> filter_flags
 {
 	filter_flags flags{};
 
 	flags.has_state = true;
-	flags.entire_row = true;
-	flags.entire_plane = true;
 
 	return flags;
 }
@@ -187,24 +286,95 @@ auto UnresizeImplV::get_required_row_range(unsigned) const -> pair_unsigned
 	return{ 0, m_context.input_width };
 }
 
-auto UnresizeImplV::get_required_col_range(unsigned, unsigned) const -> pair_unsigned
+auto UnresizeImplV::get_required_col_range(unsigned left, unsigned right) const -> pair_unsigned
 {
-	return{ 0, get_image_attributes().width };
+	return{ left, right };
+}
+
+graph::ImageBuffer<float> UnresizeImplV::get_work_buffer(const graph::ImageBuffer<void> &dst, void *tmp, unsigned worker, unsigned block_left) const
+{
+	if (m_attr.type == PixelType::FLOAT)
+		return graph::static_buffer_cast<float>(dst);
+
+	const ptrdiff_t stride = COLUMN_BLOCK * sizeof(float);
+	float *strip = reinterpret_cast<float *>(static_cast<char *>(tmp) + static_cast<size_t>(stride) * m_attr.height * worker);
+	return{ strip - block_left, stride, graph::BUFFER_MAX };
 }
 
 unsigned UnresizeImplV::get_simultaneous_lines() const { return graph::BUFFER_MAX; }
 
 unsigned UnresizeImplV::get_max_buffering() const { return graph::BUFFER_MAX; }
 
+size_t UnresizeImplV::get_tmp_size(unsigned left, unsigned right) const
+{
+	if (m_attr.type == PixelType::FLOAT)
+		return 0;
+
+	// Substitution requires the full height of each column, but only one
+	// column block per worker is in flight at a time.
+	unsigned num_blocks = (right - floor_n(left, COLUMN_BLOCK) + COLUMN_BLOCK - 1) / COLUMN_BLOCK;
+	unsigned num_workers = std::min(m_threads, num_blocks);
+
+	try {
+		checked_size_t size = static_cast<checked_size_t>(COLUMN_BLOCK * sizeof(float)) * m_attr.height * num_workers;
+		return size.get();
+	} catch (const std::overflow_error &) {
+		error::throw_<error::OutOfMemory>();
+	}
+}
+
+void UnresizeImplV::process(void *, const graph::ImageBuffer<const void> *src, const graph::ImageBuffer<void> *dst, void *tmp, unsigned, unsigned left, unsigned right) const
+{
+	unsigned block_left = floor_n(left, COLUMN_BLOCK);
+	unsigned num_blocks = (right - block_left + COLUMN_BLOCK - 1) / COLUMN_BLOCK;
+	unsigned num_workers = std::min(m_threads, num_blocks);
+
+	auto block = [=](unsigned worker, unsigned n)
+	{
+		unsigned col_left = block_left + n * COLUMN_BLOCK;
+		unsigned col_right = std::min(right, col_left + COLUMN_BLOCK);
+		process_columns(*src, *dst, get_work_buffer(*dst, tmp, worker, col_left), std::max(left, col_left), col_right);
+	};
+
+	if (num_workers <= 1) {
+		// Floating point output is substituted in place, so it can be solved in one pass.
+		if (m_attr.type == PixelType::FLOAT) {
+			process_columns(*src, *dst, get_work_buffer(*dst, tmp, 0, block_left), left, right);
+			return;
+		}
+
+		for (unsigned n = 0; n < num_blocks; ++n) {
+			block(0, n);
+		}
+		return;
+	}
+
+	// Columns are independent, so each block is solved over the full height by a single thread.
+	std::atomic_uint next{ 0 };
+
+	m_pool.run(num_workers, [&](unsigned t)
+	{
+		unsigned n;
+
+		while ((n = next++) < num_blocks) {
+			block(t, n);
+		}
+	});
+}
+
 
 UnresizeImplBuilder::UnresizeImplBuilder(unsigned up_width, unsigned up_height, PixelType type) :
 	up_width{ up_width },
 	up_height{ up_height },
 	type{ type },
+	dst_type{ type },
+	depth{ pixel_depth(type) },
 	horizontal{},
 	orig_dim{},
 	shift{},
-	cpu{ CPUClass::NONE }
+	filter{},
+	cpu{ CPUClass::NONE },
+	threads{ 1 }
 {}
 
 std::unique_ptr<graph::ImageFilter> UnresizeImplBuilder::create() const
@@ -212,12 +382,18 @@ std::unique_ptr<graph::ImageFilter> UnresizeImplBuilder::create() const
 	std::unique_ptr<graph::ImageFilter> ret;
 
 	unsigned up_dim = horizontal ? up_width : up_height;
-	BilinearContext context = create_bilinear_context(orig_dim, up_dim, shift);
-
+	unsigned depth = std::min(this->depth, pixel_depth(PixelType::WORD));
+	BilinearContext context = filter ? create_unresize_context(*filter, orig_dim, up_dim, shift) : create_bilinear_context(orig_dim, up_dim, shift);
+
+#ifdef ZIMG_X86
+	ret = horizontal ?
+		create_unresize_impl_h_x86(context, up_height, type, dst_type, depth, cpu) :
+		create_unresize_impl_v_x86(context, up_width, type, dst_type, depth, threads, cpu);
+#endif
 	if (!ret && horizontal)
-		ret = ztd::make_unique<UnresizeImplH_C>(context, up_height, type);
+		ret = ztd::make_unique<UnresizeImplH_C>(context, up_height, type, dst_type, depth);
 	if (!ret && !horizontal)
-		ret = ztd::make_unique<UnresizeImplV_C>(context, up_width, type);
+		ret = ztd::make_unique<UnresizeImplV_C>(context, up_width, type, dst_type, depth, threads);
 
 	return ret;
 }
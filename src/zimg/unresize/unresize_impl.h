@@ -4,6 +4,8 @@
 #define ZIMG_UNRESIZE_UNRESIZE_IMPL_H_
 
 #include <memory>
+#include "common/thread_pool.h"
+#include "graph/image_buffer.h"
 #include "graph/image_filter.h"
 #include "bilinear.h"
 
@@ -12,6 +14,13 @@ namespace zimg {
 enum class CPUClass;
 enum class PixelType;
 
+namespace resize {
+
+class Filter;
+
+} // namespace resize
+
+
 namespace unresize {
 
 class UnresizeImplH : public graph::ImageFilterBase {
@@ -34,10 +43,25 @@ public:
 
 class UnresizeImplV : public graph::ImageFilterBase {
 protected:
+	// Columns are distributed to threads in blocks of this size, so that no
+	// two threads write to the same cache line.
+	static constexpr unsigned COLUMN_BLOCK = 64;
+
 	BilinearContext m_context;
 	image_attributes m_attr;
+	unsigned m_threads;
+	mutable ThreadPool m_pool;
 
-	UnresizeImplV(const BilinearContext &context, const image_attributes &attr);
+	UnresizeImplV(const BilinearContext &context, const image_attributes &attr, unsigned threads);
+
+	// Plane used for substitution: [dst] if the output is FLOAT, or else a
+	// strip of [tmp] owned by the given worker. A strip is one column block
+	// wide, but is indexed by absolute column starting from [block_left].
+	graph::ImageBuffer<float> get_work_buffer(const graph::ImageBuffer<void> &dst, void *tmp, unsigned worker, unsigned block_left) const;
+
+	// Solve the columns in the range [left, right), storing the result to [dst] and [work].
+	virtual void process_columns(const graph::ImageBuffer<const void> &src, const graph::ImageBuffer<void> &dst, const graph::ImageBuffer<float> &work,
+	                             unsigned left, unsigned right) const = 0;
 public:
 	filter_flags get_flags() const override;
 
@@ -50,6 +74,10 @@ public:
 	unsigned get_simultaneous_lines() const override;
 
 	unsigned get_max_buffering() const override;
+
+	size_t get_tmp_size(unsigned left, unsigned right) const override;
+
+	void process(void *ctx, const graph::ImageBuffer<const void> *src, const graph::ImageBuffer<void> *dst, void *tmp, unsigned i, unsigned left, unsigned right) const override;
 };
 
 struct UnresizeImplBuilder {
@@ -58,10 +86,14 @@ struct UnresizeImplBuilder {
 	PixelType type;
 
 #include "common/builder.h"
+	BUILDER_MEMBER(PixelType, dst_type)
+	BUILDER_MEMBER(unsigned, depth)
 	BUILDER_MEMBER(bool, horizontal)
 	BUILDER_MEMBER(unsigned, orig_dim)
 	BUILDER_MEMBER(double, shift)
+	BUILDER_MEMBER(const resize::Filter *, filter)
 	BUILDER_MEMBER(CPUClass, cpu)
+	BUILDER_MEMBER(unsigned, threads)
 #undef BUILDER_MEMBER
 
 	UnresizeImplBuilder(unsigned up_width, unsigned up_height, PixelType type);
@@ -0,0 +1,341 @@
+#ifdef ZIMG_X86
+
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+#include <type_traits>
+#include <immintrin.h>
+#include "common/align.h"
+#include "common/ccdep.h"
+#include "common/checked_int.h"
+#include "common/except.h"
+#include "common/make_unique.h"
+#include "common/pixel.h"
+#include "graph/image_buffer.h"
+#include "unresize/bilinear.h"
+#include "unresize/unresize_impl.h"
+#include "unresize_impl_x86.h"
+
+#include "common/x86/avx_util.h"
+
+namespace zimg {
+namespace unresize {
+
+namespace {
+
+inline FORCE_INLINE __m256 load8(const float *src)
+{
+	return _mm256_load_ps(src);
+}
+
+inline FORCE_INLINE __m256 load8(const uint16_t *src)
+{
+	return _mm256_cvtepi32_ps(_mm256_cvtepu16_epi32(_mm_load_si128((const __m128i *)src)));
+}
+
+// Store the 32-bit elements of [x] with index in the range [lo, hi) into [dst].
+inline FORCE_INLINE void mm256_store_range_ps(float *dst, __m256 x, unsigned lo, unsigned hi)
+{
+	if (lo == 0 && hi == 8) {
+		_mm256_store_ps(dst, x);
+	} else {
+		__m256 orig = _mm256_load_ps(dst);
+		__m256 mask = _mm256_andnot_ps(_mm256_load_ps((const float *)(&ymm_mask_table[lo * 4])), _mm256_load_ps((const float *)(&ymm_mask_table[hi * 4])));
+
+		x = _mm256_blendv_ps(orig, x, mask);
+		_mm256_store_ps(dst, x);
+	}
+}
+
+// Round [x] to integer, clamp to [0, pixel_max], and store the elements with index in the range [lo, hi) into [dst].
+inline FORCE_INLINE void mm256_store_range_u16(uint16_t *dst, __m256 x, __m128i pixel_max, unsigned lo, unsigned hi)
+{
+	__m256i y = _mm256_cvtps_epi32(x);
+	__m128i w = _mm_packus_epi32(_mm256_castsi256_si128(y), _mm256_extracti128_si256(y, 1));
+	w = _mm_min_epu16(w, pixel_max);
+
+	if (lo == 0 && hi == 8) {
+		_mm_store_si128((__m128i *)dst, w);
+	} else {
+		__m128i orig = _mm_load_si128((const __m128i *)dst);
+		__m128i mask = _mm_andnot_si128(_mm_load_si128((const __m128i *)(&xmm_mask_table[lo * 2])), _mm_load_si128((const __m128i *)(&xmm_mask_table[hi * 2])));
+
+		w = _mm_blendv_epi8(orig, w, mask);
+		_mm_store_si128((__m128i *)dst, w);
+	}
+}
+
+inline FORCE_INLINE void store_range(float *dst, __m256 x, __m128i, unsigned lo, unsigned hi)
+{
+	mm256_store_range_ps(dst, x, lo, hi);
+}
+
+inline FORCE_INLINE void store_range(uint16_t *dst, __m256 x, __m128i pixel_max, unsigned lo, unsigned hi)
+{
+	mm256_store_range_u16(dst, x, pixel_max, lo, hi);
+}
+
+template <class T>
+void transpose_line_8x8(float *dst, const T * const *src_ptr, unsigned left, unsigned right)
+{
+	for (unsigned j = left; j < right; j += 8) {
+		__m256 x0, x1, x2, x3, x4, x5, x6, x7;
+
+		x0 = load8(src_ptr[0] + j);
+		x1 = load8(src_ptr[1] + j);
+		x2 = load8(src_ptr[2] + j);
+		x3 = load8(src_ptr[3] + j);
+		x4 = load8(src_ptr[4] + j);
+		x5 = load8(src_ptr[5] + j);
+		x6 = load8(src_ptr[6] + j);
+		x7 = load8(src_ptr[7] + j);
+
+		mm256_transpose8_ps(x0, x1, x2, x3, x4, x5, x6, x7);
+
+		_mm256_store_ps(dst + 0, x0);
+		_mm256_store_ps(dst + 8, x1);
+		_mm256_store_ps(dst + 16, x2);
+		_mm256_store_ps(dst + 24, x3);
+		_mm256_store_ps(dst + 32, x4);
+		_mm256_store_ps(dst + 40, x5);
+		_mm256_store_ps(dst + 48, x6);
+		_mm256_store_ps(dst + 56, x7);
+
+		dst += 64;
+	}
+}
+
+template <class T>
+void untranspose_line_8x8(T * const *dst_ptr, const float *src, unsigned width, __m128i pixel_max)
+{
+	for (unsigned j = 0; j < width; j += 8) {
+		__m256 x0, x1, x2, x3, x4, x5, x6, x7;
+
+		x0 = _mm256_load_ps(src + j * 8 + 0);
+		x1 = _mm256_load_ps(src + j * 8 + 8);
+		x2 = _mm256_load_ps(src + j * 8 + 16);
+		x3 = _mm256_load_ps(src + j * 8 + 24);
+		x4 = _mm256_load_ps(src + j * 8 + 32);
+		x5 = _mm256_load_ps(src + j * 8 + 40);
+		x6 = _mm256_load_ps(src + j * 8 + 48);
+		x7 = _mm256_load_ps(src + j * 8 + 56);
+
+		mm256_transpose8_ps(x0, x1, x2, x3, x4, x5, x6, x7);
+
+		unsigned hi = std::min(width - j, 8U);
+		store_range(dst_ptr[0] + j, x0, pixel_max, 0, hi);
+		store_range(dst_ptr[1] + j, x1, pixel_max, 0, hi);
+		store_range(dst_ptr[2] + j, x2, pixel_max, 0, hi);
+		store_range(dst_ptr[3] + j, x3, pixel_max, 0, hi);
+		store_range(dst_ptr[4] + j, x4, pixel_max, 0, hi);
+		store_range(dst_ptr[5] + j, x5, pixel_max, 0, hi);
+		store_range(dst_ptr[6] + j, x6, pixel_max, 0, hi);
+		store_range(dst_ptr[7] + j, x7, pixel_max, 0, hi);
+	}
+}
+
+// Solve eight transposed rows, stored in [src] and [dst] as interleaved columns.
+void unresize_line8_h_f32_avx2(const BilinearContext &ctx, const float *src, float *dst)
+{
+	const float *c = ctx.lu_c.data();
+	const float *l = ctx.lu_l.data();
+	const float *u = ctx.lu_u.data();
+	unsigned bandwidth = ctx.lu_bandwidth;
+
+	for (unsigned j = 0; j < ctx.output_width; ++j) {
+		const float *coeffs = &ctx.matrix_coefficients[j * ctx.matrix_row_stride];
+		const float *src_p = src + ctx.matrix_row_offsets[j] * 8;
+		__m256 accum = _mm256_setzero_ps();
+
+		for (unsigned k = 0; k < ctx.matrix_row_size; ++k) {
+			__m256 coeff = _mm256_broadcast_ss(coeffs + k);
+			__m256 x = _mm256_load_ps(src_p + k * 8);
+
+			accum = _mm256_fmadd_ps(coeff, x, accum);
+		}
+
+		for (unsigned k = 1; k <= std::min(j, bandwidth); ++k) {
+			accum = _mm256_fnmadd_ps(_mm256_broadcast_ss(c + j * bandwidth + k - 1), _mm256_load_ps(dst + (j - k) * 8), accum);
+		}
+		_mm256_store_ps(dst + j * 8, _mm256_mul_ps(accum, _mm256_broadcast_ss(l + j)));
+	}
+
+	for (unsigned j = ctx.output_width; j != 0; --j) {
+		__m256 w = _mm256_load_ps(dst + (j - 1) * 8);
+
+		for (unsigned k = 1; k <= std::min(ctx.output_width - j, bandwidth); ++k) {
+			w = _mm256_fnmadd_ps(_mm256_broadcast_ss(u + (j - 1) * bandwidth + k - 1), _mm256_load_ps(dst + (j - 1 + k) * 8), w);
+		}
+		_mm256_store_ps(dst + (j - 1) * 8, w);
+	}
+}
+
+template <class T>
+void unresize_line_forward_v_avx2(const BilinearContext &ctx, const graph::ImageBuffer<const T> &src, const graph::ImageBuffer<float> &dst,
+                                  unsigned i, unsigned left, unsigned right)
+{
+	const float *coeffs = &ctx.matrix_coefficients[i * ctx.matrix_row_stride];
+	unsigned top = ctx.matrix_row_offsets[i];
+
+	unsigned bandwidth = std::min(i, ctx.lu_bandwidth);
+	const float *c = &ctx.lu_c[i * ctx.lu_bandwidth];
+	const __m256 l = _mm256_set1_ps(ctx.lu_l[i]);
+
+	float *dst_p = dst[i];
+
+	for (unsigned j = floor_n(left, 8); j < right; j += 8) {
+		__m256 accum = _mm256_setzero_ps();
+
+		for (unsigned k = 0; k < ctx.matrix_row_size; ++k) {
+			__m256 coeff = _mm256_broadcast_ss(coeffs + k);
+			__m256 x = load8(src[top + k] + j);
+
+			accum = _mm256_fmadd_ps(coeff, x, accum);
+		}
+
+		for (unsigned k = 1; k <= bandwidth; ++k) {
+			accum = _mm256_fnmadd_ps(_mm256_set1_ps(c[k - 1]), _mm256_load_ps(dst[i - k] + j), accum);
+		}
+
+		__m256 z = _mm256_mul_ps(accum, l);
+		mm256_store_range_ps(dst_p + j, z, std::max(left, j) - j, std::min(right - j, 8U));
+	}
+}
+
+void unresize_line_back_v_f32_avx2(const BilinearContext &ctx, const graph::ImageBuffer<float> &dst, unsigned i, unsigned left, unsigned right)
+{
+	unsigned bandwidth = std::min(ctx.output_width - i, ctx.lu_bandwidth);
+	const float *u = &ctx.lu_u[(i - 1) * ctx.lu_bandwidth];
+
+	float *dst_p = dst[i - 1];
+
+	for (unsigned j = floor_n(left, 8); j < right; j += 8) {
+		__m256 w = _mm256_load_ps(dst_p + j);
+
+		for (unsigned k = 1; k <= bandwidth; ++k) {
+			w = _mm256_fnmadd_ps(_mm256_set1_ps(u[k - 1]), _mm256_load_ps(dst[i - 1 + k] + j), w);
+		}
+
+		mm256_store_range_ps(dst_p + j, w, std::max(left, j) - j, std::min(right - j, 8U));
+	}
+}
+
+void store_line_u16_avx2(const float *src, uint16_t *dst, unsigned left, unsigned right, __m128i pixel_max)
+{
+	for (unsigned j = floor_n(left, 8); j < right; j += 8) {
+		mm256_store_range_u16(dst + j, _mm256_load_ps(src + j), pixel_max, std::max(left, j) - j, std::min(right - j, 8U));
+	}
+}
+
+
+template <class T, class U>
+class UnresizeImplH_AVX2 final : public UnresizeImplH {
+	uint16_t m_pixel_max;
+public:
+	UnresizeImplH_AVX2(const BilinearContext &context, unsigned height, PixelType type, unsigned depth) :
+		UnresizeImplH(context, image_attributes{ context.output_width, height, type }),
+		m_pixel_max{ static_cast<uint16_t>((1UL << depth) - 1) }
+	{}
+
+	unsigned get_simultaneous_lines() const override { return 8; }
+
+	size_t get_tmp_size(unsigned, unsigned) const override
+	{
+		try {
+			checked_size_t size = (static_cast<checked_size_t>(ceil_n(m_context.input_width, 8)) + ceil_n(m_context.output_width, 8)) * sizeof(float) * 8;
+			return size.get();
+		} catch (const std::overflow_error &) {
+			error::throw_<error::OutOfMemory>();
+		}
+	}
+
+	void process(void *, const graph::ImageBuffer<const void> *src, const graph::ImageBuffer<void> *dst, void *tmp, unsigned i, unsigned, unsigned) const override
+	{
+		const auto &src_buf = graph::static_buffer_cast<const T>(*src);
+		const auto &dst_buf = graph::static_buffer_cast<U>(*dst);
+
+		const T *src_ptr[8];
+		U *dst_ptr[8];
+		float *transpose_in = static_cast<float *>(tmp);
+		float *transpose_out = transpose_in + ceil_n(m_context.input_width, 8) * 8;
+		unsigned height = get_image_attributes().height;
+
+		for (unsigned n = 0; n < 8; ++n) {
+			src_ptr[n] = src_buf[std::min(i + n, height - 1)];
+			dst_ptr[n] = dst_buf[std::min(i + n, height - 1)];
+		}
+
+		transpose_line_8x8(transpose_in, src_ptr, 0, ceil_n(m_context.input_width, 8));
+		unresize_line8_h_f32_avx2(m_context, transpose_in, transpose_out);
+		untranspose_line_8x8(dst_ptr, transpose_out, m_context.output_width, _mm_set1_epi16(m_pixel_max));
+	}
+};
+
+template <class T, class U>
+class UnresizeImplV_AVX2 final : public UnresizeImplV {
+	uint16_t m_pixel_max;
+
+	void process_columns(const graph::ImageBuffer<const void> &src, const graph::ImageBuffer<void> &dst, const graph::ImageBuffer<float> &work,
+	                     unsigned left, unsigned right) const override
+	{
+		const auto &src_buf = graph::static_buffer_cast<const T>(src);
+
+		const __m128i pixel_max = _mm_set1_epi16(m_pixel_max);
+		unsigned height = get_image_attributes().height;
+
+		for (unsigned i = 0; i < height; ++i) {
+			unresize_line_forward_v_avx2(m_context, src_buf, work, i, left, right);
+		}
+		for (unsigned i = height; i != 0; --i) {
+			unresize_line_back_v_f32_avx2(m_context, work, i, left, right);
+
+			if (std::is_same<U, uint16_t>::value)
+				store_line_u16_avx2(work[i - 1], graph::static_buffer_cast<uint16_t>(dst)[i - 1], left, right, pixel_max);
+		}
+	}
+public:
+	UnresizeImplV_AVX2(const BilinearContext &context, unsigned width, PixelType type, unsigned depth, unsigned threads) :
+		UnresizeImplV(context, image_attributes{ width, context.output_width, type }, threads),
+		m_pixel_max{ static_cast<uint16_t>((1UL << depth) - 1) }
+	{}
+};
+
+} // namespace
+
+
+std::unique_ptr<graph::ImageFilter> create_unresize_impl_h_avx2(const BilinearContext &context, unsigned height, PixelType src_type, PixelType dst_type, unsigned depth)
+{
+	std::unique_ptr<graph::ImageFilter> ret;
+
+	if (src_type == PixelType::WORD && dst_type == PixelType::WORD)
+		ret = ztd::make_unique<UnresizeImplH_AVX2<uint16_t, uint16_t>>(context, height, dst_type, depth);
+	else if (src_type == PixelType::WORD && dst_type == PixelType::FLOAT)
+		ret = ztd::make_unique<UnresizeImplH_AVX2<uint16_t, float>>(context, height, dst_type, depth);
+	else if (src_type == PixelType::FLOAT && dst_type == PixelType::WORD)
+		ret = ztd::make_unique<UnresizeImplH_AVX2<float, uint16_t>>(context, height, dst_type, depth);
+	else if (src_type == PixelType::FLOAT && dst_type == PixelType::FLOAT)
+		ret = ztd::make_unique<UnresizeImplH_AVX2<float, float>>(context, height, dst_type, depth);
+
+	return ret;
+}
+
+std::unique_ptr<graph::ImageFilter> create_unresize_impl_v_avx2(const BilinearContext &context, unsigned width, PixelType src_type, PixelType dst_type, unsigned depth, unsigned threads)
+{
+	std::unique_ptr<graph::ImageFilter> ret;
+
+	if (src_type == PixelType::WORD && dst_type == PixelType::WORD)
+		ret = ztd::make_unique<UnresizeImplV_AVX2<uint16_t, uint16_t>>(context, width, dst_type, depth, threads);
+	else if (src_type == PixelType::WORD && dst_type == PixelType::FLOAT)
+		ret = ztd::make_unique<UnresizeImplV_AVX2<uint16_t, float>>(context, width, dst_type, depth, threads);
+	else if (src_type == PixelType::FLOAT && dst_type == PixelType::WORD)
+		ret = ztd::make_unique<UnresizeImplV_AVX2<float, uint16_t>>(context, width, dst_type, depth, threads);
+	else if (src_type == PixelType::FLOAT && dst_type == PixelType::FLOAT)
+		ret = ztd::make_unique<UnresizeImplV_AVX2<float, float>>(context, width, dst_type, depth, threads);
+
+	return ret;
+}
+
+} // namespace unresize
+} // namespace zimg
+
+#endif // ZIMG_X86
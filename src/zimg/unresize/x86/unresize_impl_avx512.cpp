@@ -0,0 +1,358 @@
+#include "common/x86/avx512_msvc_compat.h"
+
+#ifdef ZIMG_X86_AVX512
+
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+#include <type_traits>
+#include <immintrin.h>
+#include "common/align.h"
+#include "common/ccdep.h"
+#include "common/checked_int.h"
+#include "common/except.h"
+#include "common/make_unique.h"
+#include "common/pixel.h"
+#include "graph/image_buffer.h"
+#include "unresize/bilinear.h"
+#include "unresize/unresize_impl.h"
+#include "unresize_impl_x86.h"
+
+#include "common/x86/avx512_util.h"
+
+namespace zimg {
+namespace unresize {
+
+namespace {
+
+inline FORCE_INLINE __m512 load16(const float *src)
+{
+	return _mm512_load_ps(src);
+}
+
+inline FORCE_INLINE __m512 load16(const uint16_t *src)
+{
+	return _mm512_cvtepi32_ps(_mm512_cvtepu16_epi32(_mm256_load_si256((const __m256i *)src)));
+}
+
+// Store the 32-bit elements of [x] with index in the range [lo, hi) into [dst].
+inline FORCE_INLINE void mm512_store_range_ps(float *dst, __m512 x, unsigned lo, unsigned hi)
+{
+	_mm512_mask_store_ps(dst, mmask16_set_lo(hi) & mmask16_set_hi(16 - lo), x);
+}
+
+// Round [x] to integer, clamp to [0, pixel_max], and store the elements with index in the range [lo, hi) into [dst].
+inline FORCE_INLINE void mm512_store_range_u16(uint16_t *dst, __m512 x, __m512i pixel_max, unsigned lo, unsigned hi)
+{
+	__m512i y = _mm512_cvtps_epi32(x);
+	y = _mm512_max_epi32(y, _mm512_setzero_si512());
+	y = _mm512_min_epi32(y, pixel_max);
+	_mm256_mask_storeu_epi16(dst, mmask16_set_lo(hi) & mmask16_set_hi(16 - lo), _mm512_cvtepi32_epi16(y));
+}
+
+inline FORCE_INLINE void store_range(float *dst, __m512 x, __m512i, unsigned lo, unsigned hi)
+{
+	mm512_store_range_ps(dst, x, lo, hi);
+}
+
+inline FORCE_INLINE void store_range(uint16_t *dst, __m512 x, __m512i pixel_max, unsigned lo, unsigned hi)
+{
+	mm512_store_range_u16(dst, x, pixel_max, lo, hi);
+}
+
+template <class T>
+void transpose_line_16x16(float *dst, const T * const *src_ptr, unsigned left, unsigned right)
+{
+	for (unsigned j = left; j < right; j += 16) {
+		__m512 x0, x1, x2, x3, x4, x5, x6, x7, x8, x9, x10, x11, x12, x13, x14, x15;
+
+		x0 = load16(src_ptr[0] + j);
+		x1 = load16(src_ptr[1] + j);
+		x2 = load16(src_ptr[2] + j);
+		x3 = load16(src_ptr[3] + j);
+		x4 = load16(src_ptr[4] + j);
+		x5 = load16(src_ptr[5] + j);
+		x6 = load16(src_ptr[6] + j);
+		x7 = load16(src_ptr[7] + j);
+		x8 = load16(src_ptr[8] + j);
+		x9 = load16(src_ptr[9] + j);
+		x10 = load16(src_ptr[10] + j);
+		x11 = load16(src_ptr[11] + j);
+		x12 = load16(src_ptr[12] + j);
+		x13 = load16(src_ptr[13] + j);
+		x14 = load16(src_ptr[14] + j);
+		x15 = load16(src_ptr[15] + j);
+
+		mm512_transpose16_ps(x0, x1, x2, x3, x4, x5, x6, x7, x8, x9, x10, x11, x12, x13, x14, x15);
+
+		_mm512_store_ps(dst + 0, x0);
+		_mm512_store_ps(dst + 16, x1);
+		_mm512_store_ps(dst + 32, x2);
+		_mm512_store_ps(dst + 48, x3);
+		_mm512_store_ps(dst + 64, x4);
+		_mm512_store_ps(dst + 80, x5);
+		_mm512_store_ps(dst + 96, x6);
+		_mm512_store_ps(dst + 112, x7);
+		_mm512_store_ps(dst + 128, x8);
+		_mm512_store_ps(dst + 144, x9);
+		_mm512_store_ps(dst + 160, x10);
+		_mm512_store_ps(dst + 176, x11);
+		_mm512_store_ps(dst + 192, x12);
+		_mm512_store_ps(dst + 208, x13);
+		_mm512_store_ps(dst + 224, x14);
+		_mm512_store_ps(dst + 240, x15);
+
+		dst += 256;
+	}
+}
+
+template <class T>
+void untranspose_line_16x16(T * const *dst_ptr, const float *src, unsigned width, __m512i pixel_max)
+{
+	for (unsigned j = 0; j < width; j += 16) {
+		__m512 x0, x1, x2, x3, x4, x5, x6, x7, x8, x9, x10, x11, x12, x13, x14, x15;
+
+		x0 = _mm512_load_ps(src + j * 16 + 0);
+		x1 = _mm512_load_ps(src + j * 16 + 16);
+		x2 = _mm512_load_ps(src + j * 16 + 32);
+		x3 = _mm512_load_ps(src + j * 16 + 48);
+		x4 = _mm512_load_ps(src + j * 16 + 64);
+		x5 = _mm512_load_ps(src + j * 16 + 80);
+		x6 = _mm512_load_ps(src + j * 16 + 96);
+		x7 = _mm512_load_ps(src + j * 16 + 112);
+		x8 = _mm512_load_ps(src + j * 16 + 128);
+		x9 = _mm512_load_ps(src + j * 16 + 144);
+		x10 = _mm512_load_ps(src + j * 16 + 160);
+		x11 = _mm512_load_ps(src + j * 16 + 176);
+		x12 = _mm512_load_ps(src + j * 16 + 192);
+		x13 = _mm512_load_ps(src + j * 16 + 208);
+		x14 = _mm512_load_ps(src + j * 16 + 224);
+		x15 = _mm512_load_ps(src + j * 16 + 240);
+
+		mm512_transpose16_ps(x0, x1, x2, x3, x4, x5, x6, x7, x8, x9, x10, x11, x12, x13, x14, x15);
+
+		unsigned hi = std::min(width - j, 16U);
+		store_range(dst_ptr[0] + j, x0, pixel_max, 0, hi);
+		store_range(dst_ptr[1] + j, x1, pixel_max, 0, hi);
+		store_range(dst_ptr[2] + j, x2, pixel_max, 0, hi);
+		store_range(dst_ptr[3] + j, x3, pixel_max, 0, hi);
+		store_range(dst_ptr[4] + j, x4, pixel_max, 0, hi);
+		store_range(dst_ptr[5] + j, x5, pixel_max, 0, hi);
+		store_range(dst_ptr[6] + j, x6, pixel_max, 0, hi);
+		store_range(dst_ptr[7] + j, x7, pixel_max, 0, hi);
+		store_range(dst_ptr[8] + j, x8, pixel_max, 0, hi);
+		store_range(dst_ptr[9] + j, x9, pixel_max, 0, hi);
+		store_range(dst_ptr[10] + j, x10, pixel_max, 0, hi);
+		store_range(dst_ptr[11] + j, x11, pixel_max, 0, hi);
+		store_range(dst_ptr[12] + j, x12, pixel_max, 0, hi);
+		store_range(dst_ptr[13] + j, x13, pixel_max, 0, hi);
+		store_range(dst_ptr[14] + j, x14, pixel_max, 0, hi);
+		store_range(dst_ptr[15] + j, x15, pixel_max, 0, hi);
+	}
+}
+
+// Solve sixteen transposed rows, stored in [src] and [dst] as interleaved columns.
+void unresize_line16_h_f32_avx512(const BilinearContext &ctx, const float *src, float *dst)
+{
+	const float *c = ctx.lu_c.data();
+	const float *l = ctx.lu_l.data();
+	const float *u = ctx.lu_u.data();
+	unsigned bandwidth = ctx.lu_bandwidth;
+
+	for (unsigned j = 0; j < ctx.output_width; ++j) {
+		const float *coeffs = &ctx.matrix_coefficients[j * ctx.matrix_row_stride];
+		const float *src_p = src + ctx.matrix_row_offsets[j] * 16;
+		__m512 accum = _mm512_setzero_ps();
+
+		for (unsigned k = 0; k < ctx.matrix_row_size; ++k) {
+			__m512 coeff = _mm512_set1_ps(coeffs[k]);
+			__m512 x = _mm512_load_ps(src_p + k * 16);
+
+			accum = _mm512_fmadd_ps(coeff, x, accum);
+		}
+
+		for (unsigned k = 1; k <= std::min(j, bandwidth); ++k) {
+			accum = _mm512_fnmadd_ps(_mm512_set1_ps(c[j * bandwidth + k - 1]), _mm512_load_ps(dst + (j - k) * 16), accum);
+		}
+		_mm512_store_ps(dst + j * 16, _mm512_mul_ps(accum, _mm512_set1_ps(l[j])));
+	}
+
+	for (unsigned j = ctx.output_width; j != 0; --j) {
+		__m512 w = _mm512_load_ps(dst + (j - 1) * 16);
+
+		for (unsigned k = 1; k <= std::min(ctx.output_width - j, bandwidth); ++k) {
+			w = _mm512_fnmadd_ps(_mm512_set1_ps(u[(j - 1) * bandwidth + k - 1]), _mm512_load_ps(dst + (j - 1 + k) * 16), w);
+		}
+		_mm512_store_ps(dst + (j - 1) * 16, w);
+	}
+}
+
+template <class T>
+void unresize_line_forward_v_avx512(const BilinearContext &ctx, const graph::ImageBuffer<const T> &src, const graph::ImageBuffer<float> &dst,
+                                    unsigned i, unsigned left, unsigned right)
+{
+	const float *coeffs = &ctx.matrix_coefficients[i * ctx.matrix_row_stride];
+	unsigned top = ctx.matrix_row_offsets[i];
+
+	unsigned bandwidth = std::min(i, ctx.lu_bandwidth);
+	const float *c = &ctx.lu_c[i * ctx.lu_bandwidth];
+	const __m512 l = _mm512_set1_ps(ctx.lu_l[i]);
+
+	float *dst_p = dst[i];
+
+	for (unsigned j = floor_n(left, 16); j < right; j += 16) {
+		__m512 accum = _mm512_setzero_ps();
+
+		for (unsigned k = 0; k < ctx.matrix_row_size; ++k) {
+			__m512 coeff = _mm512_set1_ps(coeffs[k]);
+			__m512 x = load16(src[top + k] + j);
+
+			accum = _mm512_fmadd_ps(coeff, x, accum);
+		}
+
+		for (unsigned k = 1; k <= bandwidth; ++k) {
+			accum = _mm512_fnmadd_ps(_mm512_set1_ps(c[k - 1]), _mm512_load_ps(dst[i - k] + j), accum);
+		}
+
+		__m512 z = _mm512_mul_ps(accum, l);
+		mm512_store_range_ps(dst_p + j, z, std::max(left, j) - j, std::min(right - j, 16U));
+	}
+}
+
+void unresize_line_back_v_f32_avx512(const BilinearContext &ctx, const graph::ImageBuffer<float> &dst, unsigned i, unsigned left, unsigned right)
+{
+	unsigned bandwidth = std::min(ctx.output_width - i, ctx.lu_bandwidth);
+	const float *u = &ctx.lu_u[(i - 1) * ctx.lu_bandwidth];
+
+	float *dst_p = dst[i - 1];
+
+	for (unsigned j = floor_n(left, 16); j < right; j += 16) {
+		__m512 w = _mm512_load_ps(dst_p + j);
+
+		for (unsigned k = 1; k <= bandwidth; ++k) {
+			w = _mm512_fnmadd_ps(_mm512_set1_ps(u[k - 1]), _mm512_load_ps(dst[i - 1 + k] + j), w);
+		}
+
+		mm512_store_range_ps(dst_p + j, w, std::max(left, j) - j, std::min(right - j, 16U));
+	}
+}
+
+void store_line_u16_avx512(const float *src, uint16_t *dst, unsigned left, unsigned right, __m512i pixel_max)
+{
+	for (unsigned j = floor_n(left, 16); j < right; j += 16) {
+		mm512_store_range_u16(dst + j, _mm512_load_ps(src + j), pixel_max, std::max(left, j) - j, std::min(right - j, 16U));
+	}
+}
+
+
+template <class T, class U>
+class UnresizeImplH_AVX512 final : public UnresizeImplH {
+	int32_t m_pixel_max;
+public:
+	UnresizeImplH_AVX512(const BilinearContext &context, unsigned height, PixelType type, unsigned depth) :
+		UnresizeImplH(context, image_attributes{ context.output_width, height, type }),
+		m_pixel_max{ static_cast<int32_t>((1UL << depth) - 1) }
+	{}
+
+	unsigned get_simultaneous_lines() const override { return 16; }
+
+	size_t get_tmp_size(unsigned, unsigned) const override
+	{
+		try {
+			checked_size_t size = (static_cast<checked_size_t>(ceil_n(m_context.input_width, 16)) + ceil_n(m_context.output_width, 16)) * sizeof(float) * 16;
+			return size.get();
+		} catch (const std::overflow_error &) {
+			error::throw_<error::OutOfMemory>();
+		}
+	}
+
+	void process(void *, const graph::ImageBuffer<const void> *src, const graph::ImageBuffer<void> *dst, void *tmp, unsigned i, unsigned, unsigned) const override
+	{
+		const auto &src_buf = graph::static_buffer_cast<const T>(*src);
+		const auto &dst_buf = graph::static_buffer_cast<U>(*dst);
+
+		const T *src_ptr[16];
+		U *dst_ptr[16];
+		float *transpose_in = static_cast<float *>(tmp);
+		float *transpose_out = transpose_in + ceil_n(m_context.input_width, 16) * 16;
+		unsigned height = get_image_attributes().height;
+
+		for (unsigned n = 0; n < 16; ++n) {
+			src_ptr[n] = src_buf[std::min(i + n, height - 1)];
+			dst_ptr[n] = dst_buf[std::min(i + n, height - 1)];
+		}
+
+		transpose_line_16x16(transpose_in, src_ptr, 0, ceil_n(m_context.input_width, 16));
+		unresize_line16_h_f32_avx512(m_context, transpose_in, transpose_out);
+		untranspose_line_16x16(dst_ptr, transpose_out, m_context.output_width, _mm512_set1_epi32(m_pixel_max));
+	}
+};
+
+template <class T, class U>
+class UnresizeImplV_AVX512 final : public UnresizeImplV {
+	int32_t m_pixel_max;
+
+	void process_columns(const graph::ImageBuffer<const void> &src, const graph::ImageBuffer<void> &dst, const graph::ImageBuffer<float> &work,
+	                     unsigned left, unsigned right) const override
+	{
+		const auto &src_buf = graph::static_buffer_cast<const T>(src);
+
+		const __m512i pixel_max = _mm512_set1_epi32(m_pixel_max);
+		unsigned height = get_image_attributes().height;
+
+		for (unsigned i = 0; i < height; ++i) {
+			unresize_line_forward_v_avx512(m_context, src_buf, work, i, left, right);
+		}
+		for (unsigned i = height; i != 0; --i) {
+			unresize_line_back_v_f32_avx512(m_context, work, i, left, right);
+
+			if (std::is_same<U, uint16_t>::value)
+				store_line_u16_avx512(work[i - 1], graph::static_buffer_cast<uint16_t>(dst)[i - 1], left, right, pixel_max);
+		}
+	}
+public:
+	UnresizeImplV_AVX512(const BilinearContext &context, unsigned width, PixelType type, unsigned depth, unsigned threads) :
+		UnresizeImplV(context, image_attributes{ width, context.output_width, type }, threads),
+		m_pixel_max{ static_cast<int32_t>((1UL << depth) - 1) }
+	{}
+};
+
+} // namespace
+
+
+std::unique_ptr<graph::ImageFilter> create_unresize_impl_h_avx512(const BilinearContext &context, unsigned height, PixelType src_type, PixelType dst_type, unsigned depth)
+{
+	std::unique_ptr<graph::ImageFilter> ret;
+
+	if (src_type == PixelType::WORD && dst_type == PixelType::WORD)
+		ret = ztd::make_unique<UnresizeImplH_AVX512<uint16_t, uint16_t>>(context, height, dst_type, depth);
+	else if (src_type == PixelType::WORD && dst_type == PixelType::FLOAT)
+		ret = ztd::make_unique<UnresizeImplH_AVX512<uint16_t, float>>(context, height, dst_type, depth);
+	else if (src_type == PixelType::FLOAT && dst_type == PixelType::WORD)
+		ret = ztd::make_unique<UnresizeImplH_AVX512<float, uint16_t>>(context, height, dst_type, depth);
+	else if (src_type == PixelType::FLOAT && dst_type == PixelType::FLOAT)
+		ret = ztd::make_unique<UnresizeImplH_AVX512<float, float>>(context, height, dst_type, depth);
+
+	return ret;
+}
+
+std::unique_ptr<graph::ImageFilter> create_unresize_impl_v_avx512(const BilinearContext &context, unsigned width, PixelType src_type, PixelType dst_type, unsigned depth, unsigned threads)
+{
+	std::unique_ptr<graph::ImageFilter> ret;
+
+	if (src_type == PixelType::WORD && dst_type == PixelType::WORD)
+		ret = ztd::make_unique<UnresizeImplV_AVX512<uint16_t, uint16_t>>(context, width, dst_type, depth, threads);
+	else if (src_type == PixelType::WORD && dst_type == PixelType::FLOAT)
+		ret = ztd::make_unique<UnresizeImplV_AVX512<uint16_t, float>>(context, width, dst_type, depth, threads);
+	else if (src_type == PixelType::FLOAT && dst_type == PixelType::WORD)
+		ret = ztd::make_unique<UnresizeImplV_AVX512<float, uint16_t>>(context, width, dst_type, depth, threads);
+	else if (src_type == PixelType::FLOAT && dst_type == PixelType::FLOAT)
+		ret = ztd::make_unique<UnresizeImplV_AVX512<float, float>>(context, width, dst_type, depth, threads);
+
+	return ret;
+}
+
+} // namespace unresize
+} // namespace zimg
+
+#endif // ZIMG_X86_AVX512
@@ -0,0 +1,251 @@
+#ifdef ZIMG_X86
+
+#include <algorithm>
+#include <stdexcept>
+#include <xmmintrin.h>
+#include "common/align.h"
+#include "common/ccdep.h"
+#include "common/checked_int.h"
+#include "common/except.h"
+#include "common/make_unique.h"
+#include "common/pixel.h"
+#include "graph/image_buffer.h"
+#include "unresize/bilinear.h"
+#include "unresize/unresize_impl.h"
+#include "unresize_impl_x86.h"
+
+#include "common/x86/sse_util.h"
+
+namespace zimg {
+namespace unresize {
+
+namespace {
+
+// Store the 32-bit elements of [x] with index in the range [lo, hi) into [dst].
+inline FORCE_INLINE void mm_store_range_ps(float *dst, __m128 x, unsigned lo, unsigned hi)
+{
+	if (lo == 0 && hi == 4) {
+		_mm_store_ps(dst, x);
+	} else {
+		__m128 orig = _mm_load_ps(dst);
+		__m128 mask = _mm_andnot_ps(_mm_load_ps((const float *)(&xmm_mask_table[lo * 4])), _mm_load_ps((const float *)(&xmm_mask_table[hi * 4])));
+
+		x = _mm_or_ps(_mm_and_ps(mask, x), _mm_andnot_ps(mask, orig));
+		_mm_store_ps(dst, x);
+	}
+}
+
+void transpose_line_4x4_ps(float *dst, const float *src_p0, const float *src_p1, const float *src_p2, const float *src_p3, unsigned left, unsigned right)
+{
+	for (unsigned j = left; j < right; j += 4) {
+		__m128 x0, x1, x2, x3;
+
+		x0 = _mm_load_ps(src_p0 + j);
+		x1 = _mm_load_ps(src_p1 + j);
+		x2 = _mm_load_ps(src_p2 + j);
+		x3 = _mm_load_ps(src_p3 + j);
+
+		_MM_TRANSPOSE4_PS(x0, x1, x2, x3);
+
+		_mm_store_ps(dst + 0, x0);
+		_mm_store_ps(dst + 4, x1);
+		_mm_store_ps(dst + 8, x2);
+		_mm_store_ps(dst + 12, x3);
+
+		dst += 16;
+	}
+}
+
+void untranspose_line_4x4_ps(float *dst_p0, float *dst_p1, float *dst_p2, float *dst_p3, const float *src, unsigned width)
+{
+	for (unsigned j = 0; j < width; j += 4) {
+		__m128 x0, x1, x2, x3;
+
+		x0 = _mm_load_ps(src + j * 4 + 0);
+		x1 = _mm_load_ps(src + j * 4 + 4);
+		x2 = _mm_load_ps(src + j * 4 + 8);
+		x3 = _mm_load_ps(src + j * 4 + 12);
+
+		_MM_TRANSPOSE4_PS(x0, x1, x2, x3);
+
+		unsigned hi = std::min(width - j, 4U);
+		mm_store_range_ps(dst_p0 + j, x0, 0, hi);
+		mm_store_range_ps(dst_p1 + j, x1, 0, hi);
+		mm_store_range_ps(dst_p2 + j, x2, 0, hi);
+		mm_store_range_ps(dst_p3 + j, x3, 0, hi);
+	}
+}
+
+// Solve four transposed rows, stored in [src] and [dst] as interleaved columns.
+void unresize_line4_h_f32_sse(const BilinearContext &ctx, const float *src, float *dst)
+{
+	const float *c = ctx.lu_c.data();
+	const float *l = ctx.lu_l.data();
+	const float *u = ctx.lu_u.data();
+	unsigned bandwidth = ctx.lu_bandwidth;
+
+	for (unsigned j = 0; j < ctx.output_width; ++j) {
+		const float *coeffs = &ctx.matrix_coefficients[j * ctx.matrix_row_stride];
+		const float *src_p = src + ctx.matrix_row_offsets[j] * 4;
+		__m128 accum = _mm_setzero_ps();
+
+		for (unsigned k = 0; k < ctx.matrix_row_size; ++k) {
+			__m128 coeff = _mm_set_ps1(coeffs[k]);
+			__m128 x = _mm_load_ps(src_p + k * 4);
+
+			accum = _mm_add_ps(accum, _mm_mul_ps(coeff, x));
+		}
+
+		for (unsigned k = 1; k <= std::min(j, bandwidth); ++k) {
+			accum = _mm_sub_ps(accum, _mm_mul_ps(_mm_set_ps1(c[j * bandwidth + k - 1]), _mm_load_ps(dst + (j - k) * 4)));
+		}
+		_mm_store_ps(dst + j * 4, _mm_mul_ps(accum, _mm_set_ps1(l[j])));
+	}
+
+	for (unsigned j = ctx.output_width; j != 0; --j) {
+		__m128 w = _mm_load_ps(dst + (j - 1) * 4);
+
+		for (unsigned k = 1; k <= std::min(ctx.output_width - j, bandwidth); ++k) {
+			w = _mm_sub_ps(w, _mm_mul_ps(_mm_set_ps1(u[(j - 1) * bandwidth + k - 1]), _mm_load_ps(dst + (j - 1 + k) * 4)));
+		}
+		_mm_store_ps(dst + (j - 1) * 4, w);
+	}
+}
+
+void unresize_line_forward_v_f32_sse(const BilinearContext &ctx, const graph::ImageBuffer<const float> &src, const graph::ImageBuffer<float> &dst,
+                                     unsigned i, unsigned left, unsigned right)
+{
+	const float *coeffs = &ctx.matrix_coefficients[i * ctx.matrix_row_stride];
+	unsigned top = ctx.matrix_row_offsets[i];
+
+	unsigned bandwidth = std::min(i, ctx.lu_bandwidth);
+	const float *c = &ctx.lu_c[i * ctx.lu_bandwidth];
+	const __m128 l = _mm_set_ps1(ctx.lu_l[i]);
+
+	float *dst_p = dst[i];
+
+	for (unsigned j = floor_n(left, 4); j < right; j += 4) {
+		__m128 accum = _mm_setzero_ps();
+
+		for (unsigned k = 0; k < ctx.matrix_row_size; ++k) {
+			__m128 coeff = _mm_set_ps1(coeffs[k]);
+			__m128 x = _mm_load_ps(src[top + k] + j);
+
+			accum = _mm_add_ps(accum, _mm_mul_ps(coeff, x));
+		}
+
+		for (unsigned k = 1; k <= bandwidth; ++k) {
+			accum = _mm_sub_ps(accum, _mm_mul_ps(_mm_set_ps1(c[k - 1]), _mm_load_ps(dst[i - k] + j)));
+		}
+
+		__m128 z = _mm_mul_ps(accum, l);
+		mm_store_range_ps(dst_p + j, z, std::max(left, j) - j, std::min(right - j, 4U));
+	}
+}
+
+void unresize_line_back_v_f32_sse(const BilinearContext &ctx, const graph::ImageBuffer<float> &dst, unsigned i, unsigned left, unsigned right)
+{
+	unsigned bandwidth = std::min(ctx.output_width - i, ctx.lu_bandwidth);
+	const float *u = &ctx.lu_u[(i - 1) * ctx.lu_bandwidth];
+
+	float *dst_p = dst[i - 1];
+
+	for (unsigned j = floor_n(left, 4); j < right; j += 4) {
+		__m128 w = _mm_load_ps(dst_p + j);
+
+		for (unsigned k = 1; k <= bandwidth; ++k) {
+			w = _mm_sub_ps(w, _mm_mul_ps(_mm_set_ps1(u[k - 1]), _mm_load_ps(dst[i - 1 + k] + j)));
+		}
+
+		mm_store_range_ps(dst_p + j, w, std::max(left, j) - j, std::min(right - j, 4U));
+	}
+}
+
+
+class UnresizeImplH_F32_SSE final : public UnresizeImplH {
+public:
+	UnresizeImplH_F32_SSE(const BilinearContext &context, unsigned height) :
+		UnresizeImplH(context, image_attributes{ context.output_width, height, PixelType::FLOAT })
+	{}
+
+	unsigned get_simultaneous_lines() const override { return 4; }
+
+	size_t get_tmp_size(unsigned, unsigned) const override
+	{
+		try {
+			checked_size_t size = (static_cast<checked_size_t>(ceil_n(m_context.input_width, 4)) + ceil_n(m_context.output_width, 4)) * sizeof(float) * 4;
+			return size.get();
+		} catch (const std::overflow_error &) {
+			error::throw_<error::OutOfMemory>();
+		}
+	}
+
+	void process(void *, const graph::ImageBuffer<const void> *src, const graph::ImageBuffer<void> *dst, void *tmp, unsigned i, unsigned, unsigned) const override
+	{
+		const auto &src_buf = graph::static_buffer_cast<const float>(*src);
+		const auto &dst_buf = graph::static_buffer_cast<float>(*dst);
+
+		float *transpose_in = static_cast<float *>(tmp);
+		float *transpose_out = transpose_in + ceil_n(m_context.input_width, 4) * 4;
+		unsigned height = get_image_attributes().height;
+
+		transpose_line_4x4_ps(transpose_in,
+		                      src_buf[std::min(i + 0, height - 1)], src_buf[std::min(i + 1, height - 1)],
+		                      src_buf[std::min(i + 2, height - 1)], src_buf[std::min(i + 3, height - 1)],
+		                      0, ceil_n(m_context.input_width, 4));
+
+		unresize_line4_h_f32_sse(m_context, transpose_in, transpose_out);
+
+		untranspose_line_4x4_ps(dst_buf[std::min(i + 0, height - 1)], dst_buf[std::min(i + 1, height - 1)],
+		                        dst_buf[std::min(i + 2, height - 1)], dst_buf[std::min(i + 3, height - 1)],
+		                        transpose_out, m_context.output_width);
+	}
+};
+
+class UnresizeImplV_F32_SSE final : public UnresizeImplV {
+	void process_columns(const graph::ImageBuffer<const void> &src, const graph::ImageBuffer<void> &, const graph::ImageBuffer<float> &work,
+	                     unsigned left, unsigned right) const override
+	{
+		const auto &src_buf = graph::static_buffer_cast<const float>(src);
+		unsigned height = get_image_attributes().height;
+
+		for (unsigned i = 0; i < height; ++i) {
+			unresize_line_forward_v_f32_sse(m_context, src_buf, work, i, left, right);
+		}
+		for (unsigned i = height; i != 0; --i) {
+			unresize_line_back_v_f32_sse(m_context, work, i, left, right);
+		}
+	}
+public:
+	UnresizeImplV_F32_SSE(const BilinearContext &context, unsigned width, unsigned threads) :
+		UnresizeImplV(context, image_attributes{ width, context.output_width, PixelType::FLOAT }, threads)
+	{}
+};
+
+} // namespace
+
+
+std::unique_ptr<graph::ImageFilter> create_unresize_impl_h_sse(const BilinearContext &context, unsigned height, PixelType src_type, PixelType dst_type, unsigned)
+{
+	std::unique_ptr<graph::ImageFilter> ret;
+
+	if (src_type == PixelType::FLOAT && dst_type == PixelType::FLOAT)
+		ret = ztd::make_unique<UnresizeImplH_F32_SSE>(context, height);
+
+	return ret;
+}
+
+std::unique_ptr<graph::ImageFilter> create_unresize_impl_v_sse(const BilinearContext &context, unsigned width, PixelType src_type, PixelType dst_type, unsigned, unsigned threads)
+{
+	std::unique_ptr<graph::ImageFilter> ret;
+
+	if (src_type == PixelType::FLOAT && dst_type == PixelType::FLOAT)
+		ret = ztd::make_unique<UnresizeImplV_F32_SSE>(context, width, threads);
+
+	return ret;
+}
+
+} // namespace unresize
+} // namespace zimg
+
+#endif // ZIMG_X86
@@ -0,0 +1,70 @@
+#ifdef ZIMG_X86
+
+#include "common/cpuinfo.h"
+#include "common/x86/cpuinfo_x86.h"
+#include "graph/image_filter.h"
+#include "unresize_impl_x86.h"
+
+namespace zimg {
+namespace unresize {
+
+std::unique_ptr<graph::ImageFilter> create_unresize_impl_h_x86(const BilinearContext &context, unsigned height, PixelType src_type, PixelType dst_type, unsigned depth, CPUClass cpu)
+{
+	X86Capabilities caps = query_x86_capabilities();
+	std::unique_ptr<graph::ImageFilter> ret;
+
+	if (cpu_is_autodetect(cpu)) {
+#ifdef ZIMG_X86_AVX512
+		if (!ret && cpu == CPUClass::AUTO_64B && caps.avx512f && caps.avx512dq && caps.avx512bw && caps.avx512vl)
+			ret = create_unresize_impl_h_avx512(context, height, src_type, dst_type, depth);
+#endif
+		if (!ret && caps.avx2)
+			ret = create_unresize_impl_h_avx2(context, height, src_type, dst_type, depth);
+		if (!ret && caps.sse)
+			ret = create_unresize_impl_h_sse(context, height, src_type, dst_type, depth);
+	} else {
+#ifdef ZIMG_X86_AVX512
+		if (!ret && cpu >= CPUClass::X86_AVX512)
+			ret = create_unresize_impl_h_avx512(context, height, src_type, dst_type, depth);
+#endif
+		if (!ret && cpu >= CPUClass::X86_AVX2)
+			ret = create_unresize_impl_h_avx2(context, height, src_type, dst_type, depth);
+		if (!ret && cpu >= CPUClass::X86_SSE)
+			ret = create_unresize_impl_h_sse(context, height, src_type, dst_type, depth);
+	}
+
+	return ret;
+}
+
+std::unique_ptr<graph::ImageFilter> create_unresize_impl_v_x86(const BilinearContext &context, unsigned width, PixelType src_type, PixelType dst_type, unsigned depth, unsigned threads, CPUClass cpu)
+{
+	X86Capabilities caps = query_x86_capabilities();
+	std::unique_ptr<graph::ImageFilter> ret;
+
+	if (cpu_is_autodetect(cpu)) {
+#ifdef ZIMG_X86_AVX512
+		if (!ret && cpu == CPUClass::AUTO_64B && caps.avx512f && caps.avx512dq && caps.avx512bw && caps.avx512vl)
+			ret = create_unresize_impl_v_avx512(context, width, src_type, dst_type, depth, threads);
+#endif
+		if (!ret && caps.avx2)
+			ret = create_unresize_impl_v_avx2(context, width, src_type, dst_type, depth, threads);
+		if (!ret && caps.sse)
+			ret = create_unresize_impl_v_sse(context, width, src_type, dst_type, depth, threads);
+	} else {
+#ifdef ZIMG_X86_AVX512
+		if (!ret && cpu >= CPUClass::X86_AVX512)
+			ret = create_unresize_impl_v_avx512(context, width, src_type, dst_type, depth, threads);
+#endif
+		if (!ret && cpu >= CPUClass::X86_AVX2)
+			ret = create_unresize_impl_v_avx2(context, width, src_type, dst_type, depth, threads);
+		if (!ret && cpu >= CPUClass::X86_SSE)
+			ret = create_unresize_impl_v_sse(context, width, src_type, dst_type, depth, threads);
+	}
+
+	return ret;
+}
+
+} // namespace unresize
+} // namespace zimg
+
+#endif // ZIMG_X86
@@ -1,6 +1,9 @@
 #include <cmath>
 #include <cstddef>
+#include <cstdint>
+#include <cstdlib>
 #include <cstring>
+#include <vector>
 #include "api/zimg.h"
 
 #include "gtest/gtest.h"
@@ -54,3 +57,580 @@ TEST(APITest, test_api_2_1_compat)
 		EXPECT_EQ(0xCC, *(reinterpret_cast<unsigned char *>(&params) + i));
 	}
 }
+
+TEST(APITest, test_api_2_3_compat)
+{
+	const unsigned API_2_3 = ZIMG_MAKE_API_VERSION(2, 3);
+	const size_t extra_off = offsetof(zimg_graph_builder_params, dither_threads);
+	const size_t extra_len = sizeof(zimg_graph_builder_params) - extra_off;
+
+	zimg_graph_builder_params params;
+	std::memset(reinterpret_cast<unsigned char *>(&params) + extra_off, 0xCC, extra_len);
+
+	zimg_graph_builder_params_default(&params, API_2_3);
+	EXPECT_EQ(API_2_3, params.version);
+	for (size_t i = extra_off; i < extra_off + extra_len; ++i) {
+		EXPECT_EQ(0xCC, *(reinterpret_cast<unsigned char *>(&params) + i));
+	}
+}
+
+TEST(APITest, test_graph_stats)
+{
+	zimg_image_format src_format;
+	zimg_image_format_default(&src_format, ZIMG_API_VERSION);
+	src_format.width = 640;
+	src_format.height = 480;
+	src_format.pixel_type = ZIMG_PIXEL_BYTE;
+
+	zimg_image_format dst_format = src_format;
+	dst_format.width = 320;
+	dst_format.height = 240;
+
+	zimg_graph_builder_params params;
+	zimg_graph_builder_params_default(&params, ZIMG_API_VERSION);
+	params.cpu_type = ZIMG_CPU_NONE;
+
+	zimg_filter_graph *graph = zimg_filter_graph_build(&src_format, &dst_format, &params);
+	ASSERT_TRUE(graph);
+
+	unsigned num_nodes = 0;
+	zimg_cpu_type_e cpu_type = ZIMG_CPU_AUTO;
+	EXPECT_EQ(ZIMG_ERROR_SUCCESS, zimg_filter_graph_get_stats(graph, nullptr, &num_nodes, &cpu_type));
+	EXPECT_EQ(ZIMG_CPU_NONE, cpu_type);
+	ASSERT_GT(num_nodes, 0U);
+
+	std::vector<zimg_filter_graph_node_stats> stats(num_nodes);
+	EXPECT_EQ(ZIMG_ERROR_SUCCESS, zimg_filter_graph_get_stats(graph, stats.data(), &num_nodes, nullptr));
+	EXPECT_EQ(stats.size(), num_nodes);
+
+	for (const zimg_filter_graph_node_stats &node : stats) {
+		EXPECT_TRUE(node.name && *node.name);
+		EXPECT_EQ(0U, node.calls);
+	}
+
+	zimg_filter_graph_free(graph);
+}
+
+TEST(APITest, test_graph_dump_plan)
+{
+	zimg_image_format format;
+	zimg_image_format_default(&format, ZIMG_API_VERSION);
+	format.width = 640;
+	format.height = 480;
+	format.pixel_type = ZIMG_PIXEL_BYTE;
+
+	zimg_filter_graph *graph = zimg_filter_graph_build(&format, &format, nullptr);
+	ASSERT_TRUE(graph);
+
+	size_t size = 0;
+	EXPECT_EQ(ZIMG_ERROR_SUCCESS, zimg_filter_graph_dump_plan(graph, ZIMG_GRAPH_PLAN_DOT, nullptr, &size));
+	ASSERT_GT(size, 1U);
+
+	std::vector<char> plan(size, 'x');
+	size_t capacity = size;
+	EXPECT_EQ(ZIMG_ERROR_SUCCESS, zimg_filter_graph_dump_plan(graph, ZIMG_GRAPH_PLAN_DOT, plan.data(), &capacity));
+	EXPECT_EQ(size, capacity);
+	EXPECT_EQ('\0', plan.back());
+	EXPECT_EQ(size - 1, std::strlen(plan.data()));
+
+	// A short buffer receives a truncated, terminated prefix.
+	char prefix[8];
+	capacity = sizeof(prefix);
+	EXPECT_EQ(ZIMG_ERROR_SUCCESS, zimg_filter_graph_dump_plan(graph, ZIMG_GRAPH_PLAN_DOT, prefix, &capacity));
+	EXPECT_EQ(size, capacity);
+	EXPECT_STREQ("digraph", prefix);
+
+	zimg_filter_graph_free(graph);
+}
+
+TEST(APITest, test_graph_stream)
+{
+	const unsigned w = 640;
+	const unsigned h = 480;
+
+	zimg_image_format src_format;
+	zimg_image_format_default(&src_format, ZIMG_API_VERSION);
+	src_format.width = w;
+	src_format.height = h;
+	src_format.pixel_type = ZIMG_PIXEL_BYTE;
+	src_format.color_family = ZIMG_COLOR_YUV;
+	src_format.subsample_w = 1;
+	src_format.subsample_h = 1;
+
+	zimg_image_format dst_format = src_format;
+	dst_format.width = w / 2;
+	dst_format.height = h * 3 / 4;
+
+	zimg_graph_builder_params params;
+	zimg_graph_builder_params_default(&params, ZIMG_API_VERSION);
+	params.resample_filter = ZIMG_RESIZE_LANCZOS;
+	params.cpu_type = ZIMG_CPU_NONE;
+
+	zimg_filter_graph *graph = zimg_filter_graph_build(&src_format, &dst_format, &params);
+	ASSERT_TRUE(graph);
+
+	unsigned input_lines = 0;
+	unsigned output_lines = 0;
+	size_t tmp_size = 0;
+	ASSERT_EQ(ZIMG_ERROR_SUCCESS, zimg_filter_graph_get_stream_input_buffering(graph, &input_lines));
+	ASSERT_EQ(ZIMG_ERROR_SUCCESS, zimg_filter_graph_get_output_buffering(graph, &output_lines));
+	ASSERT_EQ(ZIMG_ERROR_SUCCESS, zimg_filter_graph_get_tmp_size(graph, &tmp_size));
+	ASSERT_LT(input_lines, h);
+
+	const ptrdiff_t stride = 1024;
+	const size_t plane_size[3] = { stride * h, stride * h / 2, stride * h / 2 };
+	const unsigned input_mask = zimg_select_buffer_mask(input_lines);
+	const unsigned output_mask = zimg_select_buffer_mask(output_lines);
+
+	std::vector<unsigned char> src_image[3];
+	std::vector<unsigned char> ref_image[3];
+	std::vector<unsigned char> out_image[3];
+	std::vector<unsigned char> src_ring[3];
+	std::vector<unsigned char> dst_ring[3];
+	std::vector<unsigned char> tmp(tmp_size + 64);
+
+	zimg_image_buffer_const src_buf = { ZIMG_API_VERSION };
+	zimg_image_buffer ref_buf = { ZIMG_API_VERSION };
+	zimg_image_buffer_const ring_in = { ZIMG_API_VERSION };
+	zimg_image_buffer ring_out = { ZIMG_API_VERSION };
+
+	auto align = [](std::vector<unsigned char> &v) { return v.data() + (64 - reinterpret_cast<uintptr_t>(v.data()) % 64) % 64; };
+
+	for (unsigned p = 0; p < 3; ++p) {
+		src_image[p].resize(plane_size[p] + 64);
+		ref_image[p].resize(plane_size[p] + 64);
+		out_image[p].resize(plane_size[p]);
+		src_ring[p].resize(stride * (input_mask + 1) + 64);
+		dst_ring[p].resize(stride * (output_mask + 1) + 64);
+
+		unsigned char *src_data = align(src_image[p]);
+		for (size_t i = 0; i < plane_size[p]; ++i) {
+			src_data[i] = static_cast<unsigned char>(i * 7 + p * 13 + (i / stride) * 3);
+		}
+
+		src_buf.plane[p] = { src_data, stride, ZIMG_BUFFER_MAX };
+		ref_buf.plane[p] = { align(ref_image[p]), stride, ZIMG_BUFFER_MAX };
+		ring_in.plane[p] = { align(src_ring[p]), stride, p ? input_mask >> 1 : input_mask };
+		ring_out.plane[p] = { align(dst_ring[p]), stride, p ? output_mask >> 1 : output_mask };
+	}
+
+	ASSERT_EQ(ZIMG_ERROR_SUCCESS, zimg_filter_graph_process(graph, &src_buf, &ref_buf, align(tmp), nullptr, nullptr, nullptr, nullptr));
+
+	zimg_filter_graph_stream *stream = zimg_filter_graph_stream_begin(graph, &ring_in, &ring_out, 0);
+	ASSERT_TRUE(stream);
+
+	// Feed the image one row pair at a time, as a decoder would.
+	unsigned rows_pulled = 0;
+	for (unsigned i = 0; i < h; i += 2) {
+		for (unsigned p = 0; p < 3; ++p) {
+			for (unsigned ii = p ? i / 2 : i; ii < (p ? i / 2 + 1 : i + 2); ++ii) {
+				const unsigned char *src_row = static_cast<const unsigned char *>(src_buf.plane[p].data) + ii * stride;
+				unsigned char *ring_row = static_cast<unsigned char *>(const_cast<void *>(ring_in.plane[p].data)) + (ii & ring_in.plane[p].mask) * stride;
+				std::memcpy(ring_row, src_row, stride);
+			}
+		}
+		ASSERT_EQ(ZIMG_ERROR_SUCCESS, zimg_filter_graph_stream_push_rows(stream, 2));
+
+		unsigned first;
+		unsigned count;
+		while (true) {
+			ASSERT_EQ(ZIMG_ERROR_SUCCESS, zimg_filter_graph_stream_pull_rows(stream, &first, &count));
+			if (!count)
+				break;
+
+			EXPECT_EQ(rows_pulled, first);
+			for (unsigned p = 0; p < 3; ++p) {
+				for (unsigned ii = p ? first / 2 : first; ii < (p ? (first + count) / 2 : first + count); ++ii) {
+					const unsigned char *ring_row = static_cast<const unsigned char *>(ring_out.plane[p].data) + (ii & ring_out.plane[p].mask) * stride;
+					std::memcpy(out_image[p].data() + ii * stride, ring_row, stride);
+				}
+			}
+			rows_pulled += count;
+		}
+	}
+	EXPECT_EQ(dst_format.height, rows_pulled);
+	EXPECT_EQ(ZIMG_ERROR_ILLEGAL_ARGUMENT, zimg_filter_graph_stream_push_rows(stream, 2));
+	zimg_filter_graph_stream_end(stream);
+
+	for (unsigned p = 0; p < 3; ++p) {
+		unsigned width = p ? dst_format.width / 2 : dst_format.width;
+		unsigned height = p ? dst_format.height / 2 : dst_format.height;
+
+		for (unsigned i = 0; i < height; ++i) {
+			const unsigned char *ref_row = static_cast<const unsigned char *>(ref_buf.plane[p].data) + i * stride;
+			ASSERT_EQ(0, std::memcmp(ref_row, out_image[p].data() + i * stride, width)) << "plane " << p << " row " << i;
+		}
+	}
+
+	zimg_filter_graph_free(graph);
+}
+
+TEST(APITest, test_graph_async_io)
+{
+	const unsigned w = 640;
+	const unsigned h = 480;
+	const ptrdiff_t stride = 1024;
+
+	zimg_image_format src_format;
+	zimg_image_format_default(&src_format, ZIMG_API_VERSION);
+	src_format.width = w;
+	src_format.height = h;
+	src_format.pixel_type = ZIMG_PIXEL_BYTE;
+
+	zimg_image_format dst_format = src_format;
+	dst_format.width = w / 2;
+	dst_format.height = h * 3 / 4;
+
+	zimg_graph_builder_params params;
+	zimg_graph_builder_params_default(&params, ZIMG_API_VERSION);
+	params.resample_filter = ZIMG_RESIZE_LANCZOS;
+	params.cpu_type = ZIMG_CPU_NONE;
+
+	zimg_filter_graph *graph = zimg_filter_graph_build(&src_format, &dst_format, &params);
+	ASSERT_TRUE(graph);
+
+	struct io_data {
+		const unsigned char *src;
+		unsigned char *dst;
+		unsigned char *ring;
+		unsigned mask;
+	};
+
+	auto unpack = [](void *user, unsigned i, unsigned left, unsigned right) -> int
+	{
+		io_data *io = static_cast<io_data *>(user);
+		std::memcpy(io->ring + (i & io->mask) * stride + left, io->src + i * stride + left, right - left);
+		return 0;
+	};
+	auto pack = [](void *user, unsigned i, unsigned left, unsigned right) -> int
+	{
+		io_data *io = static_cast<io_data *>(user);
+		std::memcpy(io->dst + i * stride + left, io->ring + (i & io->mask) * stride + left, right - left);
+		return 0;
+	};
+
+	std::vector<unsigned char> src_image(stride * h + 64);
+	std::vector<unsigned char> ref_image(stride * h + 64);
+	std::vector<unsigned char> out_image(stride * h + 64);
+	std::vector<unsigned char> src_ring(stride * h + 64);
+	std::vector<unsigned char> dst_ring(stride * h + 64);
+
+	auto align = [](std::vector<unsigned char> &v) { return v.data() + (64 - reinterpret_cast<uintptr_t>(v.data()) % 64) % 64; };
+
+	for (unsigned i = 0; i < h; ++i) {
+		for (unsigned j = 0; j < w; ++j) {
+			align(src_image)[i * stride + j] = static_cast<unsigned char>(i * 7 + j * 3 + (i * j) % 11);
+		}
+	}
+
+	size_t tmp_size = 0;
+	ASSERT_EQ(ZIMG_ERROR_SUCCESS, zimg_filter_graph_get_tmp_size(graph, &tmp_size));
+	std::vector<unsigned char> tmp(tmp_size + 64);
+
+	zimg_image_buffer_const src_buf = { ZIMG_API_VERSION, { { align(src_image), stride, ZIMG_BUFFER_MAX } } };
+	zimg_image_buffer ref_buf = { ZIMG_API_VERSION, { { align(ref_image), stride, ZIMG_BUFFER_MAX } } };
+	ASSERT_EQ(ZIMG_ERROR_SUCCESS, zimg_filter_graph_process(graph, &src_buf, &ref_buf, align(tmp), nullptr, nullptr, nullptr, nullptr));
+
+	unsigned input_lines = 0;
+	unsigned output_lines = 0;
+	ASSERT_EQ(ZIMG_ERROR_SUCCESS, zimg_filter_graph_get_input_buffering(graph, &input_lines));
+	ASSERT_EQ(ZIMG_ERROR_SUCCESS, zimg_filter_graph_get_output_buffering(graph, &output_lines));
+
+	ASSERT_EQ(ZIMG_ERROR_SUCCESS, zimg_filter_graph_set_async_io(graph, 32, 8));
+
+	unsigned async_input_lines = 0;
+	unsigned async_output_lines = 0;
+	ASSERT_EQ(ZIMG_ERROR_SUCCESS, zimg_filter_graph_get_input_buffering(graph, &async_input_lines));
+	ASSERT_EQ(ZIMG_ERROR_SUCCESS, zimg_filter_graph_get_output_buffering(graph, &async_output_lines));
+	EXPECT_GE(async_input_lines, input_lines + 32);
+	EXPECT_GE(async_output_lines, output_lines + 8);
+
+	// Both the requested buffering and the minimum buffering produce the same result.
+	for (unsigned n = 0; n < 2; ++n) {
+		SCOPED_TRACE(n);
+
+		io_data unpack_data = { align(src_image), nullptr, align(src_ring), zimg_select_buffer_mask(n ? input_lines : async_input_lines) };
+		io_data pack_data = { nullptr, align(out_image), align(dst_ring), zimg_select_buffer_mask(n ? output_lines : async_output_lines) };
+
+		zimg_image_buffer_const ring_in = { ZIMG_API_VERSION, { { unpack_data.ring, stride, unpack_data.mask } } };
+		zimg_image_buffer ring_out = { ZIMG_API_VERSION, { { pack_data.ring, stride, pack_data.mask } } };
+
+		std::fill(out_image.begin(), out_image.end(), 0);
+		ASSERT_EQ(ZIMG_ERROR_SUCCESS, zimg_filter_graph_process(graph, &ring_in, &ring_out, align(tmp), unpack, &unpack_data, pack, &pack_data));
+
+		for (unsigned i = 0; i < dst_format.height; ++i) {
+			ASSERT_EQ(0, std::memcmp(align(ref_image) + i * stride, align(out_image) + i * stride, dst_format.width)) << "row " << i;
+		}
+	}
+
+	zimg_filter_graph_free(graph);
+}
+
+TEST(APITest, test_graph_process_batch)
+{
+	const unsigned w = 640;
+	const unsigned h = 480;
+	const ptrdiff_t stride = 1024;
+
+	zimg_image_format src_format;
+	zimg_image_format_default(&src_format, ZIMG_API_VERSION);
+	src_format.width = w;
+	src_format.height = h;
+	src_format.pixel_type = ZIMG_PIXEL_BYTE;
+
+	zimg_image_format dst_format = src_format;
+	dst_format.width = w / 2;
+	dst_format.height = h * 3 / 4;
+
+	zimg_graph_builder_params params;
+	zimg_graph_builder_params_default(&params, ZIMG_API_VERSION);
+	params.resample_filter = ZIMG_RESIZE_LANCZOS;
+	params.cpu_type = ZIMG_CPU_NONE;
+
+	zimg_filter_graph *graph = zimg_filter_graph_build(&src_format, &dst_format, &params);
+	ASSERT_TRUE(graph);
+
+	struct io_data {
+		const unsigned char *src;
+		unsigned char *dst;
+		unsigned char *ring;
+		unsigned mask;
+		unsigned calls;
+	};
+
+	auto unpack = [](void *user, unsigned i, unsigned count, unsigned left, unsigned right) -> int
+	{
+		io_data *io = static_cast<io_data *>(user);
+		for (unsigned ii = i; ii < i + count; ++ii) {
+			std::memcpy(io->ring + (ii & io->mask) * stride + left, io->src + ii * stride + left, right - left);
+		}
+		++io->calls;
+		return 0;
+	};
+	auto pack = [](void *user, unsigned i, unsigned count, unsigned left, unsigned right) -> int
+	{
+		io_data *io = static_cast<io_data *>(user);
+		for (unsigned ii = i; ii < i + count; ++ii) {
+			std::memcpy(io->dst + ii * stride + left, io->ring + (ii & io->mask) * stride + left, right - left);
+		}
+		++io->calls;
+		return 0;
+	};
+
+	std::vector<unsigned char> src_image(stride * h + 64);
+	std::vector<unsigned char> ref_image(stride * h + 64);
+	std::vector<unsigned char> out_image(stride * h + 64);
+	std::vector<unsigned char> src_ring(stride * h + 64);
+	std::vector<unsigned char> dst_ring(stride * h + 64);
+
+	auto align = [](std::vector<unsigned char> &v) { return v.data() + (64 - reinterpret_cast<uintptr_t>(v.data()) % 64) % 64; };
+
+	for (unsigned i = 0; i < h; ++i) {
+		for (unsigned j = 0; j < w; ++j) {
+			align(src_image)[i * stride + j] = static_cast<unsigned char>(i * 7 + j * 3 + (i * j) % 11);
+		}
+	}
+
+	size_t tmp_size = 0;
+	ASSERT_EQ(ZIMG_ERROR_SUCCESS, zimg_filter_graph_get_tmp_size(graph, &tmp_size));
+	std::vector<unsigned char> tmp(tmp_size + 64);
+
+	zimg_image_buffer_const src_buf = { ZIMG_API_VERSION, { { align(src_image), stride, ZIMG_BUFFER_MAX } } };
+	zimg_image_buffer ref_buf = { ZIMG_API_VERSION, { { align(ref_image), stride, ZIMG_BUFFER_MAX } } };
+	ASSERT_EQ(ZIMG_ERROR_SUCCESS, zimg_filter_graph_process(graph, &src_buf, &ref_buf, align(tmp), nullptr, nullptr, nullptr, nullptr));
+
+	unsigned input_lines = 0;
+	unsigned output_lines = 0;
+	ASSERT_EQ(ZIMG_ERROR_SUCCESS, zimg_filter_graph_set_callback_batch(graph, 32, 0));
+	ASSERT_EQ(ZIMG_ERROR_SUCCESS, zimg_filter_graph_get_input_buffering(graph, &input_lines));
+	ASSERT_EQ(ZIMG_ERROR_SUCCESS, zimg_filter_graph_get_output_buffering(graph, &output_lines));
+
+	io_data unpack_data = { align(src_image), nullptr, align(src_ring), zimg_select_buffer_mask(input_lines), 0 };
+	io_data pack_data = { nullptr, align(out_image), align(dst_ring), zimg_select_buffer_mask(output_lines), 0 };
+
+	zimg_image_buffer_const ring_in = { ZIMG_API_VERSION, { { unpack_data.ring, stride, unpack_data.mask } } };
+	zimg_image_buffer ring_out = { ZIMG_API_VERSION, { { pack_data.ring, stride, pack_data.mask } } };
+
+	ASSERT_EQ(ZIMG_ERROR_SUCCESS, zimg_filter_graph_process_batch(graph, &ring_in, &ring_out, align(tmp), unpack, &unpack_data, pack, &pack_data, 0));
+	EXPECT_EQ(h / 32, unpack_data.calls);
+	EXPECT_EQ((dst_format.height + 31) / 32, pack_data.calls);
+
+	for (unsigned i = 0; i < dst_format.height; ++i) {
+		ASSERT_EQ(0, std::memcmp(align(ref_image) + i * stride, align(out_image) + i * stride, dst_format.width)) << "row " << i;
+	}
+
+	zimg_filter_graph_free(graph);
+}
+
+TEST(APITest, test_scratch_pool)
+{
+	zimg_image_format src_format;
+	zimg_image_format_default(&src_format, ZIMG_API_VERSION);
+	src_format.width = 640;
+	src_format.height = 480;
+	src_format.pixel_type = ZIMG_PIXEL_BYTE;
+
+	zimg_image_format dst_format = src_format;
+	dst_format.width = 320;
+	dst_format.height = 240;
+
+	zimg_filter_graph *graph1 = zimg_filter_graph_build(&src_format, &dst_format, nullptr);
+	ASSERT_TRUE(graph1);
+
+	dst_format.width = 480;
+	dst_format.height = 360;
+	zimg_filter_graph *graph2 = zimg_filter_graph_build(&src_format, &dst_format, nullptr);
+	ASSERT_TRUE(graph2);
+
+	const ptrdiff_t stride = 1024;
+	std::vector<unsigned char> src_image(stride * 480 + 64);
+	std::vector<unsigned char> dst_image(stride * 480 + 64);
+	auto align = [](std::vector<unsigned char> &v) { return v.data() + (64 - reinterpret_cast<uintptr_t>(v.data()) % 64) % 64; };
+
+	zimg_image_buffer_const src_buf = { ZIMG_API_VERSION, { { align(src_image), stride, ZIMG_BUFFER_MAX } } };
+	zimg_image_buffer dst_buf = { ZIMG_API_VERSION, { { align(dst_image), stride, ZIMG_BUFFER_MAX } } };
+
+	size_t tmp_size = 0;
+	ASSERT_EQ(ZIMG_ERROR_SUCCESS, zimg_filter_graph_get_tmp_size(graph1, &tmp_size));
+	ASSERT_EQ(ZIMG_ERROR_SUCCESS, zimg_scratch_pool_trim());
+
+	size_t allocated_before = 0;
+	ASSERT_EQ(ZIMG_ERROR_SUCCESS, zimg_scratch_pool_get_usage(&allocated_before, nullptr, 1));
+
+	// The buffer drawn by the first call is reused by later calls.
+	size_t allocated = 0;
+	ASSERT_EQ(ZIMG_ERROR_SUCCESS, zimg_filter_graph_process(graph1, &src_buf, &dst_buf, nullptr, nullptr, nullptr, nullptr, nullptr));
+	ASSERT_EQ(ZIMG_ERROR_SUCCESS, zimg_scratch_pool_get_usage(&allocated, nullptr, 0));
+	EXPECT_GE(allocated, allocated_before + tmp_size);
+
+	size_t allocated_after = 0;
+	size_t high_water = 0;
+	ASSERT_EQ(ZIMG_ERROR_SUCCESS, zimg_filter_graph_process(graph1, &src_buf, &dst_buf, nullptr, nullptr, nullptr, nullptr, nullptr));
+	ASSERT_EQ(ZIMG_ERROR_SUCCESS, zimg_filter_graph_process(graph2, &src_buf, &dst_buf, nullptr, nullptr, nullptr, nullptr, nullptr));
+	ASSERT_EQ(ZIMG_ERROR_SUCCESS, zimg_scratch_pool_get_usage(&allocated_after, &high_water, 0));
+	EXPECT_GE(high_water, allocated_after);
+	EXPECT_GE(allocated_after, allocated);
+
+	ASSERT_EQ(ZIMG_ERROR_SUCCESS, zimg_scratch_pool_trim());
+	ASSERT_EQ(ZIMG_ERROR_SUCCESS, zimg_scratch_pool_get_usage(&allocated_after, nullptr, 0));
+	EXPECT_EQ(allocated_before, allocated_after);
+
+	zimg_filter_graph_free(graph1);
+	zimg_filter_graph_free(graph2);
+}
+
+TEST(APITest, test_allocator)
+{
+	struct counter {
+		size_t calls;
+		size_t outstanding;
+	};
+
+	auto alloc = [](void *user, size_t size, size_t alignment) -> void *
+	{
+		counter *c = static_cast<counter *>(user);
+
+		// Store the original pointer before the aligned block.
+		EXPECT_EQ(0U, alignment & (alignment - 1));
+		char *base = static_cast<char *>(std::malloc(size + alignment + sizeof(void *)));
+		if (!base)
+			return nullptr;
+
+		uintptr_t addr = reinterpret_cast<uintptr_t>(base) + sizeof(void *);
+		char *ptr = base + sizeof(void *) + (alignment - addr % alignment) % alignment;
+		std::memcpy(ptr - sizeof(void *), &base, sizeof(void *));
+
+		++c->calls;
+		c->outstanding += size;
+		return ptr;
+	};
+	auto free = [](void *user, void *ptr, size_t size)
+	{
+		counter *c = static_cast<counter *>(user);
+		c->outstanding -= size;
+
+		void *base;
+		std::memcpy(&base, static_cast<char *>(ptr) - sizeof(void *), sizeof(void *));
+		std::free(base);
+	};
+
+	zimg_image_format src_format;
+	zimg_image_format_default(&src_format, ZIMG_API_VERSION);
+	src_format.width = 640;
+	src_format.height = 480;
+	src_format.pixel_type = ZIMG_PIXEL_BYTE;
+
+	zimg_image_format dst_format = src_format;
+	dst_format.width = 320;
+	dst_format.height = 240;
+	dst_format.pixel_type = ZIMG_PIXEL_FLOAT;
+
+	zimg_graph_builder_params params;
+	zimg_graph_builder_params_default(&params, ZIMG_API_VERSION);
+	EXPECT_EQ(nullptr, params.allocator);
+
+	counter global_counter = {};
+	counter graph_counter = {};
+	zimg_allocator global_allocator = { alloc, free, &global_counter };
+	zimg_allocator graph_allocator = { alloc, free, &graph_counter };
+
+	ASSERT_EQ(ZIMG_ERROR_SUCCESS, zimg_set_allocator(&global_allocator));
+
+	// The global allocator is used by default.
+	zimg_filter_graph *graph1 = zimg_filter_graph_build(&src_format, &dst_format, &params);
+	ASSERT_TRUE(graph1);
+	EXPECT_NE(0U, global_counter.calls);
+	EXPECT_NE(0U, global_counter.outstanding);
+
+	// An allocator passed to the builder takes precedence.
+	size_t global_calls = global_counter.calls;
+	params.allocator = &graph_allocator;
+	zimg_filter_graph *graph2 = zimg_filter_graph_build(&src_format, &dst_format, &params);
+	ASSERT_TRUE(graph2);
+	EXPECT_EQ(global_calls, global_counter.calls);
+	EXPECT_NE(0U, graph_counter.calls);
+
+	// The graph and filter objects are also drawn from the allocator, even
+	// when no filter owns a table.
+	size_t graph_calls = graph_counter.calls;
+	zimg_filter_graph *graph3 = zimg_filter_graph_build(&src_format, &src_format, &params);
+	ASSERT_TRUE(graph3);
+	EXPECT_EQ(global_calls, global_counter.calls);
+	EXPECT_LT(graph_calls, graph_counter.calls);
+
+	// Objects created after the build are drawn from the allocator of the graph.
+	std::vector<unsigned char> src_plane(640 * 480 + 64);
+	std::vector<unsigned char> dst_plane(640 * 480 + 64);
+	auto align = [](std::vector<unsigned char> &v) { return v.data() + (64 - reinterpret_cast<uintptr_t>(v.data()) % 64) % 64; };
+
+	zimg_image_buffer_const src_buf = { ZIMG_API_VERSION };
+	zimg_image_buffer dst_buf = { ZIMG_API_VERSION };
+	src_buf.plane[0] = { align(src_plane), 640, ZIMG_BUFFER_MAX };
+	dst_buf.plane[0] = { align(dst_plane), 640, ZIMG_BUFFER_MAX };
+
+	graph_calls = graph_counter.calls;
+	ASSERT_EQ(ZIMG_ERROR_SUCCESS, zimg_filter_graph_set_trace_capacity(graph3, 1024));
+	EXPECT_LT(graph_calls, graph_counter.calls);
+
+	graph_calls = graph_counter.calls;
+	zimg_filter_graph_stream *stream = zimg_filter_graph_stream_begin(graph3, &src_buf, &dst_buf, 0);
+	ASSERT_TRUE(stream);
+	EXPECT_LT(graph_calls, graph_counter.calls);
+	EXPECT_EQ(global_calls, global_counter.calls);
+
+	zimg_filter_graph_stream_end(stream);
+	zimg_filter_graph_free(graph3);
+
+	// Memory is returned to its allocator after the global allocator changes.
+	ASSERT_EQ(ZIMG_ERROR_SUCCESS, zimg_set_allocator(nullptr));
+	zimg_filter_graph_free(graph1);
+	zimg_filter_graph_free(graph2);
+	EXPECT_EQ(0U, global_counter.outstanding);
+	EXPECT_EQ(0U, graph_counter.outstanding);
+
+	zimg_allocator bad_allocator = { alloc, nullptr, nullptr };
+	EXPECT_EQ(ZIMG_ERROR_ILLEGAL_ARGUMENT, zimg_set_allocator(&bad_allocator));
+	params.allocator = &bad_allocator;
+	EXPECT_FALSE(zimg_filter_graph_build(&src_format, &dst_format, &params));
+	zimg_clear_last_error();
+}
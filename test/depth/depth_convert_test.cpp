@@ -1,6 +1,14 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include "common/alloc.h"
+#include "common/cpuinfo.h"
 #include "common/pixel.h"
+#include "graph/image_buffer.h"
 #include "graph/image_filter.h"
 #include "depth/depth.h"
+#include "depth/depth_convert.h"
+#include "depth/quantize.h"
 
 #include "gtest/gtest.h"
 #include "graph/filter_validator.h"
@@ -39,9 +47,102 @@ void test_case(bool fullrange, bool chroma, bool ycgco, const char *(*expected_s
 	}
 }
 
+template <class T, class U>
+void test_case_integer_exact(const zimg::PixelFormat &pixel_in, const zimg::PixelFormat &pixel_out)
+{
+	const unsigned w = 1U << pixel_in.depth;
+
+	SCOPED_TRACE(pixel_in.depth);
+	SCOPED_TRACE(pixel_in.fullrange);
+	SCOPED_TRACE(pixel_in.chroma);
+	SCOPED_TRACE(pixel_out.depth);
+	SCOPED_TRACE(pixel_out.fullrange);
+
+	auto convert = zimg::depth::create_integer_convert(w, 1, pixel_in, pixel_out, zimg::CPUClass::NONE);
+
+	zimg::AlignedVector<T> src(w);
+	zimg::AlignedVector<U> dst(w);
+
+	for (unsigned x = 0; x < w; ++x) {
+		src[x] = static_cast<T>(x);
+	}
+
+	zimg::graph::ImageBuffer<const void> src_buf{ src.data(), 0, zimg::graph::BUFFER_MAX };
+	zimg::graph::ImageBuffer<void> dst_buf{ dst.data(), 0, zimg::graph::BUFFER_MAX };
+	convert->process(nullptr, &src_buf, &dst_buf, nullptr, 0, 0, w);
+
+	int64_t range_in = zimg::depth::integer_range(pixel_in);
+	int64_t range_out = zimg::depth::integer_range(pixel_out);
+	int64_t num = static_cast<int64_t>(zimg::depth::integer_offset(pixel_out)) * range_in - static_cast<int64_t>(zimg::depth::integer_offset(pixel_in)) * range_out;
+
+	for (unsigned x = 0; x < w; ++x) {
+		// Round half to even: floor((x * range_out + num) / range_in + 1/2), less one for odd ties.
+		int64_t y2 = 2 * (x * range_out + num) + range_in;
+		int64_t y = y2 < 0 ? -1 : y2 / (2 * range_in);
+		if (y2 >= 0 && y2 % (2 * range_in) == 0 && y % 2)
+			--y;
+		y = std::min(std::max(y, static_cast<int64_t>(0)), static_cast<int64_t>(zimg::depth::numeric_max(pixel_out.depth)));
+
+		ASSERT_EQ(y, dst[x]) << "mismatch at value: " << x;
+	}
+}
+
 } // namespace
 
 
+TEST(DepthConvertTest, test_integer_exact)
+{
+	const zimg::PixelType BYTE = zimg::PixelType::BYTE;
+	const zimg::PixelType WORD = zimg::PixelType::WORD;
+
+	test_case_integer_exact<uint16_t, uint8_t>({ WORD, 10, false, false }, { BYTE, 8, true, false });
+	test_case_integer_exact<uint16_t, uint8_t>({ WORD, 10, false, true }, { BYTE, 8, true, true });
+	test_case_integer_exact<uint16_t, uint8_t>({ WORD, 10, false, false }, { BYTE, 8, false, false });
+	test_case_integer_exact<uint8_t, uint16_t>({ BYTE, 8, false, false }, { WORD, 16, true, false });
+	test_case_integer_exact<uint8_t, uint16_t>({ BYTE, 8, false, true }, { WORD, 16, true, true });
+	test_case_integer_exact<uint8_t, uint8_t>({ BYTE, 8, true, false }, { BYTE, 8, false, false });
+	test_case_integer_exact<uint8_t, uint8_t>({ BYTE, 8, false, false }, { BYTE, 8, true, false });
+	test_case_integer_exact<uint16_t, uint16_t>({ WORD, 16, false, false }, { WORD, 16, true, false });
+	test_case_integer_exact<uint16_t, uint16_t>({ WORD, 16, true, false }, { WORD, 16, false, false });
+	test_case_integer_exact<uint16_t, uint16_t>({ WORD, 16, true, true }, { WORD, 10, false, true });
+	test_case_integer_exact<uint16_t, uint16_t>({ WORD, 12, false, false }, { WORD, 10, true, false });
+	test_case_integer_exact<uint16_t, uint8_t>({ WORD, 16, true, false }, { BYTE, 1, true, false });
+	test_case_integer_exact<uint16_t, uint8_t>({ WORD, 10, false, false }, { BYTE, 8, false, false });
+	test_case_integer_exact<uint16_t, uint8_t>({ WORD, 12, false, true }, { BYTE, 8, false, true });
+	test_case_integer_exact<uint16_t, uint16_t>({ WORD, 16, false, false }, { WORD, 10, false, false });
+}
+
+TEST(DepthConvertTest, test_integer_round_half_even)
+{
+	const zimg::PixelFormat pixel_in{ zimg::PixelType::WORD, 10, false, false };
+	const zimg::PixelFormat pixel_out{ zimg::PixelType::BYTE, 8, false, false };
+	const unsigned w = 1024;
+
+	auto convert = zimg::depth::create_integer_convert(w, 1, pixel_in, pixel_out, zimg::CPUClass::NONE);
+
+	zimg::AlignedVector<uint16_t> src(w);
+	zimg::AlignedVector<uint8_t> dst(w);
+
+	for (unsigned x = 0; x < w; ++x) {
+		src[x] = static_cast<uint16_t>(x);
+	}
+
+	zimg::graph::ImageBuffer<const void> src_buf{ src.data(), 0, zimg::graph::BUFFER_MAX };
+	zimg::graph::ImageBuffer<void> dst_buf{ dst.data(), 0, zimg::graph::BUFFER_MAX };
+	convert->process(nullptr, &src_buf, &dst_buf, nullptr, 0, 0, w);
+
+	// Limited range 10-bit to 8-bit is a division by 4, with ties at x % 4 == 2.
+	EXPECT_EQ(16, dst[66]);
+	EXPECT_EQ(18, dst[70]);
+	EXPECT_EQ(18, dst[74]);
+	EXPECT_EQ(20, dst[78]);
+
+	// Same result as the floating point conversion followed by lrint.
+	for (unsigned x = 0; x < w; ++x) {
+		ASSERT_EQ(std::min(std::lrint(x * 0.25f), 255L), dst[x]) << "mismatch at value: " << x;
+	}
+}
+
 TEST(DepthConvertTest, test_limited_luma)
 {
 	const char *expected_sha1[][3] = {
@@ -1,5 +1,10 @@
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+#include "common/alloc.h"
 #include "common/cpuinfo.h"
 #include "common/pixel.h"
+#include "graph/image_buffer.h"
 #include "graph/image_filter.h"
 #include "depth/depth.h"
 #include "depth/dither.h"
@@ -9,7 +14,7 @@
 
 namespace {
 
-void test_case(zimg::depth::DitherType type, bool fullrange, bool chroma, const char *(*expected_sha1)[3])
+void test_case(zimg::depth::DitherType type, bool fullrange, bool chroma, const char *(*expected_sha1)[3], unsigned threads = 1)
 {
 	const unsigned w = 640;
 	const unsigned h = 480;
@@ -31,7 +36,7 @@ void test_case(zimg::depth::DitherType type, bool fullrange, bool chroma, const
 			fmt_out.fullrange = fullrange;
 			fmt_out.chroma = chroma;
 
-			auto dither = zimg::depth::create_dither(type, w, h, fmt_in, fmt_out, zimg::CPUClass::NONE);
+			auto dither = zimg::depth::create_dither(type, w, h, fmt_in, fmt_out, zimg::CPUClass::NONE, threads);
 
 			FilterValidator validator{ dither.get(), w, h, fmt_in };
 			validator.set_sha1(expected_sha1[sha1_idx++]);
@@ -40,9 +45,53 @@ void test_case(zimg::depth::DitherType type, bool fullrange, bool chroma, const
 	}
 }
 
+std::vector<uint8_t> random_dither_frame(const zimg::graph::ImageFilter *filter, const zimg::AlignedVector<float> &src, unsigned w, unsigned h,
+                                         unsigned seed, unsigned tile_width)
+{
+	zimg::AlignedVector<uint8_t> dst(static_cast<size_t>(w) * h);
+	zimg::AlignedVector<char> ctx(filter->get_context_size());
+	zimg::AlignedVector<char> tmp(filter->get_tmp_size(0, w));
+
+	zimg::graph::ImageBuffer<const void> src_buf{ src.data(), static_cast<ptrdiff_t>(w * sizeof(float)), zimg::graph::BUFFER_MAX };
+	zimg::graph::ImageBuffer<void> dst_buf{ dst.data(), static_cast<ptrdiff_t>(w), zimg::graph::BUFFER_MAX };
+
+	for (unsigned left = 0; left < w; left += tile_width) {
+		unsigned right = std::min(left + tile_width, w);
+
+		filter->init_context(ctx.data(), seed);
+
+		for (unsigned i = 0; i < h; ++i) {
+			filter->process(ctx.data(), &src_buf, &dst_buf, tmp.data(), i, left, right);
+		}
+	}
+
+	return{ dst.begin(), dst.end() };
+}
+
 } // namespace
 
 
+TEST(DitherTest, test_random_dither_seed)
+{
+	const unsigned w = 640;
+	const unsigned h = 16;
+
+	zimg::PixelFormat fmt_in{ zimg::PixelType::FLOAT, 32, true, false };
+	zimg::PixelFormat fmt_out{ zimg::PixelType::BYTE, 8, true, false };
+	auto dither = zimg::depth::create_dither(zimg::depth::DitherType::RANDOM, w, h, fmt_in, fmt_out, zimg::CPUClass::NONE);
+
+	zimg::AlignedVector<float> src(static_cast<size_t>(w) * h, 0.5f / 255.0f);
+
+	auto frame0 = random_dither_frame(dither.get(), src, w, h, 0, w);
+	auto frame1 = random_dither_frame(dither.get(), src, w, h, 1, w);
+
+	// The noise depends only on the seed and pixel position.
+	EXPECT_EQ(frame0, random_dither_frame(dither.get(), src, w, h, 0, w));
+	EXPECT_EQ(frame1, random_dither_frame(dither.get(), src, w, h, 1, 80));
+	EXPECT_EQ(frame1, random_dither_frame(dither.get(), src, w, h, 1, 176));
+	EXPECT_NE(frame0, frame1);
+}
+
 TEST(DitherTest, test_limited_luma)
 {
 	const char *expected_sha1[][3] = {
@@ -139,22 +188,41 @@ TEST(DitherTest, test_bayer_dither)
 }
 
 TEST(DitherTest, test_random_dither)
+{
+	const char *expected_sha1[][3] = {
+		{ "a4390d36d154379aaf5a7b830396a077da52a8e2" },
+		{ "ad2489c439e55b21f563cc210544bd6cbecfe5d0" },
+
+		{ "4b801c39878f0511348e44862dcab55d4f0960f9" },
+		{ "1f0ad94cd8a017b8f3d21bb66e55bd2898bd78d7" },
+
+		{ "de5091d4e9f2021b12d052ca66ccd9a249018afd" },
+		{ "b66245d8078d5440263da9d76bc340d023b9a1fa" },
+
+		{ "6aebb6e8b3cb7c89d766b05bf94238c4b45233ef" },
+		{ "f1f663c7a9742222c25bae6d767baa06e9ea0bf0" },
+	};
+
+	test_case(zimg::depth::DitherType::RANDOM, false, false, expected_sha1);
+}
+
+TEST(DitherTest, test_blue_noise_dither)
 {
 	const char *expected_sha1[][3] = {
 		{ "02c0adca6d301444ac4bf717fa691fe2758752a5" },
 		{ "d5794ead078fee72fd10fc396aef511c96f8279c" },
 
-		{ "6da260ba1fec3eda99d83739ad3ae9eaeba15df2" },
+		{ "bb651dadb283678eaf0722f25f9f3329fff2df40" },
 		{ "8ba35ed1784cb6d7903a9092abefb3d9afd7a683" },
 
-		{ "30ef22fa882d6f4bc0dbb7224a1dffdedf108734" },
-		{ "661fad247819b453a77fffb32aa4da95c0e7024e" },
+		{ "cb6888d0182cf92abc7f55722a5c905a693aad21" },
+		{ "16751ce17c310c9153e8d6f1eb0da6b75c52990e" },
 
-		{ "6bf40dea8fb17f035be0e4fa14a303b3cde45dc5" },
-		{ "04df32587f1e6222c1a3979ccf77e0c1862db4bf" },
+		{ "11e4553e80fc1b645ba67da16ce28c9124de0071" },
+		{ "722e5c62da42086bfed418329ffeb61b56ae4542" },
 	};
 
-	test_case(zimg::depth::DitherType::RANDOM, false, false, expected_sha1);
+	test_case(zimg::depth::DitherType::BLUE_NOISE, false, false, expected_sha1);
 }
 
 TEST(DitherTest, test_error_diffusion)
@@ -175,3 +243,61 @@ TEST(DitherTest, test_error_diffusion)
 
 	test_case(zimg::depth::DitherType::ERROR_DIFFUSION, false, false, expected_sha1);
 }
+
+TEST(DitherTest, test_sierra_lite)
+{
+	const char *expected_sha1[][3] = {
+		{ "02c0adca6d301444ac4bf717fa691fe2758752a5" },
+		{ "d5794ead078fee72fd10fc396aef511c96f8279c" },
+
+		{ "6ff62ba9e1b9a50e9b3f948689fae23edf3a7740" },
+		{ "8ba35ed1784cb6d7903a9092abefb3d9afd7a683" },
+
+		{ "45abb01c4960564283fdd1461e0553140e232cfc" },
+		{ "66e2def6c538d6e03495da9e03e7731795a713bd" },
+
+		{ "0a0f6718bbb1a228b883cf65e6ece35211fc7a94" },
+		{ "9b66b178cb3e79e89534c8cf5f37c068bf674a70" },
+	};
+
+	test_case(zimg::depth::DitherType::SIERRA_LITE, false, false, expected_sha1);
+}
+
+TEST(DitherTest, test_error_diffusion_threaded)
+{
+	// Must be identical to the single-threaded result.
+	const char *expected_sha1[][3] = {
+		{ "02c0adca6d301444ac4bf717fa691fe2758752a5" },
+		{ "d5794ead078fee72fd10fc396aef511c96f8279c" },
+
+		{ "e78edb136329d34c7f0a7263506351f89912bc4b" },
+		{ "8ba35ed1784cb6d7903a9092abefb3d9afd7a683" },
+
+		{ "17ffbdc53895e2576f02f8279264d7c54f723671" },
+		{ "cf92073110b1752ac6a1059229660457c4a9deef" },
+
+		{ "c739ba4bed041192bc6167e03975fc5a709561b4" },
+		{ "834f918f24da72a31bb6deb7b1e398446cf052a2" },
+	};
+
+	test_case(zimg::depth::DitherType::ERROR_DIFFUSION, false, false, expected_sha1, 4);
+}
+
+TEST(DitherTest, test_sierra_lite_threaded)
+{
+	const char *expected_sha1[][3] = {
+		{ "02c0adca6d301444ac4bf717fa691fe2758752a5" },
+		{ "d5794ead078fee72fd10fc396aef511c96f8279c" },
+
+		{ "6ff62ba9e1b9a50e9b3f948689fae23edf3a7740" },
+		{ "8ba35ed1784cb6d7903a9092abefb3d9afd7a683" },
+
+		{ "45abb01c4960564283fdd1461e0553140e232cfc" },
+		{ "66e2def6c538d6e03495da9e03e7731795a713bd" },
+
+		{ "0a0f6718bbb1a228b883cf65e6ece35211fc7a94" },
+		{ "9b66b178cb3e79e89534c8cf5f37c068bf674a70" },
+	};
+
+	test_case(zimg::depth::DitherType::SIERRA_LITE, false, false, expected_sha1, 4);
+}
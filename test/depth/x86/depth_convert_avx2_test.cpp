@@ -12,6 +12,44 @@
 
 namespace {
 
+void test_case_left_shift(const zimg::PixelFormat &pixel_in, const zimg::PixelFormat &pixel_out, const char * const expected_sha1[3], double expected_snr)
+{
+	const unsigned w = 640;
+	const unsigned h = 480;
+
+	if (!zimg::query_x86_capabilities().avx2) {
+		SUCCEED() << "avx2 not available, skipping";
+		return;
+	}
+
+	auto filter_c = zimg::depth::create_left_shift(w, h, pixel_in, pixel_out, zimg::CPUClass::NONE);
+	auto filter_avx2 = zimg::depth::create_left_shift(w, h, pixel_in, pixel_out, zimg::CPUClass::X86_AVX2);
+
+	FilterValidator validator{ filter_avx2.get(), w, h, pixel_in };
+	validator.set_sha1(expected_sha1)
+	         .set_ref_filter(filter_c.get(), expected_snr)
+	         .validate();
+}
+
+void test_case_integer_convert(const zimg::PixelFormat &pixel_in, const zimg::PixelFormat &pixel_out, const char * const expected_sha1[3], double expected_snr)
+{
+	const unsigned w = 640;
+	const unsigned h = 480;
+
+	if (!zimg::query_x86_capabilities().avx2) {
+		SUCCEED() << "avx2 not available, skipping";
+		return;
+	}
+
+	auto filter_c = zimg::depth::create_integer_convert(w, h, pixel_in, pixel_out, zimg::CPUClass::NONE);
+	auto filter_avx2 = zimg::depth::create_integer_convert(w, h, pixel_in, pixel_out, zimg::CPUClass::X86_AVX2);
+
+	FilterValidator validator{ filter_avx2.get(), w, h, pixel_in };
+	validator.set_sha1(expected_sha1)
+	         .set_ref_filter(filter_c.get(), expected_snr)
+	         .validate();
+}
+
 void test_case_depth_convert(const zimg::PixelFormat &pixel_in, const zimg::PixelFormat &pixel_out, const char * const expected_sha1[3], double expected_snr)
 {
 	const unsigned w = 640;
@@ -34,6 +72,115 @@ void test_case_depth_convert(const zimg::PixelFormat &pixel_in, const zimg::Pixe
 } // namespace
 
 
+TEST(DepthConvertAVX2Test, test_left_shift_b2b)
+{
+	zimg::PixelFormat pixel_in{ zimg::PixelType::BYTE, 4 };
+	zimg::PixelFormat pixel_out{ zimg::PixelType::BYTE, 8 };
+
+	const char *expected_sha1[3] = {
+		"09f66fc9d2221b4fad52b3e18b9b31585ebd2b61"
+	};
+
+	test_case_left_shift(pixel_in, pixel_out, expected_sha1, INFINITY);
+}
+
+TEST(DepthConvertAVX2Test, test_left_shift_b2w)
+{
+	zimg::PixelFormat pixel_in{ zimg::PixelType::BYTE, 8 };
+	zimg::PixelFormat pixel_out{ zimg::PixelType::WORD, 16 };
+
+	const char *expected_sha1[3] = {
+		"d5794ead078fee72fd10fc396aef511c96f8279c"
+	};
+
+	test_case_left_shift(pixel_in, pixel_out, expected_sha1, INFINITY);
+}
+
+TEST(DepthConvertAVX2Test, test_left_shift_w2b)
+{
+	zimg::PixelFormat pixel_in{ zimg::PixelType::WORD, 4 };
+	zimg::PixelFormat pixel_out{ zimg::PixelType::BYTE, 8 };
+
+	const char *expected_sha1[3] = {
+		"09f66fc9d2221b4fad52b3e18b9b31585ebd2b61"
+	};
+
+	test_case_left_shift(pixel_in, pixel_out, expected_sha1, INFINITY);
+}
+
+TEST(DepthConvertAVX2Test, test_left_shift_w2w)
+{
+	zimg::PixelFormat pixel_in{ zimg::PixelType::WORD, 10 };
+	zimg::PixelFormat pixel_out{ zimg::PixelType::WORD, 16 };
+
+	const char *expected_sha1[3] = {
+		"1fa20cfbaa8c2de073d5a9569e474c164c4d3ec6"
+	};
+
+	test_case_left_shift(pixel_in, pixel_out, expected_sha1, INFINITY);
+}
+
+TEST(DepthConvertAVX2Test, test_integer_convert_b2b)
+{
+	zimg::PixelFormat pixel_in{ zimg::PixelType::BYTE, 8, false };
+	zimg::PixelFormat pixel_out{ zimg::PixelType::BYTE, 8, true };
+
+	const char *expected_sha1[3] = {
+		"e58cd97731df82cb2c542a5e87bc8939cc030dff"
+	};
+
+	test_case_integer_convert(pixel_in, pixel_out, expected_sha1, INFINITY);
+}
+
+TEST(DepthConvertAVX2Test, test_integer_convert_b2w)
+{
+	zimg::PixelFormat pixel_in{ zimg::PixelType::BYTE, 8, false };
+	zimg::PixelFormat pixel_out{ zimg::PixelType::WORD, 16, true };
+
+	const char *expected_sha1[3] = {
+		"6c6d02d5595a6e94413c15d1bb5a68b499e6c471"
+	};
+
+	test_case_integer_convert(pixel_in, pixel_out, expected_sha1, INFINITY);
+}
+
+TEST(DepthConvertAVX2Test, test_integer_convert_w2b)
+{
+	zimg::PixelFormat pixel_in{ zimg::PixelType::WORD, 10, false };
+	zimg::PixelFormat pixel_out{ zimg::PixelType::BYTE, 8, true };
+
+	const char *expected_sha1[3] = {
+		"367752472bc0f6957fcdadeb56d3e3aa3d2496ec"
+	};
+
+	test_case_integer_convert(pixel_in, pixel_out, expected_sha1, INFINITY);
+}
+
+TEST(DepthConvertAVX2Test, test_integer_convert_w2b_tie)
+{
+	// Limited range 10-bit to 8-bit has exact ties, which round to even.
+	zimg::PixelFormat pixel_in{ zimg::PixelType::WORD, 10, false };
+	zimg::PixelFormat pixel_out{ zimg::PixelType::BYTE, 8, false };
+
+	const char *expected_sha1[3] = {
+		"d323f9b86832d526db412acccbafe895b1c0019d"
+	};
+
+	test_case_integer_convert(pixel_in, pixel_out, expected_sha1, INFINITY);
+}
+
+TEST(DepthConvertAVX2Test, test_integer_convert_w2w)
+{
+	zimg::PixelFormat pixel_in{ zimg::PixelType::WORD, 16, true };
+	zimg::PixelFormat pixel_out{ zimg::PixelType::WORD, 10, false };
+
+	const char *expected_sha1[3] = {
+		"4346795e5776e2b48cf8dedd6e554cc861faff68"
+	};
+
+	test_case_integer_convert(pixel_in, pixel_out, expected_sha1, INFINITY);
+}
+
 TEST(DepthConvertAVX2Test, test_depth_convert_b2h)
 {
 	zimg::PixelFormat pixel_in{ zimg::PixelType::BYTE, 8, true };
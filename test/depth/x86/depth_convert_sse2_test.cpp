@@ -31,6 +31,25 @@ void test_case_left_shift(const zimg::PixelFormat &pixel_in, const zimg::PixelFo
 	         .validate();
 }
 
+void test_case_integer_convert(const zimg::PixelFormat &pixel_in, const zimg::PixelFormat &pixel_out, const char * const expected_sha1[3], double expected_snr)
+{
+	const unsigned w = 640;
+	const unsigned h = 480;
+
+	if (!zimg::query_x86_capabilities().sse2) {
+		SUCCEED() << "sse2 not available, skipping";
+		return;
+	}
+
+	auto filter_c = zimg::depth::create_integer_convert(w, h, pixel_in, pixel_out, zimg::CPUClass::NONE);
+	auto filter_sse2 = zimg::depth::create_integer_convert(w, h, pixel_in, pixel_out, zimg::CPUClass::X86_SSE2);
+
+	FilterValidator validator{ filter_sse2.get(), w, h, pixel_in };
+	validator.set_sha1(expected_sha1)
+	         .set_ref_filter(filter_c.get(), expected_snr)
+	         .validate();
+}
+
 void test_case_depth_convert(const zimg::PixelFormat &pixel_in, const char * const expected_sha1[3], double expected_snr)
 {
 	const unsigned w = 640;
@@ -103,6 +122,67 @@ TEST(DepthConvertSSE2Test, test_left_shift_w2w)
 	test_case_left_shift(pixel_in, pixel_out, expected_sha1, INFINITY);
 }
 
+TEST(DepthConvertSSE2Test, test_integer_convert_b2b)
+{
+	zimg::PixelFormat pixel_in{ zimg::PixelType::BYTE, 8, false };
+	zimg::PixelFormat pixel_out{ zimg::PixelType::BYTE, 8, true };
+
+	const char *expected_sha1[3] = {
+		"e58cd97731df82cb2c542a5e87bc8939cc030dff"
+	};
+
+	test_case_integer_convert(pixel_in, pixel_out, expected_sha1, INFINITY);
+}
+
+TEST(DepthConvertSSE2Test, test_integer_convert_b2w)
+{
+	zimg::PixelFormat pixel_in{ zimg::PixelType::BYTE, 8, false };
+	zimg::PixelFormat pixel_out{ zimg::PixelType::WORD, 16, true };
+
+	const char *expected_sha1[3] = {
+		"6c6d02d5595a6e94413c15d1bb5a68b499e6c471"
+	};
+
+	test_case_integer_convert(pixel_in, pixel_out, expected_sha1, INFINITY);
+}
+
+TEST(DepthConvertSSE2Test, test_integer_convert_w2b)
+{
+	zimg::PixelFormat pixel_in{ zimg::PixelType::WORD, 10, false };
+	zimg::PixelFormat pixel_out{ zimg::PixelType::BYTE, 8, true };
+
+	const char *expected_sha1[3] = {
+		"367752472bc0f6957fcdadeb56d3e3aa3d2496ec"
+	};
+
+	test_case_integer_convert(pixel_in, pixel_out, expected_sha1, INFINITY);
+}
+
+TEST(DepthConvertSSE2Test, test_integer_convert_w2b_tie)
+{
+	// Limited range 10-bit to 8-bit has exact ties, which round to even.
+	zimg::PixelFormat pixel_in{ zimg::PixelType::WORD, 10, false };
+	zimg::PixelFormat pixel_out{ zimg::PixelType::BYTE, 8, false };
+
+	const char *expected_sha1[3] = {
+		"d323f9b86832d526db412acccbafe895b1c0019d"
+	};
+
+	test_case_integer_convert(pixel_in, pixel_out, expected_sha1, INFINITY);
+}
+
+TEST(DepthConvertSSE2Test, test_integer_convert_w2w)
+{
+	zimg::PixelFormat pixel_in{ zimg::PixelType::WORD, 16, true };
+	zimg::PixelFormat pixel_out{ zimg::PixelType::WORD, 10, false };
+
+	const char *expected_sha1[3] = {
+		"4346795e5776e2b48cf8dedd6e554cc861faff68"
+	};
+
+	test_case_integer_convert(pixel_in, pixel_out, expected_sha1, INFINITY);
+}
+
 TEST(DepthConvertSSE2Test, test_depth_convert_b2f)
 {
 	zimg::PixelFormat pixel_in{ zimg::PixelType::BYTE, 8, true };
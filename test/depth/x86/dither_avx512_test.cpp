@@ -13,11 +13,11 @@
 
 namespace {
 
-void test_case(const zimg::PixelFormat &pixel_in, const zimg::PixelFormat &pixel_out, const char * const expected_sha1[3], double expected_snr)
+void test_case(const zimg::PixelFormat &pixel_in, const zimg::PixelFormat &pixel_out, const char * const expected_sha1[3], double expected_snr,
+               zimg::depth::DitherType dither = zimg::depth::DitherType::RANDOM)
 {
 	const unsigned w = 640;
 	const unsigned h = 480;
-	const zimg::depth::DitherType dither = zimg::depth::DitherType::RANDOM;
 
 	if (!zimg::query_x86_capabilities().avx512f) {
 		SUCCEED() << "avx512 not available, skipping";
@@ -42,7 +42,7 @@ TEST(DitherAVX512Test, test_ordered_dither_b2b)
 	zimg::PixelFormat pixel_out{ zimg::PixelType::BYTE, 1, true, false };
 
 	const char *expected_sha1[3] = {
-		"cd90fbe6881101c82387fbe4e630b7da215ab190"
+		"e5bf5905341f3f30b637b4056bf82198002d8cea"
 	};
 
 	test_case(pixel_in, pixel_out, expected_sha1, INFINITY);
@@ -55,7 +55,7 @@ TEST(DitherAVX512Test, test_ordered_dither_b2w)
 	zimg::PixelFormat pixel_out{ zimg::PixelType::WORD, 9, true, false };
 
 	const char *expected_sha1[3] = {
-		"551e95e2ab3a6cb21f5e8e532a70257b5a7ce5d7"
+		"c107a9a8672a452818b06534111192ef081b77b0"
 	};
 
 	test_case(pixel_in, pixel_out, expected_sha1, INFINITY);
@@ -67,7 +67,7 @@ TEST(DitherAVX512Test, test_ordered_dither_w2b)
 	zimg::PixelFormat pixel_out = zimg::PixelType::BYTE;
 
 	const char *expected_sha1[3] = {
-		"6da260ba1fec3eda99d83739ad3ae9eaeba15df2"
+		"4b801c39878f0511348e44862dcab55d4f0960f9"
 	};
 
 	test_case(pixel_in, pixel_out, expected_sha1, INFINITY);
@@ -79,7 +79,7 @@ TEST(DitherAVX512Test, test_ordered_dither_w2w)
 	zimg::PixelFormat pixel_out{ zimg::PixelType::WORD, 10, false, false };
 
 	const char *expected_sha1[3] = {
-		"094b16505a3030cda9283f1d2b0ebf6ed84d6535"
+		"8f48f0b812cc576293ec95ec7b84c001c5329454"
 	};
 
 	test_case(pixel_in, pixel_out, expected_sha1, INFINITY);
@@ -91,7 +91,7 @@ TEST(DitherAVX512Test, test_ordered_dither_h2b)
 	zimg::PixelFormat pixel_out = zimg::PixelType::BYTE;
 
 	const char *expected_sha1[3] = {
-		"30ef22fa882d6f4bc0dbb7224a1dffdedf108734"
+		"de5091d4e9f2021b12d052ca66ccd9a249018afd"
 	};
 
 	test_case(pixel_in, pixel_out, expected_sha1, INFINITY);
@@ -103,7 +103,7 @@ TEST(DitherAVX512Test, test_ordered_dither_h2w)
 	zimg::PixelFormat pixel_out = zimg::PixelType::WORD;
 
 	const char *expected_sha1[3] = {
-		"661fad247819b453a77fffb32aa4da95c0e7024e"
+		"b66245d8078d5440263da9d76bc340d023b9a1fa"
 	};
 
 	test_case(pixel_in, pixel_out, expected_sha1, INFINITY);
@@ -115,7 +115,7 @@ TEST(DitherAVX512Test, test_ordered_dither_f2b)
 	zimg::PixelFormat pixel_out = zimg::PixelType::BYTE;
 
 	const char *expected_sha1[3] = {
-		"6bf40dea8fb17f035be0e4fa14a303b3cde45dc5"
+		"6aebb6e8b3cb7c89d766b05bf94238c4b45233ef"
 	};
 
 	test_case(pixel_in, pixel_out, expected_sha1, INFINITY);
@@ -127,11 +127,59 @@ TEST(DitherAVX512Test, test_ordered_dither_f2w)
 	zimg::PixelFormat pixel_out = zimg::PixelType::WORD;
 
 	const char *expected_sha1[3] = {
-		"b902d8029f198214e39ca10582dbfe0714172a1d"
+		"21fc1cbdc6bdd80ed7190ce6ea428f4847da3571"
 	};
 
 	// The use of FMA changes the rounding of the result at 16-bits.
 	test_case(pixel_in, pixel_out, expected_sha1, 120.0);
 }
 
+TEST(DitherAVX512Test, test_blue_noise_w2b)
+{
+	zimg::PixelFormat pixel_in = zimg::PixelType::WORD;
+	zimg::PixelFormat pixel_out = zimg::PixelType::BYTE;
+
+	const char *expected_sha1[3] = {
+		"bb651dadb283678eaf0722f25f9f3329fff2df40"
+	};
+
+	test_case(pixel_in, pixel_out, expected_sha1, INFINITY, zimg::depth::DitherType::BLUE_NOISE);
+}
+
+TEST(DitherAVX512Test, test_quantize_h2w)
+{
+	zimg::PixelFormat pixel_in = zimg::PixelType::HALF;
+	zimg::PixelFormat pixel_out = zimg::PixelType::WORD;
+
+	const char *expected_sha1[3] = {
+		"0c8c7f18e5ee4ae4a3344a855ad31902ea4445e4"
+	};
+
+	test_case(pixel_in, pixel_out, expected_sha1, INFINITY, zimg::depth::DitherType::NONE);
+}
+
+TEST(DitherAVX512Test, test_quantize_f2b)
+{
+	zimg::PixelFormat pixel_in = zimg::PixelType::FLOAT;
+	zimg::PixelFormat pixel_out = zimg::PixelType::BYTE;
+
+	const char *expected_sha1[3] = {
+		"5e7391e61888bc96684b4fe7e08bedd677eb6233"
+	};
+
+	test_case(pixel_in, pixel_out, expected_sha1, INFINITY, zimg::depth::DitherType::NONE);
+}
+
+TEST(DitherAVX512Test, test_quantize_f2w)
+{
+	zimg::PixelFormat pixel_in = zimg::PixelType::FLOAT;
+	zimg::PixelFormat pixel_out = zimg::PixelType::WORD;
+
+	const char *expected_sha1[3] = {
+		"f9e5a910a4c52adca61bc622f4f2bba4da7927a8"
+	};
+
+	test_case(pixel_in, pixel_out, expected_sha1, 120.0, zimg::depth::DitherType::NONE);
+}
+
 #endif // ZIMG_X86_AVX512
@@ -13,11 +13,11 @@
 
 namespace {
 
-void test_case(const zimg::PixelFormat &pixel_in, const zimg::PixelFormat &pixel_out, const char * const expected_sha1[3], double expected_snr)
+void test_case(const zimg::PixelFormat &pixel_in, const zimg::PixelFormat &pixel_out, const char * const expected_sha1[3], double expected_snr,
+               zimg::depth::DitherType dither = zimg::depth::DitherType::ERROR_DIFFUSION)
 {
 	const unsigned w = 640;
 	const unsigned h = 480;
-	const zimg::depth::DitherType dither = zimg::depth::DitherType::ERROR_DIFFUSION;
 
 	if (!zimg::query_x86_capabilities().avx2) {
 		SUCCEED() << "avx2 not available, skipping";
@@ -34,6 +34,28 @@ void test_case(const zimg::PixelFormat &pixel_in, const zimg::PixelFormat &pixel
 	         .validate();
 }
 
+void test_case_threaded(const zimg::PixelFormat &pixel_in, const zimg::PixelFormat &pixel_out,
+                        zimg::depth::DitherType dither = zimg::depth::DitherType::ERROR_DIFFUSION)
+{
+	// The height is not a multiple of the wavefront.
+	const unsigned w = 640;
+	const unsigned h = 483;
+
+	if (!zimg::query_x86_capabilities().avx2) {
+		SUCCEED() << "avx2 not available, skipping";
+		return;
+	}
+
+	auto filter_avx2 = zimg::depth::create_dither(dither, w, h, pixel_in, pixel_out, zimg::CPUClass::X86_AVX2);
+	auto filter_threaded = zimg::depth::create_dither(dither, w, h, pixel_in, pixel_out, zimg::CPUClass::X86_AVX2, 4);
+	ASSERT_FALSE(assert_different_dynamic_type(filter_avx2.get(), filter_threaded.get()));
+
+	// Must be identical to the single-threaded result.
+	FilterValidator validator{ filter_threaded.get(), w, h, pixel_in };
+	validator.set_ref_filter(filter_avx2.get(), INFINITY)
+	         .validate();
+}
+
 } // namespace
 
 
@@ -136,4 +158,68 @@ TEST(ErrorDiffusionAVX2Test, test_error_diffusion_f2w)
 	test_case(pixel_in, pixel_out, expected_sha1, 50.0);
 }
 
+TEST(ErrorDiffusionAVX2Test, test_sierra_lite_b2b)
+{
+	zimg::PixelFormat pixel_in{ zimg::PixelType::BYTE, 8, true, false };
+	zimg::PixelFormat pixel_out{ zimg::PixelType::BYTE, 1, true, false };
+
+	const char *expected_sha1[3] = {
+		"e99fa6c5321d609a8f93404d60e13efe057178e1"
+	};
+
+	test_case(pixel_in, pixel_out, expected_sha1, INFINITY, zimg::depth::DitherType::SIERRA_LITE);
+}
+
+TEST(ErrorDiffusionAVX2Test, test_sierra_lite_w2w)
+{
+	zimg::PixelFormat pixel_in{ zimg::PixelType::WORD, 16, false, false };
+	zimg::PixelFormat pixel_out{ zimg::PixelType::WORD, 10, false, false };
+
+	const char *expected_sha1[3] = {
+		"ef02ca5f197b6ae9aae362a2e45b5058fc7bf305"
+	};
+
+	test_case(pixel_in, pixel_out, expected_sha1, INFINITY, zimg::depth::DitherType::SIERRA_LITE);
+}
+
+TEST(ErrorDiffusionAVX2Test, test_sierra_lite_h2b)
+{
+	zimg::PixelFormat pixel_in = zimg::PixelType::HALF;
+	zimg::PixelFormat pixel_out = zimg::PixelType::BYTE;
+
+	const char *expected_sha1[3] = {
+		"45abb01c4960564283fdd1461e0553140e232cfc"
+	};
+
+	test_case(pixel_in, pixel_out, expected_sha1, INFINITY, zimg::depth::DitherType::SIERRA_LITE);
+}
+
+TEST(ErrorDiffusionAVX2Test, test_sierra_lite_f2w)
+{
+	zimg::PixelFormat pixel_in = zimg::PixelType::FLOAT;
+	zimg::PixelFormat pixel_out = zimg::PixelType::WORD;
+
+	const char *expected_sha1[3] = {
+		"35333f0355b70f9336ee20bde1ff6a279d314df7"
+	};
+
+	test_case(pixel_in, pixel_out, expected_sha1, 50.0, zimg::depth::DitherType::SIERRA_LITE);
+}
+
+TEST(ErrorDiffusionAVX2Test, test_error_diffusion_threaded_h2w)
+{
+	zimg::PixelFormat pixel_in = zimg::PixelType::HALF;
+	zimg::PixelFormat pixel_out = zimg::PixelType::WORD;
+
+	test_case_threaded(pixel_in, pixel_out);
+}
+
+TEST(ErrorDiffusionAVX2Test, test_sierra_lite_threaded_f2b)
+{
+	zimg::PixelFormat pixel_in = zimg::PixelType::FLOAT;
+	zimg::PixelFormat pixel_out = zimg::PixelType::BYTE;
+
+	test_case_threaded(pixel_in, pixel_out, zimg::depth::DitherType::SIERRA_LITE);
+}
+
 #endif // ZIMG_X86
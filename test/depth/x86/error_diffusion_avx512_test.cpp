@@ -0,0 +1,225 @@
+#ifdef ZIMG_X86_AVX512
+
+#include <cmath>
+#include "common/cpuinfo.h"
+#include "common/pixel.h"
+#include "common/x86/cpuinfo_x86.h"
+#include "graph/image_filter.h"
+#include "depth/depth.h"
+#include "depth/dither.h"
+
+#include "gtest/gtest.h"
+#include "graph/filter_validator.h"
+
+namespace {
+
+void test_case(const zimg::PixelFormat &pixel_in, const zimg::PixelFormat &pixel_out, const char * const expected_sha1[3], double expected_snr,
+               zimg::depth::DitherType dither = zimg::depth::DitherType::ERROR_DIFFUSION)
+{
+	const unsigned w = 640;
+	const unsigned h = 480;
+
+	if (!zimg::query_x86_capabilities().avx512f) {
+		SUCCEED() << "avx512 not available, skipping";
+		return;
+	}
+
+	auto filter_c = zimg::depth::create_dither(dither, w, h, pixel_in, pixel_out, zimg::CPUClass::NONE);
+	auto filter_avx512 = zimg::depth::create_dither(dither, w, h, pixel_in, pixel_out, zimg::CPUClass::X86_AVX512);
+	ASSERT_FALSE(assert_different_dynamic_type(filter_c.get(), filter_avx512.get()));
+
+	FilterValidator validator{ filter_avx512.get(), w, h, pixel_in };
+	validator.set_sha1(expected_sha1)
+	         .set_ref_filter(filter_c.get(), expected_snr)
+	         .validate();
+}
+
+void test_case_threaded(const zimg::PixelFormat &pixel_in, const zimg::PixelFormat &pixel_out,
+                        zimg::depth::DitherType dither = zimg::depth::DitherType::ERROR_DIFFUSION)
+{
+	// The height is not a multiple of the wavefront.
+	const unsigned w = 640;
+	const unsigned h = 483;
+
+	if (!zimg::query_x86_capabilities().avx512f) {
+		SUCCEED() << "avx512 not available, skipping";
+		return;
+	}
+
+	auto filter_avx512 = zimg::depth::create_dither(dither, w, h, pixel_in, pixel_out, zimg::CPUClass::X86_AVX512);
+	auto filter_threaded = zimg::depth::create_dither(dither, w, h, pixel_in, pixel_out, zimg::CPUClass::X86_AVX512, 4);
+	ASSERT_FALSE(assert_different_dynamic_type(filter_avx512.get(), filter_threaded.get()));
+
+	// Must be identical to the single-threaded result.
+	FilterValidator validator{ filter_threaded.get(), w, h, pixel_in };
+	validator.set_ref_filter(filter_avx512.get(), INFINITY)
+	         .validate();
+}
+
+} // namespace
+
+
+TEST(ErrorDiffusionAVX512Test, test_error_diffusion_b2b)
+{
+	zimg::PixelFormat pixel_in{ zimg::PixelType::BYTE, 8, true, false };
+	zimg::PixelFormat pixel_out{ zimg::PixelType::BYTE, 1, true, false };
+
+	const char *expected_sha1[3] = {
+		"7f88314679a06f74d8f361b7eec07a87768ac9f4"
+	};
+
+	test_case(pixel_in, pixel_out, expected_sha1, INFINITY);
+}
+
+TEST(ErrorDiffusionAVX512Test, test_error_diffusion_b2w)
+{
+
+	zimg::PixelFormat pixel_in{ zimg::PixelType::BYTE, 8, true, false };
+	zimg::PixelFormat pixel_out{ zimg::PixelType::WORD, 9, true, false };
+
+	const char *expected_sha1[3] = {
+		"db9fe2d13b97bf9f7a717f37985d88ba7b025ae0"
+	};
+
+	test_case(pixel_in, pixel_out, expected_sha1, INFINITY);
+}
+
+TEST(ErrorDiffusionAVX512Test, test_error_diffusion_w2b)
+{
+	zimg::PixelFormat pixel_in = zimg::PixelType::WORD;
+	zimg::PixelFormat pixel_out = zimg::PixelType::BYTE;
+
+	const char *expected_sha1[3] = {
+		"e78edb136329d34c7f0a7263506351f89912bc4b"
+	};
+
+	test_case(pixel_in, pixel_out, expected_sha1, INFINITY);
+}
+
+TEST(ErrorDiffusionAVX512Test, test_error_diffusion_w2w)
+{
+	zimg::PixelFormat pixel_in{ zimg::PixelType::WORD, 16, false, false };
+	zimg::PixelFormat pixel_out{ zimg::PixelType::WORD, 10, false, false };
+
+	const char *expected_sha1[3] = {
+		"86397c91f37ec9a671feac8cce2508a6b67181f4"
+	};
+
+	test_case(pixel_in, pixel_out, expected_sha1, INFINITY);
+}
+
+TEST(ErrorDiffusionAVX512Test, test_error_diffusion_h2b)
+{
+	zimg::PixelFormat pixel_in = zimg::PixelType::HALF;
+	zimg::PixelFormat pixel_out = zimg::PixelType::BYTE;
+
+	const char *expected_sha1[3] = {
+		"17ffbdc53895e2576f02f8279264d7c54f723671"
+	};
+
+	test_case(pixel_in, pixel_out, expected_sha1, INFINITY);
+}
+
+TEST(ErrorDiffusionAVX512Test, test_error_diffusion_h2w)
+{
+	zimg::PixelFormat pixel_in = zimg::PixelType::HALF;
+	zimg::PixelFormat pixel_out = zimg::PixelType::WORD;
+
+	const char *expected_sha1[3] = {
+		"cf92073110b1752ac6a1059229660457c4a9deef"
+	};
+
+	test_case(pixel_in, pixel_out, expected_sha1, INFINITY);
+}
+
+TEST(ErrorDiffusionAVX512Test, test_error_diffusion_f2b)
+{
+	zimg::PixelFormat pixel_in = zimg::PixelType::FLOAT;
+	zimg::PixelFormat pixel_out = zimg::PixelType::BYTE;
+
+	const char *expected_sha1[3] = {
+		"4ed3a75693d507e93a1cf3550fbad51bfff17c3b"
+	};
+
+	// With single-precision input, the error calculation difference from FMA becomes apparent.
+	test_case(pixel_in, pixel_out, expected_sha1, 50.0);
+}
+
+TEST(ErrorDiffusionAVX512Test, test_error_diffusion_f2w)
+{
+	zimg::PixelFormat pixel_in = zimg::PixelType::FLOAT;
+	zimg::PixelFormat pixel_out = zimg::PixelType::WORD;
+
+	const char *expected_sha1[3] = {
+		"c512b5d7e29e6bd073d2ae194cdd1738539b6166"
+	};
+
+	// With single-precision input, the error calculation difference from FMA becomes apparent.
+	test_case(pixel_in, pixel_out, expected_sha1, 50.0);
+}
+
+TEST(ErrorDiffusionAVX512Test, test_sierra_lite_b2b)
+{
+	zimg::PixelFormat pixel_in{ zimg::PixelType::BYTE, 8, true, false };
+	zimg::PixelFormat pixel_out{ zimg::PixelType::BYTE, 1, true, false };
+
+	const char *expected_sha1[3] = {
+		"e99fa6c5321d609a8f93404d60e13efe057178e1"
+	};
+
+	test_case(pixel_in, pixel_out, expected_sha1, INFINITY, zimg::depth::DitherType::SIERRA_LITE);
+}
+
+TEST(ErrorDiffusionAVX512Test, test_sierra_lite_w2w)
+{
+	zimg::PixelFormat pixel_in{ zimg::PixelType::WORD, 16, false, false };
+	zimg::PixelFormat pixel_out{ zimg::PixelType::WORD, 10, false, false };
+
+	const char *expected_sha1[3] = {
+		"ef02ca5f197b6ae9aae362a2e45b5058fc7bf305"
+	};
+
+	test_case(pixel_in, pixel_out, expected_sha1, INFINITY, zimg::depth::DitherType::SIERRA_LITE);
+}
+
+TEST(ErrorDiffusionAVX512Test, test_sierra_lite_h2b)
+{
+	zimg::PixelFormat pixel_in = zimg::PixelType::HALF;
+	zimg::PixelFormat pixel_out = zimg::PixelType::BYTE;
+
+	const char *expected_sha1[3] = {
+		"45abb01c4960564283fdd1461e0553140e232cfc"
+	};
+
+	test_case(pixel_in, pixel_out, expected_sha1, INFINITY, zimg::depth::DitherType::SIERRA_LITE);
+}
+
+TEST(ErrorDiffusionAVX512Test, test_sierra_lite_f2w)
+{
+	zimg::PixelFormat pixel_in = zimg::PixelType::FLOAT;
+	zimg::PixelFormat pixel_out = zimg::PixelType::WORD;
+
+	const char *expected_sha1[3] = {
+		"35333f0355b70f9336ee20bde1ff6a279d314df7"
+	};
+
+	test_case(pixel_in, pixel_out, expected_sha1, 50.0, zimg::depth::DitherType::SIERRA_LITE);
+}
+
+TEST(ErrorDiffusionAVX512Test, test_error_diffusion_threaded_h2w)
+{
+	zimg::PixelFormat pixel_in = zimg::PixelType::HALF;
+	zimg::PixelFormat pixel_out = zimg::PixelType::WORD;
+
+	test_case_threaded(pixel_in, pixel_out);
+}
+
+TEST(ErrorDiffusionAVX512Test, test_sierra_lite_threaded_f2b)
+{
+	zimg::PixelFormat pixel_in = zimg::PixelType::FLOAT;
+	zimg::PixelFormat pixel_out = zimg::PixelType::BYTE;
+
+	test_case_threaded(pixel_in, pixel_out, zimg::depth::DitherType::SIERRA_LITE);
+}
+
+#endif // ZIMG_X86_AVX512
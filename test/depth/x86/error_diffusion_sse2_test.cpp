@@ -34,6 +34,28 @@ void test_case(const zimg::PixelFormat &pixel_in, const zimg::PixelFormat &pixel
 	         .validate();
 }
 
+void test_case_threaded(const zimg::PixelFormat &pixel_in, const zimg::PixelFormat &pixel_out,
+                        zimg::depth::DitherType dither = zimg::depth::DitherType::ERROR_DIFFUSION)
+{
+	// The height is not a multiple of the wavefront.
+	const unsigned w = 640;
+	const unsigned h = 483;
+
+	if (!zimg::query_x86_capabilities().sse2) {
+		SUCCEED() << "sse2 not available, skipping";
+		return;
+	}
+
+	auto filter_sse2 = zimg::depth::create_dither(dither, w, h, pixel_in, pixel_out, zimg::CPUClass::X86_SSE2);
+	auto filter_threaded = zimg::depth::create_dither(dither, w, h, pixel_in, pixel_out, zimg::CPUClass::X86_SSE2, 4);
+	ASSERT_FALSE(assert_different_dynamic_type(filter_sse2.get(), filter_threaded.get()));
+
+	// Must be identical to the single-threaded result.
+	FilterValidator validator{ filter_threaded.get(), w, h, pixel_in };
+	validator.set_ref_filter(filter_sse2.get(), INFINITY)
+	         .validate();
+}
+
 } // namespace
 
 
@@ -134,4 +156,20 @@ TEST(ErrorDiffusionSSE2Test, test_error_diffusion_f2w)
 	test_case(pixel_in, pixel_out, expected_sha1, INFINITY);
 }
 
+TEST(ErrorDiffusionSSE2Test, test_error_diffusion_threaded_w2b)
+{
+	zimg::PixelFormat pixel_in = zimg::PixelType::WORD;
+	zimg::PixelFormat pixel_out = zimg::PixelType::BYTE;
+
+	test_case_threaded(pixel_in, pixel_out);
+}
+
+TEST(ErrorDiffusionSSE2Test, test_error_diffusion_threaded_h2w)
+{
+	zimg::PixelFormat pixel_in = zimg::PixelType::HALF;
+	zimg::PixelFormat pixel_out = zimg::PixelType::WORD;
+
+	test_case_threaded(pixel_in, pixel_out);
+}
+
 #endif // ZIMG_X86
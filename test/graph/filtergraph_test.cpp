@@ -1,5 +1,8 @@
 #include <algorithm>
+#include <climits>
 #include <cstdint>
+#include <string>
+#include <thread>
 
 #include "common/alloc.h"
 #include "common/except.h"
@@ -594,3 +597,451 @@ TEST(FilterGraphTest, test_callback_failed)
 	SCOPED_TRACE("validating dst");
 	dst_image.validate();
 }
+
+TEST(FilterGraphTest, test_stats)
+{
+	const unsigned w = 640;
+	const unsigned h = 480;
+	const zimg::PixelType type = zimg::PixelType::WORD;
+
+	zimg::graph::ImageFilter::filter_flags flags1{};
+	flags1.entire_row = true;
+	flags1.entire_plane = true;
+
+	zimg::graph::ImageFilter::filter_flags flags2{};
+
+	auto filter1_uptr = ztd::make_unique<SplatFilter<uint16_t>>(w, h, type, flags1);
+	auto filter2_uptr = ztd::make_unique<SplatFilter<uint16_t>>(w, h, type, flags2);
+	filter1_uptr->enable_input_checking(false);
+	filter2_uptr->enable_input_checking(false);
+
+	zimg::graph::FilterGraph graph{ w, h, type, 0, 0, false };
+	graph.attach_filter(std::move(filter1_uptr));
+	graph.attach_filter(std::move(filter2_uptr));
+	graph.complete();
+
+	AuditImage<uint16_t> src_image{ AuditBufferType::PLANE, w, h, type, 0, 0 };
+	AuditImage<uint16_t> dst_image{ AuditBufferType::PLANE, w, h, type, 0, 0 };
+	zimg::AlignedVector<char> tmp(graph.get_tmp_size());
+
+	src_image.default_fill();
+
+	graph.process(src_image.as_read_buffer(), dst_image.as_write_buffer(), tmp.data(), nullptr, nullptr);
+
+	auto stats = graph.get_stats();
+	ASSERT_EQ(2U, stats.size());
+	EXPECT_STREQ("SplatFilter<unsigned short>", stats[0].name);
+	EXPECT_EQ(0U, stats[0].calls);
+	EXPECT_EQ(0U, stats[1].calls);
+
+	graph.set_stats_enabled(true);
+	graph.process(src_image.as_read_buffer(), dst_image.as_write_buffer(), tmp.data(), nullptr, nullptr);
+	graph.process(src_image.as_read_buffer(), dst_image.as_write_buffer(), tmp.data(), nullptr, nullptr);
+
+	stats = graph.get_stats();
+	ASSERT_EQ(2U, stats.size());
+	EXPECT_EQ(2U, stats[0].calls);
+	EXPECT_EQ(2U * h, stats[1].calls);
+
+	for (const auto &node : stats) {
+		EXPECT_EQ(2ULL * w * h, node.pixels);
+		EXPECT_EQ(2ULL * w * h * sizeof(uint16_t), node.bytes_read);
+		EXPECT_EQ(2ULL * w * h * sizeof(uint16_t), node.bytes_written);
+	}
+
+	graph.reset_stats();
+	stats = graph.get_stats();
+	EXPECT_EQ(0U, stats[0].calls);
+	EXPECT_EQ(0U, stats[1].pixels);
+	EXPECT_EQ(0U, stats[1].nanoseconds);
+}
+
+TEST(FilterGraphTest, test_dump_plan)
+{
+	const unsigned w = 640;
+	const unsigned h = 480;
+	const zimg::PixelType type = zimg::PixelType::BYTE;
+
+	zimg::graph::ImageFilter::filter_flags flags{};
+	flags.same_row = true;
+	flags.in_place = true;
+
+	zimg::graph::FilterGraph graph{ w, h, type, 1, 1, true };
+	graph.attach_filter(ztd::make_unique<SplatFilter<uint8_t>>(w, h, type, flags));
+	graph.complete();
+
+	std::string json = graph.dump_plan(zimg::graph::FilterGraph::plan_format::JSON);
+	EXPECT_NE(std::string::npos, json.find("\"kind\": \"source\""));
+	EXPECT_NE(std::string::npos, json.find("\"filter\": \"SplatFilter<unsigned char>\""));
+	EXPECT_NE(std::string::npos, json.find("\"flags\": [\"same_row\", \"in_place\"]"));
+	EXPECT_NE(std::string::npos, json.find("\"strategy\": \"chroma\""));
+	EXPECT_NE(std::string::npos, json.find("\"tmp_size\": " + std::to_string(graph.get_tmp_size())));
+	EXPECT_EQ(std::count(json.begin(), json.end(), '{'), std::count(json.begin(), json.end(), '}'));
+	EXPECT_EQ(std::count(json.begin(), json.end(), '['), std::count(json.begin(), json.end(), ']'));
+
+	// The chroma planes are copied by a CopyFilter attached at completion.
+	std::string dot = graph.dump_plan(zimg::graph::FilterGraph::plan_format::DOT);
+	EXPECT_EQ(0U, dot.find("digraph"));
+	EXPECT_NE(std::string::npos, dot.find("n0 -> n1;"));
+	EXPECT_NE(std::string::npos, dot.find("n0 -> n2;"));
+	EXPECT_NE(std::string::npos, dot.find("CopyFilter"));
+}
+
+TEST(FilterGraphTest, test_trace)
+{
+	const unsigned w = 640;
+	const unsigned h = 480;
+	const zimg::PixelType type = zimg::PixelType::BYTE;
+
+	zimg::graph::FilterGraph graph{ w, h, type, 0, 0, false };
+	graph.attach_filter(ztd::make_unique<SplatFilter<uint8_t>>(w, h, type));
+	graph.set_tile_width(w);
+	graph.complete();
+
+	AuditImage<uint8_t> src_image{ AuditBufferType::PLANE, w, h, type, 0, 0 };
+	AuditImage<uint8_t> dst_image{ AuditBufferType::PLANE, w, h, type, 0, 0 };
+	zimg::AlignedVector<char> tmp(graph.get_tmp_size());
+
+	auto cb = [](void *, unsigned, unsigned, unsigned) { return 0; };
+
+	src_image.default_fill();
+	graph.process(src_image.as_read_buffer(), dst_image.as_write_buffer(), tmp.data(), nullptr, nullptr);
+	EXPECT_EQ(std::string::npos, graph.dump_trace().find("\"ph\""));
+
+	// Keep only the most recent events.
+	graph.set_trace_capacity(h + 1);
+	graph.process(src_image.as_read_buffer(), dst_image.as_write_buffer(), tmp.data(), { cb, nullptr }, { cb, nullptr });
+
+	std::string trace = graph.dump_trace();
+	EXPECT_NE(std::string::npos, trace.find("\"cat\":\"tile\""));
+	EXPECT_NE(std::string::npos, trace.find("\"name\":\"color tile\""));
+	EXPECT_NE(std::string::npos, trace.find("\"name\":\"SplatFilter<unsigned char>\""));
+	EXPECT_NE(std::string::npos, trace.find("\"cat\":\"pack\""));
+	EXPECT_EQ(h + 1, static_cast<unsigned>(std::count(trace.begin(), trace.end(), '\n')) - 2);
+
+	graph.clear_trace();
+	EXPECT_EQ(std::string::npos, graph.dump_trace().find("\"ph\""));
+
+	graph.set_trace_capacity(0);
+	graph.process(src_image.as_read_buffer(), dst_image.as_write_buffer(), tmp.data(), nullptr, nullptr);
+	EXPECT_EQ(std::string::npos, graph.dump_trace().find("\"ph\""));
+}
+
+TEST(FilterGraphTest, test_stream)
+{
+	const unsigned w = 640;
+	const unsigned h = 480;
+	const zimg::PixelType type = zimg::PixelType::BYTE;
+
+	const uint8_t test_byte1 = 0xCD;
+	const uint8_t test_byte2 = 0xDC;
+
+	auto filter1_uptr = ztd::make_unique<SplatFilter<uint8_t>>(w, h, type);
+	auto filter2_uptr = ztd::make_unique<SplatFilter<uint8_t>>(w / 2, h / 2, type);
+
+	filter1_uptr->set_input_val(test_byte1);
+	filter1_uptr->set_output_val(test_byte2);
+	filter1_uptr->set_vertical_support(5);
+	filter1_uptr->set_simultaneous_lines(2);
+
+	filter2_uptr->set_input_val(test_byte1);
+	filter2_uptr->set_output_val(test_byte2);
+	filter2_uptr->set_vertical_support(3);
+
+	zimg::graph::FilterGraph graph{ w, h, type, 1, 1, true };
+	graph.attach_filter(std::move(filter1_uptr));
+	graph.attach_filter_uv(std::move(filter2_uptr));
+	graph.complete();
+
+	unsigned input_lines = graph.get_stream_input_buffering();
+	unsigned output_lines = graph.get_output_buffering();
+	ASSERT_GE(input_lines, graph.get_input_buffering());
+	ASSERT_LT(input_lines, h);
+
+	AuditBuffer<uint8_t> src_buf{ AuditBufferType::COLOR_YUV, w, h, type, input_lines, 1, 1 };
+	AuditBuffer<uint8_t> dst_buf{ AuditBufferType::COLOR_YUV, w, h, type, output_lines, 1, 1 };
+
+	src_buf.set_fill_val(test_byte1);
+	src_buf.default_fill();
+	dst_buf.set_fill_val(test_byte2);
+
+	// Buffers smaller than the stream buffering are rejected.
+	{
+		AuditBuffer<uint8_t> short_buf{ AuditBufferType::COLOR_YUV, w, h, type, input_lines / 2, 1, 1 };
+		EXPECT_THROW((zimg::graph::FilterGraph::stream{ graph, short_buf.as_read_buffer(), dst_buf.as_write_buffer() }), zimg::error::IllegalArgument);
+	}
+
+	// Input may not be announced beyond the rows still required.
+	{
+		zimg::graph::FilterGraph::stream stream{ graph, src_buf.as_read_buffer(), dst_buf.as_write_buffer() };
+		EXPECT_THROW(stream.push_rows(input_lines + 2), zimg::error::IllegalArgument);
+		EXPECT_EQ(0U, stream.get_rows_pushed());
+	}
+
+	zimg::graph::FilterGraph::stream stream{ graph, src_buf.as_read_buffer(), dst_buf.as_write_buffer() };
+	unsigned first;
+	unsigned count;
+
+	EXPECT_EQ(0U, stream.pull_rows(&first));
+
+	for (unsigned i = 0; i < h; i += 2) {
+		stream.push_rows(2);
+
+		while ((count = stream.pull_rows(&first)) != 0) {
+			EXPECT_EQ(stream.get_rows_pulled(), first + count);
+			EXPECT_LE(count, output_lines);
+
+			for (unsigned ii = first; ii < first + count; ++ii) {
+				ASSERT_FALSE(dst_buf.detect_write(ii, 0, w)) << "unexpected write at line: " << ii;
+			}
+		}
+
+		// Output is produced as soon as the input allows it.
+		EXPECT_LE(i + 2, stream.get_rows_pulled() + input_lines);
+	}
+
+	EXPECT_EQ(h, stream.get_rows_pushed());
+	EXPECT_EQ(h, stream.get_rows_pulled());
+	EXPECT_EQ(0U, stream.pull_rows(&first));
+	EXPECT_THROW(stream.push_rows(1), zimg::error::IllegalArgument);
+
+	src_buf.assert_guard_bytes();
+	dst_buf.assert_guard_bytes();
+}
+
+TEST(FilterGraphTest, test_async_io)
+{
+	static const unsigned w = 640;
+	static const unsigned h = 480;
+	const zimg::PixelType type = zimg::PixelType::BYTE;
+
+	const uint8_t test_byte1 = 0xCD;
+	const uint8_t test_byte2 = 0xFF;
+	const uint8_t test_byte3 = 0xDC;
+
+	struct callback_data {
+		zimg::graph::ColorImageBuffer<void> buffer;
+		unsigned call_count;
+		unsigned last_row;
+		unsigned fail_row;
+		uint8_t byte_val;
+		std::thread::id thread_id;
+	};
+
+	auto cb = [](void *ptr, unsigned i, unsigned left, unsigned right) -> int
+	{
+		callback_data *xptr = static_cast<callback_data *>(ptr);
+
+		if (i == xptr->fail_row)
+			return 1;
+
+		// Rows are visited in order within each tile.
+		EXPECT_TRUE(i == 0 || i == xptr->last_row + 2);
+		xptr->last_row = i;
+		xptr->thread_id = std::this_thread::get_id();
+
+		for (unsigned ii = i; ii < i + 2; ++ii) {
+			const auto &buf = zimg::graph::static_buffer_cast<uint8_t>(xptr->buffer[0]);
+			std::fill(buf[ii] + left, buf[ii] + right, xptr->byte_val);
+		}
+		for (unsigned p = 1; p < 3; ++p) {
+			const auto &chroma_buf = zimg::graph::static_buffer_cast<uint8_t>(xptr->buffer[p]);
+			std::fill(chroma_buf[i / 2] + left / 2, chroma_buf[i / 2] + right / 2, xptr->byte_val);
+		}
+
+		++xptr->call_count;
+		return 0;
+	};
+
+	auto filter1_uptr = ztd::make_unique<SplatFilter<uint8_t>>(w, h, type);
+	auto filter2_uptr = ztd::make_unique<SplatFilter<uint8_t>>(w / 2, h / 2, type);
+
+	filter1_uptr->set_input_val(test_byte1);
+	filter1_uptr->set_output_val(test_byte2);
+	filter1_uptr->set_vertical_support(5);
+
+	filter2_uptr->set_input_val(test_byte1);
+	filter2_uptr->set_output_val(test_byte2);
+
+	zimg::graph::FilterGraph graph{ w, h, type, 1, 1, true };
+	graph.attach_filter(std::move(filter1_uptr));
+	graph.attach_filter_uv(std::move(filter2_uptr));
+	graph.complete();
+	graph.set_tile_width(320);
+
+	unsigned input_buffering = graph.get_input_buffering();
+	unsigned output_buffering = graph.get_output_buffering();
+
+	graph.set_async_io(16, 16);
+	EXPECT_EQ(zimg::graph::select_zimg_buffer_mask(input_buffering + 16) + 1, graph.get_input_buffering());
+	EXPECT_EQ(zimg::graph::select_zimg_buffer_mask(output_buffering + 16) + 1, graph.get_output_buffering());
+
+	AuditImage<uint8_t> src_image{ AuditBufferType::COLOR_YUV, w, h, type, 1, 1 };
+	AuditImage<uint8_t> tmp_image{ AuditBufferType::COLOR_YUV, w, h, type, 1, 1 };
+	AuditImage<uint8_t> dst_image{ AuditBufferType::COLOR_YUV, w, h, type, 1, 1 };
+	zimg::AlignedVector<char> tmp(graph.get_tmp_size());
+
+	callback_data cb1_data = { src_image.as_write_buffer(), 0, 0, UINT_MAX, test_byte1 };
+	callback_data cb2_data = { dst_image.as_write_buffer(), 0, 0, UINT_MAX, test_byte3 };
+
+	src_image.set_fill_val(test_byte1);
+	tmp_image.set_fill_val(test_byte2);
+	dst_image.set_fill_val(test_byte3);
+
+	graph.process(src_image.as_read_buffer(), tmp_image.as_write_buffer(), tmp.data(), { cb, &cb1_data }, { cb, &cb2_data });
+
+	SCOPED_TRACE("validating src");
+	src_image.validate();
+	SCOPED_TRACE("validating tmp");
+	tmp_image.validate();
+	SCOPED_TRACE("validating dst");
+	dst_image.validate();
+
+	EXPECT_EQ(h, cb1_data.call_count);
+	EXPECT_EQ(h, cb2_data.call_count);
+
+	// The I/O thread is kept for subsequent executions.
+	std::thread::id io_thread = cb1_data.thread_id;
+	EXPECT_NE(std::this_thread::get_id(), io_thread);
+	EXPECT_EQ(io_thread, cb2_data.thread_id);
+
+	graph.process(src_image.as_read_buffer(), tmp_image.as_write_buffer(), tmp.data(), { cb, &cb1_data }, { cb, &cb2_data });
+	EXPECT_EQ(io_thread, cb1_data.thread_id);
+	EXPECT_EQ(io_thread, cb2_data.thread_id);
+
+	// Failures on the I/O thread are reported to the caller.
+	cb1_data.fail_row = h / 2;
+	EXPECT_THROW(graph.process(src_image.as_read_buffer(), tmp_image.as_write_buffer(), tmp.data(), { cb, &cb1_data }, { cb, &cb2_data }),
+	             zimg::error::UserCallbackFailed);
+
+	cb1_data.fail_row = UINT_MAX;
+	cb2_data.fail_row = h / 2;
+	EXPECT_THROW(graph.process(src_image.as_read_buffer(), tmp_image.as_write_buffer(), tmp.data(), { cb, &cb1_data }, { cb, &cb2_data }),
+	             zimg::error::UserCallbackFailed);
+
+	// A failed execution does not prevent subsequent ones.
+	cb2_data.fail_row = UINT_MAX;
+	cb1_data.call_count = 0;
+	cb2_data.call_count = 0;
+	graph.process(src_image.as_read_buffer(), tmp_image.as_write_buffer(), tmp.data(), { cb, &cb1_data }, { cb, &cb2_data });
+	EXPECT_EQ(h, cb1_data.call_count);
+	EXPECT_EQ(h, cb2_data.call_count);
+}
+
+TEST(FilterGraphTest, test_callback_batch)
+{
+	static const unsigned w = 640;
+	static const unsigned h = 480;
+	const zimg::PixelType type = zimg::PixelType::BYTE;
+
+	const uint8_t test_byte1 = 0xCD;
+	const uint8_t test_byte2 = 0xFF;
+	const uint8_t test_byte3 = 0xDC;
+
+	struct callback_data {
+		zimg::graph::ColorImageBuffer<void> buffer;
+		unsigned call_count;
+		unsigned next_row;
+		unsigned max_count;
+		bool full_width;
+		uint8_t byte_val;
+	};
+
+	auto cb = [](void *ptr, unsigned i, unsigned count, unsigned left, unsigned right) -> int
+	{
+		callback_data *xptr = static_cast<callback_data *>(ptr);
+
+		// Batches are consecutive within each tile.
+		EXPECT_TRUE(i == 0 || i == xptr->next_row);
+		EXPECT_EQ(0U, count % 2);
+		EXPECT_LE(count, xptr->max_count);
+		if (xptr->full_width) {
+			EXPECT_EQ(0U, left);
+			EXPECT_EQ(w, right);
+		}
+		xptr->next_row = i + count;
+
+		for (unsigned ii = i; ii < i + count; ++ii) {
+			const auto &buf = zimg::graph::static_buffer_cast<uint8_t>(xptr->buffer[0]);
+			std::fill(buf[ii] + left, buf[ii] + right, xptr->byte_val);
+		}
+		for (unsigned ii = i / 2; ii < (i + count) / 2; ++ii) {
+			for (unsigned p = 1; p < 3; ++p) {
+				const auto &chroma_buf = zimg::graph::static_buffer_cast<uint8_t>(xptr->buffer[p]);
+				std::fill(chroma_buf[ii] + left / 2, chroma_buf[ii] + right / 2, xptr->byte_val);
+			}
+		}
+
+		++xptr->call_count;
+		return 0;
+	};
+
+	auto filter1_uptr = ztd::make_unique<SplatFilter<uint8_t>>(w, h, type);
+	auto filter2_uptr = ztd::make_unique<SplatFilter<uint8_t>>(w / 2, h / 2, type);
+
+	filter1_uptr->set_input_val(test_byte1);
+	filter1_uptr->set_output_val(test_byte2);
+	filter1_uptr->set_vertical_support(5);
+
+	filter2_uptr->set_input_val(test_byte1);
+	filter2_uptr->set_output_val(test_byte2);
+
+	zimg::graph::FilterGraph graph{ w, h, type, 1, 1, true };
+	graph.attach_filter(std::move(filter1_uptr));
+	graph.attach_filter_uv(std::move(filter2_uptr));
+	graph.complete();
+	graph.set_tile_width(320);
+
+	unsigned input_buffering = graph.get_input_buffering();
+	unsigned output_buffering = graph.get_output_buffering();
+
+	graph.set_callback_batch(17, false);
+	EXPECT_EQ(zimg::graph::select_zimg_buffer_mask(input_buffering + 14) + 1, graph.get_input_buffering());
+	EXPECT_EQ(zimg::graph::select_zimg_buffer_mask(output_buffering + 14) + 1, graph.get_output_buffering());
+
+	AuditImage<uint8_t> src_image{ AuditBufferType::COLOR_YUV, w, h, type, 1, 1 };
+	AuditImage<uint8_t> tmp_image{ AuditBufferType::COLOR_YUV, w, h, type, 1, 1 };
+	AuditImage<uint8_t> dst_image{ AuditBufferType::COLOR_YUV, w, h, type, 1, 1 };
+	zimg::AlignedVector<char> tmp(graph.get_tmp_size());
+
+	const struct {
+		bool full_width;
+		bool async;
+		unsigned calls;
+	} tests[] = {
+		{ false, false, h / 16 * 2 },
+		{ true, false, h / 16 },
+		{ false, true, 0 },
+		{ true, true, 0 },
+	};
+
+	for (const auto &test : tests) {
+		SCOPED_TRACE(test.full_width);
+		SCOPED_TRACE(test.async);
+
+		graph.set_callback_batch(17, test.full_width);
+		graph.set_async_io(test.async ? 16 : 0, test.async ? 16 : 0);
+
+		callback_data cb1_data = { src_image.as_write_buffer(), 0, 0, 16, test.full_width, test_byte1 };
+		callback_data cb2_data = { dst_image.as_write_buffer(), 0, 0, 16, test.full_width, test_byte3 };
+
+		src_image.set_fill_val(test_byte1);
+		tmp_image.set_fill_val(test_byte2);
+		dst_image.set_fill_val(test_byte3);
+
+		graph.process(src_image.as_read_buffer(), tmp_image.as_write_buffer(), tmp.data(), { cb, &cb1_data }, { cb, &cb2_data });
+
+		SCOPED_TRACE("validating src");
+		src_image.validate();
+		SCOPED_TRACE("validating tmp");
+		tmp_image.validate();
+		SCOPED_TRACE("validating dst");
+		dst_image.validate();
+
+		// Asynchronous I/O does not wait to fill a batch.
+		if (test.calls) {
+			EXPECT_EQ(test.calls, cb1_data.call_count);
+			EXPECT_EQ(test.calls, cb2_data.call_count);
+		}
+	}
+}
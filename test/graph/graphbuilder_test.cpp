@@ -0,0 +1,192 @@
+#include <cstdint>
+#include <vector>
+
+#include "colorspace/colorspace.h"
+#include "common/alloc.h"
+#include "common/cpuinfo.h"
+#include "common/make_unique.h"
+#include "common/pixel.h"
+#include "depth/depth.h"
+#include "graph/filtergraph.h"
+#include "graph/graphbuilder.h"
+#include "graph/image_buffer.h"
+#include "graph/image_filter.h"
+#include "resize/filter.h"
+#include "unresize/unresize.h"
+
+#include "gtest/gtest.h"
+
+namespace {
+
+enum class Stage {
+	DEPTH,
+	UNRESIZE,
+};
+
+struct StageRecord {
+	Stage stage;
+	zimg::PixelType type_in;
+	zimg::PixelType type_out;
+	zimg::depth::DitherType dither_type;
+};
+
+class RecordingFilterFactory : public zimg::graph::DefaultFilterFactory {
+public:
+	std::vector<StageRecord> stages;
+
+	filter_list create_depth(const zimg::depth::DepthConversion &conv) override
+	{
+		stages.push_back({ Stage::DEPTH, conv.pixel_in.type, conv.pixel_out.type, conv.dither_type });
+		return DefaultFilterFactory::create_depth(conv);
+	}
+
+	filter_list create_unresize(const zimg::unresize::UnresizeConversion &conv) override
+	{
+		stages.push_back({ Stage::UNRESIZE, conv.type, conv.type, zimg::depth::DitherType::NONE });
+		return DefaultFilterFactory::create_unresize(conv);
+	}
+};
+
+zimg::graph::GraphBuilder::state make_grey_state(unsigned width, unsigned height, zimg::PixelType type, unsigned depth)
+{
+	zimg::graph::GraphBuilder::state state{};
+
+	state.width = width;
+	state.height = height;
+	state.type = type;
+	state.color = zimg::graph::GraphBuilder::ColorFamily::GREY;
+	state.colorspace = { zimg::colorspace::MatrixCoefficients::UNSPECIFIED, zimg::colorspace::TransferCharacteristics::UNSPECIFIED, zimg::colorspace::ColorPrimaries::UNSPECIFIED };
+	state.depth = depth;
+	state.fullrange = false;
+	state.active_width = width;
+	state.active_height = height;
+
+	return state;
+}
+
+std::vector<StageRecord> build_unresize_graph(const zimg::graph::GraphBuilder::state &source, const zimg::graph::GraphBuilder::state &target, zimg::depth::DitherType dither_type)
+{
+	zimg::graph::GraphBuilder::params params;
+	params.filter = ztd::make_unique<zimg::resize::BicubicFilter>(1.0 / 3.0, 1.0 / 3.0);
+	params.filter_uv = ztd::make_unique<zimg::resize::BilinearFilter>();
+	params.unresize = true;
+	params.dither_type = dither_type;
+	params.cpu = zimg::CPUClass::NONE;
+
+	RecordingFilterFactory factory;
+	zimg::graph::GraphBuilder builder;
+	builder.set_source(source)
+	       .connect_graph(target, &params, &factory)
+	       .complete_graph();
+
+	return factory.stages;
+}
+
+} // namespace
+
+
+TEST(GraphBuilderTest, test_unresize_dither_after)
+{
+	auto source = make_grey_state(640, 480, zimg::PixelType::WORD, 16);
+	auto target = make_grey_state(320, 240, zimg::PixelType::WORD, 10);
+
+	auto stages = build_unresize_graph(source, target, zimg::depth::DitherType::ORDERED);
+	ASSERT_EQ(3U, stages.size());
+
+	// The source is converted to float without loss, and is only quantized to the target depth after unresize.
+	EXPECT_EQ(Stage::DEPTH, stages[0].stage);
+	EXPECT_EQ(zimg::PixelType::FLOAT, stages[0].type_out);
+
+	EXPECT_EQ(Stage::UNRESIZE, stages[1].stage);
+	EXPECT_EQ(zimg::PixelType::FLOAT, stages[1].type_in);
+
+	EXPECT_EQ(Stage::DEPTH, stages[2].stage);
+	EXPECT_EQ(zimg::PixelType::FLOAT, stages[2].type_in);
+	EXPECT_EQ(zimg::PixelType::WORD, stages[2].type_out);
+	EXPECT_EQ(zimg::depth::DitherType::ORDERED, stages[2].dither_type);
+}
+
+TEST(GraphBuilderTest, test_unresize_float_dither_after)
+{
+	auto source = make_grey_state(640, 480, zimg::PixelType::FLOAT, 32);
+	auto target = make_grey_state(320, 240, zimg::PixelType::WORD, 10);
+
+	auto stages = build_unresize_graph(source, target, zimg::depth::DitherType::ERROR_DIFFUSION);
+	ASSERT_EQ(2U, stages.size());
+
+	EXPECT_EQ(Stage::UNRESIZE, stages[0].stage);
+	EXPECT_EQ(zimg::PixelType::FLOAT, stages[0].type_in);
+
+	EXPECT_EQ(Stage::DEPTH, stages[1].stage);
+	EXPECT_EQ(zimg::PixelType::WORD, stages[1].type_out);
+	EXPECT_EQ(zimg::depth::DitherType::ERROR_DIFFUSION, stages[1].dither_type);
+}
+
+TEST(GraphBuilderTest, test_unresize_word_direct)
+{
+	auto source = make_grey_state(640, 480, zimg::PixelType::WORD, 10);
+	auto target = make_grey_state(320, 240, zimg::PixelType::WORD, 10);
+
+	// Without dithering, a source already in the target format is unresized directly.
+	auto stages = build_unresize_graph(source, target, zimg::depth::DitherType::NONE);
+	ASSERT_EQ(1U, stages.size());
+	EXPECT_EQ(Stage::UNRESIZE, stages[0].stage);
+	EXPECT_EQ(zimg::PixelType::WORD, stages[0].type_in);
+
+	// With dithering, the rounding is deferred to the depth conversion.
+	stages = build_unresize_graph(source, target, zimg::depth::DitherType::ORDERED);
+	ASSERT_EQ(3U, stages.size());
+	EXPECT_EQ(Stage::UNRESIZE, stages[1].stage);
+	EXPECT_EQ(zimg::PixelType::FLOAT, stages[1].type_in);
+	EXPECT_EQ(Stage::DEPTH, stages[2].stage);
+	EXPECT_EQ(zimg::depth::DitherType::ORDERED, stages[2].dither_type);
+}
+
+
+TEST(GraphBuilderTest, test_unresize_tile_cache)
+{
+	const unsigned w = 1024;
+	const unsigned src_h = 600;
+	const unsigned dst_h = 400;
+
+	// A vertical unresize buffers the full height of its input, which is converted to float by the graph.
+	auto source = make_grey_state(w, src_h, zimg::PixelType::WORD, 16);
+	auto target = make_grey_state(w, dst_h, zimg::PixelType::WORD, 10);
+
+	zimg::graph::GraphBuilder::params params;
+	params.filter = ztd::make_unique<zimg::resize::BicubicFilter>(1.0 / 3.0, 1.0 / 3.0);
+	params.filter_uv = ztd::make_unique<zimg::resize::BilinearFilter>();
+	params.unresize = true;
+	params.dither_type = zimg::depth::DitherType::ORDERED;
+	params.cpu = zimg::CPUClass::NONE;
+
+	zimg::graph::GraphBuilder builder;
+	auto graph = builder.set_source(source)
+	                    .connect_graph(target, &params)
+	                    .complete_graph();
+
+	const ptrdiff_t stride = w * sizeof(uint16_t);
+	zimg::AlignedVector<uint16_t> src(w * src_h);
+	zimg::AlignedVector<uint16_t> dst[2] = { zimg::AlignedVector<uint16_t>(w * dst_h), zimg::AlignedVector<uint16_t>(w * dst_h) };
+	size_t tmp_size[2];
+
+	for (size_t i = 0; i < src.size(); ++i) {
+		src[i] = static_cast<uint16_t>((i * 2654435761U) >> 16);
+	}
+
+	zimg::graph::ImageBuffer<const void> src_buf[3] = { { src.data(), stride, zimg::graph::BUFFER_MAX } };
+	const unsigned tile_width[2] = { w, 256 };
+
+	for (unsigned n = 0; n < 2; ++n) {
+		graph->set_tile_width(tile_width[n]);
+		tmp_size[n] = graph->get_tmp_size();
+
+		zimg::AlignedVector<char> tmp(tmp_size[n]);
+		zimg::graph::ImageBuffer<void> dst_buf[3] = { { dst[n].data(), stride, zimg::graph::BUFFER_MAX } };
+		graph->process(src_buf, dst_buf, tmp.data(), nullptr, nullptr);
+	}
+
+	// The full-height caches only hold the columns of one tile.
+	EXPECT_LT(tmp_size[1], tmp_size[0] / 3);
+	EXPECT_TRUE(dst[0] == dst[1]);
+}
@@ -93,7 +93,7 @@ size_t MockFilter::get_tmp_size(unsigned left, unsigned right) const
 	return 0;
 }
 
-void MockFilter::init_context(void *ctx) const
+void MockFilter::init_context(void *ctx, unsigned) const
 {
 	new (ctx) context{};
 }
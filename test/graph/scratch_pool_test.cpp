@@ -0,0 +1,88 @@
+#include <cstdint>
+#include <thread>
+#include "common/align.h"
+#include "graph/scratch_pool.h"
+
+#include "gtest/gtest.h"
+
+TEST(ScratchPoolTest, test_reuse)
+{
+	zimg::graph::ScratchPool pool;
+	void *ptr;
+
+	{
+		auto lease = pool.acquire(5000);
+		ptr = lease.get();
+		ASSERT_TRUE(ptr);
+		EXPECT_EQ(0U, reinterpret_cast<uintptr_t>(ptr) % zimg::ALIGNMENT);
+		EXPECT_EQ(0U, pool.cached_size());
+	}
+	EXPECT_EQ(8192U, pool.cached_size());
+
+	// A smaller request in the same size class reuses the buffer.
+	{
+		auto lease = pool.acquire(4097);
+		EXPECT_EQ(ptr, lease.get());
+	}
+
+	// Buffers in use are not shared.
+	{
+		auto lease1 = pool.acquire(8192);
+		auto lease2 = pool.acquire(8192);
+		EXPECT_NE(lease1.get(), lease2.get());
+
+		auto lease3 = pool.acquire(100);
+		EXPECT_NE(lease3.get(), lease1.get());
+		EXPECT_NE(lease3.get(), lease2.get());
+	}
+	EXPECT_EQ(8192U * 2 + 4096U, pool.cached_size());
+
+	pool.trim();
+	EXPECT_EQ(0U, pool.cached_size());
+}
+
+TEST(ScratchPoolTest, test_high_water_mark)
+{
+	zimg::graph::ScratchPool pool;
+	size_t base = zimg::graph::ScratchPool::allocated_size();
+
+	zimg::graph::ScratchPool::reset_high_water_mark();
+	{
+		auto lease1 = pool.acquire(65536);
+		auto lease2 = pool.acquire(65536);
+		EXPECT_EQ(base + 131072, zimg::graph::ScratchPool::allocated_size());
+	}
+
+	// Trimming releases memory, but does not lower the high-water mark.
+	pool.trim();
+	EXPECT_EQ(base, zimg::graph::ScratchPool::allocated_size());
+	EXPECT_GE(zimg::graph::ScratchPool::high_water_mark(), base + 131072);
+
+	zimg::graph::ScratchPool::reset_high_water_mark();
+	EXPECT_LT(zimg::graph::ScratchPool::high_water_mark(), base + 131072);
+}
+
+TEST(ScratchPoolTest, test_thread_local)
+{
+	void *ptr1;
+	void *ptr2;
+
+	zimg::graph::ScratchPool::local().trim();
+	{
+		auto lease = zimg::graph::ScratchPool::local().acquire(4096);
+		ptr1 = lease.get();
+	}
+
+	std::thread thread{ [&]()
+	{
+		// Each thread has its own pool, and the pool is released at thread exit.
+		EXPECT_EQ(0U, zimg::graph::ScratchPool::local().cached_size());
+		auto lease = zimg::graph::ScratchPool::local().acquire(4096);
+		ptr2 = lease.get();
+	} };
+	thread.join();
+
+	EXPECT_NE(ptr1, ptr2);
+	EXPECT_EQ(4096U, zimg::graph::ScratchPool::local().cached_size());
+	zimg::graph::ScratchPool::local().trim();
+}
@@ -0,0 +1,72 @@
+#include <string>
+#include <thread>
+#include <vector>
+#include "graph/trace.h"
+
+#include "gtest/gtest.h"
+
+TEST(TraceBufferTest, test_ring)
+{
+	zimg::graph::TraceBuffer trace{ 4 };
+	auto t = zimg::graph::TraceBuffer::clock::now();
+
+	for (unsigned i = 0; i < 6; ++i) {
+		trace.record("event", zimg::graph::TraceBuffer::category::FILTER, t, t, i, 0, 16);
+	}
+
+	auto events = trace.get_events();
+	ASSERT_EQ(4U, events.size());
+	for (unsigned i = 0; i < 4; ++i) {
+		EXPECT_EQ(i + 2, events[i].row);
+	}
+
+	trace.clear();
+	EXPECT_TRUE(trace.get_events().empty());
+}
+
+TEST(TraceBufferTest, test_concurrent)
+{
+	zimg::graph::TraceBuffer trace{ 16 };
+	auto t = zimg::graph::TraceBuffer::clock::now();
+
+	auto func = [&](unsigned id)
+	{
+		for (unsigned i = 0; i < 10000; ++i) {
+			trace.record("event", zimg::graph::TraceBuffer::category::FILTER, t, t, id, id, id + 1);
+		}
+	};
+
+	std::vector<std::thread> threads;
+	for (unsigned id = 0; id < 4; ++id) {
+		threads.emplace_back(func, id);
+	}
+	for (auto &th : threads) {
+		th.join();
+	}
+
+	// Slots overwritten concurrently must not mix fields of different events.
+	auto events = trace.get_events();
+	EXPECT_FALSE(events.empty());
+	EXPECT_LE(events.size(), 16U);
+
+	for (const auto &e : events) {
+		EXPECT_EQ(e.row, e.left);
+		EXPECT_EQ(e.row + 1, e.right);
+	}
+}
+
+TEST(TraceBufferTest, test_json)
+{
+	zimg::graph::TraceBuffer trace{ 16 };
+	auto t = zimg::graph::TraceBuffer::clock::now();
+
+	trace.record("tile", zimg::graph::TraceBuffer::category::TILE, t, t + std::chrono::nanoseconds{ 1500 }, 0, 0, 128);
+	trace.record("Filter<\"x\">", zimg::graph::TraceBuffer::category::FILTER, t, t + std::chrono::microseconds{ 2 }, 7, 0, 128);
+
+	std::string json = trace.to_json();
+	EXPECT_EQ(0U, json.find("{\"displayTimeUnit\":\"ns\",\"traceEvents\":["));
+	EXPECT_NE(std::string::npos, json.find("\"name\":\"tile\",\"cat\":\"tile\",\"ph\":\"X\""));
+	EXPECT_NE(std::string::npos, json.find("\"dur\":1.500,\"args\":{\"left\":0,\"right\":128}}"));
+	EXPECT_NE(std::string::npos, json.find("\"name\":\"Filter<\\\"x\\\">\",\"cat\":\"filter\""));
+	EXPECT_NE(std::string::npos, json.find("\"dur\":2.000,\"args\":{\"row\":7,\"left\":0,\"right\":128}}"));
+}
@@ -0,0 +1,114 @@
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <random>
+#include "common/alloc.h"
+#include "common/pixel.h"
+#include "graph/image_buffer.h"
+#include "graph/image_filter.h"
+#include "resize/filter.h"
+#include "resize/resize_impl.h"
+#include "unresize/unresize_impl.h"
+
+#include "gtest/gtest.h"
+
+namespace {
+
+typedef zimg::AlignedVector<float> plane_type;
+
+void run_filter(const zimg::graph::ImageFilter *filter, const plane_type &src, ptrdiff_t src_stride, plane_type &dst, ptrdiff_t dst_stride)
+{
+	auto attr = filter->get_image_attributes();
+	zimg::AlignedVector<unsigned char> ctx(filter->get_context_size());
+	zimg::AlignedVector<unsigned char> tmp(filter->get_tmp_size(0, attr.width));
+
+	zimg::graph::ImageBuffer<const void> src_buf{ src.data(), src_stride, zimg::graph::BUFFER_MAX };
+	zimg::graph::ImageBuffer<void> dst_buf{ dst.data(), dst_stride, zimg::graph::BUFFER_MAX };
+
+	filter->init_context(ctx.data(), 0);
+
+	for (unsigned i = 0; i < attr.height; i += filter->get_simultaneous_lines()) {
+		filter->process(ctx.data(), &src_buf, &dst_buf, tmp.data(), i, 0, attr.width);
+	}
+}
+
+// Scale a random image with the resizer, and check that unresize recovers the original.
+void test_case(const zimg::resize::Filter &resample_filter, bool horizontal, unsigned orig_dim, unsigned up_dim, double shift, double max_error)
+{
+	const unsigned w = horizontal ? orig_dim : 64;
+	const unsigned h = horizontal ? 16 : orig_dim;
+	const unsigned up_w = horizontal ? up_dim : w;
+	const unsigned up_h = horizontal ? h : up_dim;
+
+	SCOPED_TRACE(resample_filter.support());
+	SCOPED_TRACE(horizontal ? "h" : "v");
+
+	auto resize = zimg::resize::ResizeImplBuilder{ w, h, zimg::PixelType::FLOAT }
+		.set_horizontal(horizontal)
+		.set_dst_dim(up_dim)
+		.set_filter(&resample_filter)
+		.set_shift(shift * orig_dim / up_dim)
+		.set_subwidth(orig_dim)
+		.create();
+	auto unresize = zimg::unresize::UnresizeImplBuilder{ up_w, up_h, zimg::PixelType::FLOAT }
+		.set_horizontal(horizontal)
+		.set_orig_dim(orig_dim)
+		.set_shift(shift)
+		.set_filter(&resample_filter)
+		.create();
+
+	ptrdiff_t stride = zimg::ceil_n(std::max(w, up_w) * sizeof(float), zimg::ALIGNMENT);
+	unsigned rows = std::max(h, up_h);
+
+	plane_type orig(stride / sizeof(float) * rows);
+	plane_type scaled(orig.size());
+	plane_type result(orig.size());
+
+	std::mt19937 mt;
+	std::uniform_real_distribution<float> dist{ 0.0f, 1.0f };
+	std::generate(orig.begin(), orig.end(), [&]() { return dist(mt); });
+
+	run_filter(resize.get(), orig, stride, scaled, stride);
+	run_filter(unresize.get(), scaled, stride, result, stride);
+
+	double error = 0.0;
+
+	for (unsigned i = 0; i < h; ++i) {
+		for (unsigned j = 0; j < w; ++j) {
+			size_t idx = i * (stride / sizeof(float)) + j;
+			error = std::max(error, static_cast<double>(std::fabs(result[idx] - orig[idx])));
+		}
+	}
+	EXPECT_LT(error, max_error);
+}
+
+void test_filters(bool horizontal, unsigned orig_dim, unsigned up_dim, double shift)
+{
+	const zimg::resize::BilinearFilter bilinear{};
+	const zimg::resize::BicubicFilter bicubic{ 1.0 / 3.0, 1.0 / 3.0 };
+	const zimg::resize::BicubicFilter catmull_rom{ 0.0, 0.5 };
+	const zimg::resize::Spline16Filter spline16{};
+	const zimg::resize::Spline36Filter spline36{};
+	const zimg::resize::LanczosFilter lanczos3{ 3 };
+
+	const zimg::resize::Filter *resample_filters[] = { &bilinear, &bicubic, &catmull_rom, &spline16, &spline36, &lanczos3 };
+
+	for (const zimg::resize::Filter *resample_filter : resample_filters) {
+		test_case(*resample_filter, horizontal, orig_dim, up_dim, shift, 1e-3);
+	}
+}
+
+} // namespace
+
+
+TEST(UnresizeImplTest, test_inverse_h)
+{
+	test_filters(true, 320, 480, 0.0);
+	test_filters(true, 321, 643, 0.25);
+}
+
+TEST(UnresizeImplTest, test_inverse_v)
+{
+	test_filters(false, 240, 360, 0.0);
+	test_filters(false, 241, 483, -0.25);
+}
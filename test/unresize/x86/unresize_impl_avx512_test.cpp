@@ -0,0 +1,159 @@
+#ifdef ZIMG_X86_AVX512
+
+#include <cmath>
+#include "common/cpuinfo.h"
+#include "common/pixel.h"
+#include "common/x86/cpuinfo_x86.h"
+#include "resize/filter.h"
+#include "unresize/unresize_impl.h"
+
+#include "gtest/gtest.h"
+#include "graph/filter_validator.h"
+
+namespace {
+
+void test_case(bool horizontal, unsigned up_w, unsigned up_h, unsigned orig_dim, const zimg::PixelFormat &src_format, zimg::PixelType dst_type,
+               const char * const expected_sha1[3], double expected_snr, const zimg::resize::Filter *resample_filter = nullptr)
+{
+	if (!zimg::query_x86_capabilities().avx512f) {
+		SUCCEED() << "avx512 not available, skipping";
+		return;
+	}
+
+	SCOPED_TRACE(horizontal ? static_cast<double>(orig_dim) / up_w : static_cast<double>(orig_dim) / up_h);
+
+	auto builder = zimg::unresize::UnresizeImplBuilder{ up_w, up_h, src_format.type }
+		.set_dst_type(dst_type)
+		.set_depth(src_format.depth)
+		.set_horizontal(horizontal)
+		.set_orig_dim(orig_dim)
+		.set_shift(0.0)
+		.set_filter(resample_filter);
+
+	std::unique_ptr<zimg::graph::ImageFilter> filter_avx512 = builder.set_cpu(zimg::CPUClass::X86_AVX512).create();
+	std::unique_ptr<zimg::graph::ImageFilter> filter_c = builder.set_cpu(zimg::CPUClass::NONE).create();
+
+	ASSERT_FALSE(assert_different_dynamic_type(filter_c.get(), filter_avx512.get()));
+
+	FilterValidator validator{ filter_avx512.get(), up_w, up_h, src_format };
+	validator.set_sha1(expected_sha1)
+	         .set_ref_filter(filter_c.get(), expected_snr);
+	validator.validate();
+}
+
+} // namespace
+
+
+TEST(UnresizeImplAVX512Test, test_unresize_h_f32)
+{
+	const unsigned up_w = 960;
+	const unsigned orig_w = 640;
+	const unsigned h = 480;
+
+	const char *expected_sha1[][3] = {
+		{ "21478209828c24819c8b1e72911b0d9f3f742d33" },
+		{ "fd95309ec45f148d9f60aa1f43c3b56afc191159" }
+	};
+	const double expected_snr = 120.0;
+
+	test_case(true, up_w, h, orig_w, zimg::PixelType::FLOAT, zimg::PixelType::FLOAT, expected_sha1[0], expected_snr);
+	test_case(true, up_w + 5, h + 3, orig_w + 1, zimg::PixelType::FLOAT, zimg::PixelType::FLOAT, expected_sha1[1], expected_snr);
+}
+
+TEST(UnresizeImplAVX512Test, test_unresize_v_f32)
+{
+	const unsigned w = 640;
+	const unsigned up_h = 720;
+	const unsigned orig_h = 480;
+
+	const char *expected_sha1[][3] = {
+		{ "ae2b0af5583e44e13d3973229d428b8c6fecc01f" },
+		{ "9f65802b8261870950d71720d139507c83a80084" }
+	};
+	const double expected_snr = 120.0;
+
+	test_case(false, w, up_h, orig_h, zimg::PixelType::FLOAT, zimg::PixelType::FLOAT, expected_sha1[0], expected_snr);
+	test_case(false, w + 5, up_h + 3, orig_h + 1, zimg::PixelType::FLOAT, zimg::PixelType::FLOAT, expected_sha1[1], expected_snr);
+}
+
+TEST(UnresizeImplAVX512Test, test_unresize_h_u16)
+{
+	const unsigned up_w = 960;
+	const unsigned orig_w = 640;
+	const unsigned h = 480;
+	const zimg::PixelFormat format_u10{ zimg::PixelType::WORD, 10 };
+	const zimg::PixelFormat format_u16{ zimg::PixelType::WORD, 16 };
+
+	const char *expected_sha1[][3] = {
+		{ "60ff6ce1061f65bbf86c5e71f5c799b368b02428" },
+		{ "58d0fc34816d7c3b65773980fb183d15637caf47" },
+		{ "82973c95083768d9ea7f9d6acf438014d3aeac8c" },
+		{ "edff0fb4ed0f906591edad0cde2a6feb46a74734" }
+	};
+	const double expected_snr = 80.0;
+
+	test_case(true, up_w, h, orig_w, format_u10, zimg::PixelType::WORD, expected_sha1[0], expected_snr);
+	test_case(true, up_w, h, orig_w, format_u16, zimg::PixelType::WORD, expected_sha1[1], expected_snr);
+	test_case(true, up_w, h, orig_w, format_u16, zimg::PixelType::FLOAT, expected_sha1[2], expected_snr);
+	test_case(true, up_w, h, orig_w, zimg::PixelType::FLOAT, zimg::PixelType::WORD, expected_sha1[3], expected_snr);
+}
+
+TEST(UnresizeImplAVX512Test, test_unresize_v_u16)
+{
+	const unsigned w = 640;
+	const unsigned up_h = 720;
+	const unsigned orig_h = 480;
+	const zimg::PixelFormat format_u10{ zimg::PixelType::WORD, 10 };
+	const zimg::PixelFormat format_u16{ zimg::PixelType::WORD, 16 };
+
+	const char *expected_sha1[][3] = {
+		{ "453ac4a23b2b1bdd3b6eb4b36c6417a3b347ba39" },
+		{ "b3fe62039ec15788f744495ef484c0c7ef4f1eb9" },
+		{ "ccb19f83f22de016c406aa1a8172daf1c1f44227" },
+		{ "c1b3d0f96a849764b4bfac77534b05529af0a85e" }
+	};
+	const double expected_snr = 80.0;
+
+	test_case(false, w, up_h, orig_h, format_u10, zimg::PixelType::WORD, expected_sha1[0], expected_snr);
+	test_case(false, w, up_h, orig_h, format_u16, zimg::PixelType::WORD, expected_sha1[1], expected_snr);
+	test_case(false, w, up_h, orig_h, format_u16, zimg::PixelType::FLOAT, expected_sha1[2], expected_snr);
+	test_case(false, w, up_h, orig_h, zimg::PixelType::FLOAT, zimg::PixelType::WORD, expected_sha1[3], expected_snr);
+}
+
+TEST(UnresizeImplAVX512Test, test_unresize_h_banded)
+{
+	const unsigned up_w = 965;
+	const unsigned orig_w = 641;
+	const unsigned h = 483;
+	const zimg::resize::BicubicFilter bicubic{ 1.0 / 3.0, 1.0 / 3.0 };
+	const zimg::resize::LanczosFilter lanczos3{ 3 };
+
+	const char *expected_sha1[][3] = {
+		{ "f3d44eb5cc51b9e9846e3cbd9aaca3bcde0dc810" },
+		{ "943ac3f1066020c65fb59491ff1fcd679681b956" }
+	};
+	const double expected_snr = 100.0;
+
+	test_case(true, up_w, h, orig_w, zimg::PixelType::FLOAT, zimg::PixelType::FLOAT, expected_sha1[0], expected_snr, &bicubic);
+	test_case(true, up_w, h, orig_w, zimg::PixelType::FLOAT, zimg::PixelType::FLOAT, expected_sha1[1], expected_snr, &lanczos3);
+}
+
+TEST(UnresizeImplAVX512Test, test_unresize_v_banded)
+{
+	const unsigned w = 645;
+	const unsigned up_h = 723;
+	const unsigned orig_h = 481;
+	const zimg::resize::BicubicFilter bicubic{ 1.0 / 3.0, 1.0 / 3.0 };
+	const zimg::resize::LanczosFilter lanczos3{ 3 };
+
+	const char *expected_sha1[][3] = {
+		{ "c9ad00303fed67db8f5aa8e3d9fbd80057105bb9" },
+		{ "5d7459b7acdd434ce257bb67187c24b694369009" }
+	};
+	const double expected_snr = 100.0;
+
+	test_case(false, w, up_h, orig_h, zimg::PixelType::FLOAT, zimg::PixelType::FLOAT, expected_sha1[0], expected_snr, &bicubic);
+	test_case(false, w, up_h, orig_h, zimg::PixelType::FLOAT, zimg::PixelType::FLOAT, expected_sha1[1], expected_snr, &lanczos3);
+}
+
+#endif // ZIMG_X86_AVX512
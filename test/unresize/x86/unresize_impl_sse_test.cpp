@@ -0,0 +1,113 @@
+#ifdef ZIMG_X86
+
+#include <cmath>
+#include "common/cpuinfo.h"
+#include "common/pixel.h"
+#include "common/x86/cpuinfo_x86.h"
+#include "resize/filter.h"
+#include "unresize/unresize_impl.h"
+
+#include "gtest/gtest.h"
+#include "graph/filter_validator.h"
+
+namespace {
+
+void test_case(bool horizontal, unsigned up_w, unsigned up_h, unsigned orig_dim, const char * const expected_sha1[3], double expected_snr,
+               const zimg::resize::Filter *resample_filter = nullptr)
+{
+	if (!zimg::query_x86_capabilities().sse) {
+		SUCCEED() << "sse not available, skipping";
+		return;
+	}
+
+	SCOPED_TRACE(horizontal ? static_cast<double>(orig_dim) / up_w : static_cast<double>(orig_dim) / up_h);
+
+	auto builder = zimg::unresize::UnresizeImplBuilder{ up_w, up_h, zimg::PixelType::FLOAT }
+		.set_horizontal(horizontal)
+		.set_orig_dim(orig_dim)
+		.set_shift(0.0)
+		.set_filter(resample_filter);
+
+	std::unique_ptr<zimg::graph::ImageFilter> filter_sse = builder.set_cpu(zimg::CPUClass::X86_SSE).create();
+	std::unique_ptr<zimg::graph::ImageFilter> filter_c = builder.set_cpu(zimg::CPUClass::NONE).create();
+
+	ASSERT_FALSE(assert_different_dynamic_type(filter_c.get(), filter_sse.get()));
+
+	FilterValidator validator{ filter_sse.get(), up_w, up_h, zimg::PixelType::FLOAT };
+	validator.set_sha1(expected_sha1)
+	         .set_ref_filter(filter_c.get(), expected_snr);
+	validator.validate();
+}
+
+} // namespace
+
+
+TEST(UnresizeImplSSETest, test_unresize_h_f32)
+{
+	const unsigned up_w = 960;
+	const unsigned orig_w = 640;
+	const unsigned h = 480;
+
+	const char *expected_sha1[][3] = {
+		{ "2cc978b236a9b0ae4cacb72f7b01f6392dda7eb8" },
+		{ "28c3e97f3b0ab23fc4517757e97a3b0a3f19a105" }
+	};
+	const double expected_snr = INFINITY;
+
+	test_case(true, up_w, h, orig_w, expected_sha1[0], expected_snr);
+	test_case(true, up_w + 5, h + 3, orig_w + 1, expected_sha1[1], expected_snr);
+}
+
+TEST(UnresizeImplSSETest, test_unresize_v_f32)
+{
+	const unsigned w = 640;
+	const unsigned up_h = 720;
+	const unsigned orig_h = 480;
+
+	const char *expected_sha1[][3] = {
+		{ "ba371921938c0a440541324b36bcba58d54401d3" },
+		{ "e52fd6903e62523df9c81720245a253eceaa1c42" }
+	};
+	const double expected_snr = INFINITY;
+
+	test_case(false, w, up_h, orig_h, expected_sha1[0], expected_snr);
+	test_case(false, w + 5, up_h + 3, orig_h + 1, expected_sha1[1], expected_snr);
+}
+
+TEST(UnresizeImplSSETest, test_unresize_h_banded)
+{
+	const unsigned up_w = 965;
+	const unsigned orig_w = 641;
+	const unsigned h = 483;
+	const zimg::resize::BicubicFilter bicubic{ 1.0 / 3.0, 1.0 / 3.0 };
+	const zimg::resize::LanczosFilter lanczos3{ 3 };
+
+	const char *expected_sha1[][3] = {
+		{ "d7c76ca3da39d8003081954a9d2f68c10789f654" },
+		{ "84336edbe61e957f1548177467116f148a6fcead" }
+	};
+	const double expected_snr = INFINITY;
+
+	test_case(true, up_w, h, orig_w, expected_sha1[0], expected_snr, &bicubic);
+	test_case(true, up_w, h, orig_w, expected_sha1[1], expected_snr, &lanczos3);
+}
+
+TEST(UnresizeImplSSETest, test_unresize_v_banded)
+{
+	const unsigned w = 645;
+	const unsigned up_h = 723;
+	const unsigned orig_h = 481;
+	const zimg::resize::BicubicFilter bicubic{ 1.0 / 3.0, 1.0 / 3.0 };
+	const zimg::resize::LanczosFilter lanczos3{ 3 };
+
+	const char *expected_sha1[][3] = {
+		{ "d4c0fb8e86fa3534c383fca74ac9f88de49d7310" },
+		{ "e5cd978abe88d7aee36b4ad6d5c2d14326201779" }
+	};
+	const double expected_snr = INFINITY;
+
+	test_case(false, w, up_h, orig_h, expected_sha1[0], expected_snr, &bicubic);
+	test_case(false, w, up_h, orig_h, expected_sha1[1], expected_snr, &lanczos3);
+}
+
+#endif // ZIMG_X86